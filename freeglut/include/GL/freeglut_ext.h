@@ -90,6 +90,22 @@
 
 #define  GLUT_STROKE_FONT_DRAW_JOIN_DOTS    0x0206  /* Draw dots between line segments of stroke fonts? */
 
+#define  GLUT_BITMAP_FONT_ATLAS             0x0207  /* Draw bitmap fonts from a texture atlas instead of glBitmap? */
+
+#define  GLUT_GEOMETRY_TEAPOT_SUBDIVISIONS  0x0208  /* Vertices along each side of a teapot, teacup or teaspoon patch, 0 for the default */
+
+#define  GLUT_GEOMETRY_INSTANCES            0x0209  /* Instances of each shape drawn through glutSetShapeUniform */
+
+#define  GLUT_GL_STATE_FILTER               0x020A  /* Keep freeglut's shadow of GL bindings between calls? Setting it forgets the shadow */
+#define  GLUT_GL_CALLS_ISSUED               0x020B  /* Binding calls and queries freeglut made through the shadow */
+#define  GLUT_GL_CALLS_ELIDED               0x020C  /* Those the shadow dropped as redundant */
+#define  GLUT_HEADLESS_FRAME_RATE           0x020D  /* Headless only: frames per second of a virtual clock, 0 for the real one */
+#define  GLUT_READBACK_DEPTH                0x020E  /* Frames glutReadFrameAsync keeps in flight, 0 for the default */
+#define  GLUT_RECORD_POOL_FRAMES            0x020F  /* Frames a recording may queue for its writer, 0 for the default */
+#define  GLUT_RECORD_FRAMES_WRITTEN         0x0210  /* Of the recording, or of the last one */
+#define  GLUT_RECORD_FRAMES_DROPPED         0x0211  /* Likewise, when the disk could not keep up */
+#define  GLUT_PROFILE_FRAMES                0x0212  /* Main loop iterations profiled, 0 to not profile */
+
 /*
  * New tokens for glutInitDisplayMode.
  * Only one GLUT_AUXn bit may be used at a time.
@@ -171,6 +187,19 @@ FGAPI GLfloat FGAPIENTRY glutStrokeHeight( void* font );
 FGAPI void    FGAPIENTRY glutBitmapString( void* font, const unsigned char *string );
 FGAPI void    FGAPIENTRY glutStrokeString( void* font, const unsigned char *string );
 
+/*
+ * Position and colour of bitmap text drawn from the font atlas, which is
+ * used instead of glBitmap in core profile contexts, see fg_font_atlas.c
+ */
+FGAPI void    FGAPIENTRY glutTextWindowPos2f( float x, float y );
+FGAPI void    FGAPIENTRY glutTextColor4f( float red, float green, float blue, float alpha );
+
+/*
+ * Stroke text of any size drawn from a distance field atlas at the text
+ * position, the font's height being pixelHeight pixels
+ */
+FGAPI void    FGAPIENTRY glutStrokeStringSDF( void* font, float pixelHeight, const unsigned char *string );
+
 /*
  * Geometry functions, see fg_geometry.c
  */
@@ -181,6 +210,49 @@ FGAPI void    FGAPIENTRY glutSolidSierpinskiSponge ( int num_levels, double offs
 FGAPI void    FGAPIENTRY glutWireCylinder( double radius, double height, GLint slices, GLint stacks);
 FGAPI void    FGAPIENTRY glutSolidCylinder( double radius, double height, GLint slices, GLint stacks);
 
+/* Slices and stacks chosen from the projected size, for a row major
+   modelview-projection matrix such as sim::mat4f::coefficients() */
+FGAPI void    FGAPIENTRY glutWireSphereLOD( double radius, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutSolidSphereLOD( double radius, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutWireConeLOD( double base, double height, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutSolidConeLOD( double base, double height, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutWireCylinderLOD( double radius, double height, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutSolidCylinderLOD( double radius, double height, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutWireTorusLOD( double innerRadius, double outerRadius, const GLfloat *modelviewProjection, double pixelError );
+FGAPI void    FGAPIENTRY glutSolidTorusLOD( double innerRadius, double outerRadius, const GLfloat *modelviewProjection, double pixelError );
+
+/* Built-in shapes baked into a file ahead of time, and mapped rather than
+   generated, see fg_shape_blob.c. NULL specs bake the default list. */
+FGAPI int     FGAPIENTRY glutBakeShapes( const char *path, const char *const *specs );
+FGAPI int     FGAPIENTRY glutMapShapes( const char *path );
+
+/*
+ * Frames read back without stalling, see fg_readback.c. The callback is
+ * given RGBA bytes, bottom row first, which are valid until it returns.
+ */
+FGAPI int     FGAPIENTRY glutReadFrameAsync( int x, int y, int width, int height,
+                                             void (* callback)( const void* pixels, int width, int height, int frame, void* userData ),
+                                             void* userData );
+FGAPI void    FGAPIENTRY glutReadFrameFlush( void );
+
+/*
+ * Recording the current window's frames to disk, see fg_record.c
+ */
+FGAPI int     FGAPIENTRY glutRecordStart( const char *path, int format, int framesPerSecond );
+FGAPI void    FGAPIENTRY glutRecordStop( void );
+/* Formats of glutRecordStart */
+#define GLUT_RECORD_RAW                     0x0001
+#define GLUT_RECORD_Y4M                     0x0002
+#define GLUT_RECORD_PNG                     0x0003
+
+/*
+ * Profiling the main loop and callbacks frame by frame, see fg_profile.c
+ */
+FGAPI void    FGAPIENTRY glutProfileBegin( const char *name );
+FGAPI void    FGAPIENTRY glutProfileEnd( void );
+FGAPI int     FGAPIENTRY glutProfileWriteTrace( const char *path );
+FGAPI int     FGAPIENTRY glutProfileWriteSummary( const char *path );
+
 /*
  * Rest of functions for rendering Newell's teaset, found in fg_teapot.c
  * NB: front facing polygons have clockwise winding, not counter clockwise
@@ -247,6 +319,11 @@ FGAPI void    FGAPIENTRY glutInitWarningFunc( void (* callback)( const char *fmt
 FGAPI void    FGAPIENTRY glutSetVertexAttribCoord3(GLint attrib);
 FGAPI void    FGAPIENTRY glutSetVertexAttribNormal(GLint attrib);
 FGAPI void    FGAPIENTRY glutSetVertexAttribTexCoord2(GLint attrib);
+/* Origin of each stroke font glyph, to be added to the coordinate, see fg_font_stroke.c */
+FGAPI void    FGAPIENTRY glutSetVertexAttribGlyphOffset2(GLint attrib);
+/* Shapes generated in the vertex shader from gl_VertexID, see fg_geometry_procedural.c */
+FGAPI const char* FGAPIENTRY glutGetShapeShaderSource(void);
+FGAPI void    FGAPIENTRY glutSetShapeUniform(GLint location);
 
 /* Mobile platforms lifecycle */
 FGAPI void    FGAPIENTRY glutInitContextFunc(void (* callback)());
@@ -0,0 +1,349 @@
+/*
+ * fg_batch.c
+ *
+ * Batched 2D output of coloured shapes and bitmap text, used by the menus.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * A batch collects triangles in window coordinates, with the origin at
+ * the top left like the menus use, each vertex having its own colour.
+ * Bitmap text is added to the same batch as quads textured from the font
+ * atlas (see fg_font_atlas.c), so that a whole menu, borders, highlights,
+ * arrows and labels alike, goes to OpenGL in a single glDrawArrays call
+ * with one shader, its vertices streamed through fg_stream.c. Texels
+ * below one half are discarded like the atlas path does; untextured
+ * vertices have a negative s coordinate.
+ *
+ * Images, such as the cached contents of a menu, are textured quads that
+ * modulate their colour instead. As a batch has a single texture, adding
+ * an image after text, text after an image, or another image, draws what
+ * the batch holds so far first.
+ *
+ * Batches need OpenGL 2.0, but work in core profiles as well as in
+ * compatibility ones. Only one batch can be built at a time.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+typedef struct tagSFG_BatchVertex SFG_BatchVertex;
+struct tagSFG_BatchVertex
+{
+    GLfloat X, Y, S, T;
+    GLubyte Color[ 4 ];
+};
+
+/* The vertices of the batch being built */
+static SFG_BatchVertex* fghBatchVertices = NULL;
+static int              fghBatchCount = 0;
+static int              fghBatchCapacity = 0;
+static GLfloat          fghBatchWidth, fghBatchHeight;
+static GLuint           fghBatchImage = 0;      /* 0 while drawing text    */
+
+static const char* fghBatchAttributes[] = { "fg_coord", "fg_texcoord", "fg_color", NULL };
+
+static const char* fghBatchVertexShader =
+    "uniform vec4 fg_transform;\n"
+    "attribute vec2 fg_coord;\n"
+    "attribute vec2 fg_texcoord;\n"
+    "attribute vec4 fg_color;\n"
+    "varying vec2 fg_uv;\n"
+    "varying vec4 fg_rgba;\n"
+    "void main()\n"
+    "{\n"
+    "    fg_uv = fg_texcoord;\n"
+    "    fg_rgba = fg_color;\n"
+    "    gl_Position = vec4(fg_coord * fg_transform.xy + fg_transform.zw, -1.0, 1.0);\n"
+    "}\n";
+
+static const char* fghBatchFragmentShader =
+    "uniform sampler2D fg_texture;\n"
+    "uniform int fg_image;\n"
+    "varying vec2 fg_uv;\n"
+    "varying vec4 fg_rgba;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 color = fg_rgba;\n"
+    "    if (fg_uv.x >= 0.0)\n"
+    "    {\n"
+    "        vec4 texel = fgTexture2D(fg_texture, fg_uv);\n"
+    "        if (fg_image != 0)\n"
+    "            color *= texel;\n"
+    "        else if (texel.r < 0.5)\n"
+    "            discard;\n"
+    "    }\n"
+    "    fgFragColor = color;\n"
+    "}\n";
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static SFG_BatchVertex* fghReserveBatch( int vertices )
+{
+    if( fghBatchCount + vertices > fghBatchCapacity )
+    {
+        int capacity = fghBatchCapacity ? fghBatchCapacity : 256;
+        SFG_BatchVertex* batch;
+
+        while( capacity < fghBatchCount + vertices )
+            capacity *= 2;
+        batch = realloc( fghBatchVertices, capacity * sizeof( SFG_BatchVertex ) );
+        if( !batch )
+            fgError( "Failed to allocate memory in fghReserveBatch" );
+        fghBatchVertices = batch;
+        fghBatchCapacity = capacity;
+    }
+    return fghBatchVertices + fghBatchCount;
+}
+
+static void fghBatchVertex( SFG_BatchVertex* v, GLfloat x, GLfloat y, GLfloat s, GLfloat t,
+                            const GLubyte* color )
+{
+    v->X = x;
+    v->Y = y;
+    v->S = s;
+    v->T = t;
+    v->Color[ 0 ] = color[ 0 ];
+    v->Color[ 1 ] = color[ 1 ];
+    v->Color[ 2 ] = color[ 2 ];
+    v->Color[ 3 ] = color[ 3 ];
+}
+
+static void fghPackColor( GLubyte* packed, const GLfloat* color )
+{
+    int i;
+    for( i = 0; i < 4; i++ )
+        packed[ i ] = (GLubyte)( ( color[ i ] < 0.0f ? 0.0f : color[ i ] > 1.0f ? 1.0f : color[ i ] )
+                                 * 255.0f + 0.5f );
+}
+
+/*
+ * Creates the program and vertex array of the current context
+ */
+static GLboolean fghInitBatch( SFG_TextRenderer* text )
+{
+    if( text->BatchProgram )
+        return GL_TRUE;
+
+    text->BatchProgram = fgCreateProgram( fghBatchVertexShader, fghBatchFragmentShader,
+                                          fghBatchAttributes );
+    if( !text->BatchProgram )
+        return GL_FALSE;
+    text->BatchTextureUniform = fghGetUniformLocation( text->BatchProgram, "fg_texture" );
+    text->BatchImageUniform = fghGetUniformLocation( text->BatchProgram, "fg_image" );
+    text->BatchTransformUniform = fghGetUniformLocation( text->BatchProgram, "fg_transform" );
+
+    if( fghGenVertexArrays )
+    {
+        GLint vertexArray;
+        fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &vertexArray );
+
+        fghGenVertexArrays( 1, &text->BatchVertexArray );
+        fghBindVertexArray( text->BatchVertexArray );
+        fghEnableVertexAttribArray( 0 );
+        fghEnableVertexAttribArray( 1 );
+        fghEnableVertexAttribArray( 2 );
+        fghBindVertexArray( vertexArray );
+    }
+    return GL_TRUE;
+}
+
+/*
+ * Points the attributes at the vertices at offset in the bound buffer
+ */
+static void fghBatchPointers( size_t offset )
+{
+    fghVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, sizeof( SFG_BatchVertex ),
+                            (GLvoid*)offset );
+    fghVertexAttribPointer( 1, 2, GL_FLOAT, GL_FALSE, sizeof( SFG_BatchVertex ),
+                            (GLvoid*)( offset + 2 * sizeof( GLfloat ) ) );
+    fghVertexAttribPointer( 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof( SFG_BatchVertex ),
+                            (GLvoid*)( offset + 4 * sizeof( GLfloat ) ) );
+}
+
+/*
+ * Draws the batch so far with a single call, restoring the state it changes
+ */
+static void fghFlushBatch( void )
+{
+    SFG_TextRenderer* text = fgTextRenderer( );
+    GLint program, arrayBuffer, vertexArray = 0, activeTexture, texture;
+    GLuint bound;
+    size_t offset;
+
+    if( !text || !fghBatchCount || fghBatchWidth <= 0.0f || fghBatchHeight <= 0.0f ||
+        !fghInitBatch( text ) )
+    {
+        fghBatchCount = 0;
+        return;
+    }
+    bound = fghBatchImage ? fghBatchImage : fgFontAtlasTexture( );
+
+    fgGLStateBegin( );
+    fghGetIntegerv( FGH_CURRENT_PROGRAM, &program );
+    fghGetIntegerv( FGH_ARRAY_BUFFER_BINDING, &arrayBuffer );
+    glGetIntegerv( FGH_ACTIVE_TEXTURE, &activeTexture );
+    if( text->BatchVertexArray )
+        fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &vertexArray );
+
+    fghUseProgram( text->BatchProgram );
+    fghUniform1i( text->BatchTextureUniform, 0 );
+    fghUniform1i( text->BatchImageUniform, fghBatchImage != 0 );
+    fghUniform4f( text->BatchTransformUniform,
+                  2.0f / fghBatchWidth, -2.0f / fghBatchHeight, -1.0f, 1.0f );
+    fghActiveTexture( FGH_TEXTURE0 );
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+    glBindTexture( GL_TEXTURE_2D, bound );
+
+    /* The vertices go to the stream, see fg_stream.c */
+    fgStreamUpload( fghBatchVertices, fghBatchCount * sizeof( SFG_BatchVertex ), &offset );
+
+    if( text->BatchVertexArray )
+    {
+        fghBindVertexArray( text->BatchVertexArray );
+        fghBatchPointers( offset );
+        glDrawArrays( GL_TRIANGLES, 0, fghBatchCount );
+        fghBindVertexArray( vertexArray );
+    }
+    else
+    {
+        fghEnableVertexAttribArray( 0 );
+        fghEnableVertexAttribArray( 1 );
+        fghEnableVertexAttribArray( 2 );
+        fghBatchPointers( offset );
+        glDrawArrays( GL_TRIANGLES, 0, fghBatchCount );
+        fghDisableVertexAttribArray( 0 );
+        fghDisableVertexAttribArray( 1 );
+        fghDisableVertexAttribArray( 2 );
+    }
+
+    fghBindBuffer( FGH_ARRAY_BUFFER, arrayBuffer );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    fghActiveTexture( activeTexture );
+    fghUseProgram( program );
+    fgGLStateEnd( );
+    fghBatchCount = 0;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Starts a batch for a viewport of the given size
+ */
+void fgBatchBegin( int width, int height )
+{
+    fghBatchCount = 0;
+    fghBatchWidth = (GLfloat)width;
+    fghBatchHeight = (GLfloat)height;
+    fghBatchImage = 0;
+}
+
+/*
+ * Adds a triangle strip of count (x, y) points in a single colour
+ */
+void fgBatchStrip( const GLfloat* points, int count, const GLfloat* color )
+{
+    SFG_BatchVertex* v;
+    GLubyte packed[ 4 ];
+    int i;
+
+    freeglut_return_if_fail( count >= 3 );
+    fghPackColor( packed, color );
+    v = fghReserveBatch( 3 * ( count - 2 ) );
+
+    for( i = 2; i < count; i++ )
+    {
+        fghBatchVertex( v++, points[ 2 * i - 4 ], points[ 2 * i - 3 ], -1.0f, -1.0f, packed );
+        fghBatchVertex( v++, points[ 2 * i - 2 ], points[ 2 * i - 1 ], -1.0f, -1.0f, packed );
+        fghBatchVertex( v++, points[ 2 * i     ], points[ 2 * i + 1 ], -1.0f, -1.0f, packed );
+    }
+    fghBatchCount += 3 * ( count - 2 );
+}
+
+/*
+ * Adds an image covering the given rectangle, the texture's t coordinate
+ * going up like window coordinates do
+ */
+void fgBatchImage( GLuint texture, GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1 )
+{
+    static const GLubyte white[ 4 ] = { 255, 255, 255, 255 };
+    SFG_BatchVertex* v;
+
+    freeglut_return_if_fail( texture );
+    if( fghBatchImage != texture )
+    {
+        fghFlushBatch( );
+        fghBatchImage = texture;
+    }
+
+    v = fghReserveBatch( 6 );
+    fghBatchVertex( v++, x0, y0, 0.0f, 1.0f, white );
+    fghBatchVertex( v++, x1, y0, 1.0f, 1.0f, white );
+    fghBatchVertex( v++, x1, y1, 1.0f, 0.0f, white );
+    fghBatchVertex( v++, x0, y0, 0.0f, 1.0f, white );
+    fghBatchVertex( v++, x1, y1, 1.0f, 0.0f, white );
+    fghBatchVertex( v++, x0, y1, 0.0f, 0.0f, white );
+    fghBatchCount += 6;
+}
+
+/*
+ * Adds a bitmap font string, (x, y) being where glRasterPos would put it
+ */
+void fgBatchBitmapString( SFG_Font* font, GLfloat x, GLfloat y, const unsigned char* string,
+                          const GLfloat* color )
+{
+    const SFG_TextLayout* layout;
+    const GLfloat* q;
+    SFG_BatchVertex* v;
+    GLubyte packed[ 4 ];
+    int i, n;
+
+    freeglut_return_if_fail( string && *string );
+    layout = fgFontAtlasLayout( font, string, ( int )strlen( ( const char* )string ) );
+    freeglut_return_if_fail( layout );
+
+    if( fghBatchImage )
+    {
+        fghFlushBatch( );
+        fghBatchImage = 0;
+    }
+
+    /* The atlas quads go up from the baseline, batches go down */
+    fghPackColor( packed, color );
+    n = layout->Glyphs * 6;
+    v = fghReserveBatch( n );
+    for( i = 0, q = layout->Vertices; i < n; i++, q += 4 )
+        fghBatchVertex( v++, x + q[ 0 ], y - q[ 1 ], q[ 2 ], q[ 3 ], packed );
+    fghBatchCount += n;
+}
+
+/*
+ * Draws what is left of the batch
+ */
+void fgBatchEnd( void )
+{
+    fghFlushBatch( );
+}
+
+/*** END OF FILE ***/
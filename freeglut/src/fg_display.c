@@ -58,11 +58,14 @@ void FGAPIENTRY glutSwapBuffers( void )
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSwapBuffers" );
     FREEGLUT_EXIT_IF_NO_WINDOW ( "glutSwapBuffers" );
 
+    fgRecordFrame( fgStructure.CurrentWindow );
+
     /*
      * "glXSwapBuffers" already performs an implicit call to "glFlush". What
      * about "SwapBuffers"?
      */
     glFlush( );
+    fgPollReadback( fgStructure.CurrentWindow );
     if( ! fgStructure.CurrentWindow->Window.DoubleBuffered )
         return;
 
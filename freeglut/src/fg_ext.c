@@ -137,6 +137,24 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     CHECK_NAME(glutSolidTorus);
     CHECK_NAME(glutWireCylinder);
     CHECK_NAME(glutSolidCylinder);
+    CHECK_NAME(glutWireSphereLOD);
+    CHECK_NAME(glutSolidSphereLOD);
+    CHECK_NAME(glutWireConeLOD);
+    CHECK_NAME(glutSolidConeLOD);
+    CHECK_NAME(glutWireCylinderLOD);
+    CHECK_NAME(glutSolidCylinderLOD);
+    CHECK_NAME(glutWireTorusLOD);
+    CHECK_NAME(glutSolidTorusLOD);
+    CHECK_NAME(glutBakeShapes);
+    CHECK_NAME(glutMapShapes);
+    CHECK_NAME(glutReadFrameAsync);
+    CHECK_NAME(glutReadFrameFlush);
+    CHECK_NAME(glutRecordStart);
+    CHECK_NAME(glutRecordStop);
+    CHECK_NAME(glutProfileBegin);
+    CHECK_NAME(glutProfileEnd);
+    CHECK_NAME(glutProfileWriteTrace);
+    CHECK_NAME(glutProfileWriteSummary);
     CHECK_NAME(glutWireTeapot);
     CHECK_NAME(glutSolidTeapot);
     CHECK_NAME(glutWireTeacup);
@@ -185,6 +203,9 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     CHECK_NAME(glutStrokeHeight);
     CHECK_NAME(glutBitmapString);
     CHECK_NAME(glutStrokeString);
+    CHECK_NAME(glutTextWindowPos2f);
+    CHECK_NAME(glutTextColor4f);
+    CHECK_NAME(glutStrokeStringSDF);
     CHECK_NAME(glutGetProcAddress);
     CHECK_NAME(glutMouseWheelFunc);
     CHECK_NAME(glutJoystickGetNumAxes);
@@ -210,6 +231,9 @@ static GLUTproc fghGetGLUTProcAddress( const char* procName )
     CHECK_NAME(glutSetVertexAttribCoord3);
     CHECK_NAME(glutSetVertexAttribNormal);
     CHECK_NAME(glutSetVertexAttribTexCoord2);
+    CHECK_NAME(glutSetVertexAttribGlyphOffset2);
+    CHECK_NAME(glutGetShapeShaderSource);
+    CHECK_NAME(glutSetShapeUniform);
 #undef CHECK_NAME
 
     return NULL;
@@ -109,6 +109,13 @@ void FGAPIENTRY glutBitmapCharacter( void* fontID, int character )
     }
     freeglut_return_if_fail( ( character >= 1 )&&( character < 256 ) );
 
+    if( fgFontAtlasEnabled( ) )
+    {
+        const unsigned char c = ( unsigned char )character;
+        fgFontAtlasString( font, &c, 1 );
+        return;
+    }
+
     /*
      * Find the character we want to draw (???)
      */
@@ -145,6 +152,12 @@ void FGAPIENTRY glutBitmapString( void* fontID, const unsigned char *string )
     if ( !string || ! *string )
         return;
 
+    if( fgFontAtlasEnabled( ) )
+    {
+        fgFontAtlasString( font, string, ( int )strlen( ( const char* )string ) );
+        return;
+    }
+
     glPushClientAttrib( GL_CLIENT_PIXEL_STORE_BIT );
     glPixelStorei( GL_UNPACK_SWAP_BYTES,  GL_FALSE );
     glPixelStorei( GL_UNPACK_LSB_FIRST,   GL_FALSE );
@@ -203,8 +216,6 @@ int FGAPIENTRY glutBitmapWidth( void* fontID, int character )
  */
 int FGAPIENTRY glutBitmapLength( void* fontID, const unsigned char* string )
 {
-    unsigned char c;
-    int length = 0, this_line_length = 0;
     SFG_Font* font;
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutBitmapLength" );
     font = fghFontByID( fontID );
@@ -216,21 +227,8 @@ int FGAPIENTRY glutBitmapLength( void* fontID, const unsigned char* string )
     if ( !string || ! *string )
         return 0;
 
-    while( ( c = *string++) )
-    {
-        if( c != '\n' )/* Not an EOL, increment length of line */
-            this_line_length += *( font->Characters[ c ]);
-        else  /* EOL; reset the length of this line */
-        {
-            if( length < this_line_length )
-                length = this_line_length;
-            this_line_length = 0;
-        }
-    }
-    if ( length < this_line_length )
-        length = this_line_length;
-
-    return length;
+    /* The length of the longest line, from the layout cache */
+    return ( int )fgBitmapLayout( font, string, ( int )strlen( ( const char* )string ) )->Width;
 }
 
 /*
@@ -255,8 +253,7 @@ int FGAPIENTRY glutBitmapHeight( void* fontID )
 void FGAPIENTRY glutStrokeCharacter( void* fontID, int character )
 {
     const SFG_StrokeChar *schar;
-    const SFG_StrokeStrip *strip;
-    int i, j;
+    unsigned char c;
     SFG_StrokeFont* font;
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutStrokeCharacter" );
     font = fghStrokeByID( fontID );
@@ -270,31 +267,13 @@ void FGAPIENTRY glutStrokeCharacter( void* fontID, int character )
 
     schar = font->Characters[ character ];
     freeglut_return_if_fail( schar );
-    strip = schar->Strips;
 
-    for( i = 0; i < schar->Number; i++, strip++ )
-    {
-        glBegin( GL_LINE_STRIP );
-        for( j = 0; j < strip->Number; j++ )
-            glVertex2f( strip->Vertices[ j ].X, strip->Vertices[ j ].Y );
-        glEnd( );
-        
-        if (fgState.StrokeFontDrawJoinDots)
-        {
-            glBegin( GL_POINTS );
-            for( j = 0; j < strip->Number; j++ )
-                glVertex2f( strip->Vertices[ j ].X, strip->Vertices[ j ].Y );
-            glEnd( );
-        }
-    }
-    glTranslatef( schar->Right, 0.0, 0.0 );
+    c = ( unsigned char )character;
+    fgStrokeString( font, &c, 1, fgState.StrokeFontDrawJoinDots );
 }
 
 void FGAPIENTRY glutStrokeString( void* fontID, const unsigned char *string )
 {
-    unsigned char c;
-    int i, j;
-    float length = 0.0;
     SFG_StrokeFont* font;
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutStrokeString" );
     font = fghStrokeByID( fontID );
@@ -311,36 +290,27 @@ void FGAPIENTRY glutStrokeString( void* fontID, const unsigned char *string )
      * A newline will simply translate the next character's insertion
      * point back to the start of the line and down one line.
      */
-    while( ( c = *string++) )
-        if( c < font->Quantity )
-        {
-            if( c == '\n' )
-            {
-                glTranslatef ( -length, -( float )( font->Height ), 0.0 );
-                length = 0.0;
-            }
-            else  /* Not an EOL, draw the bitmap character */
-            {
-                const SFG_StrokeChar *schar = font->Characters[ c ];
-                if( schar )
-                {
-                    const SFG_StrokeStrip *strip = schar->Strips;
-
-                    for( i = 0; i < schar->Number; i++, strip++ )
-                    {
-                        glBegin( GL_LINE_STRIP );
-                        for( j = 0; j < strip->Number; j++ )
-                            glVertex2f( strip->Vertices[ j ].X,
-                                        strip->Vertices[ j ].Y);
-
-                        glEnd( );
-                    }
-
-                    length += schar->Right;
-                    glTranslatef( schar->Right, 0.0, 0.0 );
-                }
-            }
-        }
+    fgStrokeString( font, string, ( int )strlen( ( const char* )string ), GL_FALSE );
+}
+
+/*
+ * Draw a stroke string from the distance field atlas, at the text position
+ * given by glutTextWindowPos2f, which it advances. Requires OpenGL 2.0.
+ */
+void FGAPIENTRY glutStrokeStringSDF( void* fontID, float pixelHeight, const unsigned char *string )
+{
+    SFG_StrokeFont* font;
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutStrokeStringSDF" );
+    font = fghStrokeByID( fontID );
+    if (!font)
+    {
+        fgWarning("glutStrokeStringSDF: stroke font 0x%08x not found. Make sure you're not passing a bitmap font.\n",fontID);
+        return;
+    }
+    if ( !string || ! *string || !fgState.HasOpenGL20 )
+        return;
+
+    fgDistanceFieldString( font, pixelHeight, string, ( int )strlen( ( const char* )string ) );
 }
 
 /*
@@ -376,9 +346,6 @@ int FGAPIENTRY glutStrokeWidth(void* fontID, int character)
  */
 GLfloat FGAPIENTRY glutStrokeLengthf( void* fontID, const unsigned char* string )
 {
-    unsigned char c;
-    GLfloat length = 0.0;
-    GLfloat this_line_length = 0.0;
     SFG_StrokeFont* font;
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutStrokeLength" );
     font = fghStrokeByID( fontID );
@@ -390,25 +357,8 @@ GLfloat FGAPIENTRY glutStrokeLengthf( void* fontID, const unsigned char* string
     if ( !string || ! *string )
         return 0;
 
-    while( ( c = *string++) )
-        if( c < font->Quantity )
-        {
-            if( c == '\n' ) /* EOL; reset the length of this line */
-            {
-                if( length < this_line_length )
-                    length = this_line_length;
-                this_line_length = 0.0;
-            }
-            else  /* Not an EOL, increment the length of this line */
-            {
-                const SFG_StrokeChar *schar = font->Characters[ c ];
-                if( schar )
-                    this_line_length += schar->Right;
-            }
-        }
-    if( length < this_line_length )
-        length = this_line_length;
-    return length;
+    /* The length of the longest line, from the layout cache */
+    return fgStrokeLayout( font, string, ( int )strlen( ( const char* )string ) )->Width;
 }
 int FGAPIENTRY glutStrokeLength( void* fontID, const unsigned char* string )
 {
@@ -0,0 +1,949 @@
+/*
+ * fg_font_atlas.c
+ *
+ * Bitmap font output from a glyph atlas texture, for contexts without
+ * glBitmap (core profile, forward compatible and OpenGL ES contexts), and
+ * stroke font output from a distance field atlas, at any size.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * All bitmap fonts are baked once into a single one channel texture, a
+ * glyph being opaque (255) where glBitmap would have drawn a fragment.
+ * A string then becomes a stream of textured quads, two triangles per
+ * glyph, which is drawn with a single glDrawArrays call. The quads are
+ * kept with the string's cached layout (see fg_font_layout.c), relative
+ * to its start, and placed by the vertex shader. The fragment
+ * shader discards transparent texels instead of blending, so that the
+ * result matches glBitmap without touching the blend state.
+ *
+ * As there is no raster position in a core profile, strings are drawn at
+ * the text position given by glutTextWindowPos2f, in window coordinates
+ * like glWindowPos, which is advanced past the string just like the
+ * raster position is by glBitmap. The colour is set by glutTextColor4f.
+ *
+ * The stroke fonts are also baked once into an atlas, of the distance of
+ * each texel to the nearest segment of its glyph's strips. Text of any
+ * size is then drawn with one linearly filtered quad per glyph, the
+ * fragment shader thresholding the distance at the stroke's half width,
+ * with a ramp of about a pixel on either side for antialiasing when
+ * blending is enabled. The cost per glyph does not depend on the size nor
+ * on the number of segments of the glyph.
+ */
+
+/* -- IMPORT DECLARATIONS -------------------------------------------------- */
+
+extern SFG_Font fgFontFixed8x13;
+extern SFG_Font fgFontFixed9x15;
+extern SFG_Font fgFontHelvetica10;
+extern SFG_Font fgFontHelvetica12;
+extern SFG_Font fgFontHelvetica18;
+extern SFG_Font fgFontTimesRoman10;
+extern SFG_Font fgFontTimesRoman24;
+extern SFG_StrokeFont fgStrokeRoman;
+extern SFG_StrokeFont fgStrokeMonoRoman;
+
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_ATLAS_NUM_FONTS     7
+#define FGH_ATLAS_WIDTH         1024
+#define FGH_ATLAS_PADDING       1       /* Empty texels between glyphs */
+
+/* Two triangles of (x, y, s, t) vertices per glyph */
+#define FGH_GLYPH_VERTICES      6
+#define FGH_GLYPH_FLOATS        ( FGH_GLYPH_VERTICES * 4 )
+
+/*
+ * The distance field atlas samples glyphs every FGH_DISTANCE_TEXEL font
+ * units, up to FGH_DISTANCE_SPREAD units away from a stroke. The stroke
+ * half width is FGH_DISTANCE_WEIGHT units, but at least half a pixel.
+ */
+#define FGH_DISTANCE_WIDTH      1024
+#define FGH_DISTANCE_TEXEL      3.0f
+#define FGH_DISTANCE_SPREAD     16.0f
+#define FGH_DISTANCE_WEIGHT     4.0f
+
+/* Texture coordinates of a glyph in the atlas */
+typedef struct tagSFG_AtlasGlyph SFG_AtlasGlyph;
+struct tagSFG_AtlasGlyph
+{
+    GLfloat S0, T0, S1, T1;
+};
+
+/* A stroke font glyph in the distance field atlas */
+typedef struct tagSFG_DistanceGlyph SFG_DistanceGlyph;
+struct tagSFG_DistanceGlyph
+{
+    GLfloat X0, Y0, X1, Y1;         /* Quad, in font units; empty if X0 == X1 */
+    SFG_AtlasGlyph Texture;
+};
+
+static SFG_Font* fghAtlasFonts[ FGH_ATLAS_NUM_FONTS ] =
+{
+    &fgFontFixed8x13, &fgFontFixed9x15, &fgFontHelvetica10,
+    &fgFontHelvetica12, &fgFontHelvetica18, &fgFontTimesRoman10,
+    &fgFontTimesRoman24
+};
+
+/* The CPU copy of the atlas, baked once and shared by all contexts */
+static GLboolean      fghAtlasBaked = GL_FALSE;
+static GLubyte*       fghAtlasTexels = NULL;
+static int            fghAtlasHeight = 0;
+static SFG_AtlasGlyph fghAtlasGlyphs[ FGH_ATLAS_NUM_FONTS ][ 256 ];
+
+static SFG_StrokeFont* fghDistanceFonts[ FREEGLUT_NUM_STROKE_FONTS ] =
+{
+    &fgStrokeRoman, &fgStrokeMonoRoman
+};
+
+/* The CPU copy of the distance field atlas, likewise */
+static GLboolean         fghDistanceBaked = GL_FALSE;
+static GLubyte*          fghDistanceTexels = NULL;
+static int               fghDistanceHeight = 0;
+static SFG_DistanceGlyph fghDistanceGlyphs[ FREEGLUT_NUM_STROKE_FONTS ][ 128 ];
+
+static const char* fghTextAttributes[] = { "fg_coord", "fg_texcoord", NULL };
+
+static const char* fghTextVertexShader =
+    "uniform vec4 fg_transform;\n"
+    "attribute vec2 fg_coord;\n"
+    "attribute vec2 fg_texcoord;\n"
+    "varying vec2 fg_uv;\n"
+    "void main()\n"
+    "{\n"
+    "    fg_uv = fg_texcoord;\n"
+    "    gl_Position = vec4(fg_coord * fg_transform.xy + fg_transform.zw, -1.0, 1.0);\n"
+    "}\n";
+
+static const char* fghTextFragmentShader =
+    "uniform sampler2D fg_atlas;\n"
+    "uniform vec4 fg_color;\n"
+    "varying vec2 fg_uv;\n"
+    "void main()\n"
+    "{\n"
+    "    if (fgTexture2D(fg_atlas, fg_uv).r < 0.5)\n"
+    "        discard;\n"
+    "    fgFragColor = fg_color;\n"
+    "}\n";
+
+/*
+ * fg_params holds the distance of the stroke edge, the half width of the
+ * antialiasing ramp, and whether to threshold instead, without blending
+ */
+static const char* fghDistanceFragmentShader =
+    "uniform sampler2D fg_atlas;\n"
+    "uniform vec4 fg_color;\n"
+    "uniform vec4 fg_params;\n"
+    "varying vec2 fg_uv;\n"
+    "void main()\n"
+    "{\n"
+    "    float d = fgTexture2D(fg_atlas, fg_uv).r;\n"
+    "    float a = smoothstep(fg_params.x - fg_params.y, fg_params.x + fg_params.y, d);\n"
+    "    if (fg_params.z > 0.0)\n"
+    "        a = step(fg_params.x, d);\n"
+    "    if (a <= 0.0)\n"
+    "        discard;\n"
+    "    fgFragColor = vec4(fg_color.rgb, fg_color.a * a);\n"
+    "}\n";
+
+/* The state changed by a text draw call, saved to be restored afterwards */
+typedef struct tagSFG_TextState SFG_TextState;
+struct tagSFG_TextState
+{
+    GLint Program, ArrayBuffer, VertexArray, ActiveTexture, Texture;
+};
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static int fghAtlasFontIndex( const SFG_Font* font )
+{
+    int i;
+    for( i = 0; i < FGH_ATLAS_NUM_FONTS; i++ )
+        if( fghAtlasFonts[ i ] == font )
+            return i;
+    return -1;
+}
+
+/*
+ * Packs every glyph of every font into rows of the atlas. When texels is
+ * NULL only the layout is computed, returning the height needed.
+ */
+static int fghLayoutAtlas( GLubyte* texels, int height )
+{
+    int f, c, row, col;
+    int x = 0, y = 0, rowHeight = 0;
+
+    for( f = 0; f < FGH_ATLAS_NUM_FONTS; f++ )
+    {
+        const SFG_Font* font = fghAtlasFonts[ f ];
+        const int h = font->Height;
+
+        /* Each font starts on a new row, so rows have a uniform height */
+        if( x > 0 )
+        {
+            x = 0;
+            y += rowHeight + FGH_ATLAS_PADDING;
+        }
+        rowHeight = h;
+
+        for( c = 0; c < 256; c++ )
+        {
+            const GLubyte* face = font->Characters[ c ];
+            const int w = face ? face[ 0 ] : 0;
+            const int stride = ( w + 7 ) / 8;
+            SFG_AtlasGlyph* glyph = &fghAtlasGlyphs[ f ][ c ];
+
+            if( x + w > FGH_ATLAS_WIDTH )
+            {
+                x = 0;
+                y += h + FGH_ATLAS_PADDING;
+            }
+
+            if( texels )
+            {
+                /* Like glBitmap data, rows go from the bottom up, MSB first */
+                for( row = 0; row < h; row++ )
+                    for( col = 0; col < w; col++ )
+                        if( face[ 1 + row * stride + col / 8 ] & ( 0x80 >> ( col % 8 ) ) )
+                            texels[ ( y + row ) * FGH_ATLAS_WIDTH + x + col ] = 255;
+
+                glyph->S0 = (GLfloat)x / FGH_ATLAS_WIDTH;
+                glyph->S1 = (GLfloat)( x + w ) / FGH_ATLAS_WIDTH;
+                glyph->T0 = (GLfloat)y / height;
+                glyph->T1 = (GLfloat)( y + h ) / height;
+            }
+
+            x += w + FGH_ATLAS_PADDING;
+        }
+    }
+
+    return y + rowHeight;
+}
+
+static void fghBakeFontAtlas( void )
+{
+    int height = 1;
+    const int used = fghLayoutAtlas( NULL, 0 );
+
+    /* Keep a power of two size for OpenGL (ES) 2.0 */
+    while( height < used )
+        height *= 2;
+
+    fghAtlasTexels = calloc( FGH_ATLAS_WIDTH * height, 1 );
+    if( !fghAtlasTexels )
+        fgError( "Failed to allocate memory in fghBakeFontAtlas" );
+    fghAtlasHeight = height;
+    fghLayoutAtlas( fghAtlasTexels, height );
+    fghAtlasBaked = GL_TRUE;
+}
+
+/*
+ * Lays out the glyphs of every stroke font in rows of cells of the
+ * font's height, computing each texel's distance to the glyph's strips
+ * when texels is not NULL. Returns the height needed.
+ */
+static int fghLayoutDistanceAtlas( GLubyte* texels, int height )
+{
+    int f, c, i, j, k, row, col;
+    int x = 0, y = 0, h = 0;
+
+    for( f = 0; f < FREEGLUT_NUM_STROKE_FONTS; f++ )
+    {
+        const SFG_StrokeFont* font = fghDistanceFonts[ f ];
+        GLfloat minY = 0.0f, maxY = 0.0f;
+
+        /* Every glyph of a font gets the same vertical extent */
+        for( c = 0; c < font->Quantity; c++ )
+        {
+            const SFG_StrokeChar* schar = font->Characters[ c ];
+            if( schar )
+                for( i = 0; i < schar->Number; i++ )
+                    for( j = 0; j < schar->Strips[ i ].Number; j++ )
+                    {
+                        const GLfloat v = schar->Strips[ i ].Vertices[ j ].Y;
+                        if( v < minY ) minY = v;
+                        if( v > maxY ) maxY = v;
+                    }
+        }
+        minY -= FGH_DISTANCE_SPREAD;
+        maxY += FGH_DISTANCE_SPREAD;
+
+        if( x > 0 )
+        {
+            x = 0;
+            y += h + FGH_ATLAS_PADDING;
+        }
+        h = (int)ceil( ( maxY - minY ) / FGH_DISTANCE_TEXEL );
+
+        for( c = 0; c < font->Quantity; c++ )
+        {
+            const SFG_StrokeChar* schar = font->Characters[ c ];
+            SFG_DistanceGlyph* glyph = &fghDistanceGlyphs[ f ][ c ];
+            GLfloat minX, maxX;
+            int w;
+
+            glyph->X0 = glyph->X1 = 0.0f;
+            if( !schar || !schar->Number )
+                continue;
+
+            minX = maxX = schar->Strips[ 0 ].Vertices[ 0 ].X;
+            for( i = 0; i < schar->Number; i++ )
+                for( j = 0; j < schar->Strips[ i ].Number; j++ )
+                {
+                    const GLfloat v = schar->Strips[ i ].Vertices[ j ].X;
+                    if( v < minX ) minX = v;
+                    if( v > maxX ) maxX = v;
+                }
+            minX -= FGH_DISTANCE_SPREAD;
+            w = (int)ceil( ( maxX + FGH_DISTANCE_SPREAD - minX ) / FGH_DISTANCE_TEXEL );
+
+            if( x + w > FGH_DISTANCE_WIDTH )
+            {
+                x = 0;
+                y += h + FGH_ATLAS_PADDING;
+            }
+
+            glyph->X0 = minX;
+            glyph->Y0 = minY;
+            glyph->X1 = minX + w * FGH_DISTANCE_TEXEL;
+            glyph->Y1 = minY + h * FGH_DISTANCE_TEXEL;
+
+            if( texels )
+            {
+                GLfloat* d2 = malloc( w * h * sizeof( GLfloat ) );
+                if( !d2 )
+                    fgError( "Failed to allocate memory in fghLayoutDistanceAtlas" );
+                for( k = 0; k < w * h; k++ )
+                    d2[ k ] = FGH_DISTANCE_SPREAD * FGH_DISTANCE_SPREAD;
+
+                /*
+                 * Each segment only updates the texels within the spread of
+                 * its bounding box. A single vertex strip is a segment of
+                 * length 0.
+                 */
+                for( i = 0; i < schar->Number; i++ )
+                {
+                    const SFG_StrokeStrip* strip = &schar->Strips[ i ];
+
+                    for( j = strip->Number > 1 ? 1 : 0; j < strip->Number; j++ )
+                    {
+                        const SFG_StrokeVertex* a = &strip->Vertices[ j ? j - 1 : 0 ];
+                        const SFG_StrokeVertex* b = &strip->Vertices[ j ];
+                        const GLfloat ex = b->X - a->X, ey = b->Y - a->Y;
+                        const GLfloat len2 = ex * ex + ey * ey;
+                        int col0 = (int)( ( ( a->X < b->X ? a->X : b->X ) - FGH_DISTANCE_SPREAD - minX ) / FGH_DISTANCE_TEXEL );
+                        int col1 = (int)( ( ( a->X > b->X ? a->X : b->X ) + FGH_DISTANCE_SPREAD - minX ) / FGH_DISTANCE_TEXEL );
+                        int row0 = (int)( ( ( a->Y < b->Y ? a->Y : b->Y ) - FGH_DISTANCE_SPREAD - minY ) / FGH_DISTANCE_TEXEL );
+                        int row1 = (int)( ( ( a->Y > b->Y ? a->Y : b->Y ) + FGH_DISTANCE_SPREAD - minY ) / FGH_DISTANCE_TEXEL );
+
+                        if( col0 < 0 ) col0 = 0;
+                        if( row0 < 0 ) row0 = 0;
+                        if( col1 > w - 1 ) col1 = w - 1;
+                        if( row1 > h - 1 ) row1 = h - 1;
+
+                        for( row = row0; row <= row1; row++ )
+                            for( col = col0; col <= col1; col++ )
+                            {
+                                /* The texel centre, in font units */
+                                const GLfloat px = minX + ( col + 0.5f ) * FGH_DISTANCE_TEXEL;
+                                const GLfloat py = minY + ( row + 0.5f ) * FGH_DISTANCE_TEXEL;
+                                GLfloat t = 0.0f, dx, dy;
+
+                                if( len2 > 0.0f )
+                                {
+                                    t = ( ( px - a->X ) * ex + ( py - a->Y ) * ey ) / len2;
+                                    t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+                                }
+                                dx = a->X + t * ex - px;
+                                dy = a->Y + t * ey - py;
+                                if( dx * dx + dy * dy < d2[ row * w + col ] )
+                                    d2[ row * w + col ] = dx * dx + dy * dy;
+                            }
+                    }
+                }
+
+                for( row = 0; row < h; row++ )
+                    for( col = 0; col < w; col++ )
+                        texels[ ( y + row ) * FGH_DISTANCE_WIDTH + x + col ] = (GLubyte)
+                            ( 255.0f * ( 1.0f - (GLfloat)sqrt( d2[ row * w + col ] ) / FGH_DISTANCE_SPREAD ) + 0.5f );
+                free( d2 );
+
+                glyph->Texture.S0 = (GLfloat)x / FGH_DISTANCE_WIDTH;
+                glyph->Texture.S1 = (GLfloat)( x + w ) / FGH_DISTANCE_WIDTH;
+                glyph->Texture.T0 = (GLfloat)y / height;
+                glyph->Texture.T1 = (GLfloat)( y + h ) / height;
+            }
+
+            x += w + FGH_ATLAS_PADDING;
+        }
+    }
+
+    return y + h;
+}
+
+static void fghBakeDistanceAtlas( void )
+{
+    int height = 1;
+    const int used = fghLayoutDistanceAtlas( NULL, 0 );
+
+    while( height < used )
+        height *= 2;
+
+    fghDistanceTexels = calloc( FGH_DISTANCE_WIDTH * height, 1 );
+    if( !fghDistanceTexels )
+        fgError( "Failed to allocate memory in fghBakeDistanceAtlas" );
+    fghDistanceHeight = height;
+    fghLayoutDistanceAtlas( fghDistanceTexels, height );
+    fghDistanceBaked = GL_TRUE;
+}
+
+/*
+ * Uploads a one channel atlas to a new texture of the current context
+ */
+static GLuint fghCreateAtlasTexture( const GLubyte* texels, int width, int height, GLint filter )
+{
+    GLuint texture;
+    GLint unpackAlignment, binding;
+    GLenum internalFormat, format;
+
+    /* Luminance textures are gone from core profiles, red ones are not in ES 2.0 */
+#ifdef GL_ES_VERSION_2_0
+    internalFormat = format = GL_LUMINANCE;
+#else
+    if( fgState.MajorVersion >= 3 )
+    {
+        internalFormat = FGH_R8;
+        format = FGH_RED;
+    }
+    else
+        internalFormat = format = GL_LUMINANCE;
+#endif
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &binding );
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, FGH_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, FGH_CLAMP_TO_EDGE );
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &unpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, width, height,
+                  0, format, GL_UNSIGNED_BYTE, texels );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, unpackAlignment );
+    glBindTexture( GL_TEXTURE_2D, binding );
+
+    return texture;
+}
+
+/*
+ * Creates the vertex array, if available, shared by both atlases in the
+ * current context. The quads themselves are streamed, see fg_stream.c.
+ */
+static void fghInitTextBuffers( SFG_TextRenderer* text )
+{
+    GLint vertexArray;
+
+    if( text->VertexArray || !fghGenVertexArrays )
+        return;
+
+    fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &vertexArray );
+    fghGenVertexArrays( 1, &text->VertexArray );
+    fghBindVertexArray( text->VertexArray );
+    fghEnableVertexAttribArray( 0 );
+    fghEnableVertexAttribArray( 1 );
+    fghBindVertexArray( vertexArray );
+}
+
+/*
+ * Creates the bitmap font program and atlas texture in the current context
+ */
+static GLboolean fghInitTextRenderer( SFG_TextRenderer* text )
+{
+    if( text->Program )
+        return GL_TRUE;
+
+    if( !fghAtlasBaked )
+        fghBakeFontAtlas( );
+
+    text->Program = fgCreateProgram( fghTextVertexShader, fghTextFragmentShader,
+                                     fghTextAttributes );
+    if( !text->Program )
+        return GL_FALSE;
+    text->AtlasUniform = fghGetUniformLocation( text->Program, "fg_atlas" );
+    text->ColorUniform = fghGetUniformLocation( text->Program, "fg_color" );
+    text->TransformUniform = fghGetUniformLocation( text->Program, "fg_transform" );
+
+    text->Texture = fghCreateAtlasTexture( fghAtlasTexels, FGH_ATLAS_WIDTH, fghAtlasHeight,
+                                           GL_NEAREST );
+    fghInitTextBuffers( text );
+    return GL_TRUE;
+}
+
+/*
+ * Creates the distance field program and atlas texture in the current context
+ */
+static GLboolean fghInitDistanceRenderer( SFG_TextRenderer* text )
+{
+    if( text->DistanceProgram )
+        return GL_TRUE;
+
+    if( !fghDistanceBaked )
+        fghBakeDistanceAtlas( );
+
+    text->DistanceProgram = fgCreateProgram( fghTextVertexShader, fghDistanceFragmentShader,
+                                             fghTextAttributes );
+    if( !text->DistanceProgram )
+        return GL_FALSE;
+    text->DistanceAtlasUniform  = fghGetUniformLocation( text->DistanceProgram, "fg_atlas" );
+    text->DistanceColorUniform  = fghGetUniformLocation( text->DistanceProgram, "fg_color" );
+    text->DistanceTransformUniform = fghGetUniformLocation( text->DistanceProgram, "fg_transform" );
+    text->DistanceParamsUniform = fghGetUniformLocation( text->DistanceProgram, "fg_params" );
+
+    text->DistanceTexture = fghCreateAtlasTexture( fghDistanceTexels, FGH_DISTANCE_WIDTH,
+                                                   fghDistanceHeight, GL_LINEAR );
+    fghInitTextBuffers( text );
+    return GL_TRUE;
+}
+
+static GLfloat* fghEmitVertex( GLfloat* v, GLfloat x, GLfloat y, GLfloat s, GLfloat t )
+{
+    v[ 0 ] = x;
+    v[ 1 ] = y;
+    v[ 2 ] = s;
+    v[ 3 ] = t;
+    return v + 4;
+}
+
+/*
+ * Emits the two triangles of a glyph quad
+ */
+static GLfloat* fghEmitQuad( GLfloat* v, GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1,
+                             const SFG_AtlasGlyph* glyph )
+{
+    v = fghEmitVertex( v, x0, y0, glyph->S0, glyph->T0 );
+    v = fghEmitVertex( v, x1, y0, glyph->S1, glyph->T0 );
+    v = fghEmitVertex( v, x1, y1, glyph->S1, glyph->T1 );
+    v = fghEmitVertex( v, x0, y0, glyph->S0, glyph->T0 );
+    v = fghEmitVertex( v, x1, y1, glyph->S1, glyph->T1 );
+    v = fghEmitVertex( v, x0, y1, glyph->S0, glyph->T1 );
+    return v;
+}
+
+/*
+ * Gets the scale and offset from window to normalized device coordinates
+ */
+static GLboolean fghWindowToDevice( GLfloat* sx, GLfloat* sy, GLfloat* ox, GLfloat* oy )
+{
+    GLint viewport[ 4 ];
+
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    if( viewport[ 2 ] <= 0 || viewport[ 3 ] <= 0 )
+        return GL_FALSE;
+    *sx = 2.0f / viewport[ 2 ];
+    *sy = 2.0f / viewport[ 3 ];
+    *ox = -1.0f - viewport[ 0 ] * *sx;
+    *oy = -1.0f - viewport[ 1 ] * *sy;
+    return GL_TRUE;
+}
+
+static GLfloat* fghAllocLayoutVertices( SFG_TextLayout* layout )
+{
+    layout->Vertices = malloc( ( layout->Length ? layout->Length : 1 ) *
+                               FGH_GLYPH_FLOATS * sizeof( GLfloat ) );
+    if( !layout->Vertices )
+        fgError( "Failed to allocate memory in fghAllocLayoutVertices" );
+    layout->Glyphs = 0;
+    return layout->Vertices;
+}
+
+/*
+ * Builds the quads of a bitmap font layout, in pixels from the string's start
+ */
+static void fghBuildAtlasQuads( SFG_TextLayout* layout, const SFG_Font* font, int f )
+{
+    GLfloat* v = fghAllocLayoutVertices( layout );
+    int x = 0, y = 0, i;
+
+    for( i = 0; i < layout->Length; i++ )
+    {
+        const unsigned char c = layout->String[ i ];
+
+        if( c == '\n' )
+        {
+            x = 0;
+            y -= font->Height;
+        }
+        else
+        {
+            const GLubyte* face = font->Characters[ c ];
+
+            if( face[ 0 ] )
+            {
+                v = fghEmitQuad( v, x - font->xorig, y - font->yorig,
+                                 x - font->xorig + face[ 0 ], y - font->yorig + font->Height,
+                                 &fghAtlasGlyphs[ f ][ c ] );
+                layout->Glyphs++;
+            }
+            x += face[ 0 ];
+        }
+    }
+}
+
+/*
+ * Builds the quads of a stroke font layout, in font units from the string's start
+ */
+static void fghBuildDistanceQuads( SFG_TextLayout* layout, const SFG_StrokeFont* font, int f )
+{
+    GLfloat* v = fghAllocLayoutVertices( layout );
+    GLfloat x = 0.0f, y = 0.0f;
+    int i;
+
+    for( i = 0; i < layout->Length; i++ )
+    {
+        const unsigned char c = layout->String[ i ];
+
+        if( c >= font->Quantity )
+            continue;
+
+        if( c == '\n' )
+        {
+            x = 0.0f;
+            y -= font->Height;
+        }
+        else if( font->Characters[ c ] )
+        {
+            const SFG_DistanceGlyph* glyph = &fghDistanceGlyphs[ f ][ c ];
+
+            if( glyph->X1 > glyph->X0 )
+            {
+                v = fghEmitQuad( v, x + glyph->X0, y + glyph->Y0, x + glyph->X1, y + glyph->Y1,
+                                 &glyph->Texture );
+                layout->Glyphs++;
+            }
+            x += font->Characters[ c ]->Right;
+        }
+    }
+}
+
+/*
+ * Saves the state we are about to change, then makes the program and
+ * atlas texture current. The caller sets the program's uniforms.
+ */
+static void fghBeginText( SFG_TextState* saved, GLuint program, GLuint texture )
+{
+    fgGLStateBegin( );
+    fghGetIntegerv( FGH_CURRENT_PROGRAM, &saved->Program );
+    fghGetIntegerv( FGH_ARRAY_BUFFER_BINDING, &saved->ArrayBuffer );
+    glGetIntegerv( FGH_ACTIVE_TEXTURE, &saved->ActiveTexture );
+    saved->VertexArray = 0;
+    if( fghGenVertexArrays )
+        fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &saved->VertexArray );
+
+    fghUseProgram( program );
+    fghActiveTexture( FGH_TEXTURE0 );
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &saved->Texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+}
+
+/*
+ * Draws the glyph quads of a layout
+ */
+static void fghDrawText( SFG_TextRenderer* text, const SFG_TextLayout* layout )
+{
+    const int glyphs = layout->Glyphs;
+    size_t offset;
+
+    fgStreamUpload( layout->Vertices, glyphs * FGH_GLYPH_FLOATS * sizeof( GLfloat ), &offset );
+
+    if( text->VertexArray )
+        fghBindVertexArray( text->VertexArray );
+    else
+    {
+        fghEnableVertexAttribArray( 0 );
+        fghEnableVertexAttribArray( 1 );
+    }
+    fghVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof( GLfloat ), (GLvoid*)offset );
+    fghVertexAttribPointer( 1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof( GLfloat ),
+                            (GLvoid*)( offset + 2 * sizeof( GLfloat ) ) );
+    glDrawArrays( GL_TRIANGLES, 0, glyphs * FGH_GLYPH_VERTICES );
+    if( !text->VertexArray )
+    {
+        fghDisableVertexAttribArray( 0 );
+        fghDisableVertexAttribArray( 1 );
+    }
+}
+
+static void fghEndText( const SFG_TextState* saved )
+{
+    if( fghGenVertexArrays )
+        fghBindVertexArray( saved->VertexArray );
+    fghBindBuffer( FGH_ARRAY_BUFFER, saved->ArrayBuffer );
+    glBindTexture( GL_TEXTURE_2D, saved->Texture );
+    fghActiveTexture( saved->ActiveTexture );
+    fghUseProgram( saved->Program );
+    fgGLStateEnd( );
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Returns the text renderer of the current window, creating it if needed
+ */
+SFG_TextRenderer* fgTextRenderer( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+    SFG_TextRenderer* text;
+
+    freeglut_return_val_if_fail( window, NULL );
+
+    text = window->Window.TextRenderer;
+    if( !text )
+    {
+        text = calloc( 1, sizeof( SFG_TextRenderer ) );
+        if( !text )
+            fgError( "Failed to allocate memory in fgTextRenderer" );
+        text->Color[ 0 ] = text->Color[ 1 ] = text->Color[ 2 ] = 1.0f;
+        text->Color[ 3 ] = 1.0f;
+        window->Window.TextRenderer = text;
+    }
+    return text;
+}
+
+/*
+ * The atlas is used when requested through glutSetOption, and always
+ * when the context cannot have glBitmap.
+ */
+GLboolean fgFontAtlasEnabled( void )
+{
+#ifdef GL_ES_VERSION_2_0
+    return fgState.HasOpenGL20;
+#else
+    const GLboolean coreProfile =
+        ( fgState.ContextFlags & GLUT_FORWARD_COMPATIBLE ) ||
+        ( ( fgState.MajorVersion > 3 || ( fgState.MajorVersion == 3 && fgState.MinorVersion >= 2 ) ) &&
+          fgState.ContextProfile != GLUT_COMPATIBILITY_PROFILE );
+
+    return fgState.HasOpenGL20 && ( fgState.BitmapFontAtlas || coreProfile );
+#endif
+}
+
+/*
+ * Draws the first length characters of a string with a single draw call
+ */
+void fgFontAtlasString( SFG_Font* font, const unsigned char* string, int length )
+{
+    SFG_TextRenderer* text = fgTextRenderer( );
+    SFG_TextLayout* layout;
+    SFG_TextState saved;
+    GLfloat sx, sy, ox, oy;
+    int f;
+
+    freeglut_return_if_fail( text );
+    f = fghAtlasFontIndex( font );
+    freeglut_return_if_fail( f >= 0 );
+    freeglut_return_if_fail( fghInitTextRenderer( text ) );
+    freeglut_return_if_fail( fghWindowToDevice( &sx, &sy, &ox, &oy ) );
+
+    layout = fgBitmapLayout( font, string, length );
+    if( !layout->Vertices )
+        fghBuildAtlasQuads( layout, font, f );
+
+    if( layout->Glyphs )
+    {
+        fghBeginText( &saved, text->Program, text->Texture );
+        fghUniform1i( text->AtlasUniform, 0 );
+        fghUniform4f( text->ColorUniform, text->Color[ 0 ], text->Color[ 1 ],
+                      text->Color[ 2 ], text->Color[ 3 ] );
+        fghUniform4f( text->TransformUniform, sx, sy,
+                      text->Position[ 0 ] * sx + ox, text->Position[ 1 ] * sy + oy );
+        fghDrawText( text, layout );
+        fghEndText( &saved );
+    }
+
+    /* Advance the text position just like glBitmap does the raster position */
+    text->Position[ 0 ] += layout->EndX;
+    text->Position[ 1 ] += layout->EndY;
+}
+
+/*
+ * Returns the layout of a string in a bitmap font, with its atlas quads
+ */
+SFG_TextLayout* fgFontAtlasLayout( SFG_Font* font, const unsigned char* string, int length )
+{
+    SFG_TextLayout* layout;
+    const int f = fghAtlasFontIndex( font );
+
+    freeglut_return_val_if_fail( f >= 0, NULL );
+    if( !fghAtlasBaked )
+        fghBakeFontAtlas( );
+
+    layout = fgBitmapLayout( font, string, length );
+    if( !layout->Vertices )
+        fghBuildAtlasQuads( layout, font, f );
+    return layout;
+}
+
+/*
+ * Returns the bitmap font atlas texture of the current context, or 0
+ */
+GLuint fgFontAtlasTexture( void )
+{
+    SFG_TextRenderer* text = fgTextRenderer( );
+
+    freeglut_return_val_if_fail( text && fghInitTextRenderer( text ), 0 );
+    return text->Texture;
+}
+
+/*
+ * Draws the first length characters of a string in a stroke font, the
+ * font's height being pixelHeight pixels, with a single draw call
+ */
+void fgDistanceFieldString( SFG_StrokeFont* font, GLfloat pixelHeight,
+                            const unsigned char* string, int length )
+{
+    SFG_TextRenderer* text = fgTextRenderer( );
+    SFG_TextLayout* layout;
+    SFG_TextState saved;
+    GLfloat sx, sy, ox, oy, scale, halfWidth, ramp;
+    int f;
+
+    freeglut_return_if_fail( text );
+    freeglut_return_if_fail( pixelHeight > 0.0f );
+    for( f = 0; f < FREEGLUT_NUM_STROKE_FONTS; f++ )
+        if( fghDistanceFonts[ f ] == font )
+            break;
+    freeglut_return_if_fail( f < FREEGLUT_NUM_STROKE_FONTS );
+    freeglut_return_if_fail( fghInitDistanceRenderer( text ) );
+    freeglut_return_if_fail( fghWindowToDevice( &sx, &sy, &ox, &oy ) );
+
+    /* Pixels per font unit */
+    scale = pixelHeight / font->Height;
+
+    layout = fgStrokeLayout( font, string, length );
+    if( !layout->Vertices )
+        fghBuildDistanceQuads( layout, font, f );
+
+    if( layout->Glyphs )
+    {
+        /* The stroke half width and the ramp half width, in font units */
+        halfWidth = 0.5f / scale;
+        if( halfWidth < FGH_DISTANCE_WEIGHT )
+            halfWidth = FGH_DISTANCE_WEIGHT;
+        if( halfWidth > 0.75f * FGH_DISTANCE_SPREAD )
+            halfWidth = 0.75f * FGH_DISTANCE_SPREAD;
+        ramp = 0.5f / scale;
+
+        fghBeginText( &saved, text->DistanceProgram, text->DistanceTexture );
+        fghUniform1i( text->DistanceAtlasUniform, 0 );
+        fghUniform4f( text->DistanceColorUniform, text->Color[ 0 ], text->Color[ 1 ],
+                      text->Color[ 2 ], text->Color[ 3 ] );
+        fghUniform4f( text->DistanceParamsUniform,
+                      1.0f - halfWidth / FGH_DISTANCE_SPREAD, ramp / FGH_DISTANCE_SPREAD,
+                      glIsEnabled( GL_BLEND ) ? 0.0f : 1.0f, 0.0f );
+        fghUniform4f( text->DistanceTransformUniform, scale * sx, scale * sy,
+                      text->Position[ 0 ] * sx + ox, text->Position[ 1 ] * sy + oy );
+        fghDrawText( text, layout );
+        fghEndText( &saved );
+    }
+
+    text->Position[ 0 ] += layout->EndX * scale;
+    text->Position[ 1 ] += layout->EndY * scale;
+}
+
+/*
+ * Releases a window's text renderer. Its GL objects are deleted when the
+ * window's context is current, otherwise they go with the context.
+ */
+void fgDestroyTextRenderer( SFG_Window* window )
+{
+    SFG_TextRenderer* text = window->Window.TextRenderer;
+
+    freeglut_return_if_fail( text );
+
+    if( fgState.HasOpenGL20 && fgStructure.CurrentWindow == window )
+    {
+        if( text->Program )
+        {
+            fghDeleteProgram( text->Program );
+            glDeleteTextures( 1, &text->Texture );
+        }
+        if( text->DistanceProgram )
+        {
+            fghDeleteProgram( text->DistanceProgram );
+            glDeleteTextures( 1, &text->DistanceTexture );
+        }
+        if( text->VertexArray )
+            fghDeleteVertexArrays( 1, &text->VertexArray );
+        if( text->BatchProgram )
+        {
+            fghDeleteProgram( text->BatchProgram );
+            if( text->BatchVertexArray )
+                fghDeleteVertexArrays( 1, &text->BatchVertexArray );
+        }
+
+        /* Unused names are silently ignored */
+        fghDeleteBuffers( FREEGLUT_NUM_STROKE_FONTS, text->StrokeBuffers );
+    }
+
+    free( text );
+    window->Window.TextRenderer = NULL;
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Sets the text position of the current window, in window coordinates
+ */
+void FGAPIENTRY glutTextWindowPos2f( float x, float y )
+{
+    SFG_TextRenderer* text;
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTextWindowPos2f" );
+    text = fgTextRenderer( );
+    freeglut_return_if_fail( text );
+
+    text->Position[ 0 ] = x;
+    text->Position[ 1 ] = y;
+}
+
+/*
+ * Sets the text colour of the current window
+ */
+void FGAPIENTRY glutTextColor4f( float red, float green, float blue, float alpha )
+{
+    SFG_TextRenderer* text;
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutTextColor4f" );
+    text = fgTextRenderer( );
+    freeglut_return_if_fail( text );
+
+    text->Color[ 0 ] = red;
+    text->Color[ 1 ] = green;
+    text->Color[ 2 ] = blue;
+    text->Color[ 3 ] = alpha;
+}
+
+/*** END OF FILE ***/
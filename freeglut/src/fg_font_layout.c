@@ -0,0 +1,230 @@
+/*
+ * fg_font_layout.c
+ *
+ * A cache of laid out strings, for text that is drawn again and again.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+
+/*
+ * Labels and other static text are usually the same strings in the same
+ * fonts from one frame to the next. Their layout, that is their metrics
+ * and the atlas quads they are drawn with (see fg_font_atlas.c), is kept
+ * in a hash table keyed by the font and string. A lookup hashes the
+ * string once and compares it with the few entries of its bucket.
+ *
+ * The table holds at most FGH_LAYOUT_CACHE_SIZE layouts. The least
+ * recently used one is replaced when it is full, so text that changes
+ * every frame (a frame counter, say) cannot grow it.
+ *
+ * Layouts are relative to the start of the string, so that the same one
+ * serves wherever, and for the stroke fonts at whatever size, the string
+ * is drawn. A returned layout is valid until the next lookup.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_LAYOUT_CACHE_SIZE   256
+#define FGH_LAYOUT_BUCKETS      512     /* A power of two */
+
+static SFG_TextLayout* fghLayoutBuckets[ FGH_LAYOUT_BUCKETS ];
+static SFG_List        fghLayoutList = { NULL, NULL };  /* Least recently used first */
+static int             fghLayoutCount = 0;
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * FNV-1a, seeded with the font so that the same string in different
+ * fonts tends to land in different buckets
+ */
+static unsigned int fghHashString( const void* font, const unsigned char* string, int length )
+{
+    unsigned int hash = 2166136261u ^ (unsigned int)( (size_t)font >> 4 );
+    int i;
+
+    for( i = 0; i < length; i++ )
+    {
+        hash ^= string[ i ];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void fghUnlinkLayout( SFG_TextLayout* layout )
+{
+    SFG_TextLayout** link = &fghLayoutBuckets[ layout->Hash & ( FGH_LAYOUT_BUCKETS - 1 ) ];
+
+    while( *link != layout )
+        link = &( *link )->HashNext;
+    *link = layout->HashNext;
+
+    fgListRemove( &fghLayoutList, &layout->Node );
+    fghLayoutCount--;
+}
+
+static void fghFreeLayout( SFG_TextLayout* layout )
+{
+    free( layout->String );
+    free( layout->Vertices );
+    free( layout );
+}
+
+/*
+ * Finds the layout of a string, moving it to the back of the list. When
+ * it is not cached, a new layout without metrics is returned, the least
+ * recently used one making room for it if needed.
+ */
+static SFG_TextLayout* fghFindLayout( const void* font, const unsigned char* string, int length,
+                                      GLboolean* found )
+{
+    const unsigned int hash = fghHashString( font, string, length );
+    SFG_TextLayout** bucket = &fghLayoutBuckets[ hash & ( FGH_LAYOUT_BUCKETS - 1 ) ];
+    SFG_TextLayout* layout;
+
+    for( layout = *bucket; layout; layout = layout->HashNext )
+        if( layout->Hash == hash && layout->Font == font && layout->Length == length &&
+            !memcmp( layout->String, string, length ) )
+        {
+            fgListRemove( &fghLayoutList, &layout->Node );
+            fgListAppend( &fghLayoutList, &layout->Node );
+            *found = GL_TRUE;
+            return layout;
+        }
+
+    if( fghLayoutCount >= FGH_LAYOUT_CACHE_SIZE )
+    {
+        layout = fghLayoutList.First;
+        fghUnlinkLayout( layout );
+        fghFreeLayout( layout );
+    }
+
+    layout = calloc( 1, sizeof( SFG_TextLayout ) );
+    if( layout )
+        layout->String = malloc( length ? length : 1 );
+    if( !layout || !layout->String )
+        fgError( "Failed to allocate memory in fghFindLayout" );
+
+    memcpy( layout->String, string, length );
+    layout->Length = length;
+    layout->Font = font;
+    layout->Hash = hash;
+    layout->HashNext = *bucket;
+    *bucket = layout;
+    fgListAppend( &fghLayoutList, &layout->Node );
+    fghLayoutCount++;
+
+    *found = GL_FALSE;
+    return layout;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Returns the layout of the first length characters of a string in a
+ * bitmap font, in pixels
+ */
+SFG_TextLayout* fgBitmapLayout( SFG_Font* font, const unsigned char* string, int length )
+{
+    GLboolean found;
+    SFG_TextLayout* layout = fghFindLayout( font, string, length, &found );
+    int i, width = 0, line = 0, y = 0;
+
+    if( found )
+        return layout;
+
+    for( i = 0; i < length; i++ )
+    {
+        if( string[ i ] != '\n' )
+            line += *( font->Characters[ string[ i ] ] );
+        else
+        {
+            if( width < line )
+                width = line;
+            line = 0;
+            y -= font->Height;
+        }
+    }
+    if( width < line )
+        width = line;
+
+    layout->Width = (GLfloat)width;
+    layout->EndX = (GLfloat)line;
+    layout->EndY = (GLfloat)y;
+    return layout;
+}
+
+/*
+ * Returns the layout of the first length characters of a string in a
+ * stroke font, in font units
+ */
+SFG_TextLayout* fgStrokeLayout( SFG_StrokeFont* font, const unsigned char* string, int length )
+{
+    GLboolean found;
+    SFG_TextLayout* layout = fghFindLayout( font, string, length, &found );
+    GLfloat width = 0.0f, line = 0.0f, y = 0.0f;
+    int i;
+
+    if( found )
+        return layout;
+
+    for( i = 0; i < length; i++ )
+    {
+        const unsigned char c = string[ i ];
+
+        if( c >= font->Quantity )
+            continue;
+
+        if( c == '\n' )
+        {
+            if( width < line )
+                width = line;
+            line = 0.0f;
+            y -= font->Height;
+        }
+        else if( font->Characters[ c ] )
+            line += font->Characters[ c ]->Right;
+    }
+    if( width < line )
+        width = line;
+
+    layout->Width = width;
+    layout->EndX = line;
+    layout->EndY = y;
+    return layout;
+}
+
+/*
+ * Empties the cache, on deinitialization
+ */
+void fgDestroyTextLayouts( void )
+{
+    SFG_TextLayout* layout;
+
+    while( ( layout = fghLayoutList.First ) )
+    {
+        fghUnlinkLayout( layout );
+        fghFreeLayout( layout );
+    }
+}
+
+/*** END OF FILE ***/
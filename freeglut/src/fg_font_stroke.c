@@ -0,0 +1,393 @@
+/*
+ * fg_font_stroke.c
+ *
+ * Stroke font output from precompiled glyph geometry.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * The strips of every glyph of a stroke font are flattened once into a
+ * single array of GL_LINES segments, so that each glyph is a contiguous
+ * range of vertices, found through a per-character (first, count) table.
+ * Lines rasterize the same as the line strips they came from. The join
+ * dots follow, one per strip vertex, in a second range per character.
+ *
+ * Without vertex attributes (see below), a glyph is one glDrawArrays call
+ * from that array followed by the usual glTranslatef, instead of a
+ * glBegin/glEnd pair per strip and a glVertex2f call per vertex.
+ *
+ * When the application has given the locations of a coordinate attribute
+ * (glutSetVertexAttribCoord3) and a glyph offset attribute
+ * (glutSetVertexAttribGlyphOffset2), there are no matrices to translate
+ * with. The geometry then lives in a vertex buffer of the context, and
+ * each glyph's origin is fed to the offset attribute, which the vertex
+ * shader is expected to add to the coordinate. With OpenGL 4.3 a whole
+ * string is then a single glMultiDrawArraysIndirect call, one command per
+ * glyph, whose base instance selects its origin from an instanced
+ * attribute array. Otherwise each glyph takes one glDrawArrays call with
+ * a constant offset attribute. Strings start at the origin in this mode,
+ * and lines go down by the font height.
+ */
+
+/* -- IMPORT DECLARATIONS -------------------------------------------------- */
+
+extern SFG_StrokeFont fgStrokeRoman;
+extern SFG_StrokeFont fgStrokeMonoRoman;
+
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+/* The flattened glyph geometry of a stroke font */
+typedef struct tagSFG_StrokeGeometry SFG_StrokeGeometry;
+struct tagSFG_StrokeGeometry
+{
+    GLfloat* Vertices;      /* (x, y) pairs, two vertices per segment,
+                               then the dots                           */
+    GLint    NumVertices;
+    GLint*   First;         /* First vertex of each character          */
+    GLint*   Count;         /* Number of vertices of each character    */
+    GLint*   DotFirst;      /* Likewise for the dots                   */
+    GLint*   DotCount;
+};
+
+static SFG_StrokeFont* fghStrokeFonts[ FREEGLUT_NUM_STROKE_FONTS ] =
+{
+    &fgStrokeRoman, &fgStrokeMonoRoman
+};
+
+static SFG_StrokeGeometry fghStrokeGeometry[ FREEGLUT_NUM_STROKE_FONTS ];
+
+/* Scratch memory for the per-glyph draw commands and origins of a string */
+static GLuint*  fghStrokeCommands = NULL;   /* count, instances, first, base */
+static GLfloat* fghStrokeOffsets = NULL;
+static int      fghStrokeCapacity = 0;      /* In glyphs */
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static void fghBakeStrokeGeometry( SFG_StrokeGeometry* geometry, const SFG_StrokeFont* font )
+{
+    int c, i, j, n = 0;
+    GLfloat* v;
+
+    for( c = 0; c < font->Quantity; c++ )
+    {
+        const SFG_StrokeChar* schar = font->Characters[ c ];
+        if( schar )
+            for( i = 0; i < schar->Number; i++ )
+            {
+                if( schar->Strips[ i ].Number > 1 )
+                    n += 2 * ( schar->Strips[ i ].Number - 1 );
+                n += schar->Strips[ i ].Number;
+            }
+    }
+
+    geometry->Vertices = malloc( n * 2 * sizeof( GLfloat ) );
+    geometry->First = calloc( font->Quantity, sizeof( GLint ) );
+    geometry->Count = calloc( font->Quantity, sizeof( GLint ) );
+    geometry->DotFirst = calloc( font->Quantity, sizeof( GLint ) );
+    geometry->DotCount = calloc( font->Quantity, sizeof( GLint ) );
+    if( !geometry->Vertices || !geometry->First || !geometry->Count ||
+        !geometry->DotFirst || !geometry->DotCount )
+        fgError( "Failed to allocate memory in fghBakeStrokeGeometry" );
+    geometry->NumVertices = n;
+
+    v = geometry->Vertices;
+    n = 0;
+    for( c = 0; c < font->Quantity; c++ )
+    {
+        const SFG_StrokeChar* schar = font->Characters[ c ];
+
+        geometry->First[ c ] = n;
+        if( !schar )
+            continue;
+
+        for( i = 0; i < schar->Number; i++ )
+        {
+            const SFG_StrokeStrip* strip = &schar->Strips[ i ];
+            for( j = 1; j < strip->Number; j++ )
+            {
+                *v++ = strip->Vertices[ j - 1 ].X;
+                *v++ = strip->Vertices[ j - 1 ].Y;
+                *v++ = strip->Vertices[ j ].X;
+                *v++ = strip->Vertices[ j ].Y;
+                n += 2;
+            }
+        }
+        geometry->Count[ c ] = n - geometry->First[ c ];
+    }
+
+    /* The dots, from the strips themselves so that inner vertices get one
+     * dot rather than two, and single vertex strips one rather than none */
+    for( c = 0; c < font->Quantity; c++ )
+    {
+        const SFG_StrokeChar* schar = font->Characters[ c ];
+
+        geometry->DotFirst[ c ] = n;
+        if( !schar )
+            continue;
+
+        for( i = 0; i < schar->Number; i++ )
+        {
+            const SFG_StrokeStrip* strip = &schar->Strips[ i ];
+            for( j = 0; j < strip->Number; j++ )
+            {
+                *v++ = strip->Vertices[ j ].X;
+                *v++ = strip->Vertices[ j ].Y;
+                n++;
+            }
+        }
+        geometry->DotCount[ c ] = n - geometry->DotFirst[ c ];
+    }
+}
+
+static void fghReserveStrokeGlyphs( int glyphs )
+{
+    if( glyphs > fghStrokeCapacity )
+    {
+        int capacity = fghStrokeCapacity ? fghStrokeCapacity : 64;
+        GLuint* commands;
+        GLfloat* offsets;
+
+        while( capacity < glyphs )
+            capacity *= 2;
+        commands = realloc( fghStrokeCommands, capacity * 4 * sizeof( GLuint ) );
+        if( commands )
+            fghStrokeCommands = commands;
+        offsets = realloc( fghStrokeOffsets, capacity * 2 * sizeof( GLfloat ) );
+        if( offsets )
+            fghStrokeOffsets = offsets;
+        if( !commands || !offsets )
+            fgError( "Failed to allocate memory in fghReserveStrokeGlyphs" );
+        fghStrokeCapacity = capacity;
+    }
+}
+
+/*
+ * Draws through the fixed function pipeline, translating the modelview
+ * matrix by each character's advance like glutStrokeCharacter always has
+ */
+static void fghDrawStrokeString11( const SFG_StrokeFont* font, const SFG_StrokeGeometry* geometry,
+                                   const unsigned char* string, int length, GLboolean joinDots )
+{
+    GLfloat lineLength = 0.0f;
+    int i;
+
+    glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+    if( fgState.HasOpenGL20 )
+        fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glVertexPointer( 2, GL_FLOAT, 0, geometry->Vertices );
+
+    for( i = 0; i < length; i++ )
+    {
+        const unsigned char c = string[ i ];
+
+        if( c >= font->Quantity )
+            continue;
+
+        if( c == '\n' )
+        {
+            glTranslatef( -lineLength, -font->Height, 0.0f );
+            lineLength = 0.0f;
+        }
+        else if( font->Characters[ c ] )
+        {
+            const GLfloat right = font->Characters[ c ]->Right;
+
+            if( geometry->Count[ c ] )
+                glDrawArrays( GL_LINES, geometry->First[ c ], geometry->Count[ c ] );
+            if( joinDots && geometry->DotCount[ c ] )
+                glDrawArrays( GL_POINTS, geometry->DotFirst[ c ], geometry->DotCount[ c ] );
+
+            lineLength += right;
+            glTranslatef( right, 0.0f, 0.0f );
+        }
+    }
+
+    glPopClientAttrib( );
+}
+
+/*
+ * Draws with the application's shader, see the top of this file
+ */
+static void fghDrawStrokeString20( const SFG_StrokeFont* font, int fontIndex,
+                                   const SFG_StrokeGeometry* geometry,
+                                   const unsigned char* string, int length, GLboolean joinDots,
+                                   GLint attribute_v_coord, GLint attribute_v_glyph_offset )
+{
+    SFG_TextRenderer* text = fgTextRenderer( );
+    GLfloat x = 0.0f, y = 0.0f;
+    int i, glyphs = 0;
+
+    freeglut_return_if_fail( text );
+    /* The dots' commands are gathered after the lines' ones, see below */
+    fghReserveStrokeGlyphs( 2 * length );
+
+    for( i = 0; i < length; i++ )
+    {
+        const unsigned char c = string[ i ];
+
+        if( c >= font->Quantity )
+            continue;
+
+        if( c == '\n' )
+        {
+            x = 0.0f;
+            y -= font->Height;
+        }
+        else if( font->Characters[ c ] )
+        {
+            if( geometry->Count[ c ] || ( joinDots && geometry->DotCount[ c ] ) )
+            {
+                GLuint* command = fghStrokeCommands + glyphs * 4;
+                GLuint* dotCommand = fghStrokeCommands + ( length + glyphs ) * 4;
+                command[ 0 ] = geometry->Count[ c ];
+                command[ 1 ] = 1;
+                command[ 2 ] = geometry->First[ c ];
+                command[ 3 ] = glyphs;
+                dotCommand[ 0 ] = geometry->DotCount[ c ];
+                dotCommand[ 1 ] = 1;
+                dotCommand[ 2 ] = geometry->DotFirst[ c ];
+                dotCommand[ 3 ] = glyphs;
+                fghStrokeOffsets[ glyphs * 2     ] = x;
+                fghStrokeOffsets[ glyphs * 2 + 1 ] = y;
+                glyphs++;
+            }
+            x += font->Characters[ c ]->Right;
+        }
+    }
+
+    if( !glyphs )
+        return;
+
+    /* The dots' commands right after the lines' ones, for a single upload */
+    if( joinDots )
+        memmove( fghStrokeCommands + glyphs * 4, fghStrokeCommands + length * 4,
+                 glyphs * 4 * sizeof( GLuint ) );
+
+    fgGLStateBegin( );
+
+    /* The glyph geometry is uploaded once per context */
+    if( !text->StrokeBuffers[ fontIndex ] )
+    {
+        fghGenBuffers( 1, &text->StrokeBuffers[ fontIndex ] );
+        fghBindBuffer( FGH_ARRAY_BUFFER, text->StrokeBuffers[ fontIndex ] );
+        fghBufferData( FGH_ARRAY_BUFFER, geometry->NumVertices * 2 * sizeof( GLfloat ),
+                       geometry->Vertices, FGH_STATIC_DRAW );
+    }
+
+    fghEnableVertexAttribArray( attribute_v_coord );
+    fghBindBuffer( FGH_ARRAY_BUFFER, text->StrokeBuffers[ fontIndex ] );
+    fghVertexAttribPointer( attribute_v_coord, 2, GL_FLOAT, GL_FALSE, 0, 0 );
+
+    if( fghMultiDrawArraysIndirect && fghVertexAttribDivisor )
+    {
+        const size_t offsetsSize = glyphs * 2 * sizeof( GLfloat );
+        const size_t commandsSize = ( joinDots ? 2 : 1 ) * glyphs * 4 * sizeof( GLuint );
+        GLint indirectBuffer;
+        GLuint buffer;
+        size_t offsets, commands;
+        GLubyte* range;
+
+        /* The origins and commands share a range of the stream, see fg_stream.c */
+        range = fgStreamMap( commandsSize + offsetsSize, &buffer, &commands );
+        memcpy( range, fghStrokeCommands, commandsSize );
+        memcpy( range + commandsSize, fghStrokeOffsets, offsetsSize );
+        fgStreamUnmap( );
+        offsets = commands + commandsSize;
+
+        fghEnableVertexAttribArray( attribute_v_glyph_offset );
+        fghVertexAttribPointer( attribute_v_glyph_offset, 2, GL_FLOAT, GL_FALSE, 0,
+                                (GLvoid*)offsets );
+        fghVertexAttribDivisor( attribute_v_glyph_offset, 1 );
+
+        fghGetIntegerv( FGH_DRAW_INDIRECT_BUFFER_BINDING, &indirectBuffer );
+        fghBindBuffer( FGH_DRAW_INDIRECT_BUFFER, buffer );
+
+        fghMultiDrawArraysIndirect( GL_LINES, (GLvoid*)commands, glyphs, 0 );
+        if( joinDots )
+            fghMultiDrawArraysIndirect( GL_POINTS, (GLvoid*)( commands + glyphs * 4 * sizeof( GLuint ) ),
+                                        glyphs, 0 );
+
+        fghBindBuffer( FGH_DRAW_INDIRECT_BUFFER, indirectBuffer );
+        fghVertexAttribDivisor( attribute_v_glyph_offset, 0 );
+        fghDisableVertexAttribArray( attribute_v_glyph_offset );
+    }
+    else
+    {
+        for( i = 0; i < glyphs; i++ )
+        {
+            const GLuint* command = fghStrokeCommands + i * 4;
+            const GLuint* dotCommand = fghStrokeCommands + ( glyphs + i ) * 4;
+            fghVertexAttrib2f( attribute_v_glyph_offset,
+                               fghStrokeOffsets[ i * 2 ], fghStrokeOffsets[ i * 2 + 1 ] );
+            if( command[ 0 ] )
+                glDrawArrays( GL_LINES, command[ 2 ], command[ 0 ] );
+            if( joinDots && dotCommand[ 0 ] )
+                glDrawArrays( GL_POINTS, dotCommand[ 2 ], dotCommand[ 0 ] );
+        }
+    }
+
+    fghDisableVertexAttribArray( attribute_v_coord );
+    fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+    fgGLStateEnd( );
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Draws the first length characters of a string, drawing dots at the
+ * vertices too when joinDots is set
+ */
+void fgStrokeString( SFG_StrokeFont* font, const unsigned char* string, int length,
+                     GLboolean joinDots )
+{
+    SFG_StrokeGeometry* geometry;
+    GLint attribute_v_coord = -1, attribute_v_glyph_offset = -1;
+    int f;
+
+    for( f = 0; f < FREEGLUT_NUM_STROKE_FONTS; f++ )
+        if( fghStrokeFonts[ f ] == font )
+            break;
+    freeglut_return_if_fail( f < FREEGLUT_NUM_STROKE_FONTS );
+
+    geometry = &fghStrokeGeometry[ f ];
+    if( !geometry->Vertices )
+        fghBakeStrokeGeometry( geometry, font );
+
+    if( fgStructure.CurrentWindow )
+    {
+        attribute_v_coord        = fgStructure.CurrentWindow->Window.attribute_v_coord;
+        attribute_v_glyph_offset = fgStructure.CurrentWindow->Window.attribute_v_glyph_offset;
+    }
+
+    if( fgState.HasOpenGL20 && attribute_v_coord != -1 && attribute_v_glyph_offset != -1 )
+        fghDrawStrokeString20( font, f, geometry, string, length, joinDots,
+                               attribute_v_coord, attribute_v_glyph_offset );
+    else
+        fghDrawStrokeString11( font, geometry, string, length, joinDots );
+}
+
+/*** END OF FILE ***/
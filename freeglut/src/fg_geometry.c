@@ -29,39 +29,30 @@
 #include "fg_internal.h"
 #include "fg_gl2.h"
 #include <math.h>
+#include <limits.h>
 
 /*
- * A note: We do not use the GLuint data type for vertex index arrays
- * in this code as Open GL ES1 only supports GLushort. This affects the
- * cylindrical objects only (Torus, Sphere, Cylinder and Cone) and limits
- * their number of vertices to 65535 (2^16-1). Thats about 256*256
- * subdivisions, which is sufficient for just about any usage case, so
- * I am not going to worry about it for now.
- * One could do compile time detection of the gluint type through CMake,
- * but it is likely that we'll eventually move to runtime selection
- * of OpenGL or GLES1/2, which would make that strategy useless...
+ * A note: vertex indices are GLuint, so that the cylindrical objects
+ * (Torus, Sphere, Cylinder and Cone) can have more than 65535 vertices.
+ * Shapes that fit are still drawn with GLushort indices (see
+ * fg_shape_cache.c). OpenGL ES 1.1 only supports GLushort, so there the
+ * indices of larger shapes wrap, as they used to everywhere.
  */
 
 /* declare for drawing using the different OpenGL versions here so we can
    have a nice code order below */
-static void fghDrawGeometryWire11(GLfloat *vertices, GLfloat *normals,
-                                  GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                  GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
+static void fghDrawGeometryWire11(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                  GLuint *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                                  GLuint *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
     );
 static void fghDrawGeometrySolid11(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart);
-static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
-                                  GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                  GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2,
-                                  GLint attribute_v_coord, GLint attribute_v_normal
-    );
-static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart,
-                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture);
+                                   GLuint *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart);
 /* declare function for generating visualization of normals */
-static void fghGenerateNormalVisualization(GLfloat *vertices, GLfloat *normals, GLsizei numVertices);
-static void fghDrawNormalVisualization11();
-static void fghDrawNormalVisualization20(GLint attribute_v_coord);
+static void fghGenerateNormalVisualization(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                           GLfloat *verticesOut);
+static void fghDrawNormalVisualization11(GLfloat *vertices, GLfloat *normals, GLsizei numVertices);
+static void fghDrawNormalVisualization20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                         GLint attribute_v_coord);
 
 /* Drawing geometry:
  * Explanation of the functions has to be separate for the polyhedra and
@@ -109,7 +100,7 @@ static void fghDrawNormalVisualization20(GLint attribute_v_coord);
  * GLfloat *vertices, GLfloat *normals, GLsizei numVertices
  *   The vertex coordinate and normal buffers, and the number of entries in
  *   those
- * GLushort *vertIdxs
+ * GLuint *vertIdxs
  *   a vertex indices buffer, optional (never passed for the polyhedra)
  * GLsizei numParts, GLsizei numVertPerPart
  *   polyhedra: number of faces, and the number of vertices for drawing
@@ -123,28 +114,46 @@ static void fghDrawNormalVisualization20(GLint attribute_v_coord);
  * GLenum vertexMode
  *   vertex drawing mode (e.g. always GL_LINE_LOOP for polyhedra, varies
  *   for others)
- * GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
+ * GLuint *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
  *   non-polyhedra only: same as the above, but now for subdivisions along
  *   the other axis. Always drawn as GL_LINE_LOOP.
+ * const SFG_ShapeKey *key
+ *   what the shape was generated from, to keep its buffers for later
+ *   draws (see fgDrawCachedShape), or NULL
  *
  * Feel free to contribute better naming ;)
  */
-void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
-                                GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
+void fghDrawGeometryWire(const SFG_ShapeKey *key,
+                         GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                         GLuint *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                         GLuint *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
     )
 {
-    GLint attribute_v_coord  = fgStructure.CurrentWindow->Window.attribute_v_coord;
-    GLint attribute_v_normal = fgStructure.CurrentWindow->Window.attribute_v_normal;
+    GLint attribute_v_coord, attribute_v_normal;
+
+    /* Kept for a file of glutBakeShapes instead, with no window to draw in */
+    if (fgBakeShape(key, vertices, normals, NULL, numVertices, vertexMode,
+                    vertIdxs, numParts, numVertPerPart, vertIdxs2, numParts2, numVertPerPart2))
+        return;
+
+    attribute_v_coord  = fgStructure.CurrentWindow->Window.attribute_v_coord;
+    attribute_v_normal = fgStructure.CurrentWindow->Window.attribute_v_normal;
 
     if (fgState.HasOpenGL20 && (attribute_v_coord != -1 || attribute_v_normal != -1))
+    {
         /* User requested a 2.0 draw */
-        fghDrawGeometryWire20(vertices, normals, numVertices,
-                              vertIdxs, numParts, numVertPerPart, vertexMode,
-                              vertIdxs2, numParts2, numVertPerPart2,
-                              attribute_v_coord, attribute_v_normal);
+        SFG_Shape *shape;
+
+        fgGLStateBegin();
+        shape = fgCreateShape(key, vertices, normals, NULL, numVertices, vertexMode,
+                              vertIdxs, numParts, numVertPerPart,
+                              vertIdxs2, numParts2, numVertPerPart2);
+        fgDrawShape(shape);
+        fgReleaseShape(shape);
+        fgGLStateEnd();
+    }
     else
-        fghDrawGeometryWire11(vertices, normals,
+        fghDrawGeometryWire11(vertices, normals, numVertices,
                               vertIdxs, numParts, numVertPerPart, vertexMode,
                               vertIdxs2, numParts2, numVertPerPart2);
 }
@@ -155,7 +164,7 @@ void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertice
  * GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices
  *   The vertex coordinate, normal and texture coordinate buffers, and the
  *   number of entries in those
- * GLushort *vertIdxs
+ * GLuint *vertIdxs
  *   a vertex indices buffer, optional (not passed for the polyhedra with
  *   triangular faces)
  * GLsizei numParts, GLsizei numVertPerPart
@@ -174,28 +183,46 @@ void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertice
        processed at each draw call.
  *   numParts * numVertPerPart gives the number of entries in the vertex
  *     array vertIdxs
+ * const SFG_ShapeKey *key
+ *   as for fghDrawGeometryWire
  */
-void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                          GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
+void fghDrawGeometrySolid(const SFG_ShapeKey *key,
+                          GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
+                          GLuint *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
 {
-    GLint attribute_v_coord   = fgStructure.CurrentWindow->Window.attribute_v_coord;
-    GLint attribute_v_normal  = fgStructure.CurrentWindow->Window.attribute_v_normal;
-    GLint attribute_v_texture = fgStructure.CurrentWindow->Window.attribute_v_texture;
+    GLint attribute_v_coord, attribute_v_normal;
 
-    if (fgStructure.CurrentWindow->State.VisualizeNormals)
-        /* generate normals for each vertex to be drawn as well */
-        fghGenerateNormalVisualization(vertices, normals, numVertices);
+    if (fgBakeShape(key, vertices, normals, textcs, numVertices, GL_TRIANGLES,
+                    vertIdxs, numParts, numVertIdxsPerPart, NULL, 0, 0))
+        return;
+
+    attribute_v_coord   = fgStructure.CurrentWindow->Window.attribute_v_coord;
+    attribute_v_normal  = fgStructure.CurrentWindow->Window.attribute_v_normal;
 
     if (fgState.HasOpenGL20 && (attribute_v_coord != -1 || attribute_v_normal != -1))
     {
-        /* User requested a 2.0 draw */
-        fghDrawGeometrySolid20(vertices, normals, textcs, numVertices,
-                               vertIdxs, numParts, numVertIdxsPerPart,
-                               attribute_v_coord, attribute_v_normal, attribute_v_texture);
+        /* User requested a 2.0 draw. The shape is not kept when the
+           normals are shown, as they are drawn from its vertices */
+        SFG_Shape *shape;
+
+        if (fgStructure.CurrentWindow->State.VisualizeNormals)
+            key = NULL;
+
+        fgGLStateBegin();
+        if (!vertIdxs)
+            shape = fgCreateShape(key, vertices, normals, textcs, numVertices, GL_TRIANGLES,
+                                  NULL, 1, numVertices, NULL, 0, 0);
+        else
+            shape = fgCreateShape(key, vertices, normals, textcs, numVertices,
+                                  numParts>1 ? GL_TRIANGLE_STRIP : GL_TRIANGLES,
+                                  vertIdxs, numParts, numVertIdxsPerPart, NULL, 0, 0);
+        fgDrawShape(shape);
+        fgReleaseShape(shape);
 
         if (fgStructure.CurrentWindow->State.VisualizeNormals)
             /* draw normals for each vertex as well */
-            fghDrawNormalVisualization20(attribute_v_coord);
+            fghDrawNormalVisualization20(vertices, normals, numVertices, attribute_v_coord);
+        fgGLStateEnd();
     }
     else
     {
@@ -204,19 +231,102 @@ void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs,
 
         if (fgStructure.CurrentWindow->State.VisualizeNormals)
             /* draw normals for each vertex as well */
-            fghDrawNormalVisualization11();
+            fghDrawNormalVisualization11(vertices, normals, numVertices);
     }
 }
 
+/* Whether shapes are drawn from buffers, through the vertex attributes,
+ * and can be kept in them
+ */
+static GLboolean fghDrawToShapeBuffers(void)
+{
+    SFG_Window *window = fgStructure.CurrentWindow;
 
+    return fgState.HasOpenGL20 && !window->State.VisualizeNormals &&
+           (window->Window.attribute_v_coord != -1 || window->Window.attribute_v_normal != -1);
+}
+
+/* Draws a shape from the buffers kept by an earlier fghDrawGeometryWire or
+ * fghDrawGeometrySolid with the same key, if there are any, or else from
+ * the file of glutMapShapes, so that it does not have to be generated
+ * again. Returns GL_FALSE if it is in neither, or while baking shapes.
+ */
+GLboolean fgDrawCachedShape(const SFG_ShapeKey *key)
+{
+    SFG_Shape *shape;
+
+    if (fgBakingShapes())
+        return GL_FALSE;
+
+    if (fghDrawToShapeBuffers())
+    {
+        shape = fgFindShape(key);
+        if (shape)
+        {
+            fgDrawShape(shape);
+            return GL_TRUE;
+        }
+    }
+
+    return fgDrawBakedShape(key);
+}
+
+
+
+/* OpenGL ES 1.1 only takes GLushort indices. Returns the indices to pass
+ * to glDrawElements, to be released with fghFreeIndices11.
+ */
+static GLvoid *fghIndices11(GLuint *vertIdxs, GLsizei numVertIdxs, GLsizei numVertices,
+                            GLenum *type, GLsizei *size)
+{
+#ifdef GL_ES_VERSION_2_0
+    GLushort *shortIdxs;
+    GLsizei i;
+
+    *type = GL_UNSIGNED_SHORT;
+    *size = sizeof(GLushort);
+    if (!vertIdxs)
+        return NULL;
+
+    if (numVertices > 65535)
+        fgWarning("fghIndices11: too many slices or stacks requested, indices will wrap");
+
+    shortIdxs = malloc(numVertIdxs*sizeof(GLushort));
+    if (!shortIdxs)
+        fgError("Failed to allocate memory in fghIndices11");
+    for (i=0; i<numVertIdxs; i++)
+        shortIdxs[i] = (GLushort)vertIdxs[i];
+    return shortIdxs;
+#else
+    /* Used as they are */
+    (void)numVertIdxs;
+    (void)numVertices;
+    *type = GL_UNSIGNED_INT;
+    *size = sizeof(GLuint);
+    return vertIdxs;
+#endif
+}
+
+static void fghFreeIndices11(GLvoid *idxs)
+{
+#ifdef GL_ES_VERSION_2_0
+    free(idxs);
+#else
+    (void)idxs;
+#endif
+}
 
 /* Version for OpenGL (ES) 1.1 */
-static void fghDrawGeometryWire11(GLfloat *vertices, GLfloat *normals,
-                                  GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                  GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
+static void fghDrawGeometryWire11(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                  GLuint *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                                  GLuint *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2
     )
 {
     int i;
+    GLenum type;
+    GLsizei size;
+    GLubyte *idxs  = fghIndices11(vertIdxs,  numParts*numVertPerPart,   numVertices, &type, &size);
+    GLubyte *idxs2 = fghIndices11(vertIdxs2, numParts2*numVertPerPart2, numVertices, &type, &size);
     
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_NORMAL_ARRAY);
@@ -231,21 +341,27 @@ static void fghDrawGeometryWire11(GLfloat *vertices, GLfloat *normals,
             glDrawArrays(vertexMode, i*numVertPerPart, numVertPerPart);
     else
         for (i=0; i<numParts; i++)
-            glDrawElements(vertexMode,numVertPerPart,GL_UNSIGNED_SHORT,vertIdxs+i*numVertPerPart);
+            glDrawElements(vertexMode,numVertPerPart,type,idxs+i*numVertPerPart*size);
 
     if (vertIdxs2)
         for (i=0; i<numParts2; i++)
-            glDrawElements(GL_LINE_LOOP,numVertPerPart2,GL_UNSIGNED_SHORT,vertIdxs2+i*numVertPerPart2);
+            glDrawElements(GL_LINE_LOOP,numVertPerPart2,type,idxs2+i*numVertPerPart2*size);
 
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_NORMAL_ARRAY);
+
+    fghFreeIndices11(idxs);
+    fghFreeIndices11(idxs2);
 }
 
 
 static void fghDrawGeometrySolid11(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
+                                   GLuint *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart)
 {
     int i;
+    GLenum type;
+    GLsizei size;
+    GLubyte *idxs = fghIndices11(vertIdxs, numParts*numVertIdxsPerPart, numVertices, &type, &size);
 
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_NORMAL_ARRAY);
@@ -264,275 +380,57 @@ static void fghDrawGeometrySolid11(GLfloat *vertices, GLfloat *normals, GLfloat
     else
         if (numParts>1)
             for (i=0; i<numParts; i++)
-                glDrawElements(GL_TRIANGLE_STRIP, numVertIdxsPerPart, GL_UNSIGNED_SHORT, vertIdxs+i*numVertIdxsPerPart);
+                glDrawElements(GL_TRIANGLE_STRIP, numVertIdxsPerPart, type, idxs+i*numVertIdxsPerPart*size);
         else
-            glDrawElements(GL_TRIANGLES, numVertIdxsPerPart, GL_UNSIGNED_SHORT, vertIdxs);
+            glDrawElements(GL_TRIANGLES, numVertIdxsPerPart, type, idxs);
 
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_NORMAL_ARRAY);
     if (textcs)
         glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-}
-
-/* Version for OpenGL (ES) >= 2.0 */
-static void fghDrawGeometryWire20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
-                                  GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                  GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2,
-                                  GLint attribute_v_coord, GLint attribute_v_normal)
-{
-    GLuint vbo_coords = 0, vbo_normals = 0,
-        ibo_elements = 0, ibo_elements2 = 0;
-    GLsizei numVertIdxs = numParts * numVertPerPart;
-    GLsizei numVertIdxs2 = numParts2 * numVertPerPart2;
-    int i;
-
-    if (numVertices > 0 && attribute_v_coord != -1) {
-        fghGenBuffers(1, &vbo_coords);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
-                      vertices, FGH_STATIC_DRAW);
-    }
-    
-    if (numVertices > 0 && attribute_v_normal != -1) {
-        fghGenBuffers(1, &vbo_normals);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
-                      normals, FGH_STATIC_DRAW);
-    }
-    
-    if (vertIdxs != NULL) {
-        fghGenBuffers(1, &ibo_elements);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
-                      vertIdxs, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
-    }
-
-    if (vertIdxs2 != NULL) {
-        fghGenBuffers(1, &ibo_elements2);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements2);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs2 * sizeof(vertIdxs2[0]),
-                      vertIdxs2, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
-    }
-
-    if (vbo_coords) {
-        fghEnableVertexAttribArray(attribute_v_coord);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghVertexAttribPointer(
-            attribute_v_coord,  /* attribute */
-            3,                  /* number of elements per vertex, here (x,y,z) */
-            GL_FLOAT,           /* the type of each element */
-            GL_FALSE,           /* take our values as-is */
-            0,                  /* no extra data between each position */
-            0                   /* offset of first element */
-        );
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    }
-
-    if (vbo_normals) {
-        fghEnableVertexAttribArray(attribute_v_normal);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghVertexAttribPointer(
-            attribute_v_normal, /* attribute */
-            3,                  /* number of elements per vertex, here (x,y,z) */
-            GL_FLOAT,           /* the type of each element */
-            GL_FALSE,           /* take our values as-is */
-            0,                  /* no extra data between each position */
-            0                   /* offset of first element */
-        );
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    }
-
-    if (!vertIdxs) {
-        /* Draw per face (TODO: could use glMultiDrawArrays if available) */
-        for (i=0; i<numParts; i++)
-            glDrawArrays(vertexMode, i*numVertPerPart, numVertPerPart);
-    } else {
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        for (i=0; i<numParts; i++)
-            glDrawElements(vertexMode, numVertPerPart,
-                           GL_UNSIGNED_SHORT, (GLvoid*)(sizeof(vertIdxs[0])*i*numVertPerPart));
-        /* Clean existing bindings before clean-up */
-        /* Android showed instability otherwise */
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
-    }
 
-    if (vertIdxs2) {
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements2);
-        for (i=0; i<numParts2; i++)
-            glDrawElements(GL_LINE_LOOP, numVertPerPart2,
-                           GL_UNSIGNED_SHORT, (GLvoid*)(sizeof(vertIdxs2[0])*i*numVertPerPart2));
-        /* Clean existing bindings before clean-up */
-        /* Android showed instability otherwise */
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
-    }
-    
-    if (vbo_coords != 0)
-        fghDisableVertexAttribArray(attribute_v_coord);
-    if (vbo_normals != 0)
-        fghDisableVertexAttribArray(attribute_v_normal);
-    
-    if (vbo_coords != 0)
-        fghDeleteBuffers(1, &vbo_coords);
-    if (vbo_normals != 0)
-        fghDeleteBuffers(1, &vbo_normals);
-    if (ibo_elements != 0)
-        fghDeleteBuffers(1, &ibo_elements);
-    if (ibo_elements2 != 0)
-        fghDeleteBuffers(1, &ibo_elements2);
+    fghFreeIndices11(idxs);
 }
 
-
-
-
-/* Version for OpenGL (ES) >= 2.0 */
-static void fghDrawGeometrySolid20(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                                   GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart,
-                                   GLint attribute_v_coord, GLint attribute_v_normal, GLint attribute_v_texture)
+/**
+ * Generate the lines visualizing the normals, one from each vertex along
+ * its normal, into verticesOut, which has room for numVertices*2 vertices
+ */
+static void fghGenerateNormalVisualization(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                           GLfloat *verticesOut)
 {
-    GLuint vbo_coords = 0, vbo_normals = 0, vbo_textcs = 0, ibo_elements = 0;
-    GLsizei numVertIdxs = numParts * numVertIdxsPerPart;
-    int i;
-  
-    if (numVertices > 0 && attribute_v_coord != -1) {
-        fghGenBuffers(1, &vbo_coords);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(vertices[0]),
-                      vertices, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    }
-    
-    if (numVertices > 0 && attribute_v_normal != -1) {
-        fghGenBuffers(1, &vbo_normals);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 3 * sizeof(normals[0]),
-                      normals, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    }
-
-    if (numVertices > 0 && attribute_v_texture != -1 && textcs) {
-        fghGenBuffers(1, &vbo_textcs);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_textcs);
-        fghBufferData(FGH_ARRAY_BUFFER, numVertices * 2 * sizeof(textcs[0]),
-                      textcs, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    }
-    
-    if (vertIdxs != NULL) {
-        fghGenBuffers(1, &ibo_elements);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        fghBufferData(FGH_ELEMENT_ARRAY_BUFFER, numVertIdxs * sizeof(vertIdxs[0]),
-                      vertIdxs, FGH_STATIC_DRAW);
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
-    }
-    
-    if (vbo_coords) {
-        fghEnableVertexAttribArray(attribute_v_coord);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghVertexAttribPointer(
-            attribute_v_coord,  /* attribute */
-            3,                  /* number of elements per vertex, here (x,y,z) */
-            GL_FLOAT,           /* the type of each element */
-            GL_FALSE,           /* take our values as-is */
-            0,                  /* no extra data between each position */
-            0                   /* offset of first element */
-        );
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    };
-    
-    if (vbo_normals) {
-        fghEnableVertexAttribArray(attribute_v_normal);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_normals);
-        fghVertexAttribPointer(
-            attribute_v_normal, /* attribute */
-            3,                  /* number of elements per vertex, here (x,y,z) */
-            GL_FLOAT,           /* the type of each element */
-            GL_FALSE,           /* take our values as-is */
-            0,                  /* no extra data between each position */
-            0                   /* offset of first element */
-        );
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    };
+    int i,j;
 
-    if (vbo_textcs) {
-        fghEnableVertexAttribArray(attribute_v_texture);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_textcs);
-        fghVertexAttribPointer(
-            attribute_v_texture,/* attribute */
-            2,                  /* number of elements per vertex, here (s,t) */
-            GL_FLOAT,           /* the type of each element */
-            GL_FALSE,           /* take our values as-is */
-            0,                  /* no extra data between each position */
-            0                   /* offset of first element */
-            );
-        fghBindBuffer(FGH_ARRAY_BUFFER, 0);
-    };
-    
-    if (vertIdxs == NULL) {
-        glDrawArrays(GL_TRIANGLES, 0, numVertices);
-    } else {
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, ibo_elements);
-        if (numParts>1) {
-            for (i=0; i<numParts; i++) {
-                glDrawElements(GL_TRIANGLE_STRIP, numVertIdxsPerPart, GL_UNSIGNED_SHORT, (GLvoid*)(sizeof(vertIdxs[0])*i*numVertIdxsPerPart));
-            }
-        } else {
-            glDrawElements(GL_TRIANGLES, numVertIdxsPerPart, GL_UNSIGNED_SHORT, 0);
-        }
-        /* Clean existing bindings before clean-up */
-        /* Android showed instability otherwise */
-        fghBindBuffer(FGH_ELEMENT_ARRAY_BUFFER, 0);
+    for (i=0,j=0; i<numVertices*3; i+=3, j+=6)
+    {
+        verticesOut[j+0] = vertices[i+0];
+        verticesOut[j+1] = vertices[i+1];
+        verticesOut[j+2] = vertices[i+2];
+        verticesOut[j+3] = vertices[i+0] + normals[i+0]/4.f;
+        verticesOut[j+4] = vertices[i+1] + normals[i+1]/4.f;
+        verticesOut[j+5] = vertices[i+2] + normals[i+2]/4.f;
     }
-    
-    if (vbo_coords != 0)
-        fghDisableVertexAttribArray(attribute_v_coord);
-    if (vbo_normals != 0)
-        fghDisableVertexAttribArray(attribute_v_normal);
-    if (vbo_textcs != 0)
-        fghDisableVertexAttribArray(attribute_v_texture);
-    
-    if (vbo_coords != 0)
-        fghDeleteBuffers(1, &vbo_coords);
-    if (vbo_normals != 0)
-        fghDeleteBuffers(1, &vbo_normals);
-    if (vbo_textcs != 0)
-        fghDeleteBuffers(1, &vbo_textcs);
-    if (ibo_elements != 0)
-        fghDeleteBuffers(1, &ibo_elements);
 }
 
-
-
-/**
- * Generate vertex indices for visualizing the normals.
- * vertices are written into verticesForNormalVisualization.
- * This must be freed by caller, we do the free at the
- * end of fghDrawNormalVisualization11/fghDrawNormalVisualization20
+/* Version for OpenGL (ES) 1.1, which draws from client memory: the lines
+ * go in a buffer that is kept, and only grown, from draw to draw
  */
 static GLfloat *verticesForNormalVisualization;
-static GLsizei numNormalVertices = 0;
-static void fghGenerateNormalVisualization(GLfloat *vertices, GLfloat *normals, GLsizei numVertices)
+static GLsizei maxNormalVertices = 0;
+static void fghDrawNormalVisualization11(GLfloat *vertices, GLfloat *normals, GLsizei numVertices)
 {
-    int i,j;
-    numNormalVertices = numVertices * 2;
-    verticesForNormalVisualization = malloc(numNormalVertices*3 * sizeof(GLfloat));
+    GLfloat currentColor[4];
 
-    for (i=0,j=0; i<numNormalVertices*3/2; i+=3, j+=6)
+    if (numVertices*2 > maxNormalVertices)
     {
-        verticesForNormalVisualization[j+0] = vertices[i+0];
-        verticesForNormalVisualization[j+1] = vertices[i+1];
-        verticesForNormalVisualization[j+2] = vertices[i+2];
-        verticesForNormalVisualization[j+3] = vertices[i+0] + normals[i+0]/4.f;
-        verticesForNormalVisualization[j+4] = vertices[i+1] + normals[i+1]/4.f;
-        verticesForNormalVisualization[j+5] = vertices[i+2] + normals[i+2]/4.f;
+        free(verticesForNormalVisualization);
+        verticesForNormalVisualization = malloc(numVertices*2*3 * sizeof(GLfloat));
+        if (!verticesForNormalVisualization)
+            fgError("Failed to allocate memory in fghDrawNormalVisualization11");
+        maxNormalVertices = numVertices*2;
     }
-}
+    fghGenerateNormalVisualization(vertices, normals, numVertices, verticesForNormalVisualization);
 
-/* Version for OpenGL (ES) 1.1 */
-static void fghDrawNormalVisualization11()
-{
-    GLfloat currentColor[4];
     /* Setup draw color: (1,1,1)-shape's color */
     glGetFloatv(GL_CURRENT_COLOR,currentColor);
     glColor4f(1-currentColor[0],1-currentColor[1],1-currentColor[2],currentColor[3]);
@@ -540,52 +438,44 @@ static void fghDrawNormalVisualization11()
     glEnableClientState(GL_VERTEX_ARRAY);
 
     glVertexPointer(3, GL_FLOAT, 0, verticesForNormalVisualization);
-    glDrawArrays(GL_LINES, 0, numNormalVertices);
+    glDrawArrays(GL_LINES, 0, numVertices*2);
 
     glDisableClientState(GL_VERTEX_ARRAY);
 
-    /* Done, free memory, reset color */
-    free(verticesForNormalVisualization);
+    /* Done, reset color */
     glColor4f(currentColor[0],currentColor[1],currentColor[2],currentColor[3]);
 }
 
 /* Version for OpenGL (ES) >= 2.0 */
-static void fghDrawNormalVisualization20(GLint attribute_v_coord)
+static void fghDrawNormalVisualization20(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                                         GLint attribute_v_coord)
 {
-    GLuint vbo_coords = 0;
-
     if (attribute_v_coord != -1) {
-        fghGenBuffers(1, &vbo_coords);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
-        fghBufferData(FGH_ARRAY_BUFFER, numNormalVertices * 3 * sizeof(verticesForNormalVisualization[0]),
-            verticesForNormalVisualization, FGH_STATIC_DRAW);
-    }
+        /* Drawn once, so generated straight into the stream rather than
+           given a buffer of its own */
+        GLuint buffer;
+        size_t offset;
+        GLfloat *verticesOut = fgStreamMap(numVertices*2*3 * sizeof(GLfloat), &buffer, &offset);
 
+        fghGenerateNormalVisualization(vertices, normals, numVertices, verticesOut);
+        fgStreamUnmap();
 
-    if (vbo_coords) {
         fghEnableVertexAttribArray(attribute_v_coord);
-        fghBindBuffer(FGH_ARRAY_BUFFER, vbo_coords);
         fghVertexAttribPointer(
             attribute_v_coord,  /* attribute */
             3,                  /* number of elements per vertex, here (x,y,z) */
             GL_FLOAT,           /* the type of each element */
             GL_FALSE,           /* take our values as-is */
             0,                  /* no extra data between each position */
-            0                   /* offset of first element */
+            (GLvoid*)offset     /* offset of first element */
             );
         fghBindBuffer(FGH_ARRAY_BUFFER, 0);
     }
 
-    glDrawArrays(GL_LINES, 0, numNormalVertices);
+    glDrawArrays(GL_LINES, 0, numVertices*2);
 
-    if (vbo_coords != 0)
+    if (attribute_v_coord != -1)
         fghDisableVertexAttribArray(attribute_v_coord);
-
-    if (vbo_coords != 0)
-        fghDeleteBuffers(1, &vbo_coords);
-
-    /* Done, free memory */
-    free(verticesForNormalVisualization);
 }
 
 /**
@@ -600,7 +490,7 @@ static void fghDrawNormalVisualization20(GLint attribute_v_coord)
 static GLubyte   vert4Decomp[6] = {0,1,2, 0,2,3};             /* quad    : 4 input vertices, 6 output (2 triangles) */
 static GLubyte   vert5Decomp[9] = {0,1,2, 0,2,4, 4,2,3};      /* pentagon: 5 input vertices, 9 output (3 triangles) */
 
-static void fghGenerateGeometryWithIndexArray(int numFaces, int numEdgePerFace, GLfloat *vertices, GLubyte *vertIndices, GLfloat *normals, GLfloat *vertOut, GLfloat *normOut, GLushort *vertIdxOut)
+static void fghGenerateGeometryWithIndexArray(int numFaces, int numEdgePerFace, GLfloat *vertices, GLubyte *vertIndices, GLfloat *normals, GLfloat *vertOut, GLfloat *normOut, GLuint *vertIdxOut)
 {
     int i,j,numEdgeIdxPerFace;
     GLubyte   *vertSamps = NULL;
@@ -676,7 +566,7 @@ static void fghGenerateGeometry(int numFaces, int numEdgePerFace, GLfloat *verti
     static GLboolean name##Cached = GL_FALSE;\
     static GLfloat   name##_verts[nameCaps##_VERT_ELEM_PER_OBJ];\
     static GLfloat   name##_norms[nameCaps##_VERT_ELEM_PER_OBJ];\
-    static GLushort  name##_vertIdxs[nameCaps##_VERT_PER_OBJ_TRI];\
+    static GLuint  name##_vertIdxs[nameCaps##_VERT_PER_OBJ_TRI];\
     static void fgh##nameICaps##Generate()\
     {\
         fghGenerateGeometryWithIndexArray(nameCaps##_NUM_FACES, nameCaps##_NUM_EDGE_PER_FACE,\
@@ -1050,44 +940,66 @@ static unsigned int ipow (int x, unsigned int y)
     }
 }
 
-static void fghSierpinskiSpongeGenerate ( int numLevels, double offset[3], GLfloat scale, GLfloat* vertices, GLfloat* normals )
+/* Tetrahedra generated at a time, which bounds the memory a sponge takes
+ * on the CPU whatever its number of levels */
+#define SIERPINSKI_SPONGE_CHUNK 4096
+
+/* Beyond, the number of tetrahedra no longer fits in a GLsizei */
+#define SIERPINSKI_SPONGE_MAX_LEVELS 15
+
+/*
+ * Generates tetrahedra first to first+count-1 of a sponge, in the order the
+ * recursive subdivision would: read most significant first, the base 4
+ * digits of a tetrahedron's number say which corner it went to at each
+ * level. Each tetrahedron is worked out on its own, so any range can be
+ * generated without the others. Vertices and normals are written every
+ * stride floats. Faces come as triangles, or with asLines as the three
+ * segments of their outline.
+ */
+static void fghSierpinskiSpongeGenerate ( int numLevels, double offset[3], GLfloat scale,
+                                          GLsizei first, GLsizei count, GLboolean asLines,
+                                          GLfloat* vertices, GLfloat* normals, int stride )
 {
-    int i, j;
-    if ( numLevels == 0 )
+    int i, j, k, level;
+    GLsizei t;
+
+    for ( t = first; t < first + count; t++ )
     {
+        double local_offset[3];     /* In double, as the recursion had it, to avoid buildup of roundoff errors */
+        GLfloat local_scale = scale;
+
+        local_offset[0] = offset[0];
+        local_offset[1] = offset[1];
+        local_offset[2] = offset[2];
+        for ( level = numLevels - 1; level >= 0; level-- )
+        {
+            int idx = ( ( t >> ( 2 * level ) ) & 3 ) * 3;
+            local_scale /= 2.0;
+            local_offset[0] += local_scale * tetrahedron_v[idx  ];
+            local_offset[1] += local_scale * tetrahedron_v[idx+1];
+            local_offset[2] += local_scale * tetrahedron_v[idx+2];
+        }
+
         for (i=0; i<TETRAHEDRON_NUM_FACES; i++)
         {
             int normIdx         = i*3;
             int faceIdxVertIdx  = i*TETRAHEDRON_NUM_EDGE_PER_FACE;
-            for (j=0; j<TETRAHEDRON_NUM_EDGE_PER_FACE; j++)
+            for (k=0; k<(asLines ? 2*TETRAHEDRON_NUM_EDGE_PER_FACE : TETRAHEDRON_NUM_EDGE_PER_FACE); k++)
             {
-                int outIdx  = i*TETRAHEDRON_NUM_EDGE_PER_FACE*3+j*3;
-                int vertIdx = tetrahedron_vi[faceIdxVertIdx+j]*3;
-
-                vertices[outIdx  ] = (GLfloat)offset[0] + scale * tetrahedron_v[vertIdx  ];
-                vertices[outIdx+1] = (GLfloat)offset[1] + scale * tetrahedron_v[vertIdx+1];
-                vertices[outIdx+2] = (GLfloat)offset[2] + scale * tetrahedron_v[vertIdx+2];
-
-                normals [outIdx  ] = tetrahedron_n[normIdx  ];
-                normals [outIdx+1] = tetrahedron_n[normIdx+1];
-                normals [outIdx+2] = tetrahedron_n[normIdx+2];
+                /* Segments from each corner to the next */
+                int corner  = asLines ? ( k/2 + k%2 ) % TETRAHEDRON_NUM_EDGE_PER_FACE : k;
+                int vertIdx = tetrahedron_vi[faceIdxVertIdx+corner]*3;
+
+                for (j=0; j<3; j++)
+                {
+                    vertices[j] = (GLfloat)local_offset[j] + local_scale * tetrahedron_v[vertIdx+j];
+                    normals [j] = tetrahedron_n[normIdx+j];
+                }
+                vertices += stride;
+                normals  += stride;
             }
         }
     }
-    else if ( numLevels > 0 )
-    {
-        double local_offset[3] ;    /* Use a local variable to avoid buildup of roundoff errors */
-        unsigned int stride = ipow(4,--numLevels)*TETRAHEDRON_VERT_ELEM_PER_OBJ;
-        scale /= 2.0 ;
-        for ( i = 0 ; i < TETRAHEDRON_NUM_FACES ; i++ )
-        {
-            int idx         = i*3;
-            local_offset[0] = offset[0] + scale * tetrahedron_v[idx  ];
-            local_offset[1] = offset[1] + scale * tetrahedron_v[idx+1];
-            local_offset[2] = offset[2] + scale * tetrahedron_v[idx+2];
-            fghSierpinskiSpongeGenerate ( numLevels, local_offset, scale, vertices+i*stride, normals+i*stride );
-        }
-    }
 }
 
 /* -- Now the various non-polyhedra (shapes involving circles) -- */
@@ -1165,11 +1077,6 @@ static void fghGenerateSphere(GLfloat radius, GLint slices, GLint stacks, GLfloa
         return;
     }
     *nVert = slices*(stacks-1)+2;
-    if ((*nVert) > 65535)
-        /*
-         * limit of glushort, thats 256*256 subdivisions, should be enough in practice. See note above
-         */
-        fgWarning("fghGenerateSphere: too many slices or stacks requested, indices will wrap");
 
     /* precompute values on unit circle */
     fghCircleTable(&sint1,&cost1,-slices,GL_FALSE);
@@ -1260,11 +1167,6 @@ void fghGenerateCone(
     }
     *nVert = slices*(stacks+2)+1;   /* need an extra stack for closing off bottom with correct normals */
 
-    if ((*nVert) > 65535)
-        /*
-         * limit of glushort, thats 256*256 subdivisions, should be enough in practice. See note above
-         */
-        fgWarning("fghGenerateCone: too many slices or stacks requested, indices will wrap");
 
     /* Pre-computed circle */
     fghCircleTable(&sint,&cost,-slices,GL_FALSE);
@@ -1345,11 +1247,6 @@ void fghGenerateCylinder(
     }
     *nVert = slices*(stacks+3)+2;   /* need two extra stacks for closing off top and bottom with correct normals */
 
-    if ((*nVert) > 65535)
-        /*
-         * limit of glushort, thats 256*256 subdivisions, should be enough in practice. See note above
-         */
-        fgWarning("fghGenerateCylinder: too many slices or stacks requested, indices will wrap");
 
     /* Pre-computed circle */
     fghCircleTable(&sint,&cost,-slices,GL_FALSE);
@@ -1447,11 +1344,6 @@ void fghGenerateTorus(
     }
     *nVert = nSides * nRings;
 
-    if ((*nVert) > 65535)
-        /*
-         * limit of glushort, thats 256*256 subdivisions, should be enough in practice. See note above
-         */
-        fgWarning("fghGenerateTorus: too many slices or stacks requested, indices will wrap");
 
     /* precompute values on unit circle */
     fghCircleTable(&spsi,&cpsi, nRings,GL_FALSE);
@@ -1493,6 +1385,13 @@ void fghGenerateTorus(
 #define _DECLARE_INTERNAL_DRAW_DO_DECLARE(name,nameICaps,nameCaps,vertIdxs)\
     static void fgh##nameICaps( GLboolean useWireMode )\
     {\
+        SFG_ShapeKey key;\
+        fgInitShapeKey(&key, FG_SHAPE_##nameCaps, useWireMode, 0.f, 0.f, 0, 0);\
+        if (fgDrawProceduralPolyhedron(&key, 1.f, name##_v, nameCaps##_NUM_VERT, name##_vi,\
+                                       nameCaps##_NUM_FACES, nameCaps##_NUM_EDGE_PER_FACE, name##_n) ||\
+            fgDrawCachedShape(&key))\
+            return;\
+        \
         if (!name##Cached)\
         {\
             fgh##nameICaps##Generate();\
@@ -1501,13 +1400,13 @@ void fghGenerateTorus(
         \
         if (useWireMode)\
         {\
-            fghDrawGeometryWire (name##_verts,name##_norms,nameCaps##_VERT_PER_OBJ, \
+            fghDrawGeometryWire (&key,name##_verts,name##_norms,nameCaps##_VERT_PER_OBJ, \
                                  NULL,nameCaps##_NUM_FACES,nameCaps##_NUM_EDGE_PER_FACE,GL_LINE_LOOP,\
                                  NULL,0,0);\
         }\
         else\
         {\
-            fghDrawGeometrySolid(name##_verts,name##_norms,NULL,nameCaps##_VERT_PER_OBJ,\
+            fghDrawGeometrySolid(&key,name##_verts,name##_norms,NULL,nameCaps##_VERT_PER_OBJ,\
                                  vertIdxs, 1, nameCaps##_VERT_PER_OBJ_TRI); \
         }\
     }
@@ -1517,6 +1416,13 @@ void fghGenerateTorus(
 static void fghCube( GLfloat dSize, GLboolean useWireMode )
 {
     GLfloat *vertices;
+    SFG_ShapeKey key;
+
+    fgInitShapeKey(&key, FG_SHAPE_CUBE, useWireMode, dSize, 0.f, 0, 0);
+    if (fgDrawProceduralPolyhedron(&key, dSize, cube_v, CUBE_NUM_VERT, cube_vi,
+                                   CUBE_NUM_FACES, CUBE_NUM_EDGE_PER_FACE, cube_n) ||
+        fgDrawCachedShape(&key))
+        return;
 
     if (!cubeCached)
     {
@@ -1545,11 +1451,11 @@ static void fghCube( GLfloat dSize, GLboolean useWireMode )
         vertices = cube_verts;
 
     if (useWireMode)
-        fghDrawGeometryWire(vertices, cube_norms, CUBE_VERT_PER_OBJ,
+        fghDrawGeometryWire(&key, vertices, cube_norms, CUBE_VERT_PER_OBJ,
                             NULL,CUBE_NUM_FACES, CUBE_NUM_EDGE_PER_FACE,GL_LINE_LOOP,
                             NULL,0,0);
     else
-        fghDrawGeometrySolid(vertices, cube_norms, NULL, CUBE_VERT_PER_OBJ,
+        fghDrawGeometrySolid(&key, vertices, cube_norms, NULL, CUBE_VERT_PER_OBJ,
                              cube_vertIdxs, 1, CUBE_VERT_PER_OBJ_TRI);
 
     if (dSize!=1.f)
@@ -1563,20 +1469,88 @@ DECLARE_INTERNAL_DRAW(octahedron,Octahedron,OCTAHEDRON)
 DECLARE_INTERNAL_DRAW_DECOMPOSED_TO_TRIANGLE(rhombicdodecahedron,RhombicDodecahedron,RHOMBICDODECAHEDRON)
 DECLARE_INTERNAL_DRAW(tetrahedron,Tetrahedron,TETRAHEDRON)
 
+/*
+ * Generates a sponge straight into the vertex buffer of a new cached
+ * shape, a chunk at a time, through glMapBufferRange where there is one.
+ * Returns GL_FALSE, generating nothing, if the buffer would be too large.
+ */
+static GLboolean fghSierpinskiSpongeToBuffer ( const SFG_ShapeKey *key, int numLevels, double offset[3], GLfloat scale, GLboolean useWireMode )
+{
+    const GLsizei numTetr     = ipow(4,numLevels);
+    const GLsizei vertPerTetr = useWireMode ? 2*TETRAHEDRON_VERT_PER_OBJ : TETRAHEDRON_VERT_PER_OBJ;
+    const size_t  tetrBytes   = vertPerTetr * 6 * sizeof(GLfloat);
+    GLfloat *chunk = NULL;
+    GLuint buffer;
+    GLsizei first, count;
+    SFG_Shape *shape;
+
+    /* Both the buffer size, a fghGLsizeiptr, and the vertex count must fit */
+    if ((size_t)numTetr > INT_MAX / tetrBytes || numTetr > INT_MAX / vertPerTetr)
+        return GL_FALSE;
+
+    fghGenBuffers(1, &buffer);
+    fghBindBuffer(FGH_ARRAY_BUFFER, buffer);
+    fghBufferData(FGH_ARRAY_BUFFER, (fghGLsizeiptr)((size_t)numTetr * tetrBytes), NULL, FGH_STATIC_DRAW);
+
+    for (first=0; first<numTetr; first+=count)
+    {
+        GLfloat *out = NULL;
+
+        count = numTetr-first < SIERPINSKI_SPONGE_CHUNK ? numTetr-first : SIERPINSKI_SPONGE_CHUNK;
+        if (fghMapBufferRange)
+            out = fghMapBufferRange(FGH_ARRAY_BUFFER, (fghGLintptr)((size_t)first * tetrBytes), (fghGLintptr)((size_t)count * tetrBytes),
+                                    FGH_MAP_WRITE_BIT | FGH_MAP_INVALIDATE_RANGE_BIT);
+        if (!out)
+        {
+            if (!chunk)
+                chunk = malloc(SIERPINSKI_SPONGE_CHUNK * tetrBytes);
+            if (!chunk)
+                fgError("Failed to allocate memory in fghSierpinskiSpongeToBuffer");
+            out = chunk;
+        }
+
+        fghSierpinskiSpongeGenerate(numLevels, offset, scale, first, count, useWireMode, out, out+3, 6);
+
+        if (out == chunk)
+            fghBufferSubData(FGH_ARRAY_BUFFER, (fghGLintptr)((size_t)first * tetrBytes), (fghGLintptr)((size_t)count * tetrBytes), chunk);
+        else
+            fghUnmapBuffer(FGH_ARRAY_BUFFER);
+    }
+    fghBindBuffer(FGH_ARRAY_BUFFER, 0);
+    free(chunk);
+
+    shape = fgCreateShapeFromBuffer(key, buffer, numTetr*vertPerTetr, useWireMode ? GL_LINES : GL_TRIANGLES, GL_FLOAT, GL_FALSE);
+    fgDrawShape(shape);
+    return GL_TRUE;
+}
+
 static void fghSierpinskiSponge ( int numLevels, double offset[3], GLfloat scale, GLboolean useWireMode )
 {
     GLfloat *vertices;
     GLfloat * normals;
     GLsizei    numTetr = numLevels<0? 0 : ipow(4,numLevels); /* No sponge for numLevels below 0 */
-    GLsizei    numVert = numTetr*TETRAHEDRON_VERT_PER_OBJ;
-    GLsizei    numFace = numTetr*TETRAHEDRON_NUM_FACES;
+    GLsizei    first, count;
+    SFG_ShapeKey key;
 
-    if (numTetr)
+    if (numLevels > SIERPINSKI_SPONGE_MAX_LEVELS)
     {
-        /* Allocate memory */
-        vertices = malloc(numVert*3 * sizeof(GLfloat));
-        normals  = malloc(numVert*3 * sizeof(GLfloat));
-        /* Bail out if memory allocation fails, fgError never returns */
+        fgWarning("Sierpinski sponge of %d levels is too large, at most %d are drawn", numLevels, SIERPINSKI_SPONGE_MAX_LEVELS);
+        return;
+    }
+    if (!numTetr)
+        return;
+
+    fgInitShapeKey(&key, FG_SHAPE_SIERPINSKI_SPONGE, useWireMode, (GLfloat)offset[0], (GLfloat)offset[1], numLevels, 0);
+    key.Params[2] = (GLfloat)offset[2];
+    key.Params[3] = scale;
+    if (fgDrawCachedShape(&key))
+        return;
+
+    if (fgBakingShapes())
+    {
+        /* Kept whole for glutBakeShapes, as the mapped file is drawn from in one go */
+        vertices = malloc((size_t)numTetr*TETRAHEDRON_VERT_ELEM_PER_OBJ * sizeof(GLfloat));
+        normals  = malloc((size_t)numTetr*TETRAHEDRON_VERT_ELEM_PER_OBJ * sizeof(GLfloat));
         if (!vertices || !normals)
         {
             free(vertices);
@@ -1584,20 +1558,49 @@ static void fghSierpinskiSponge ( int numLevels, double offset[3], GLfloat scale
             fgError("Failed to allocate memory in fghSierpinskiSponge");
         }
 
-        /* Generate elements */
-        fghSierpinskiSpongeGenerate ( numLevels, offset, scale, vertices, normals );
-
-        /* Draw and cleanup */
+        fghSierpinskiSpongeGenerate ( numLevels, offset, scale, 0, numTetr, GL_FALSE, vertices, normals, 3 );
         if (useWireMode)
-            fghDrawGeometryWire (vertices,normals,numVert,
-                                 NULL,numFace,TETRAHEDRON_NUM_EDGE_PER_FACE,GL_LINE_LOOP,
+            fghDrawGeometryWire (&key,vertices,normals,numTetr*TETRAHEDRON_VERT_PER_OBJ,
+                                 NULL,numTetr*TETRAHEDRON_NUM_FACES,TETRAHEDRON_NUM_EDGE_PER_FACE,GL_LINE_LOOP,
                                  NULL,0,0);
         else
-            fghDrawGeometrySolid(vertices,normals,NULL,numVert,NULL,1,0);
+            fghDrawGeometrySolid(&key,vertices,normals,NULL,numTetr*TETRAHEDRON_VERT_PER_OBJ,NULL,1,0);
 
         free(vertices);
         free(normals );
+        return;
     }
+
+    if (fghDrawToShapeBuffers() &&
+        fghSierpinskiSpongeToBuffer(&key, numLevels, offset, scale, useWireMode))
+        return;
+
+    /* Otherwise, or if too large for a buffer, drawn a chunk at a time from client memory */
+    vertices = malloc(SIERPINSKI_SPONGE_CHUNK*TETRAHEDRON_VERT_ELEM_PER_OBJ * sizeof(GLfloat));
+    normals  = malloc(SIERPINSKI_SPONGE_CHUNK*TETRAHEDRON_VERT_ELEM_PER_OBJ * sizeof(GLfloat));
+    /* Bail out if memory allocation fails, fgError never returns */
+    if (!vertices || !normals)
+    {
+        free(vertices);
+        free(normals);
+        fgError("Failed to allocate memory in fghSierpinskiSponge");
+    }
+
+    for (first=0; first<numTetr; first+=count)
+    {
+        count = numTetr-first < SIERPINSKI_SPONGE_CHUNK ? numTetr-first : SIERPINSKI_SPONGE_CHUNK;
+        fghSierpinskiSpongeGenerate ( numLevels, offset, scale, first, count, GL_FALSE, vertices, normals, 3 );
+
+        if (useWireMode)
+            fghDrawGeometryWire (NULL,vertices,normals,count*TETRAHEDRON_VERT_PER_OBJ,
+                                 NULL,count*TETRAHEDRON_NUM_FACES,TETRAHEDRON_NUM_EDGE_PER_FACE,GL_LINE_LOOP,
+                                 NULL,0,0);
+        else
+            fghDrawGeometrySolid(NULL,vertices,normals,NULL,count*TETRAHEDRON_VERT_PER_OBJ,NULL,1,0);
+    }
+
+    free(vertices);
+    free(normals );
 }
 
 
@@ -1605,6 +1608,11 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeKey key;
+
+    fgInitShapeKey(&key, FG_SHAPE_SPHERE, useWireMode, radius, 0.f, slices, stacks);
+    if (fgDrawProceduralShape(&key) || fgDrawCachedShape(&key))
+        return;
 
     /* Generate vertices and normals */
     fghGenerateSphere(radius,slices,stacks,&vertices,&normals,&nVert);
@@ -1615,14 +1623,14 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
 
     if (useWireMode)
     {
-        GLushort  *sliceIdx, *stackIdx;
+        GLuint  *sliceIdx, *stackIdx;
         /* First, generate vertex index arrays for drawing with glDrawElements
          * We have a bunch of line_loops to draw for each stack, and a
          * bunch for each slice.
          */
 
-        sliceIdx = malloc(slices*(stacks+1)*sizeof(GLushort));
-        stackIdx = malloc(slices*(stacks-1)*sizeof(GLushort));
+        sliceIdx = malloc(slices*(stacks+1)*sizeof(GLuint));
+        stackIdx = malloc(slices*(stacks-1)*sizeof(GLuint));
         if (!(stackIdx) || !(sliceIdx))
         {
             free(stackIdx);
@@ -1633,7 +1641,7 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
         /* generate for each stack */
         for (i=0,idx=0; i<stacks-1; i++)
         {
-            GLushort offset = 1+i*slices;           /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
+            GLuint offset = 1+i*slices;           /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
             for (j=0; j<slices; j++, idx++)
             {
                 stackIdx[idx] = offset+j;
@@ -1643,7 +1651,7 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
         /* generate for each slice */
         for (i=0,idx=0; i<slices; i++)
         {
-            GLushort offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
+            GLuint offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
             sliceIdx[idx++] = 0;                    /* vertex on top */
             for (j=0; j<stacks-1; j++, idx++)
             {
@@ -1653,7 +1661,7 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
         }
 
         /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        fghDrawGeometryWire(&key,vertices,normals,nVert,
             sliceIdx,slices,stacks+1,GL_LINE_STRIP,
             stackIdx,stacks-1,slices);
         
@@ -1667,12 +1675,12 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
          * All stacks, including top and bottom are covered with a triangle
          * strip.
          */
-        GLushort  *stripIdx;
+        GLuint  *stripIdx;
         /* Create index vector */
-        GLushort offset;
+        GLuint offset;
 
         /* Allocate buffers for indices, bail out if memory allocation fails */
-        stripIdx = malloc((slices+1)*2*(stacks)*sizeof(GLushort));
+        stripIdx = malloc((slices+1)*2*(stacks)*sizeof(GLuint));
         if (!(stripIdx))
         {
             free(stripIdx);
@@ -1715,7 +1723,7 @@ static void fghSphere( GLfloat radius, GLint slices, GLint stacks, GLboolean use
 
 
         /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks,(slices+1)*2);
+        fghDrawGeometrySolid(&key,vertices,normals,NULL,nVert,stripIdx,stacks,(slices+1)*2);
 
         /* cleanup allocated memory */
         free(stripIdx);
@@ -1730,6 +1738,11 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeKey key;
+
+    fgInitShapeKey(&key, FG_SHAPE_CONE, useWireMode, base, height, slices, stacks);
+    if (fgDrawProceduralShape(&key) || fgDrawCachedShape(&key))
+        return;
 
     /* Generate vertices and normals */
     /* Note, (stacks+1)*slices vertices for side of object, slices+1 for top and bottom closures */
@@ -1741,14 +1754,14 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
 
     if (useWireMode)
     {
-        GLushort  *sliceIdx, *stackIdx;
+        GLuint  *sliceIdx, *stackIdx;
         /* First, generate vertex index arrays for drawing with glDrawElements
          * We have a bunch of line_loops to draw for each stack, and a
          * bunch for each slice.
          */
 
-        stackIdx = malloc(slices*stacks*sizeof(GLushort));
-        sliceIdx = malloc(slices*2     *sizeof(GLushort));
+        stackIdx = malloc(slices*stacks*sizeof(GLuint));
+        sliceIdx = malloc(slices*2     *sizeof(GLuint));
         if (!(stackIdx) || !(sliceIdx))
         {
             free(stackIdx);
@@ -1759,7 +1772,7 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
         /* generate for each stack */
         for (i=0,idx=0; i<stacks; i++)
         {
-            GLushort offset = 1+(i+1)*slices;       /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
+            GLuint offset = 1+(i+1)*slices;       /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
             for (j=0; j<slices; j++, idx++)
             {
                 stackIdx[idx] = offset+j;
@@ -1769,13 +1782,13 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
         /* generate for each slice */
         for (i=0,idx=0; i<slices; i++)
         {
-            GLushort offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
+            GLuint offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
             sliceIdx[idx++] = offset+slices;
             sliceIdx[idx++] = offset+(stacks+1)*slices;
         }
 
         /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        fghDrawGeometryWire(&key,vertices,normals,nVert,
             sliceIdx,1,slices*2,GL_LINES,
             stackIdx,stacks,slices);
 
@@ -1789,12 +1802,12 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
          * All stacks, including top and bottom are covered with a triangle
          * strip.
          */
-        GLushort  *stripIdx;
+        GLuint  *stripIdx;
         /* Create index vector */
-        GLushort offset;
+        GLuint offset;
 
         /* Allocate buffers for indices, bail out if memory allocation fails */
-        stripIdx = malloc((slices+1)*2*(stacks+1)*sizeof(GLushort));    /*stacks +1 because of closing off bottom */
+        stripIdx = malloc((slices+1)*2*(stacks+1)*sizeof(GLuint));    /*stacks +1 because of closing off bottom */
         if (!(stripIdx))
         {
             free(stripIdx);
@@ -1826,7 +1839,7 @@ static void fghCone( GLfloat base, GLfloat height, GLint slices, GLint stacks, G
         }
 
         /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks+1,(slices+1)*2);
+        fghDrawGeometrySolid(&key,vertices,normals,NULL,nVert,stripIdx,stacks+1,(slices+1)*2);
 
         /* cleanup allocated memory */
         free(stripIdx);
@@ -1841,6 +1854,11 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeKey key;
+
+    fgInitShapeKey(&key, FG_SHAPE_CYLINDER, useWireMode, radius, height, slices, stacks);
+    if (fgDrawProceduralShape(&key) || fgDrawCachedShape(&key))
+        return;
 
     /* Generate vertices and normals */
     /* Note, (stacks+1)*slices vertices for side of object, 2*slices+2 for top and bottom closures */
@@ -1852,14 +1870,14 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
 
     if (useWireMode)
     {
-        GLushort  *sliceIdx, *stackIdx;
+        GLuint  *sliceIdx, *stackIdx;
         /* First, generate vertex index arrays for drawing with glDrawElements
          * We have a bunch of line_loops to draw for each stack, and a
          * bunch for each slice.
          */
 
-        stackIdx = malloc(slices*(stacks+1)*sizeof(GLushort));
-        sliceIdx = malloc(slices*2         *sizeof(GLushort));
+        stackIdx = malloc(slices*(stacks+1)*sizeof(GLuint));
+        sliceIdx = malloc(slices*2         *sizeof(GLuint));
         if (!(stackIdx) || !(sliceIdx))
         {
             free(stackIdx);
@@ -1870,7 +1888,7 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
         /* generate for each stack */
         for (i=0,idx=0; i<stacks+1; i++)
         {
-            GLushort offset = 1+(i+1)*slices;       /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
+            GLuint offset = 1+(i+1)*slices;       /* start at 1 (0 is top vertex), and we advance one stack down as we go along */
             for (j=0; j<slices; j++, idx++)
             {
                 stackIdx[idx] = offset+j;
@@ -1880,13 +1898,13 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
         /* generate for each slice */
         for (i=0,idx=0; i<slices; i++)
         {
-            GLushort offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
+            GLuint offset = 1+i;                  /* start at 1 (0 is top vertex), and we advance one slice as we go along */
             sliceIdx[idx++] = offset+slices;
             sliceIdx[idx++] = offset+(stacks+1)*slices;
         }
 
         /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        fghDrawGeometryWire(&key,vertices,normals,nVert,
             sliceIdx,1,slices*2,GL_LINES,
             stackIdx,stacks+1,slices);
 
@@ -1900,12 +1918,12 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
          * All stacks, including top and bottom are covered with a triangle
          * strip.
          */
-        GLushort  *stripIdx;
+        GLuint  *stripIdx;
         /* Create index vector */
-        GLushort offset;
+        GLuint offset;
 
         /* Allocate buffers for indices, bail out if memory allocation fails */
-        stripIdx = malloc((slices+1)*2*(stacks+2)*sizeof(GLushort));    /*stacks +2 because of closing off bottom and top */
+        stripIdx = malloc((slices+1)*2*(stacks+2)*sizeof(GLuint));    /*stacks +2 because of closing off bottom and top */
         if (!(stripIdx))
         {
             free(stripIdx);
@@ -1947,7 +1965,7 @@ static void fghCylinder( GLfloat radius, GLfloat height, GLint slices, GLint sta
         stripIdx[idx+1] = nVert-1;                  /* repeat first slice's idx for closing off shape */
 
         /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,stacks+2,(slices+1)*2);
+        fghDrawGeometrySolid(&key,vertices,normals,NULL,nVert,stripIdx,stacks+2,(slices+1)*2);
 
         /* cleanup allocated memory */
         free(stripIdx);
@@ -1962,6 +1980,11 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
 {
     int i,j,idx, nVert;
     GLfloat *vertices, *normals;
+    SFG_ShapeKey key;
+
+    fgInitShapeKey(&key, FG_SHAPE_TORUS, useWireMode, dInnerRadius, dOuterRadius, nSides, nRings);
+    if (fgDrawProceduralShape(&key) || fgDrawCachedShape(&key))
+        return;
 
     /* Generate vertices and normals */
     fghGenerateTorus(dInnerRadius,dOuterRadius,nSides,nRings, &vertices,&normals,&nVert);
@@ -1972,14 +1995,14 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
 
     if (useWireMode)
     {
-        GLushort  *sideIdx, *ringIdx;
+        GLuint  *sideIdx, *ringIdx;
         /* First, generate vertex index arrays for drawing with glDrawElements
          * We have a bunch of line_loops to draw each side, and a
          * bunch for each ring.
          */
 
-        ringIdx = malloc(nRings*nSides*sizeof(GLushort));
-        sideIdx = malloc(nSides*nRings*sizeof(GLushort));
+        ringIdx = malloc(nRings*nSides*sizeof(GLuint));
+        sideIdx = malloc(nSides*nRings*sizeof(GLuint));
         if (!(ringIdx) || !(sideIdx))
         {
             free(ringIdx);
@@ -1998,7 +2021,7 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
                 sideIdx[idx] = j * nSides + i;
 
         /* draw */
-        fghDrawGeometryWire(vertices,normals,nVert,
+        fghDrawGeometryWire(&key,vertices,normals,nVert,
             ringIdx,nRings,nSides,GL_LINE_LOOP,
             sideIdx,nSides,nRings);
         
@@ -2012,10 +2035,10 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
          * All stacks, including top and bottom are covered with a triangle
          * strip.
          */
-        GLushort  *stripIdx;
+        GLuint  *stripIdx;
 
         /* Allocate buffers for indices, bail out if memory allocation fails */
-        stripIdx = malloc((nRings+1)*2*nSides*sizeof(GLushort));
+        stripIdx = malloc((nRings+1)*2*nSides*sizeof(GLuint));
         if (!(stripIdx))
         {
             free(stripIdx);
@@ -2041,7 +2064,7 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
         }
 
         /* draw */
-        fghDrawGeometrySolid(vertices,normals,NULL,nVert,stripIdx,nSides,(nRings+1)*2);
+        fghDrawGeometrySolid(&key,vertices,normals,NULL,nVert,stripIdx,nSides,(nRings+1)*2);
 
         /* cleanup allocated memory */
         free(stripIdx);
@@ -2052,6 +2075,96 @@ static void fghTorus( GLfloat dInnerRadius, GLfloat dOuterRadius, GLint nSides,
     free(normals);
 }
 
+/* -- Level of detail -- */
+/* Slices the *LOD functions choose from, so that whatever the distance
+ * only a handful of tessellations of a shape end up in the shape cache
+ */
+static const GLint fghLODSlices[] = { 6, 8, 12, 16, 24, 32, 48, 64, 96, 128 };
+#define FGH_NUM_LOD_SLICES  ( sizeof( fghLODSlices ) / sizeof( fghLODSlices[0] ) )
+
+/*
+ * Pixels per object space unit around the origin of a shape, for the
+ * current window and a row major modelview-projection matrix (as
+ * sim::mat4f::coefficients() gives). Taken at the point of the bounding
+ * sphere nearest to the eye, so the estimate errs on the side of detail.
+ * Returns 0 when that sphere reaches behind the eye.
+ */
+static GLfloat fghPixelsPerUnit(const GLfloat *mvp, GLfloat boundingRadius)
+{
+    SFG_Window *window = fgStructure.CurrentWindow;
+    GLfloat halfWidth  = window->State.Width  * 0.5f;
+    GLfloat halfHeight = window->State.Height * 0.5f;
+    GLfloat w = mvp[15] - boundingRadius*(GLfloat)sqrt(mvp[12]*mvp[12] + mvp[13]*mvp[13] + mvp[14]*mvp[14]);
+    GLfloat scale = 0.f;
+    int i;
+
+    if (w <= 0.f)
+        return 0.f;
+
+    /* Largest screen stretch of the three object axes */
+    for (i=0; i<3; i++)
+    {
+        GLfloat x = mvp[i]  *halfWidth;
+        GLfloat y = mvp[4+i]*halfHeight;
+        if (x*x + y*y > scale)
+            scale = x*x + y*y;
+    }
+    return (GLfloat)sqrt(scale) / w;
+}
+
+/*
+ * Fewest slices for a circle of the given radius in pixels to stay within
+ * pixelError of the true one: a chord of n slices falls short of it by
+ * radius*(1-cos(PI/n))
+ */
+static GLint fghLODSlicesFor(GLfloat pixelRadius, GLfloat pixelError)
+{
+    unsigned int i;
+
+    if (pixelRadius <= 0.f)
+        return fghLODSlices[FGH_NUM_LOD_SLICES-1];
+
+    for (i=0; i<FGH_NUM_LOD_SLICES-1; i++)
+        if (pixelRadius*(1.f-(GLfloat)cos(M_PI/fghLODSlices[i])) <= pixelError)
+            break;
+    return fghLODSlices[i];
+}
+
+static void fghSphereLOD(GLfloat radius, const GLfloat *mvp, GLfloat pixelError, GLboolean useWireMode)
+{
+    GLint slices = fghLODSlicesFor(radius*fghPixelsPerUnit(mvp,radius), pixelError);
+
+    fghSphere(radius, slices, slices/2, useWireMode);
+}
+
+/* The sides of cones and cylinders are straight, with the same normal all
+ * along: a single stack shows as much as any number would */
+static void fghConeLOD(GLfloat base, GLfloat height, const GLfloat *mvp, GLfloat pixelError, GLboolean useWireMode)
+{
+    GLfloat pixelsPerUnit = fghPixelsPerUnit(mvp, (GLfloat)sqrt(base*base + height*height));
+
+    fghCone(base, height, fghLODSlicesFor(base*pixelsPerUnit, pixelError), 1, useWireMode);
+}
+
+static void fghCylinderLOD(GLfloat radius, GLfloat height, const GLfloat *mvp, GLfloat pixelError, GLboolean useWireMode)
+{
+    GLfloat pixelsPerUnit = fghPixelsPerUnit(mvp, (GLfloat)sqrt(radius*radius + height*height));
+
+    fghCylinder(radius, height, fghLODSlicesFor(radius*pixelsPerUnit, pixelError), 1, useWireMode);
+}
+
+/* Sides go around the tube, of the inner radius, rings around the axis,
+ * out to the outer radius plus the inner one */
+static void fghTorusLOD(GLfloat dInnerRadius, GLfloat dOuterRadius, const GLfloat *mvp, GLfloat pixelError, GLboolean useWireMode)
+{
+    GLfloat pixelsPerUnit = fghPixelsPerUnit(mvp, dInnerRadius+dOuterRadius);
+
+    fghTorus(dInnerRadius, dOuterRadius,
+             fghLODSlicesFor(dInnerRadius*pixelsPerUnit, pixelError),
+             fghLODSlicesFor((dInnerRadius+dOuterRadius)*pixelsPerUnit, pixelError),
+             useWireMode);
+}
+
 
 /* -- INTERFACE FUNCTIONS ---------------------------------------------- */
 
@@ -2130,6 +2243,59 @@ void FGAPIENTRY glutSolidTorus( double dInnerRadius, double dOuterRadius, GLint
     fghTorus((GLfloat)dInnerRadius, (GLfloat)dOuterRadius, nSides, nRings, GL_FALSE);
 }
 
+/*
+ * Sphere, cone, cylinder and torus with their slices and stacks chosen
+ * for their projection, given a row major modelview-projection matrix, to
+ * be off by at most pixelError pixels in the current window
+ */
+void FGAPIENTRY glutSolidSphereLOD(double radius, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidSphereLOD" );
+    fghSphereLOD((GLfloat)radius, modelviewProjection, (GLfloat)pixelError, GL_FALSE);
+}
+
+void FGAPIENTRY glutWireSphereLOD(double radius, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireSphereLOD" );
+    fghSphereLOD((GLfloat)radius, modelviewProjection, (GLfloat)pixelError, GL_TRUE);
+}
+
+void FGAPIENTRY glutSolidConeLOD(double base, double height, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidConeLOD" );
+    fghConeLOD((GLfloat)base, (GLfloat)height, modelviewProjection, (GLfloat)pixelError, GL_FALSE);
+}
+
+void FGAPIENTRY glutWireConeLOD(double base, double height, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireConeLOD" );
+    fghConeLOD((GLfloat)base, (GLfloat)height, modelviewProjection, (GLfloat)pixelError, GL_TRUE);
+}
+
+void FGAPIENTRY glutSolidCylinderLOD(double radius, double height, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidCylinderLOD" );
+    fghCylinderLOD((GLfloat)radius, (GLfloat)height, modelviewProjection, (GLfloat)pixelError, GL_FALSE);
+}
+
+void FGAPIENTRY glutWireCylinderLOD(double radius, double height, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireCylinderLOD" );
+    fghCylinderLOD((GLfloat)radius, (GLfloat)height, modelviewProjection, (GLfloat)pixelError, GL_TRUE);
+}
+
+void FGAPIENTRY glutSolidTorusLOD(double dInnerRadius, double dOuterRadius, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidTorusLOD" );
+    fghTorusLOD((GLfloat)dInnerRadius, (GLfloat)dOuterRadius, modelviewProjection, (GLfloat)pixelError, GL_FALSE);
+}
+
+void FGAPIENTRY glutWireTorusLOD(double dInnerRadius, double dOuterRadius, const GLfloat *modelviewProjection, double pixelError)
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireTorusLOD" );
+    fghTorusLOD((GLfloat)dInnerRadius, (GLfloat)dOuterRadius, modelviewProjection, (GLfloat)pixelError, GL_TRUE);
+}
+
 
 
 /* -- INTERFACE FUNCTIONS -------------------------------------------------- */
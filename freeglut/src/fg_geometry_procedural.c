@@ -0,0 +1,372 @@
+/*
+ * fg_geometry_procedural.c
+ *
+ * Shapes generated in the vertex shader, without vertex or index buffers.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * The sphere, cone, cylinder, torus and the polyhedra can be generated
+ * entirely in the vertex shader, from gl_VertexID and a small uniform
+ * array, so drawing one uploads a few vec4s and issues a glDrawArrays
+ * with no buffer bound at all.
+ *
+ * freeglut draws with the application's program, so the application
+ * pastes the GLSL of glutGetShapeShaderSource into its vertex shader
+ * (GLSL 1.30 or GLSL ES 3.00 and later) and hands the location of its
+ * fg_shape uniform to glutSetShapeUniform. The shader then calls
+ *
+ *     if (!fgShapeVertex(position, normal))
+ *         ... use the vertex attributes, as for the teapot ...
+ *
+ * fg_shape[0] is left zero between shapes, for which fgShapeVertex
+ * returns false. gl_InstanceID counts the GLUT_GEOMETRY_INSTANCES drawn.
+ *
+ * The vertices are those of fg_geometry.c, in the same order: a solid
+ * round shape is the triangles of its triangle strips, a wire one the
+ * segments of its lines and loops, and a polyhedron its faces, split as
+ * fghGenerateGeometryWithIndexArray does, with their flat normals.
+ *
+ *   fg_shape[0]    shape, 1 for wire, then slices and stacks (sphere, cone,
+ *                  cylinder) or rings and sides (torus)
+ *   fg_shape[1]    the sizes passed to glutSolid*, or for a polyhedron
+ *                  its scale, number of faces and edges per face
+ *   fg_shape[2..]  for a polyhedron, its face normals, then its vertex
+ *                  indices four to a vec4, then its vertices
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+/* Two header entries, and the largest polyhedron table (the dodecahedron
+   and icosahedron's, 47) */
+#define FGH_SHAPE_UNIFORM_SIZE  49
+#define FGH_STRINGIFY(x)        #x
+#define FGH_TOSTRING(x)         FGH_STRINGIFY(x)
+
+static const char* fghShapeShaderSource =
+    "uniform vec4 fg_shape[" FGH_TOSTRING( FGH_SHAPE_UNIFORM_SIZE ) "];\n"
+    "\n"
+    "const float fg_shape_pi = 3.14159265358979;\n"
+    "\n"
+    /* A point of a round shape, its rows going along the axis (around the
+       tube of the torus) and its columns around it */
+    "vec3 fgShapeGridVertex(int kind, int row, int column, out vec3 normal)\n"
+    "{\n"
+    "    float columns = fg_shape[0].z, stacks = fg_shape[0].w;\n"
+    "    vec2 size = fg_shape[1].xy;\n"
+    "    float slice = -2.0 * fg_shape_pi * float(column) / columns;\n"
+    "    vec2 c = vec2(cos(slice), sin(slice));\n"
+    "    if (kind == 7) {\n"
+    "        float theta = fg_shape_pi * float(row) / stacks;\n"
+    "        normal = vec3(c * sin(theta), cos(theta));\n"
+    "        return normal * size.x;\n"
+    "    }\n"
+    "    if (kind == 8) {\n"
+    "        float t = float(row - 2) / stacks;\n"
+    "        if (row < 2) {\n"
+    "            normal = vec3(0.0, 0.0, -1.0);\n"
+    "            return vec3(float(row) * size.x * c, 0.0);\n"
+    "        }\n"
+    "        normal = vec3(size.y * c, size.x) / length(size);\n"
+    "        return vec3((1.0 - t) * size.x * c, t * size.y);\n"
+    "    }\n"
+    "    if (kind == 9) {\n"
+    "        int top = int(stacks) + 2;\n"
+    "        if (row < 2) {\n"
+    "            normal = vec3(0.0, 0.0, -1.0);\n"
+    "            return vec3(float(row) * size.x * c, 0.0);\n"
+    "        }\n"
+    "        if (row > top) {\n"
+    "            normal = vec3(0.0, 0.0, 1.0);\n"
+    "            return vec3(float(top + 2 - row) * size.x * c, size.y);\n"
+    "        }\n"
+    "        normal = vec3(c, 0.0);\n"
+    "        return vec3(size.x * c, float(row - 2) * size.y / stacks);\n"
+    "    }\n"
+    "    float ring = 2.0 * fg_shape_pi * float(column) / columns;\n"
+    "    float side = -2.0 * fg_shape_pi * float(row) / stacks;\n"
+    "    vec2 r = vec2(cos(ring), sin(ring));\n"
+    "    normal = vec3(cos(side) * r, sin(side));\n"
+    "    return vec3((size.y + cos(side) * size.x) * r, sin(side) * size.x);\n"
+    "}\n"
+    "\n"
+    /* The rows of the two sides of a triangle strip */
+    "ivec2 fgShapeStripRows(int kind, int strip, int stacks)\n"
+    "{\n"
+    "    if (kind == 7)\n"
+    "        return ivec2(strip + 1, strip);\n"
+    "    if (kind == 10)\n"
+    "        return ivec2(strip, (strip + 1) % stacks);\n"
+    "    if (strip == 0)\n"
+    "        return ivec2(0, 1);\n"
+    "    if (strip > stacks)\n"
+    "        return ivec2(stacks + 3, stacks + 4);\n"
+    "    return ivec2(strip + 1, strip + 2);\n"
+    "}\n"
+    "\n"
+    "void fgShapePolyhedronVertex(int id, bool wire, out vec3 position, out vec3 normal)\n"
+    "{\n"
+    "    const int quad[6] = int[6](0, 1, 2, 0, 2, 3);\n"
+    "    const int pentagon[9] = int[9](0, 1, 2, 0, 2, 4, 4, 2, 3);\n"
+    "    int faces = int(fg_shape[1].y), edges = int(fg_shape[1].z);\n"
+    "    int face, corner;\n"
+    "    if (wire) {\n"
+    "        face = id / 2 / edges;\n"
+    "        corner = (id / 2 % edges + id % 2) % edges;\n"
+    "    } else {\n"
+    "        int k = id % (3 * edges - 6);\n"
+    "        face = id / (3 * edges - 6);\n"
+    "        corner = edges == 3 ? k : edges == 4 ? quad[k] : pentagon[k];\n"
+    "    }\n"
+    "    int i = face * edges + corner;\n"
+    "    int index = int(fg_shape[2 + faces + i / 4][i % 4]);\n"
+    "    normal = fg_shape[2 + face].xyz;\n"
+    "    position = fg_shape[2 + faces + (faces * edges + 3) / 4 + index].xyz * fg_shape[1].x;\n"
+    "}\n"
+    "\n"
+    "bool fgShapeVertex(out vec3 position, out vec3 normal)\n"
+    "{\n"
+    "    int kind = int(fg_shape[0].x);\n"
+    "    int id = gl_VertexID;\n"
+    "    bool wire = fg_shape[0].y != 0.0;\n"
+    "    int columns = int(fg_shape[0].z), stacks = int(fg_shape[0].w);\n"
+    "    int row, column;\n"
+    "    position = vec3(0.0);\n"
+    "    normal = vec3(0.0, 0.0, 1.0);\n"
+    "    if (kind == 0)\n"
+    "        return false;\n"
+    "    if (kind < 7) {\n"
+    "        fgShapePolyhedronVertex(id, wire, position, normal);\n"
+    "        return true;\n"
+    "    }\n"
+    "    if (!wire) {\n"
+    /*       Two triangles per column of each strip */
+    "        int corner = id % 6;\n"
+    "        ivec2 rows = fgShapeStripRows(kind, id / 6 / columns, stacks);\n"
+    "        column = id / 6 % columns;\n"
+    "        if (corner == 2 || corner == 3 || corner == 5)\n"
+    "            column = (column + 1) % columns;\n"
+    "        row = corner == 1 || corner == 4 || corner == 5 ? rows.y : rows.x;\n"
+    "    } else {\n"
+    /*       The segments along each column, then those around each row */
+    "        int segment = id / 2, end = id % 2;\n"
+    "        int along = kind == 8 || kind == 9 ? 1 : stacks;\n"
+    "        if (segment < columns * along) {\n"
+    "            column = segment / along;\n"
+    "            if (along == 1)\n"
+    "                row = end == 0 ? 2 : stacks + 2;\n"
+    "            else\n"
+    "                row = (segment % along + end) % (kind == 7 ? stacks + 1 : stacks);\n"
+    "        } else {\n"
+    "            segment -= columns * along;\n"
+    "            row = segment / columns + (kind == 7 ? 1 : kind == 10 ? 0 : 2);\n"
+    "            column = (segment % columns + end) % columns;\n"
+    "        }\n"
+    "    }\n"
+    "    position = fgShapeGridVertex(kind, row, column, normal);\n"
+    "    return true;\n"
+    "}\n";
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * Whether the current window's shapes can be drawn from fg_shape
+ */
+static GLboolean fghProceduralShapes( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+
+    return !fgBakingShapes( ) && window && window->Window.uniform_shape != -1 && fgState.HasOpenGL20 &&
+           fghGenVertexArrays && !window->State.VisualizeNormals;
+}
+
+/*
+ * Sets fg_shape up and draws its vertices, with an empty vertex array
+ * object for the core profiles that want one bound
+ */
+static void fghDrawProcedural( const GLfloat* shape, GLsizei numEntries, GLenum mode, GLsizei numVertices )
+{
+    SFG_Context* context = &fgStructure.CurrentWindow->Window;
+    GLint vertexArray;
+
+    if( !context->ShapeVertexArray )
+        fghGenVertexArrays( 1, &context->ShapeVertexArray );
+
+    fgGLStateBegin( );
+    fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &vertexArray );
+    fghBindVertexArray( context->ShapeVertexArray );
+    fghUniform4fv( context->uniform_shape, numEntries, shape );
+
+    if( fgState.ShapeInstances > 1 && fghDrawArraysInstanced )
+        fghDrawArraysInstanced( mode, 0, numVertices, fgState.ShapeInstances );
+    else
+        glDrawArrays( mode, 0, numVertices );
+
+    /* Back to the vertex attributes, for the shapes that use them */
+    fghUniform4f( context->uniform_shape, 0.f, 0.f, 0.f, 0.f );
+    fghBindVertexArray( vertexArray );
+    fgGLStateEnd( );
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Draws a sphere, cone, cylinder or torus from fg_shape, if the current
+ * window has it set up. Returns GL_FALSE for the caller to draw it from
+ * buffers instead.
+ */
+GLboolean fgDrawProceduralShape( const SFG_ShapeKey* key )
+{
+    GLfloat shape[ 8 ];
+    GLint columns = key->Divisions[ 0 ], stacks = key->Divisions[ 1 ];
+    GLsizei strips, along, loops;
+
+    if( !fghProceduralShapes( ) )
+        return GL_FALSE;
+
+    switch( key->Shape )
+    {
+    case FG_SHAPE_SPHERE:
+        if( columns < 1 || stacks < 2 )
+            return GL_FALSE;
+        strips = stacks;
+        along = stacks;
+        loops = stacks - 1;
+        break;
+    case FG_SHAPE_CONE:
+        if( columns < 1 || stacks < 1 )
+            return GL_FALSE;
+        strips = stacks + 1;
+        along = 1;
+        loops = stacks;
+        break;
+    case FG_SHAPE_CYLINDER:
+        if( columns < 1 || stacks < 1 )
+            return GL_FALSE;
+        strips = stacks + 2;
+        along = 1;
+        loops = stacks + 1;
+        break;
+    case FG_SHAPE_TORUS:
+        /* Sides go along the rows, rings around them */
+        columns = key->Divisions[ 1 ];
+        stacks = key->Divisions[ 0 ];
+        if( columns < 2 || stacks < 2 )
+            return GL_FALSE;
+        strips = stacks;
+        along = stacks;
+        loops = stacks;
+        break;
+    default:
+        return GL_FALSE;
+    }
+
+    shape[ 0 ] = ( GLfloat )key->Shape;
+    shape[ 1 ] = key->Wire ? 1.f : 0.f;
+    shape[ 2 ] = ( GLfloat )columns;
+    shape[ 3 ] = ( GLfloat )stacks;
+    shape[ 4 ] = key->Params[ 0 ];
+    shape[ 5 ] = key->Params[ 1 ];
+    shape[ 6 ] = 0.f;
+    shape[ 7 ] = 0.f;
+
+    if( key->Wire )
+        fghDrawProcedural( shape, 2, GL_LINES, 2 * columns * ( along + loops ) );
+    else
+        fghDrawProcedural( shape, 2, GL_TRIANGLES, 6 * columns * strips );
+    return GL_TRUE;
+}
+
+/*
+ * Draws a polyhedron from fg_shape, given its tables of fg_geometry.c
+ */
+GLboolean fgDrawProceduralPolyhedron( const SFG_ShapeKey* key, GLfloat scale,
+                                      const GLfloat* vertices, GLsizei numVertices,
+                                      const GLubyte* vertIndices, GLsizei numFaces, GLsizei numEdgePerFace,
+                                      const GLfloat* normals )
+{
+    GLfloat shape[ FGH_SHAPE_UNIFORM_SIZE * 4 ];
+    GLsizei numIndices = numFaces * numEdgePerFace;
+    GLsizei numEntries = 2 + numFaces + ( numIndices + 3 ) / 4 + numVertices;
+    GLfloat* entry;
+    int i;
+
+    if( !fghProceduralShapes( ) || numEntries > FGH_SHAPE_UNIFORM_SIZE )
+        return GL_FALSE;
+
+    memset( shape, 0, sizeof( shape ) );
+    shape[ 0 ] = ( GLfloat )key->Shape;
+    shape[ 1 ] = key->Wire ? 1.f : 0.f;
+    shape[ 4 ] = scale;
+    shape[ 5 ] = ( GLfloat )numFaces;
+    shape[ 6 ] = ( GLfloat )numEdgePerFace;
+
+    entry = shape + 2 * 4;
+    for( i = 0; i < numFaces; i++, entry += 4 )
+    {
+        entry[ 0 ] = normals[ i * 3 ];
+        entry[ 1 ] = normals[ i * 3 + 1 ];
+        entry[ 2 ] = normals[ i * 3 + 2 ];
+    }
+    for( i = 0; i < numIndices; i++ )
+        entry[ i ] = vertIndices[ i ];
+    entry += ( numIndices + 3 ) / 4 * 4;
+    for( i = 0; i < numVertices; i++, entry += 4 )
+    {
+        entry[ 0 ] = vertices[ i * 3 ];
+        entry[ 1 ] = vertices[ i * 3 + 1 ];
+        entry[ 2 ] = vertices[ i * 3 + 2 ];
+    }
+
+    if( key->Wire )
+        fghDrawProcedural( shape, numEntries, GL_LINES, 2 * numIndices );
+    else
+        fghDrawProcedural( shape, numEntries, GL_TRIANGLES, 3 * numFaces * ( numEdgePerFace - 2 ) );
+    return GL_TRUE;
+}
+
+/*
+ * Deletes the empty vertex array object of a window, its context being current
+ */
+void fgDestroyProceduralShapes( SFG_Window* window )
+{
+    if( window->Window.ShapeVertexArray )
+        fghDeleteVertexArrays( 1, &window->Window.ShapeVertexArray );
+    window->Window.ShapeVertexArray = 0;
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * GLSL for an application's vertex shader to generate freeglut's shapes
+ * with, see above
+ */
+const char* FGAPIENTRY glutGetShapeShaderSource( void )
+{
+    return fghShapeShaderSource;
+}
+
+/*** END OF FILE ***/
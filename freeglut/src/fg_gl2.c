@@ -1,7 +1,7 @@
 /*
  * fg_gl2.c
  *
- * Load OpenGL (ES) 2.0 functions used by fg_geometry
+ * Load OpenGL (ES) 2.0 functions used by fg_geometry and fg_font_atlas
  *
  * Copyright (C) 2012  Sylvain Beucler
  *
@@ -27,6 +27,64 @@
 #include "fg_internal.h"
 #include "fg_gl2.h"
 
+#ifndef GL_ES_VERSION_2_0
+FGH_PFNGLGENBUFFERSPROC fghGenBuffers;
+FGH_PFNGLDELETEBUFFERSPROC fghDirectDeleteBuffers;
+FGH_PFNGLBINDBUFFERPROC fghDirectBindBuffer;
+FGH_PFNGLBUFFERDATAPROC fghBufferData;
+FGH_PFNGLBUFFERSUBDATAPROC fghBufferSubData;
+FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC fghDirectEnableVertexAttribArray;
+FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC fghDirectDisableVertexAttribArray;
+FGH_PFNGLVERTEXATTRIBPOINTERPROC fghVertexAttribPointer;
+FGH_PFNGLCREATESHADERPROC fghCreateShader;
+FGH_PFNGLSHADERSOURCEPROC fghShaderSource;
+FGH_PFNGLCOMPILESHADERPROC fghCompileShader;
+FGH_PFNGLGETSHADERIVPROC fghGetShaderiv;
+FGH_PFNGLGETSHADERINFOLOGPROC fghGetShaderInfoLog;
+FGH_PFNGLDELETESHADERPROC fghDeleteShader;
+FGH_PFNGLCREATEPROGRAMPROC fghCreateProgram;
+FGH_PFNGLATTACHSHADERPROC fghAttachShader;
+FGH_PFNGLBINDATTRIBLOCATIONPROC fghBindAttribLocation;
+FGH_PFNGLLINKPROGRAMPROC fghLinkProgram;
+FGH_PFNGLGETPROGRAMIVPROC fghGetProgramiv;
+FGH_PFNGLGETPROGRAMINFOLOGPROC fghGetProgramInfoLog;
+FGH_PFNGLDELETEPROGRAMPROC fghDeleteProgram;
+FGH_PFNGLUSEPROGRAMPROC fghDirectUseProgram;
+FGH_PFNGLGETUNIFORMLOCATIONPROC fghGetUniformLocation;
+FGH_PFNGLUNIFORM1IPROC fghUniform1i;
+FGH_PFNGLUNIFORM4FPROC fghUniform4f;
+FGH_PFNGLUNIFORM4FVPROC fghUniform4fv;
+FGH_PFNGLACTIVETEXTUREPROC fghActiveTexture;
+FGH_PFNGLVERTEXATTRIB2FPROC fghVertexAttrib2f;
+#endif
+
+FGH_PFNGLMULTIDRAWELEMENTSPROC fghMultiDrawElements;
+FGH_PFNGLGENVERTEXARRAYSPROC fghGenVertexArrays;
+FGH_PFNGLBINDVERTEXARRAYPROC fghDirectBindVertexArray;
+FGH_PFNGLDELETEVERTEXARRAYSPROC fghDirectDeleteVertexArrays;
+FGH_PFNGLGENFRAMEBUFFERSPROC fghGenFramebuffers;
+FGH_PFNGLBINDFRAMEBUFFERPROC fghBindFramebuffer;
+FGH_PFNGLDELETEFRAMEBUFFERSPROC fghDeleteFramebuffers;
+FGH_PFNGLFRAMEBUFFERTEXTURE2DPROC fghFramebufferTexture2D;
+FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC fghCheckFramebufferStatus;
+FGH_PFNGLMAPBUFFERRANGEPROC fghMapBufferRange;
+FGH_PFNGLUNMAPBUFFERPROC fghUnmapBuffer;
+FGH_PFNGLPRIMITIVERESTARTINDEXPROC fghPrimitiveRestartIndex;
+FGH_PFNGLDRAWARRAYSINSTANCEDPROC fghDrawArraysInstanced;
+FGH_PFNGLFENCESYNCPROC fghFenceSync;
+FGH_PFNGLCLIENTWAITSYNCPROC fghClientWaitSync;
+FGH_PFNGLDELETESYNCPROC fghDeleteSync;
+FGH_PFNGLVERTEXATTRIBDIVISORPROC fghVertexAttribDivisor;
+FGH_PFNGLTRANSFORMFEEDBACKVARYINGSPROC fghTransformFeedbackVaryings;
+FGH_PFNGLBINDBUFFERBASEPROC fghBindBufferBase;
+FGH_PFNGLGETINTEGERI_VPROC fghGetIntegeri_v;
+FGH_PFNGLBEGINTRANSFORMFEEDBACKPROC fghBeginTransformFeedback;
+FGH_PFNGLENDTRANSFORMFEEDBACKPROC fghEndTransformFeedback;
+FGH_PFNGLMULTIDRAWARRAYSINDIRECTPROC fghMultiDrawArraysIndirect;
+FGH_PFNGLBUFFERSTORAGEPROC fghBufferStorage;
+GLboolean fghHasIndexUint;
+GLboolean fghHasFixedIndexRestart;
+
 void FGAPIENTRY glutSetVertexAttribCoord3(GLint attrib) {
   if (fgStructure.CurrentWindow != NULL)
     fgStructure.CurrentWindow->Window.attribute_v_coord = attrib;
@@ -42,7 +100,115 @@ void FGAPIENTRY glutSetVertexAttribTexCoord2(GLint attrib) {
         fgStructure.CurrentWindow->Window.attribute_v_texture = attrib;
 }
 
+void FGAPIENTRY glutSetVertexAttribGlyphOffset2(GLint attrib) {
+    if (fgStructure.CurrentWindow != NULL)
+        fgStructure.CurrentWindow->Window.attribute_v_glyph_offset = attrib;
+}
+
+void FGAPIENTRY glutSetShapeUniform(GLint location) {
+    if (fgStructure.CurrentWindow != NULL)
+        fgStructure.CurrentWindow->Window.uniform_shape = location;
+}
+
+/*
+ * Version of the current context as major*10+minor, from GL_VERSION which
+ * reads e.g. "4.5 (Core Profile) Mesa 22.3.6" or "OpenGL ES 3.2 ..."
+ */
+static int fghContextVersion() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+
+    if (version == NULL)
+        return 0;
+    while (*version && (*version < '0' || *version > '9'))
+        version++;
+    if (sscanf(version, "%d.%d", &major, &minor) != 2)
+        return 0;
+    return major * 10 + minor;
+}
+
+static void fghInitOptionalGL() {
+#ifdef GL_ES_VERSION_2_0
+#define VERSION(gl, es) (fgState.GLVersion >= (es))
+#else
+#define VERSION(gl, es) (fgState.GLVersion >= (gl))
+#endif
+    fghMultiDrawElements = NULL;
+    fghGenVertexArrays = NULL;
+    fghDirectBindVertexArray = NULL;
+    fghDirectDeleteVertexArrays = NULL;
+    fghGenFramebuffers = NULL;
+    fghMapBufferRange = NULL;
+    fghPrimitiveRestartIndex = NULL;
+    fghDrawArraysInstanced = NULL;
+    fghFenceSync = NULL;
+    fghVertexAttribDivisor = NULL;
+    fghTransformFeedbackVaryings = NULL;
+    fghMultiDrawArraysIndirect = NULL;
+    fghBufferStorage = NULL;
+    fghHasIndexUint = VERSION(11, 30);
+    fghHasFixedIndexRestart = VERSION(43, 30);
+
+    /* Mesa hands out stubs for any name, so only ask for what the version has */
+    if (VERSION(14, 999))
+        fghMultiDrawElements = (FGH_PFNGLMULTIDRAWELEMENTSPROC)glutGetProcAddress("glMultiDrawElements");
+    if (VERSION(30, 30)) {
+        fghGenVertexArrays = (FGH_PFNGLGENVERTEXARRAYSPROC)glutGetProcAddress("glGenVertexArrays");
+        fghDirectBindVertexArray = (FGH_PFNGLBINDVERTEXARRAYPROC)glutGetProcAddress("glBindVertexArray");
+        fghDirectDeleteVertexArrays = (FGH_PFNGLDELETEVERTEXARRAYSPROC)glutGetProcAddress("glDeleteVertexArrays");
+        if (!fghGenVertexArrays || !fghDirectBindVertexArray || !fghDirectDeleteVertexArrays)
+            fghGenVertexArrays = NULL;
+    }
+    if (VERSION(30, 20)) {
+        fghGenFramebuffers = (FGH_PFNGLGENFRAMEBUFFERSPROC)glutGetProcAddress("glGenFramebuffers");
+        fghBindFramebuffer = (FGH_PFNGLBINDFRAMEBUFFERPROC)glutGetProcAddress("glBindFramebuffer");
+        fghDeleteFramebuffers = (FGH_PFNGLDELETEFRAMEBUFFERSPROC)glutGetProcAddress("glDeleteFramebuffers");
+        fghFramebufferTexture2D = (FGH_PFNGLFRAMEBUFFERTEXTURE2DPROC)glutGetProcAddress("glFramebufferTexture2D");
+        fghCheckFramebufferStatus = (FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC)glutGetProcAddress("glCheckFramebufferStatus");
+        if (!fghGenFramebuffers || !fghBindFramebuffer || !fghDeleteFramebuffers ||
+            !fghFramebufferTexture2D || !fghCheckFramebufferStatus)
+            fghGenFramebuffers = NULL;
+    }
+    if (VERSION(30, 30)) {
+        fghMapBufferRange = (FGH_PFNGLMAPBUFFERRANGEPROC)glutGetProcAddress("glMapBufferRange");
+        fghUnmapBuffer = (FGH_PFNGLUNMAPBUFFERPROC)glutGetProcAddress("glUnmapBuffer");
+        if (!fghMapBufferRange || !fghUnmapBuffer)
+            fghMapBufferRange = NULL;
+    }
+    if (VERSION(31, 999))
+        fghPrimitiveRestartIndex = (FGH_PFNGLPRIMITIVERESTARTINDEXPROC)glutGetProcAddress("glPrimitiveRestartIndex");
+    if (VERSION(31, 30))
+        fghDrawArraysInstanced = (FGH_PFNGLDRAWARRAYSINSTANCEDPROC)glutGetProcAddress("glDrawArraysInstanced");
+    if (VERSION(32, 30)) {
+        fghFenceSync = (FGH_PFNGLFENCESYNCPROC)glutGetProcAddress("glFenceSync");
+        fghClientWaitSync = (FGH_PFNGLCLIENTWAITSYNCPROC)glutGetProcAddress("glClientWaitSync");
+        fghDeleteSync = (FGH_PFNGLDELETESYNCPROC)glutGetProcAddress("glDeleteSync");
+        if (!fghFenceSync || !fghClientWaitSync || !fghDeleteSync)
+            fghFenceSync = NULL;
+    }
+    if (VERSION(33, 30))
+        fghVertexAttribDivisor = (FGH_PFNGLVERTEXATTRIBDIVISORPROC)glutGetProcAddress("glVertexAttribDivisor");
+    if (VERSION(40, 999)) {
+        fghTransformFeedbackVaryings = (FGH_PFNGLTRANSFORMFEEDBACKVARYINGSPROC)glutGetProcAddress("glTransformFeedbackVaryings");
+        fghBindBufferBase = (FGH_PFNGLBINDBUFFERBASEPROC)glutGetProcAddress("glBindBufferBase");
+        fghGetIntegeri_v = (FGH_PFNGLGETINTEGERI_VPROC)glutGetProcAddress("glGetIntegeri_v");
+        fghBeginTransformFeedback = (FGH_PFNGLBEGINTRANSFORMFEEDBACKPROC)glutGetProcAddress("glBeginTransformFeedback");
+        fghEndTransformFeedback = (FGH_PFNGLENDTRANSFORMFEEDBACKPROC)glutGetProcAddress("glEndTransformFeedback");
+        if (!fghTransformFeedbackVaryings || !fghBindBufferBase || !fghGetIntegeri_v ||
+            !fghBeginTransformFeedback || !fghEndTransformFeedback)
+            fghTransformFeedbackVaryings = NULL;
+    }
+    if (VERSION(43, 999))
+        fghMultiDrawArraysIndirect = (FGH_PFNGLMULTIDRAWARRAYSINDIRECTPROC)glutGetProcAddress("glMultiDrawArraysIndirect");
+    if (VERSION(44, 999))
+        fghBufferStorage = (FGH_PFNGLBUFFERSTORAGEPROC)glutGetProcAddress("glBufferStorage");
+#undef VERSION
+}
+
 void fgInitGL2() {
+    fgState.GLVersion = fghContextVersion();
+    fghInitOptionalGL();
+
 #ifdef GL_ES_VERSION_2_0
     fgState.HasOpenGL20 = (fgState.MajorVersion >= 2);
 #else
@@ -50,13 +216,401 @@ void fgInitGL2() {
        when we request a non-existent function */
 #define CHECK(func, a) if ((a) == NULL) { fgWarning("fgInitGL2: " func " is NULL"); return; }
     CHECK("fghGenBuffers", fghGenBuffers = (FGH_PFNGLGENBUFFERSPROC)glutGetProcAddress("glGenBuffers"));
-    CHECK("fghDeleteBuffers", fghDeleteBuffers = (FGH_PFNGLDELETEBUFFERSPROC)glutGetProcAddress("glDeleteBuffers"));
-    CHECK("fghBindBuffer", fghBindBuffer = (FGH_PFNGLBINDBUFFERPROC)glutGetProcAddress("glBindBuffer"));
+    CHECK("fghDirectDeleteBuffers", fghDirectDeleteBuffers = (FGH_PFNGLDELETEBUFFERSPROC)glutGetProcAddress("glDeleteBuffers"));
+    CHECK("fghDirectBindBuffer", fghDirectBindBuffer = (FGH_PFNGLBINDBUFFERPROC)glutGetProcAddress("glBindBuffer"));
     CHECK("fghBufferData", fghBufferData = (FGH_PFNGLBUFFERDATAPROC)glutGetProcAddress("glBufferData"));
+    CHECK("fghBufferSubData", fghBufferSubData = (FGH_PFNGLBUFFERSUBDATAPROC)glutGetProcAddress("glBufferSubData"));
     CHECK("fghVertexAttribPointer", fghVertexAttribPointer = (FGH_PFNGLVERTEXATTRIBPOINTERPROC)glutGetProcAddress("glVertexAttribPointer"));
-    CHECK("fghEnableVertexAttribArray", fghEnableVertexAttribArray = (FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC)glutGetProcAddress("glEnableVertexAttribArray"));
-    CHECK("fghDisableVertexAttribArray", fghDisableVertexAttribArray = (FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC)glutGetProcAddress("glDisableVertexAttribArray"));
+    CHECK("fghDirectEnableVertexAttribArray", fghDirectEnableVertexAttribArray = (FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC)glutGetProcAddress("glEnableVertexAttribArray"));
+    CHECK("fghDirectDisableVertexAttribArray", fghDirectDisableVertexAttribArray = (FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC)glutGetProcAddress("glDisableVertexAttribArray"));
+    CHECK("fghCreateShader", fghCreateShader = (FGH_PFNGLCREATESHADERPROC)glutGetProcAddress("glCreateShader"));
+    CHECK("fghShaderSource", fghShaderSource = (FGH_PFNGLSHADERSOURCEPROC)glutGetProcAddress("glShaderSource"));
+    CHECK("fghCompileShader", fghCompileShader = (FGH_PFNGLCOMPILESHADERPROC)glutGetProcAddress("glCompileShader"));
+    CHECK("fghGetShaderiv", fghGetShaderiv = (FGH_PFNGLGETSHADERIVPROC)glutGetProcAddress("glGetShaderiv"));
+    CHECK("fghGetShaderInfoLog", fghGetShaderInfoLog = (FGH_PFNGLGETSHADERINFOLOGPROC)glutGetProcAddress("glGetShaderInfoLog"));
+    CHECK("fghDeleteShader", fghDeleteShader = (FGH_PFNGLDELETESHADERPROC)glutGetProcAddress("glDeleteShader"));
+    CHECK("fghCreateProgram", fghCreateProgram = (FGH_PFNGLCREATEPROGRAMPROC)glutGetProcAddress("glCreateProgram"));
+    CHECK("fghAttachShader", fghAttachShader = (FGH_PFNGLATTACHSHADERPROC)glutGetProcAddress("glAttachShader"));
+    CHECK("fghBindAttribLocation", fghBindAttribLocation = (FGH_PFNGLBINDATTRIBLOCATIONPROC)glutGetProcAddress("glBindAttribLocation"));
+    CHECK("fghLinkProgram", fghLinkProgram = (FGH_PFNGLLINKPROGRAMPROC)glutGetProcAddress("glLinkProgram"));
+    CHECK("fghGetProgramiv", fghGetProgramiv = (FGH_PFNGLGETPROGRAMIVPROC)glutGetProcAddress("glGetProgramiv"));
+    CHECK("fghGetProgramInfoLog", fghGetProgramInfoLog = (FGH_PFNGLGETPROGRAMINFOLOGPROC)glutGetProcAddress("glGetProgramInfoLog"));
+    CHECK("fghDeleteProgram", fghDeleteProgram = (FGH_PFNGLDELETEPROGRAMPROC)glutGetProcAddress("glDeleteProgram"));
+    CHECK("fghDirectUseProgram", fghDirectUseProgram = (FGH_PFNGLUSEPROGRAMPROC)glutGetProcAddress("glUseProgram"));
+    CHECK("fghGetUniformLocation", fghGetUniformLocation = (FGH_PFNGLGETUNIFORMLOCATIONPROC)glutGetProcAddress("glGetUniformLocation"));
+    CHECK("fghUniform1i", fghUniform1i = (FGH_PFNGLUNIFORM1IPROC)glutGetProcAddress("glUniform1i"));
+    CHECK("fghUniform4f", fghUniform4f = (FGH_PFNGLUNIFORM4FPROC)glutGetProcAddress("glUniform4f"));
+    CHECK("fghUniform4fv", fghUniform4fv = (FGH_PFNGLUNIFORM4FVPROC)glutGetProcAddress("glUniform4fv"));
+    CHECK("fghActiveTexture", fghActiveTexture = (FGH_PFNGLACTIVETEXTUREPROC)glutGetProcAddress("glActiveTexture"));
+    CHECK("fghVertexAttrib2f", fghVertexAttrib2f = (FGH_PFNGLVERTEXATTRIB2FPROC)glutGetProcAddress("glVertexAttrib2f"));
 #undef CHECK
     fgState.HasOpenGL20 = 1;
 #endif
 }
+
+/*
+ * The shaders in freeglut are written against GLSL 1.10 and GLSL ES 1.00.
+ * When a 3.x or later context was requested, which may be a core profile
+ * context, they are mapped onto GLSL 1.30/1.50 through a few macros.
+ */
+static const char* fghShaderVersion( void )
+{
+#ifdef GL_ES_VERSION_2_0
+    return "#version 100\n";
+#else
+    if (fgState.MajorVersion > 3 || (fgState.MajorVersion == 3 && fgState.MinorVersion >= 2))
+        return "#version 150\n";
+    if (fgState.MajorVersion == 3)
+        return "#version 130\n";
+    return "#version 110\n";
+#endif
+}
+
+static const char* fghShaderPreamble( GLenum type )
+{
+#ifndef GL_ES_VERSION_2_0
+    if (fgState.MajorVersion >= 3)
+        return type == FGH_VERTEX_SHADER
+            ? "#define attribute in\n"
+              "#define varying out\n"
+            : "#define varying in\n"
+              "#define fgTexture2D texture\n"
+              "out vec4 fgFragColor;\n";
+#endif
+    return type == FGH_VERTEX_SHADER
+        ? ""
+        : "#ifdef GL_ES\n"
+          "precision mediump float;\n"
+          "#endif\n"
+          "#define fgTexture2D texture2D\n"
+          "#define fgFragColor gl_FragColor\n";
+}
+
+static const char* fghShaderTypeName( GLenum type )
+{
+    switch (type)
+    {
+    case FGH_VERTEX_SHADER:   return "vertex";
+    case FGH_FRAGMENT_SHADER: return "fragment";
+    default:                  return "unknown";
+    }
+}
+
+static GLuint fghCompileShaderSources( const char* caller, GLenum type,
+                                       const fghGLchar* const* sources, GLsizei count )
+{
+    GLint status = GL_FALSE;
+    GLuint shader = fghCreateShader(type);
+
+    fghShaderSource(shader, count, sources, NULL);
+    fghCompileShader(shader);
+    fghGetShaderiv(shader, FGH_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        fghGLchar log[1024];
+        fghGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fgWarning("%s: failed to compile %s shader:\n%s", caller, fghShaderTypeName(type), log);
+        fghDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint fghBuildShader( GLenum type, const char* source )
+{
+    const fghGLchar* sources[3];
+
+    sources[0] = fghShaderVersion();
+    sources[1] = fghShaderPreamble(type);
+    sources[2] = source;
+    return fghCompileShaderSources("fgCreateProgram", type, sources, 3);
+}
+
+/* Links a program, deleting it if that fails */
+static GLuint fghLinkProgramChecked( const char* caller, GLuint program )
+{
+    GLint status = GL_FALSE;
+
+    fghLinkProgram(program);
+    fghGetProgramiv(program, FGH_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        fghGLchar log[1024];
+        fghGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fgWarning("%s: failed to link program:\n%s", caller, log);
+        fghDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GLuint fgCreateProgram( const char* vertexShader, const char* fragmentShader,
+                        const char* const* attributes )
+{
+    GLuint program, vs, fs;
+    GLuint i;
+
+    if (!fgState.HasOpenGL20)
+        return 0;
+
+    vs = fghBuildShader(FGH_VERTEX_SHADER, vertexShader);
+    fs = vs ? fghBuildShader(FGH_FRAGMENT_SHADER, fragmentShader) : 0;
+    if (!fs)
+    {
+        if (vs)
+            fghDeleteShader(vs);
+        return 0;
+    }
+
+    program = fghCreateProgram();
+    fghAttachShader(program, vs);
+    fghAttachShader(program, fs);
+    for (i = 0; attributes && attributes[i]; i++)
+        fghBindAttribLocation(program, i, attributes[i]);
+
+    /* The program keeps the shaders alive for as long as it needs them */
+    fghDeleteShader(vs);
+    fghDeleteShader(fs);
+
+    return fghLinkProgramChecked("fgCreateProgram", program);
+}
+
+#define FGH_MAX_SHADER_SOURCES 16
+
+static GLuint fghBuildFeedbackShader( GLenum type, const char* const* source )
+{
+    const fghGLchar* sources[FGH_MAX_SHADER_SOURCES];
+    GLsizei count = 0;
+
+    sources[count++] = "#version 400 core\n";
+    while (*source && count < FGH_MAX_SHADER_SOURCES)
+        sources[count++] = *source++;
+    return fghCompileShaderSources("fgCreateFeedbackProgram", type, sources, count);
+}
+
+GLuint fgCreateFeedbackProgram( const char* const* vertexShader,
+                                const char* const* varyings )
+{
+    GLuint program, vs;
+    GLsizei numVaryings = 0;
+
+    if (!fgState.HasOpenGL20 || !fghTransformFeedbackVaryings)
+        return 0;
+
+    vs = fghBuildFeedbackShader(FGH_VERTEX_SHADER, vertexShader);
+    if (!vs)
+        return 0;
+
+    program = fghCreateProgram();
+    fghAttachShader(program, vs);
+    fghDeleteShader(vs);
+    while (varyings[numVaryings])
+        numVaryings++;
+    fghTransformFeedbackVaryings(program, numVaryings, varyings, FGH_INTERLEAVED_ATTRIBS);
+
+    return fghLinkProgramChecked("fgCreateFeedbackProgram", program);
+}
+
+/*
+ * The geometry, text and stream code binds buffers, vertex arrays and
+ * programs, and enables attribute arrays, around every draw, often to
+ * what is already bound. The calls below keep a shadow of that state in
+ * the current context and drop those that would not change it.
+ *
+ * freeglut shares the context with the application, which may change
+ * any of it between freeglut calls. The shadow therefore starts out
+ * unknown at the outermost fgGLStateBegin, learns values as freeglut sets
+ * or queries them, and is forgotten again at the matching fgGLStateEnd.
+ * With GLUT_GL_STATE_FILTER set, it is kept from one freeglut call to the
+ * next instead, for applications that leave these bindings to freeglut
+ * or set the option again after changing them. The shadow is kept with
+ * each window, so a window whose context other windows also use
+ * (GLUT_USE_CURRENT_CONTEXT) forgets it on becoming current, in
+ * fgSetWindow.
+ *
+ * The element array buffer and enabled attribute arrays belong to the
+ * bound vertex array, so they are forgotten whenever that changes.
+ */
+#define FGH_UNKNOWN (-1)
+
+static SFG_GLState* fghGLState()
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+
+    if (!window)
+        return NULL;
+    if (window->Window.GLState.Depth == 0 && !fgState.GLStateFilter)
+        return NULL;
+    return &window->Window.GLState;
+}
+
+/* Counts a call, returning whether it is to be issued */
+static GLboolean fghGLStateChanges(GLint* shadow, GLint value)
+{
+    if (shadow && *shadow == value)
+    {
+        fgState.GLCallsElided++;
+        return GL_FALSE;
+    }
+    fgState.GLCallsIssued++;
+    if (shadow)
+        *shadow = value;
+    return GL_TRUE;
+}
+
+static void fghForgetVertexArrayState(SFG_GLState* state)
+{
+    int i;
+
+    state->ElementArrayBuffer = FGH_UNKNOWN;
+    for (i = 0; i < FREEGLUT_GL_STATE_ATTRIBS; i++)
+        state->Attribs[i] = FGH_UNKNOWN;
+}
+
+static GLint* fghBufferShadow(SFG_GLState* state, GLenum target)
+{
+    if (!state)
+        return NULL;
+    switch (target)
+    {
+    case FGH_ARRAY_BUFFER:          return &state->ArrayBuffer;
+    case FGH_ELEMENT_ARRAY_BUFFER:  return &state->ElementArrayBuffer;
+    case FGH_DRAW_INDIRECT_BUFFER:  return &state->DrawIndirectBuffer;
+    default:                        return NULL;
+    }
+}
+
+static GLint* fghAttribShadow(SFG_GLState* state, GLuint index)
+{
+    return state && index < FREEGLUT_GL_STATE_ATTRIBS ? &state->Attribs[index] : NULL;
+}
+
+void fghBindBuffer( GLenum target, GLuint buffer )
+{
+    if (fghGLStateChanges(fghBufferShadow(fghGLState(), target), buffer))
+        fghDirectBindBuffer(target, buffer);
+}
+
+void fghDeleteBuffers( GLsizei n, const GLuint* buffers )
+{
+    SFG_GLState* state = fghGLState();
+    GLsizei i;
+
+    /* Deleting a bound buffer binds 0 in its place */
+    for (i = 0; state && i < n; i++)
+    {
+        if (state->ArrayBuffer == (GLint)buffers[i])
+            state->ArrayBuffer = 0;
+        if (state->ElementArrayBuffer == (GLint)buffers[i])
+            state->ElementArrayBuffer = 0;
+        if (state->DrawIndirectBuffer == (GLint)buffers[i])
+            state->DrawIndirectBuffer = 0;
+    }
+    fghDirectDeleteBuffers(n, buffers);
+}
+
+void fghEnableVertexAttribArray( GLuint index )
+{
+    if (fghGLStateChanges(fghAttribShadow(fghGLState(), index), GL_TRUE))
+        fghDirectEnableVertexAttribArray(index);
+}
+
+void fghDisableVertexAttribArray( GLuint index )
+{
+    if (fghGLStateChanges(fghAttribShadow(fghGLState(), index), GL_FALSE))
+        fghDirectDisableVertexAttribArray(index);
+}
+
+void fghBindVertexArray( GLuint array )
+{
+    SFG_GLState* state = fghGLState();
+
+    if (fghGLStateChanges(state ? &state->VertexArray : NULL, array))
+    {
+        fghDirectBindVertexArray(array);
+        if (state)
+            fghForgetVertexArrayState(state);
+    }
+}
+
+void fghDeleteVertexArrays( GLsizei n, const GLuint* arrays )
+{
+    SFG_GLState* state = fghGLState();
+    GLsizei i;
+
+    /* Deleting the bound vertex array binds 0 in its place */
+    for (i = 0; state && i < n; i++)
+        if (state->VertexArray == (GLint)arrays[i])
+        {
+            state->VertexArray = 0;
+            fghForgetVertexArrayState(state);
+        }
+    fghDirectDeleteVertexArrays(n, arrays);
+}
+
+void fghUseProgram( GLuint program )
+{
+    SFG_GLState* state = fghGLState();
+
+    if (fghGLStateChanges(state ? &state->Program : NULL, program))
+        fghDirectUseProgram(program);
+}
+
+/*
+ * glGetIntegerv for the bindings, from the shadow when it has them
+ */
+void fghGetIntegerv( GLenum pname, GLint* value )
+{
+    SFG_GLState* state = fghGLState();
+    GLint* shadow = NULL;
+
+    if (state)
+        switch (pname)
+        {
+        case FGH_ARRAY_BUFFER_BINDING:          shadow = &state->ArrayBuffer;        break;
+        case FGH_DRAW_INDIRECT_BUFFER_BINDING:  shadow = &state->DrawIndirectBuffer; break;
+        case FGH_VERTEX_ARRAY_BINDING:          shadow = &state->VertexArray;        break;
+        case FGH_CURRENT_PROGRAM:               shadow = &state->Program;            break;
+        }
+
+    if (shadow && *shadow != FGH_UNKNOWN)
+    {
+        fgState.GLCallsElided++;
+        *value = *shadow;
+        return;
+    }
+    fgState.GLCallsIssued++;
+    glGetIntegerv(pname, value);
+    if (shadow)
+        *shadow = *value;
+}
+
+/*
+ * Forgets all of a context's shadowed state
+ */
+void fgGLStateInvalidate( SFG_Context* context )
+{
+    SFG_GLState* state = &context->GLState;
+
+    state->ArrayBuffer = FGH_UNKNOWN;
+    state->DrawIndirectBuffer = FGH_UNKNOWN;
+    state->VertexArray = FGH_UNKNOWN;
+    state->Program = FGH_UNKNOWN;
+    fghForgetVertexArrayState(state);
+}
+
+void fgGLStateBegin( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+
+    if (window && window->Window.GLState.Depth++ == 0 && !fgState.GLStateFilter)
+        fgGLStateInvalidate(&window->Window);
+}
+
+void fgGLStateEnd( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+
+    if (window && window->Window.GLState.Depth > 0)
+        window->Window.GLState.Depth--;
+}
@@ -1,7 +1,7 @@
 /*
  * fg_gl2.c
  *
- * Load OpenGL (ES) 2.0 functions used by fg_geometry
+ * Load OpenGL (ES) 2.0 functions used by fg_geometry and fg_font_atlas
  *
  * Copyright (C) 2012  Sylvain Beucler
  *
@@ -28,6 +28,7 @@
 
 #include <GL/freeglut.h>
 #include "fg_internal.h"
+#include <stddef.h>
 
 #ifdef GL_ES_VERSION_2_0
 /* Use existing functions on GLES 2.0 */
@@ -37,13 +38,49 @@
 #define FGH_ELEMENT_ARRAY_BUFFER GL_ELEMENT_ARRAY_BUFFER
 
 #define fghGenBuffers glGenBuffers
-#define fghDeleteBuffers glDeleteBuffers
-#define fghBindBuffer glBindBuffer
+#define fghDirectDeleteBuffers glDeleteBuffers
+#define fghDirectBindBuffer glBindBuffer
 #define fghBufferData glBufferData
-#define fghEnableVertexAttribArray glEnableVertexAttribArray
-#define fghDisableVertexAttribArray glDisableVertexAttribArray
+#define fghBufferSubData glBufferSubData
+#define fghDirectEnableVertexAttribArray glEnableVertexAttribArray
+#define fghDirectDisableVertexAttribArray glDisableVertexAttribArray
 #define fghVertexAttribPointer glVertexAttribPointer
 
+#define FGH_STREAM_DRAW GL_STREAM_DRAW
+#define FGH_ARRAY_BUFFER_BINDING GL_ARRAY_BUFFER_BINDING
+#define FGH_VERTEX_SHADER GL_VERTEX_SHADER
+#define FGH_FRAGMENT_SHADER GL_FRAGMENT_SHADER
+#define FGH_COMPILE_STATUS GL_COMPILE_STATUS
+#define FGH_LINK_STATUS GL_LINK_STATUS
+#define FGH_INFO_LOG_LENGTH GL_INFO_LOG_LENGTH
+#define FGH_CURRENT_PROGRAM GL_CURRENT_PROGRAM
+#define FGH_TEXTURE0 GL_TEXTURE0
+#define FGH_ACTIVE_TEXTURE GL_ACTIVE_TEXTURE
+
+typedef GLchar fghGLchar;
+typedef GLintptr fghGLintptr;
+
+#define fghCreateShader glCreateShader
+#define fghShaderSource glShaderSource
+#define fghCompileShader glCompileShader
+#define fghGetShaderiv glGetShaderiv
+#define fghGetShaderInfoLog glGetShaderInfoLog
+#define fghDeleteShader glDeleteShader
+#define fghCreateProgram glCreateProgram
+#define fghAttachShader glAttachShader
+#define fghBindAttribLocation glBindAttribLocation
+#define fghLinkProgram glLinkProgram
+#define fghGetProgramiv glGetProgramiv
+#define fghGetProgramInfoLog glGetProgramInfoLog
+#define fghDeleteProgram glDeleteProgram
+#define fghDirectUseProgram glUseProgram
+#define fghGetUniformLocation glGetUniformLocation
+#define fghUniform1i glUniform1i
+#define fghUniform4f glUniform4f
+#define fghUniform4fv glUniform4fv
+#define fghActiveTexture glActiveTexture
+#define fghVertexAttrib2f glVertexAttrib2f
+
 #else
 /* Load functions dynamically, they are not defined in e.g. win32's
    OpenGL headers */
@@ -58,25 +95,230 @@
 #define FGH_STATIC_DRAW 0x88E4
 #define FGH_ELEMENT_ARRAY_BUFFER 0x8893
 
+#define FGH_STREAM_DRAW 0x88E0
+#define FGH_ARRAY_BUFFER_BINDING 0x8894
+#define FGH_VERTEX_SHADER 0x8B31
+#define FGH_FRAGMENT_SHADER 0x8B30
+#define FGH_COMPILE_STATUS 0x8B81
+#define FGH_LINK_STATUS 0x8B82
+#define FGH_INFO_LOG_LENGTH 0x8B84
+#define FGH_CURRENT_PROGRAM 0x8B8D
+#define FGH_TEXTURE0 0x84C0
+#define FGH_ACTIVE_TEXTURE 0x84E0
+
 typedef int fghGLsizeiptr;
+typedef ptrdiff_t fghGLintptr;
+typedef char fghGLchar;
 typedef void (APIENTRY *FGH_PFNGLGENBUFFERSPROC) (GLsizei n, GLuint *buffers);
 typedef void (APIENTRY *FGH_PFNGLBINDBUFFERPROC) (GLenum target, GLuint buffer);
 typedef void (APIENTRY *FGH_PFNGLBUFFERDATAPROC) (GLenum target, fghGLsizeiptr size, const GLvoid *data, GLenum usage);
+typedef void (APIENTRY *FGH_PFNGLBUFFERSUBDATAPROC) (GLenum target, fghGLintptr offset, fghGLintptr size, const GLvoid *data);
 typedef void (APIENTRY *FGH_PFNGLDELETEBUFFERSPROC) (GLsizei n, const GLuint* buffers);
 typedef void (APIENTRY *FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC) (GLuint index);
 typedef void (APIENTRY *FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC) (GLuint);
 typedef void (APIENTRY *FGH_PFNGLVERTEXATTRIBPOINTERPROC) (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pointer);
+typedef GLuint (APIENTRY *FGH_PFNGLCREATESHADERPROC) (GLenum type);
+typedef void (APIENTRY *FGH_PFNGLSHADERSOURCEPROC) (GLuint shader, GLsizei count, const fghGLchar* const *string, const GLint *length);
+typedef void (APIENTRY *FGH_PFNGLCOMPILESHADERPROC) (GLuint shader);
+typedef void (APIENTRY *FGH_PFNGLGETSHADERIVPROC) (GLuint shader, GLenum pname, GLint *params);
+typedef void (APIENTRY *FGH_PFNGLGETSHADERINFOLOGPROC) (GLuint shader, GLsizei bufSize, GLsizei *length, fghGLchar *infoLog);
+typedef void (APIENTRY *FGH_PFNGLDELETESHADERPROC) (GLuint shader);
+typedef GLuint (APIENTRY *FGH_PFNGLCREATEPROGRAMPROC) (void);
+typedef void (APIENTRY *FGH_PFNGLATTACHSHADERPROC) (GLuint program, GLuint shader);
+typedef void (APIENTRY *FGH_PFNGLBINDATTRIBLOCATIONPROC) (GLuint program, GLuint index, const fghGLchar *name);
+typedef void (APIENTRY *FGH_PFNGLLINKPROGRAMPROC) (GLuint program);
+typedef void (APIENTRY *FGH_PFNGLGETPROGRAMIVPROC) (GLuint program, GLenum pname, GLint *params);
+typedef void (APIENTRY *FGH_PFNGLGETPROGRAMINFOLOGPROC) (GLuint program, GLsizei bufSize, GLsizei *length, fghGLchar *infoLog);
+typedef void (APIENTRY *FGH_PFNGLDELETEPROGRAMPROC) (GLuint program);
+typedef void (APIENTRY *FGH_PFNGLUSEPROGRAMPROC) (GLuint program);
+typedef GLint (APIENTRY *FGH_PFNGLGETUNIFORMLOCATIONPROC) (GLuint program, const fghGLchar *name);
+typedef void (APIENTRY *FGH_PFNGLUNIFORM1IPROC) (GLint location, GLint v0);
+typedef void (APIENTRY *FGH_PFNGLUNIFORM4FPROC) (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+typedef void (APIENTRY *FGH_PFNGLUNIFORM4FVPROC) (GLint location, GLsizei count, const GLfloat *value);
+typedef void (APIENTRY *FGH_PFNGLACTIVETEXTUREPROC) (GLenum texture);
+typedef void (APIENTRY *FGH_PFNGLVERTEXATTRIB2FPROC) (GLuint index, GLfloat x, GLfloat y);
 
-FGH_PFNGLGENBUFFERSPROC fghGenBuffers;
-FGH_PFNGLDELETEBUFFERSPROC fghDeleteBuffers;
-FGH_PFNGLBINDBUFFERPROC fghBindBuffer;
-FGH_PFNGLBUFFERDATAPROC fghBufferData;
-FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC fghEnableVertexAttribArray;
-FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC fghDisableVertexAttribArray;
-FGH_PFNGLVERTEXATTRIBPOINTERPROC fghVertexAttribPointer;
+extern FGH_PFNGLGENBUFFERSPROC fghGenBuffers;
+extern FGH_PFNGLDELETEBUFFERSPROC fghDirectDeleteBuffers;
+extern FGH_PFNGLBINDBUFFERPROC fghDirectBindBuffer;
+extern FGH_PFNGLBUFFERDATAPROC fghBufferData;
+extern FGH_PFNGLBUFFERSUBDATAPROC fghBufferSubData;
+extern FGH_PFNGLENABLEVERTEXATTRIBARRAYPROC fghDirectEnableVertexAttribArray;
+extern FGH_PFNGLDISABLEVERTEXATTRIBARRAYPROC fghDirectDisableVertexAttribArray;
+extern FGH_PFNGLVERTEXATTRIBPOINTERPROC fghVertexAttribPointer;
+extern FGH_PFNGLCREATESHADERPROC fghCreateShader;
+extern FGH_PFNGLSHADERSOURCEPROC fghShaderSource;
+extern FGH_PFNGLCOMPILESHADERPROC fghCompileShader;
+extern FGH_PFNGLGETSHADERIVPROC fghGetShaderiv;
+extern FGH_PFNGLGETSHADERINFOLOGPROC fghGetShaderInfoLog;
+extern FGH_PFNGLDELETESHADERPROC fghDeleteShader;
+extern FGH_PFNGLCREATEPROGRAMPROC fghCreateProgram;
+extern FGH_PFNGLATTACHSHADERPROC fghAttachShader;
+extern FGH_PFNGLBINDATTRIBLOCATIONPROC fghBindAttribLocation;
+extern FGH_PFNGLLINKPROGRAMPROC fghLinkProgram;
+extern FGH_PFNGLGETPROGRAMIVPROC fghGetProgramiv;
+extern FGH_PFNGLGETPROGRAMINFOLOGPROC fghGetProgramInfoLog;
+extern FGH_PFNGLDELETEPROGRAMPROC fghDeleteProgram;
+extern FGH_PFNGLUSEPROGRAMPROC fghDirectUseProgram;
+extern FGH_PFNGLGETUNIFORMLOCATIONPROC fghGetUniformLocation;
+extern FGH_PFNGLUNIFORM1IPROC fghUniform1i;
+extern FGH_PFNGLUNIFORM4FPROC fghUniform4f;
+extern FGH_PFNGLUNIFORM4FVPROC fghUniform4fv;
+extern FGH_PFNGLACTIVETEXTUREPROC fghActiveTexture;
+extern FGH_PFNGLVERTEXATTRIB2FPROC fghVertexAttrib2f;
 
 #    endif
 
+/* Texture tokens missing from the OpenGL 1.1 or OpenGL ES 2.0 headers */
+#define FGH_CLAMP_TO_EDGE 0x812F
+#define FGH_RED 0x1903
+#define FGH_R8 0x8229
+
+/* Pixel store tokens missing from the OpenGL ES 2.0 headers */
+#define FGH_PACK_ROW_LENGTH 0x0D02
+#define FGH_PACK_SKIP_ROWS 0x0D03
+#define FGH_PACK_SKIP_PIXELS 0x0D04
+
+/* Entry points beyond OpenGL (ES) 2.0. They are loaded when the version of
+   the context, fgState.GLVersion, has them and are NULL otherwise. */
+#define FGH_VERTEX_ARRAY_BINDING 0x85B5
+#define FGH_DRAW_INDIRECT_BUFFER 0x8F3F
+#define FGH_DRAW_INDIRECT_BUFFER_BINDING 0x8F43
+#define FGH_FRAMEBUFFER 0x8D40
+#define FGH_FRAMEBUFFER_BINDING 0x8CA6
+#define FGH_FRAMEBUFFER_COMPLETE 0x8CD5
+#define FGH_COLOR_ATTACHMENT0 0x8CE0
+#define FGH_PIXEL_PACK_BUFFER 0x88EB
+#define FGH_PIXEL_PACK_BUFFER_BINDING 0x88ED
+#define FGH_STREAM_READ 0x88E1
+#define FGH_PRIMITIVE_RESTART 0x8F9D
+#define FGH_PRIMITIVE_RESTART_INDEX 0x8F9E
+#define FGH_PRIMITIVE_RESTART_FIXED_INDEX 0x8D69
+#define FGH_TRANSFORM_FEEDBACK_BUFFER 0x8C8E
+#define FGH_TRANSFORM_FEEDBACK_BUFFER_BINDING 0x8C8F
+#define FGH_INTERLEAVED_ATTRIBS 0x8C8C
+#define FGH_RASTERIZER_DISCARD 0x8C89
+#define FGH_TRANSFORM_FEEDBACK_ACTIVE 0x8E24
+#define FGH_MAP_READ_BIT 0x0001
+#define FGH_MAP_WRITE_BIT 0x0002
+#define FGH_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define FGH_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define FGH_MAP_PERSISTENT_BIT 0x0040
+#define FGH_MAP_COHERENT_BIT 0x0080
+#define FGH_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define FGH_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define FGH_TIMEOUT_EXPIRED 0x911B
+#define FGH_WAIT_FAILED 0x911D
+
+typedef struct fghGLsyncObject* fghGLsync;
+typedef unsigned long long fghGLuint64;
+
+typedef void (APIENTRY *FGH_PFNGLGENVERTEXARRAYSPROC) (GLsizei n, GLuint *arrays);
+typedef void (APIENTRY *FGH_PFNGLBINDVERTEXARRAYPROC) (GLuint array);
+typedef void (APIENTRY *FGH_PFNGLDELETEVERTEXARRAYSPROC) (GLsizei n, const GLuint *arrays);
+typedef void (APIENTRY *FGH_PFNGLVERTEXATTRIBDIVISORPROC) (GLuint index, GLuint divisor);
+typedef void (APIENTRY *FGH_PFNGLMULTIDRAWARRAYSINDIRECTPROC) (GLenum mode, const GLvoid *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRY *FGH_PFNGLGENFRAMEBUFFERSPROC) (GLsizei n, GLuint *framebuffers);
+typedef void (APIENTRY *FGH_PFNGLBINDFRAMEBUFFERPROC) (GLenum target, GLuint framebuffer);
+typedef void (APIENTRY *FGH_PFNGLDELETEFRAMEBUFFERSPROC) (GLsizei n, const GLuint *framebuffers);
+typedef void (APIENTRY *FGH_PFNGLFRAMEBUFFERTEXTURE2DPROC) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+typedef GLenum (APIENTRY *FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC) (GLenum target);
+typedef void (APIENTRY *FGH_PFNGLMULTIDRAWELEMENTSPROC) (GLenum mode, const GLsizei *count, GLenum type, const GLvoid *const *indices, GLsizei drawcount);
+typedef void (APIENTRY *FGH_PFNGLPRIMITIVERESTARTINDEXPROC) (GLuint index);
+typedef GLvoid* (APIENTRY *FGH_PFNGLMAPBUFFERRANGEPROC) (GLenum target, fghGLintptr offset, fghGLintptr length, GLbitfield access);
+typedef GLboolean (APIENTRY *FGH_PFNGLUNMAPBUFFERPROC) (GLenum target);
+typedef void (APIENTRY *FGH_PFNGLBUFFERSTORAGEPROC) (GLenum target, fghGLintptr size, const GLvoid *data, GLbitfield flags);
+typedef fghGLsync (APIENTRY *FGH_PFNGLFENCESYNCPROC) (GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRY *FGH_PFNGLCLIENTWAITSYNCPROC) (fghGLsync sync, GLbitfield flags, fghGLuint64 timeout);
+typedef void (APIENTRY *FGH_PFNGLDELETESYNCPROC) (fghGLsync sync);
+typedef void (APIENTRY *FGH_PFNGLDRAWARRAYSINSTANCEDPROC) (GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+typedef void (APIENTRY *FGH_PFNGLTRANSFORMFEEDBACKVARYINGSPROC) (GLuint program, GLsizei count, const fghGLchar *const *varyings, GLenum bufferMode);
+typedef void (APIENTRY *FGH_PFNGLBINDBUFFERBASEPROC) (GLenum target, GLuint index, GLuint buffer);
+typedef void (APIENTRY *FGH_PFNGLGETINTEGERI_VPROC) (GLenum target, GLuint index, GLint *data);
+typedef void (APIENTRY *FGH_PFNGLBEGINTRANSFORMFEEDBACKPROC) (GLenum primitiveMode);
+typedef void (APIENTRY *FGH_PFNGLENDTRANSFORMFEEDBACKPROC) (void);
+
+/* OpenGL 1.4 */
+extern FGH_PFNGLMULTIDRAWELEMENTSPROC fghMultiDrawElements;
+/* OpenGL 3.0, OpenGL ES 3.0. Mandatory for drawing in core profiles */
+extern FGH_PFNGLGENVERTEXARRAYSPROC fghGenVertexArrays;
+extern FGH_PFNGLBINDVERTEXARRAYPROC fghDirectBindVertexArray;
+extern FGH_PFNGLDELETEVERTEXARRAYSPROC fghDirectDeleteVertexArrays;
+/* OpenGL 3.0, OpenGL ES 2.0 */
+extern FGH_PFNGLGENFRAMEBUFFERSPROC fghGenFramebuffers;
+extern FGH_PFNGLBINDFRAMEBUFFERPROC fghBindFramebuffer;
+extern FGH_PFNGLDELETEFRAMEBUFFERSPROC fghDeleteFramebuffers;
+extern FGH_PFNGLFRAMEBUFFERTEXTURE2DPROC fghFramebufferTexture2D;
+extern FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC fghCheckFramebufferStatus;
+/* OpenGL 3.0, OpenGL ES 3.0. Set together or not at all */
+extern FGH_PFNGLMAPBUFFERRANGEPROC fghMapBufferRange;
+extern FGH_PFNGLUNMAPBUFFERPROC fghUnmapBuffer;
+/* OpenGL 3.1 */
+extern FGH_PFNGLPRIMITIVERESTARTINDEXPROC fghPrimitiveRestartIndex;
+/* OpenGL 3.1, OpenGL ES 3.0 */
+extern FGH_PFNGLDRAWARRAYSINSTANCEDPROC fghDrawArraysInstanced;
+/* OpenGL 3.2, OpenGL ES 3.0. Set together or not at all */
+extern FGH_PFNGLFENCESYNCPROC fghFenceSync;
+extern FGH_PFNGLCLIENTWAITSYNCPROC fghClientWaitSync;
+extern FGH_PFNGLDELETESYNCPROC fghDeleteSync;
+/* OpenGL 3.3, OpenGL ES 3.0 */
+extern FGH_PFNGLVERTEXATTRIBDIVISORPROC fghVertexAttribDivisor;
+/* OpenGL 4.0: transform feedback, for shaders of GLSL 4.00 whose
+   precise qualifier the teapot needs. Set together or not at all. */
+extern FGH_PFNGLTRANSFORMFEEDBACKVARYINGSPROC fghTransformFeedbackVaryings;
+extern FGH_PFNGLBINDBUFFERBASEPROC fghBindBufferBase;
+extern FGH_PFNGLGETINTEGERI_VPROC fghGetIntegeri_v;
+extern FGH_PFNGLBEGINTRANSFORMFEEDBACKPROC fghBeginTransformFeedback;
+extern FGH_PFNGLENDTRANSFORMFEEDBACKPROC fghEndTransformFeedback;
+/* OpenGL 4.3 */
+extern FGH_PFNGLMULTIDRAWARRAYSINDIRECTPROC fghMultiDrawArraysIndirect;
+/* OpenGL 4.4 */
+extern FGH_PFNGLBUFFERSTORAGEPROC fghBufferStorage;
+
+/* Capabilities without entry points of their own */
+extern GLboolean fghHasIndexUint;          /* OpenGL, OpenGL ES 3.0: GL_UNSIGNED_INT indices */
+extern GLboolean fghHasFixedIndexRestart;  /* OpenGL 4.3, OpenGL ES 3.0 */
+
 extern void fgInitGL2();
 
+/*
+ * Buffer, vertex array and program bindings, and enabled attribute arrays,
+ * go through a shadow of that state in the current context, which drops
+ * the calls that would not change it (see fg_gl2.c). The fghDirect entry
+ * points above bypass it and are only for fg_gl2.c. The shadow is valid
+ * between fgGLStateBegin and fgGLStateEnd, which nest, and between them
+ * only if GLUT_GL_STATE_FILTER was set.
+ */
+extern void fghBindBuffer( GLenum target, GLuint buffer );
+extern void fghDeleteBuffers( GLsizei n, const GLuint* buffers );
+extern void fghEnableVertexAttribArray( GLuint index );
+extern void fghDisableVertexAttribArray( GLuint index );
+extern void fghBindVertexArray( GLuint array );
+extern void fghDeleteVertexArrays( GLsizei n, const GLuint* arrays );
+extern void fghUseProgram( GLuint program );
+extern void fghGetIntegerv( GLenum pname, GLint* value );
+extern void fgGLStateBegin( void );
+extern void fgGLStateEnd( void );
+
+/*
+ * Compiles and links a program from the given vertex and fragment shader
+ * bodies. A "#version" line and macros matching the requested context
+ * are prepended, so that shaders can be written once using "attribute",
+ * "varying", fgTexture2D() and fgFragColor. Attributes are bound to the
+ * indices given by their position in the NULL-terminated attributes list.
+ * Returns 0 and warns if compiling or linking fails.
+ */
+extern GLuint fgCreateProgram( const char* vertexShader, const char* fragmentShader,
+                               const char* const* attributes );
+
+/*
+ * Compiles and links a program of a GLSL 4.00 vertex shader alone, whose
+ * outputs are captured into a single buffer by transform feedback. The
+ * shader is given as a NULL-terminated list of strings, following a
+ * "#version 400 core" line. Needs fghTransformFeedbackVaryings; returns
+ * 0 and warns if building fails.
+ */
+extern GLuint fgCreateFeedbackProgram( const char* const* vertexShader,
+                                       const char* const* varyings );
+
 #endif
@@ -88,11 +88,24 @@ SFG_State fgState = { { -1, -1, GL_FALSE },  /* Position */
                       4,                      /* SampleNumber */
                       GL_FALSE,               /* SkipStaleMotion */
                       GL_FALSE,               /* StrokeFontDrawJoinDots */
+                      GL_FALSE,               /* BitmapFontAtlas */
+                      0,                      /* TeapotSubdivisions */
+                      1,                      /* ShapeInstances */
+                      GL_FALSE,               /* GLStateFilter */
+                      0,                      /* GLCallsIssued */
+                      0,                      /* GLCallsElided */
+                      0,                      /* FrameRate */
+                      0,                      /* ReadbackDepth */
+                      0,                      /* RecordPoolFrames */
+                      0,                      /* ProfileFrames */
+                      NULL,                   /* ProfilePath */
+                      NULL,                   /* Profiler */
                       1,                      /* OpenGL context MajorVersion */
                       0,                      /* OpenGL context MinorVersion */
                       0,                      /* OpenGL ContextFlags */
                       0,                      /* OpenGL ContextProfile */
                       0,                      /* HasOpenGL20 */
+                      0,                      /* GLVersion */
                       NULL,                   /* ErrorFunc */
                       NULL                    /* WarningFunc */
 };
@@ -126,6 +139,26 @@ void fghParseCommandLineArguments ( int* pargc, char** argv, char **pDisplayName
         }
     }
 
+    {
+        /* and GLUT_HEADLESS_FRAME_RATE, for the virtual clock of a headless build */
+        const char *rate = getenv( "GLUT_HEADLESS_FRAME_RATE" );
+
+        if( rate && atoi( rate ) > 0 )
+            fgState.FrameRate = atoi( rate );
+    }
+
+    {
+        /* and GLUT_PROFILE, a file to write a trace of the main loop to on exit */
+        const char *profile = getenv( "GLUT_PROFILE" );
+
+        if( profile && *profile )
+        {
+            fgState.ProfilePath = strdup( profile );
+            if( !fgState.ProfileFrames )
+                fgState.ProfileFrames = 600;  /* 10 seconds at 60 Hz */
+        }
+    }
+
     *pDisplayName = getenv( "DISPLAY" );
 
     for( i = 1; i < argc; i++ )
@@ -243,8 +276,13 @@ void fgDeinitialize( void )
         fgStructure.MenuContext = NULL;
     }
 
+    /* Before the windows go, as the frames are read from the recorded one */
+    fgStopRecording( NULL );
+
     fgDestroyStructure( );
 
+    fgProfileExit( );
+
     while( ( timer = fgState.Timers.First) )
     {
         fgListRemove( &fgState.Timers, &timer->Node );
@@ -257,6 +295,10 @@ void fgDeinitialize( void )
         free( timer );
     }
 
+    fgDestroyTextLayouts( );
+    fgDestroyTeasets( );
+    fgUnmapShapes( );
+
     fgPlatformDeinitialiseInputDevices ();
 
     fgState.MouseWheelTicks = 0;
@@ -304,6 +346,10 @@ void fgDeinitialize( void )
     fgState.SwapCount   = 0;
     fgState.SwapTime    = 0;
     fgState.FPSInterval = 0;
+    fgState.FrameRate   = 0;
+    fgState.ReadbackDepth = 0;
+    fgState.RecordPoolFrames = 0;
+    fgState.ProfileFrames = 0;
 
     if( fgState.ProgramName )
     {
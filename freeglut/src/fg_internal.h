@@ -38,7 +38,7 @@
 /* XXX: Don't all MS-Windows compilers (except Cygwin) have _WIN32 defined?
  * XXX: If so, remove the first set of defined()'s below.
  */
-#if !defined(TARGET_HOST_POSIX_X11) && !defined(TARGET_HOST_MS_WINDOWS) && !defined(TARGET_HOST_MAC_OSX) && !defined(TARGET_HOST_SOLARIS)
+#if !defined(TARGET_HOST_POSIX_X11) && !defined(TARGET_HOST_MS_WINDOWS) && !defined(TARGET_HOST_MAC_OSX) && !defined(TARGET_HOST_SOLARIS) && !defined(TARGET_HOST_HEADLESS)
 #if defined(_MSC_VER) || defined(__WATCOMC__) || defined(__MINGW32__) \
     || defined(_WIN32) || defined(_WIN32_WCE) \
     || ( defined(__CYGWIN__) && defined(X_DISPLAY_MISSING) )
@@ -89,6 +89,11 @@
 #   define  TARGET_HOST_MAC_OSX    0
 #endif
 
+/* Without a display server, only by request (-DTARGET_HOST_HEADLESS=1) */
+#ifndef  TARGET_HOST_HEADLESS
+#   define  TARGET_HOST_HEADLESS   0
+#endif
+
 #ifndef  TARGET_HOST_SOLARIS
 #   define  TARGET_HOST_SOLARIS    0
 #endif
@@ -200,6 +205,9 @@
 #if TARGET_HOST_BLACKBERRY
 #include "blackberry/fg_internal_blackberry.h"
 #endif
+#if TARGET_HOST_HEADLESS
+#include "headless/fg_internal_headless.h"
+#endif
 
 
 /* -- GLOBAL TYPE DEFINITIONS ---------------------------------------------- */
@@ -287,6 +295,17 @@ typedef enum
   GLUT_EXEC_STATE_STOP
 } fgExecutionState ;
 
+/* The frames profiled and the scopes open, see fg_profile.c */
+typedef struct tagSFG_Profiler SFG_Profiler;
+
+/* What a profiled scope times; 0 is the frame itself */
+enum
+{
+  FG_PROFILE_PHASE = 1,                 /* A phase of glutMainLoopEvent      */
+  FG_PROFILE_CALLBACK,                  /* A callback of the application's   */
+  FG_PROFILE_USER                       /* glutProfileBegin                  */
+};
+
 /* This structure holds different freeglut settings */
 typedef struct tagSFG_State SFG_State;
 struct tagSFG_State
@@ -343,12 +362,25 @@ struct tagSFG_State
     GLboolean        SkipStaleMotion;      /* skip stale motion events */
 
     GLboolean        StrokeFontDrawJoinDots;/* Draw dots between line segments of stroke fonts? */
+    GLboolean        BitmapFontAtlas;      /* Draw bitmap fonts from a texture atlas? */
+    int              TeapotSubdivisions;   /* Vertices along a teapot patch side, 0 for the default */
+    int              ShapeInstances;       /* Instances of each procedural shape drawn */
+    GLboolean        GLStateFilter;        /* Keep the GL state shadow between calls? */
+    unsigned long    GLCallsIssued;        /* Calls through the GL state shadow ...   */
+    unsigned long    GLCallsElided;        /* ... and those it dropped                */
+    int              FrameRate;            /* Virtual frames per second, headless     */
+    int              ReadbackDepth;        /* Asynchronous reads in flight, 0 for the default */
+    int              RecordPoolFrames;     /* Frames a recording may queue, 0 for the default */
+    int              ProfileFrames;        /* Frames profiled, 0 to not profile       */
+    char*            ProfilePath;          /* Where to write the profile on exit      */
+    SFG_Profiler*    Profiler;             /* The profile, while profiling            */
 
     int              MajorVersion;         /* Major OpenGL context version  */
     int              MinorVersion;         /* Minor OpenGL context version  */
     int              ContextFlags;         /* OpenGL context flags          */
     int              ContextProfile;       /* OpenGL context profile        */
     int              HasOpenGL20;          /* fgInitGL2 could find all OpenGL 2.0 functions */
+    int              GLVersion;            /* Version of the last context, major*10+minor */
     FGError          ErrorFunc;            /* User defined error handler    */
     FGWarning        WarningFunc;          /* User defined warning handler  */
 };
@@ -380,6 +412,30 @@ struct tagSFG_Timer
  * A window and its OpenGL context. The contents of this structure
  * are highly dependent on the target operating system we aim at...
  */
+/* Per-context GL objects and state for drawing text, see fg_font_atlas.c */
+typedef struct tagSFG_TextRenderer SFG_TextRenderer;
+/* Per-context GL objects for tessellating the teapot family, see fg_teapot_gpu.c */
+typedef struct tagSFG_Tessellator SFG_Tessellator;
+/* Per-context ring buffer of streamed vertices, see fg_stream.c */
+typedef struct tagSFG_StreamBuffer SFG_StreamBuffer;
+/* Per-context ring of pixel buffers for glutReadFrameAsync, see fg_readback.c */
+typedef struct tagSFG_Readback SFG_Readback;
+
+/* freeglut's shadow of the GL bindings of a context, see fg_gl2.c. -1 is unknown. */
+#define FREEGLUT_GL_STATE_ATTRIBS  16
+
+typedef struct tagSFG_GLState SFG_GLState;
+struct tagSFG_GLState
+{
+    int             Depth;           /* Of nested fgGLStateBegin calls   */
+    GLint           ArrayBuffer;
+    GLint           DrawIndirectBuffer;
+    GLint           VertexArray;
+    GLint           Program;
+    GLint           ElementArrayBuffer;  /* Of the bound vertex array    */
+    GLint           Attribs[ FREEGLUT_GL_STATE_ATTRIBS ];  /* Enabled, likewise */
+};
+
 typedef struct tagSFG_Context SFG_Context;
 struct tagSFG_Context
 {
@@ -397,6 +453,19 @@ struct tagSFG_Context
     GLint           attribute_v_coord;
     GLint           attribute_v_normal;
     GLint           attribute_v_texture;
+    GLint           attribute_v_glyph_offset;  /* Stroke font glyph origins */
+    GLint           uniform_shape;   /* fg_shape[] of glutGetShapeShaderSource */
+
+    SFG_TextRenderer* TextRenderer;  /* Created on first text output     */
+
+    SFG_List        Shapes;          /* Shape buffers, see fg_shape_cache.c */
+    size_t          ShapesSize;      /* Their total size, in bytes       */
+
+    SFG_Tessellator* Tessellator;    /* Created on first teapot drawn    */
+    GLuint          ShapeVertexArray;  /* Empty, for the procedural shapes */
+    SFG_StreamBuffer* Stream;        /* Created on first streamed draw   */
+    SFG_Readback*   Readback;        /* Created on first frame read back */
+    SFG_GLState     GLState;
 };
 
 
@@ -535,6 +604,15 @@ do                                                             \
 #define FETCH_WCB(window,cbname) \
     ((window).CallBacks[WCB_ ## cbname])
 
+/*
+ * Time a scope, while profiling; the two must pair up. See fg_profile.c.
+ */
+#define FREEGLUT_PROFILE_BEGIN(name,kind,window) \
+    do { if( fgState.Profiler ) fgProfileBegin( (name), (kind), (window) ); } while( 0 )
+
+#define FREEGLUT_PROFILE_END() \
+    do { if( fgState.Profiler ) fgProfileEnd( ); } while( 0 )
+
 /*
  * INVOKE_WCB() is used as:
  *
@@ -551,7 +629,7 @@ do                                                             \
  * ...so the parentheses are REQUIRED in the {arg_list}.
  *
  * NOTE that it does a sanity-check and also sets the
- * current window.
+ * current window, and that the call is profiled.
  *
  */
 #if TARGET_HOST_MS_WINDOWS && !defined(_WIN32_WCE) /* FIXME: also WinCE? */
@@ -562,7 +640,9 @@ do                                            \
     {                                         \
         FGCB ## cbname func = (FGCB ## cbname)(FETCH_WCB( window, cbname )); \
         fgSetWindow( &window );               \
+        FREEGLUT_PROFILE_BEGIN( #cbname, FG_PROFILE_CALLBACK, (window).ID ); \
         func arg_list;                        \
+        FREEGLUT_PROFILE_END( );              \
     }                                         \
 } while( 0 )
 #else
@@ -572,7 +652,9 @@ do                                            \
     if( FETCH_WCB( window, cbname ) )         \
     {                                         \
         fgSetWindow( &window );               \
+        FREEGLUT_PROFILE_BEGIN( #cbname, FG_PROFILE_CALLBACK, (window).ID ); \
         ((FGCB ## cbname)FETCH_WCB( window, cbname )) arg_list; \
+        FREEGLUT_PROFILE_END( );              \
     }                                         \
 } while( 0 )
 #endif
@@ -662,6 +744,14 @@ struct tagSFG_Menu
     SFG_MenuEntry      *ActiveEntry;  /* Currently active entry in the menu  */
     SFG_Window         *Window;       /* Window for menu                     */
     SFG_Window         *ParentWindow; /* Window in which the menu is invoked */
+
+    SFG_MenuEntry     **EntryTable;   /* The entries by row, for hit testing */
+    int                 NumEntries;
+
+    GLuint              CacheTexture; /* The contents without highlighting,  */
+    int                 CacheWidth;   /* in the menu window's context        */
+    int                 CacheHeight;
+    GLboolean           CacheValid;   /* Cleared when the entries change     */
 };
 
 /* This is a menu entry */
@@ -788,6 +878,123 @@ struct tagSFG_StrokeFont
     const SFG_StrokeChar** Characters;          /* The characters mapping    */
 };
 
+/* The GL objects and state used for text output in a context */
+#define FREEGLUT_NUM_STROKE_FONTS  2
+
+struct tagSFG_TextRenderer
+{
+    /* Bitmap fonts, see fg_font_atlas.c */
+    GLuint   Program;               /* Created on first text output       */
+    GLint    AtlasUniform;
+    GLint    ColorUniform;
+    GLint    TransformUniform;
+    GLuint   Texture;               /* The atlas, uploaded to this context */
+    GLuint   VertexArray;           /* 0 if VAOs are not available        */
+
+    GLfloat  Position[ 2 ];         /* Text position, in window coords    */
+    GLfloat  Color[ 4 ];            /* Text colour                        */
+
+    /* Stroke fonts as distance fields, see fg_font_atlas.c */
+    GLuint   DistanceProgram;
+    GLint    DistanceAtlasUniform;
+    GLint    DistanceColorUniform;
+    GLint    DistanceTransformUniform;
+    GLint    DistanceParamsUniform;
+    GLuint   DistanceTexture;
+
+    /* 2D batches, see fg_batch.c */
+    GLuint   BatchProgram;
+    GLint    BatchTextureUniform;
+    GLint    BatchImageUniform;
+    GLint    BatchTransformUniform;
+    GLuint   BatchVertexArray;      /* 0 if VAOs are not available        */
+
+    /* Stroke fonts, see fg_font_stroke.c */
+    GLuint   StrokeBuffers[ FREEGLUT_NUM_STROKE_FONTS ]; /* Glyph segments */
+};
+
+/* A string laid out in a font, cached by fg_font_layout.c */
+typedef struct tagSFG_TextLayout SFG_TextLayout;
+struct tagSFG_TextLayout
+{
+    SFG_Node        Node;           /* In least recently used order       */
+    SFG_TextLayout* HashNext;       /* The next layout in the same bucket */
+    const void*     Font;           /* An SFG_Font or an SFG_StrokeFont   */
+    unsigned int    Hash;
+    unsigned char*  String;         /* A copy of the string, unterminated */
+    int             Length;
+
+    GLfloat         Width;          /* Of the longest line                */
+    GLfloat         EndX, EndY;     /* Where the next string would start  */
+
+    GLfloat*        Vertices;       /* Atlas quads, built on first output */
+    int             Glyphs;
+};
+
+
+/* The shapes of fg_geometry.c and fg_teapot.c */
+#define FG_SHAPE_CUBE                   1
+#define FG_SHAPE_DODECAHEDRON           2
+#define FG_SHAPE_ICOSAHEDRON            3
+#define FG_SHAPE_OCTAHEDRON             4
+#define FG_SHAPE_RHOMBICDODECAHEDRON    5
+#define FG_SHAPE_TETRAHEDRON            6
+#define FG_SHAPE_SPHERE                 7
+#define FG_SHAPE_CONE                   8
+#define FG_SHAPE_CYLINDER               9
+#define FG_SHAPE_TORUS                  10
+#define FG_SHAPE_TEAPOT                 11
+#define FG_SHAPE_TEACUP                 12
+#define FG_SHAPE_TEASPOON               13
+#define FG_SHAPE_SIERPINSKI_SPONGE      14
+
+/* What a shape's vertices depend on */
+typedef struct tagSFG_ShapeKey SFG_ShapeKey;
+struct tagSFG_ShapeKey
+{
+    int             Shape;          /* One of the FG_SHAPE_* values       */
+    GLboolean       Wire;
+    GLfloat         Params[ 4 ];    /* Sizes, as passed to glut*()        */
+    GLint           Divisions[ 2 ]; /* Slices and stacks, sides and rings */
+};
+
+/* A shape in buffer objects of a context, see fg_shape_cache.c */
+typedef struct tagSFG_Shape SFG_Shape;
+struct tagSFG_Shape
+{
+    SFG_Node        Node;           /* In least recently drawn order      */
+    SFG_ShapeKey    Key;
+    GLboolean       Cached;         /* Kept in the context's Shapes list  */
+    size_t          Size;           /* Of the buffers, in bytes           */
+
+    GLuint          VertexBuffer;   /* Interleaved vertices               */
+    GLuint          IndexBuffer;    /* 0 if drawn without indices         */
+    GLuint          VertexArray;    /* 0 if VAOs are not available        */
+    GLint           Attributes[ 3 ];/* The locations VertexArray is for   */
+    GLsizei         Stride;
+    GLenum          NormalType;     /* GL_SHORT (normalized) or GL_FLOAT  */
+    GLboolean       HasTexture;
+
+    /* The draw call, see fgCreateShape */
+    GLsizei         NumVertices;
+    GLenum          Mode;
+    GLenum          IndexType;      /* 0 if drawn without indices         */
+    GLsizei         NumIndices;
+    GLsizei         NumParts;       /* Strips, between restart indices    */
+    GLsizei         NumVertPerPart;
+    GLsizei*        PartCounts;     /* For glMultiDrawElements, if used   */
+    GLvoid**        PartOffsets;
+};
+
+/* The GL objects that tessellate the teapot family in a context */
+struct tagSFG_Tessellator
+{
+    GLuint          Programs[ 2 ];  /* Solid and wire, 0 if not built     */
+    GLint           PatchUniforms[ 2 ];
+    GLint           ParamsUniforms[ 2 ];
+    GLuint          VertexArray;
+};
+
 
 /* -- JOYSTICK-SPECIFIC STRUCTURES AND TYPES ------------------------------- */
 /*
@@ -1042,6 +1249,112 @@ void fgDeactivateMenu( SFG_Window *window );
  */
 void fgDisplayMenu( void );
 
+/*
+ * Bitmap font output through a glyph atlas texture, for contexts that do
+ * not have glBitmap. Defined in fg_font_atlas.c file.
+ */
+SFG_TextRenderer* fgTextRenderer( void );
+GLboolean fgFontAtlasEnabled( void );
+void fgFontAtlasString( SFG_Font* font, const unsigned char* string, int length );
+void fgDistanceFieldString( SFG_StrokeFont* font, GLfloat pixelHeight,
+                            const unsigned char* string, int length );
+SFG_TextLayout* fgFontAtlasLayout( SFG_Font* font, const unsigned char* string, int length );
+GLuint fgFontAtlasTexture( void );
+void fgDestroyTextRenderer( SFG_Window* window );
+
+/* Batched 2D output for the menus, see fg_batch.c */
+void fgBatchBegin( int width, int height );
+void fgBatchStrip( const GLfloat* points, int count, const GLfloat* color );
+void fgBatchImage( GLuint texture, GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1 );
+void fgBatchBitmapString( SFG_Font* font, GLfloat x, GLfloat y, const unsigned char* string,
+                          const GLfloat* color );
+void fgBatchEnd( void );
+
+/* The layout cache of repeated strings, see fg_font_layout.c */
+SFG_TextLayout* fgBitmapLayout( SFG_Font* font, const unsigned char* string, int length );
+SFG_TextLayout* fgStrokeLayout( SFG_StrokeFont* font, const unsigned char* string, int length );
+void fgDestroyTextLayouts( void );
+
+/* Stroke font output from precompiled glyph geometry, see fg_font_stroke.c */
+void fgStrokeString( SFG_StrokeFont* font, const unsigned char* string, int length,
+                     GLboolean joinDots );
+
+/* Shapes in buffer objects for OpenGL (ES) 2.0, see fg_shape_cache.c */
+void fgInitShapeKey( SFG_ShapeKey* key, int shape, GLboolean wire,
+                     GLfloat param0, GLfloat param1, GLint divisions0, GLint divisions1 );
+SFG_Shape* fgFindShape( const SFG_ShapeKey* key );
+SFG_Shape* fgCreateShape( const SFG_ShapeKey* key,
+                          const GLfloat* vertices, const GLfloat* normals, const GLfloat* textcs,
+                          GLsizei numVertices, GLenum mode,
+                          const GLuint* vertIdxs, GLsizei numParts, GLsizei numVertPerPart,
+                          const GLuint* vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 );
+SFG_Shape* fgCreateShapeFromBuffer( const SFG_ShapeKey* key, GLuint vertexBuffer,
+                                    GLsizei numVertices, GLenum mode, GLenum normalType,
+                                    GLboolean hasTexture );
+void fgDrawShape( SFG_Shape* shape );
+void fgReleaseShape( SFG_Shape* shape );
+void fgDestroyShapes( SFG_Window* window );
+
+/* The tessellated teapot, teacup and teaspoon, see fg_teapot.c */
+void fgDestroyTeasets( void );
+
+/* Their tessellation on the GPU, see fg_teapot_gpu.c */
+SFG_Shape* fgTessellateTeaset( const SFG_ShapeKey* key, const GLfloat* patches, GLsizei numPatches,
+                               int nSubDivs, GLfloat scale );
+void fgDestroyTessellator( SFG_Window* window );
+
+/* Shapes generated in the vertex shader, see fg_geometry_procedural.c */
+GLboolean fgDrawProceduralShape( const SFG_ShapeKey* key );
+GLboolean fgDrawProceduralPolyhedron( const SFG_ShapeKey* key, GLfloat scale,
+                                      const GLfloat* vertices, GLsizei numVertices,
+                                      const GLubyte* vertIndices, GLsizei numFaces, GLsizei numEdgePerFace,
+                                      const GLfloat* normals );
+void fgDestroyProceduralShapes( SFG_Window* window );
+
+/* Shapes baked into a file and mapped, see fg_shape_blob.c */
+GLboolean fgBakingShapes( void );
+GLboolean fgBakeShape( const SFG_ShapeKey* key,
+                       const GLfloat* vertices, const GLfloat* normals, const GLfloat* textcs,
+                       GLsizei numVertices, GLenum mode,
+                       const GLuint* vertIdxs, GLsizei numParts, GLsizei numVertPerPart,
+                       const GLuint* vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 );
+GLboolean fgDrawBakedShape( const SFG_ShapeKey* key );
+void fgUnmapShapes( void );
+
+/* Transient vertices and draw commands, see fg_stream.c */
+GLvoid* fgStreamMap( size_t size, GLuint* buffer, size_t* offset );
+void fgStreamUnmap( void );
+GLuint fgStreamUpload( const GLvoid* data, size_t size, size_t* offset );
+void fgDestroyStream( SFG_Window* window );
+
+/* Asynchronous frame readback, see fg_readback.c */
+void fgPollReadback( SFG_Window* window );
+void fgDestroyReadback( SFG_Window* window );
+
+/* Recording frames to disk, see fg_record.c */
+void fgRecordFrame( SFG_Window* window );
+void fgStopRecording( SFG_Window* window );
+int fgRecordGet( GLenum eWhat );
+
+/* Profiling the main loop, see fg_profile.c */
+void fgProfileFrame( void );
+void fgProfileBegin( const char* name, int kind, int window );
+void fgProfileEnd( void );
+void fgProfileExit( void );
+
+/* The shadow of a context's GL bindings, see fg_gl2.c */
+void fgGLStateInvalidate( SFG_Context* context );
+
+/* Shape drawing, see fg_geometry.c */
+GLboolean fgDrawCachedShape( const SFG_ShapeKey* key );
+void fghDrawGeometryWire( const SFG_ShapeKey* key,
+                          GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
+                          GLuint *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
+                          GLuint *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 );
+void fghDrawGeometrySolid( const SFG_ShapeKey* key,
+                           GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
+                           GLuint *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart );
+
 /* Elapsed time as per glutGet(GLUT_ELAPSED_TIME). */
 fg_time_t fgElapsedTime( void );
 
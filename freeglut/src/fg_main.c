@@ -233,7 +233,9 @@ static void fghCheckTimers( void )
         fgListRemove( &fgState.Timers, &timer->Node );
         fgListAppend( &fgState.FreeTimers, &timer->Node );
 
+        FREEGLUT_PROFILE_BEGIN( "Timer", FG_PROFILE_CALLBACK, 0 );
         timer->Callback( timer->ID );
+        FREEGLUT_PROFILE_END( );
     }
 }
 
@@ -445,16 +447,32 @@ void fgProcessWork(SFG_Window *window)
  */
 void FGAPIENTRY glutMainLoopEvent( void )
 {
+    /* A frame of the profile runs from one iteration to the next */
+    if( fgState.ProfileFrames || fgState.Profiler )
+        fgProfileFrame( );
+
     /* Process input */
+    FREEGLUT_PROFILE_BEGIN( "fgPlatformProcessSingleEvent", FG_PROFILE_PHASE, 0 );
 	fgPlatformProcessSingleEvent ();
+    FREEGLUT_PROFILE_END( );
 
     if( fgState.Timers.First )
+    {
+        FREEGLUT_PROFILE_BEGIN( "fghCheckTimers", FG_PROFILE_PHASE, 0 );
         fghCheckTimers( );
+        FREEGLUT_PROFILE_END( );
+    }
     if (fgState.NumActiveJoysticks>0)   /* If zero, don't poll joysticks */
+    {
+        FREEGLUT_PROFILE_BEGIN( "fghCheckJoystickPolls", FG_PROFILE_PHASE, 0 );
         fghCheckJoystickPolls( );
+        FREEGLUT_PROFILE_END( );
+    }
 
     /* Perform work on the window (position, reshape, display, etc) */
+    FREEGLUT_PROFILE_BEGIN( "fghProcessWork", FG_PROFILE_PHASE, 0 );
     fghProcessWork( );
+    FREEGLUT_PROFILE_END( );
 
     /* Check OpenGL error state if requested.
      * Don't call if no more open windows (can happen if user closes window from
@@ -463,7 +481,9 @@ void FGAPIENTRY glutMainLoopEvent( void )
     if (fgState.GLDebugSwitch && fgStructure.CurrentWindow)
         glutReportErrors( );
 
+    FREEGLUT_PROFILE_BEGIN( "fgCloseWindows", FG_PROFILE_PHASE, 0 );
     fgCloseWindows( );
+    FREEGLUT_PROFILE_END( );
 }
 
 /*
@@ -507,10 +527,16 @@ void FGAPIENTRY glutMainLoop( void )
                     fgStructure.CurrentWindow->IsMenu )
                     /* fail safe */
                     fgSetWindow( window );
+                FREEGLUT_PROFILE_BEGIN( "Idle", FG_PROFILE_CALLBACK, 0 );
                 fgState.IdleCallback( );
+                FREEGLUT_PROFILE_END( );
             }
             else
+            {
+                FREEGLUT_PROFILE_BEGIN( "fghSleepForEvents", FG_PROFILE_PHASE, 0 );
                 fghSleepForEvents( );
+                FREEGLUT_PROFILE_END( );
+            }
         }
     }
 
@@ -28,6 +28,7 @@
 #define FREEGLUT_BUILDING_LIB
 #include <GL/freeglut.h>
 #include "fg_internal.h"
+#include "fg_gl2.h"
 
 
 /* -- DEFINITIONS ---------------------------------------------------------- */
@@ -90,6 +91,10 @@ static SFG_MenuEntry *fghFindMenuEntry( SFG_Menu* menu, int index )
     SFG_MenuEntry *entry;
     int i = 1;
 
+    /* The table is rebuilt by fghCalculateMenuBoxSize on every change */
+    if( menu->EntryTable )
+        return ( index >= 1 && index <= menu->NumEntries ) ? menu->EntryTable[ index - 1 ] : NULL;
+
     for( entry = (SFG_MenuEntry *)menu->Entries.First;
          entry;
          entry = (SFG_MenuEntry *)entry->Node.Next )
@@ -151,29 +156,28 @@ static GLboolean fghCheckMenuStatus( SFG_Menu* menu )
     SFG_MenuEntry* menuEntry;
     int x, y;
 
-    /* First of all check any of the active sub menus... */
-    for( menuEntry = (SFG_MenuEntry *)menu->Entries.First;
-         menuEntry;
-         menuEntry = (SFG_MenuEntry *)menuEntry->Node.Next )
+    /*
+     * First of all check the active sub menu, if any. Only the active
+     * entry can be highlighted, so there is no need to look at the others.
+     */
+    menuEntry = menu->ActiveEntry;
+    if( menuEntry && menuEntry->SubMenu && menuEntry->IsActive )
     {
-        if( menuEntry->SubMenu && menuEntry->IsActive )
-        {
-            /*
-             * OK, have the sub-menu checked, too. If it returns GL_TRUE, it
-             * will mean that it caught the mouse cursor and we do not need
-             * to regenerate the activity list, and so our parents do...
-             */
-            GLboolean return_status;
+        /*
+         * OK, have the sub-menu checked, too. If it returns GL_TRUE, it
+         * will mean that it caught the mouse cursor and we do not need
+         * to regenerate the activity list, and so our parents do...
+         */
+        GLboolean return_status;
 
-            menuEntry->SubMenu->Window->State.MouseX =
-                menu->Window->State.MouseX + menu->X - menuEntry->SubMenu->X;
-            menuEntry->SubMenu->Window->State.MouseY =
-                menu->Window->State.MouseY + menu->Y - menuEntry->SubMenu->Y;
-            return_status = fghCheckMenuStatus( menuEntry->SubMenu );
+        menuEntry->SubMenu->Window->State.MouseX =
+            menu->Window->State.MouseX + menu->X - menuEntry->SubMenu->X;
+        menuEntry->SubMenu->Window->State.MouseY =
+            menu->Window->State.MouseY + menu->Y - menuEntry->SubMenu->Y;
+        return_status = fghCheckMenuStatus( menuEntry->SubMenu );
 
-            if ( return_status )
-                return GL_TRUE;
-        }
+        if ( return_status )
+            return GL_TRUE;
     }
 
     /* That much about our sub menus, let's get to checking the current menu: */
@@ -288,7 +292,7 @@ static GLboolean fghCheckMenuStatus( SFG_Menu* menu )
 /*
  * Displays a menu box and all of its submenus (if they are active)
  */
-static void fghDisplayMenuBox( SFG_Menu* menu )
+static void fghDisplayMenuBox11( SFG_Menu* menu )
 {
     SFG_MenuEntry *menuEntry;
     int i;
@@ -402,6 +406,184 @@ static void fghDisplayMenuBox( SFG_Menu* menu )
     }
 }
 
+/*
+ * Adds the bevelled frame and background of a menu to a batch
+ */
+static void fghBatchMenuFrame( SFG_Menu* menu )
+{
+    const GLfloat w = ( GLfloat )menu->Width, h = ( GLfloat )menu->Height;
+    const GLfloat b = ( GLfloat )FREEGLUT_MENU_BORDER;
+    GLfloat points[ 12 ];
+
+    static const GLfloat light[ 4 ] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const GLfloat dark [ 4 ] = { 0.5f, 0.5f, 0.5f, 1.0f };
+
+#define FGH_POINT(n,x,y) ( points[ 2 * (n) ] = (x), points[ 2 * (n) + 1 ] = (y) )
+
+    /* The top left and bottom right bevels, then the background */
+    FGH_POINT( 0, w    , 0     ); FGH_POINT( 1, w - b, b     );
+    FGH_POINT( 2, 0    , 0     ); FGH_POINT( 3, b    , b     );
+    FGH_POINT( 4, 0    , h     ); FGH_POINT( 5, b    , h - b );
+    fgBatchStrip( points, 6, light );
+
+    FGH_POINT( 0, 0    , h     ); FGH_POINT( 1, b    , h - b );
+    FGH_POINT( 2, w    , h     ); FGH_POINT( 3, w - b, h - b );
+    FGH_POINT( 4, w    , 0     ); FGH_POINT( 5, w - b, b     );
+    fgBatchStrip( points, 6, dark );
+
+    FGH_POINT( 0, b    , b     ); FGH_POINT( 1, w - b, b     );
+    FGH_POINT( 2, b    , h - b ); FGH_POINT( 3, w - b, h - b );
+    fgBatchStrip( points, 4, menu_pen_back );
+
+#undef FGH_POINT
+}
+
+/*
+ * Adds the entry in row i of a menu to a batch, with its highlight if
+ * highlighted is set
+ */
+static void fghBatchMenuEntry( SFG_Menu* menu, SFG_Font* font, SFG_MenuEntry* menuEntry,
+                               int i, GLboolean highlighted )
+{
+    const GLfloat w = ( GLfloat )menu->Width;
+    const GLfloat b = ( GLfloat )FREEGLUT_MENU_BORDER;
+    const int entryHeight = FREEGLUT_MENUENTRY_HEIGHT(menu->Font);
+    const GLfloat* pen = highlighted ? menu_pen_hfore : menu_pen_fore;
+    GLfloat points[ 8 ];
+
+    if( highlighted )
+    {
+        const GLfloat y0 = ( GLfloat )( ( i + 0 ) * entryHeight ) + b;
+        const GLfloat y1 = ( GLfloat )( ( i + 1 ) * entryHeight ) + b;
+
+        points[ 0 ] = b;     points[ 1 ] = y0;
+        points[ 2 ] = w - b; points[ 3 ] = y0;
+        points[ 4 ] = b;     points[ 5 ] = y1;
+        points[ 6 ] = w - b; points[ 7 ] = y1;
+        fgBatchStrip( points, 4, menu_pen_hback );
+    }
+
+    fgBatchBitmapString( font, 2 * b,
+                         ( GLfloat )( ( i + 1 ) * entryHeight -
+                                      ( int )( entryHeight * 0.3 - FREEGLUT_MENU_BORDER ) ),
+                         (unsigned char *)menuEntry->Text, pen );
+
+    if( menuEntry->SubMenu )
+    {
+        const GLfloat x_base = w - 2 - glutBitmapWidth( menu->Font, '_' );
+        const GLfloat y_base = ( GLfloat )( i * entryHeight ) + b;
+
+        points[ 0 ] = x_base; points[ 1 ] = y_base + 2 * b;
+        points[ 2 ] = w - 2;  points[ 3 ] = y_base + ( GLfloat )( ( entryHeight + FREEGLUT_MENU_BORDER ) / 2 );
+        points[ 4 ] = x_base; points[ 5 ] = y_base + entryHeight - b;
+        fgBatchStrip( points, 3, pen );
+    }
+}
+
+/*
+ * Renders the contents of a menu without any highlighting into its cache
+ * texture, if it is out of date. Returns GL_FALSE without framebuffer objects.
+ */
+static GLboolean fghUpdateMenuCache( SFG_Menu* menu, SFG_Font* font )
+{
+    SFG_MenuEntry *menuEntry;
+    GLint framebuffer, texture, viewport[ 4 ];
+    GLuint fbo;
+    GLenum status;
+    int i;
+
+    if( !fghGenFramebuffers || menu->Width <= 0 || menu->Height <= 0 )
+        return GL_FALSE;
+
+    if( menu->CacheTexture && menu->CacheValid &&
+        menu->CacheWidth == menu->Width && menu->CacheHeight == menu->Height )
+        return GL_TRUE;
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+    if( !menu->CacheTexture )
+        glGenTextures( 1, &menu->CacheTexture );
+    glBindTexture( GL_TEXTURE_2D, menu->CacheTexture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, FGH_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, FGH_CLAMP_TO_EDGE );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, menu->Width, menu->Height, 0,
+                  GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    glBindTexture( GL_TEXTURE_2D, texture );
+
+    glGetIntegerv( FGH_FRAMEBUFFER_BINDING, &framebuffer );
+    glGetIntegerv( GL_VIEWPORT, viewport );
+    fghGenFramebuffers( 1, &fbo );
+    fghBindFramebuffer( FGH_FRAMEBUFFER, fbo );
+    fghFramebufferTexture2D( FGH_FRAMEBUFFER, FGH_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                             menu->CacheTexture, 0 );
+    status = fghCheckFramebufferStatus( FGH_FRAMEBUFFER );
+
+    if( status == FGH_FRAMEBUFFER_COMPLETE )
+    {
+        glViewport( 0, 0, menu->Width, menu->Height );
+
+        fgBatchBegin( menu->Width, menu->Height );
+        fghBatchMenuFrame( menu );
+        for( menuEntry = (SFG_MenuEntry *)menu->Entries.First, i = 0;
+             menuEntry;
+             menuEntry = (SFG_MenuEntry *)menuEntry->Node.Next, ++i )
+            fghBatchMenuEntry( menu, font, menuEntry, i, GL_FALSE );
+        fgBatchEnd( );
+
+        glViewport( viewport[ 0 ], viewport[ 1 ], viewport[ 2 ], viewport[ 3 ] );
+    }
+
+    fghBindFramebuffer( FGH_FRAMEBUFFER, framebuffer );
+    fghDeleteFramebuffers( 1, &fbo );
+
+    if( status != FGH_FRAMEBUFFER_COMPLETE )
+    {
+        glDeleteTextures( 1, &menu->CacheTexture );
+        menu->CacheTexture = 0;
+        return GL_FALSE;
+    }
+
+    menu->CacheWidth = menu->Width;
+    menu->CacheHeight = menu->Height;
+    menu->CacheValid = GL_TRUE;
+    return GL_TRUE;
+}
+
+/*
+ * The same as fghDisplayMenuBox11, through batches (see fg_batch.c). The
+ * contents are drawn from the menu's cache texture when possible, only
+ * the active entry being drawn over it.
+ */
+static void fghDisplayMenuBox20( SFG_Menu* menu )
+{
+    SFG_MenuEntry *menuEntry;
+    SFG_Font* font = fghFontByID( menu->Font );
+    int i;
+
+    if( fghUpdateMenuCache( menu, font ) )
+    {
+        fgBatchBegin( glutGet( GLUT_WINDOW_WIDTH ), glutGet( GLUT_WINDOW_HEIGHT ) );
+        fgBatchImage( menu->CacheTexture, 0.0f, 0.0f,
+                      ( GLfloat )menu->Width, ( GLfloat )menu->Height );
+
+        menuEntry = menu->ActiveEntry;
+        if( menuEntry && menuEntry->IsActive )
+            fghBatchMenuEntry( menu, font, menuEntry, menuEntry->Ordinal, GL_TRUE );
+
+        fgBatchEnd( );
+        return;
+    }
+
+    fgBatchBegin( glutGet( GLUT_WINDOW_WIDTH ), glutGet( GLUT_WINDOW_HEIGHT ) );
+    fghBatchMenuFrame( menu );
+    for( menuEntry = (SFG_MenuEntry *)menu->Entries.First, i = 0;
+         menuEntry;
+         menuEntry = (SFG_MenuEntry *)menuEntry->Node.Next, ++i )
+        fghBatchMenuEntry( menu, font, menuEntry, i, menuEntry->IsActive );
+    fgBatchEnd( );
+}
+
 /*
  * Private static function to set the parent window of a submenu and all
  * of its submenus.
@@ -437,35 +619,72 @@ void fgDisplayMenu( void )
 
     fgSetWindow( menu->Window );
 
-    glPushAttrib( GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT | GL_LIGHTING_BIT |
-                  GL_POLYGON_BIT );
-
-    glDisable( GL_DEPTH_TEST );
-    glDisable( GL_TEXTURE_2D );
-    glDisable( GL_LIGHTING   );
-    glDisable( GL_CULL_FACE  );
-
-    glMatrixMode( GL_PROJECTION );
-    glPushMatrix( );
-    glLoadIdentity( );
-    glOrtho(
-         0, glutGet( GLUT_WINDOW_WIDTH  ),
-         glutGet( GLUT_WINDOW_HEIGHT ), 0,
-        -1, 1
-    );
+    /* Core profiles have neither immediate mode nor the matrix stacks */
+    if( fgState.HasOpenGL20 )
+    {
+        const GLboolean depthTest = glIsEnabled( GL_DEPTH_TEST );
+        const GLboolean cullFace = glIsEnabled( GL_CULL_FACE );
+#ifndef GL_ES_VERSION_2_0
+        GLint polygonMode[ 2 ];
+
+        /* Menus are filled whatever the application's polygon mode, as
+         * GL_POLYGON_BIT saw to below */
+        glGetIntegerv( GL_POLYGON_MODE, polygonMode );
+        glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+#endif
+
+        glDisable( GL_DEPTH_TEST );
+        glDisable( GL_CULL_FACE  );
+
+        fghDisplayMenuBox20( menu );
+
+        if( depthTest )
+            glEnable( GL_DEPTH_TEST );
+        if( cullFace )
+            glEnable( GL_CULL_FACE );
+#ifndef GL_ES_VERSION_2_0
+        /* Core profiles only take GL_FRONT_AND_BACK, and so only have one mode */
+        if( polygonMode[ 0 ] == polygonMode[ 1 ] )
+            glPolygonMode( GL_FRONT_AND_BACK, polygonMode[ 0 ] );
+        else
+        {
+            glPolygonMode( GL_FRONT, polygonMode[ 0 ] );
+            glPolygonMode( GL_BACK, polygonMode[ 1 ] );
+        }
+#endif
+    }
+    else
+    {
+        glPushAttrib( GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT | GL_LIGHTING_BIT |
+                      GL_POLYGON_BIT );
+
+        glDisable( GL_DEPTH_TEST );
+        glDisable( GL_TEXTURE_2D );
+        glDisable( GL_LIGHTING   );
+        glDisable( GL_CULL_FACE  );
+
+        glMatrixMode( GL_PROJECTION );
+        glPushMatrix( );
+        glLoadIdentity( );
+        glOrtho(
+             0, glutGet( GLUT_WINDOW_WIDTH  ),
+             glutGet( GLUT_WINDOW_HEIGHT ), 0,
+            -1, 1
+        );
 
-    glMatrixMode( GL_MODELVIEW );
-    glPushMatrix( );
-    glLoadIdentity( );
+        glMatrixMode( GL_MODELVIEW );
+        glPushMatrix( );
+        glLoadIdentity( );
 
-    fghDisplayMenuBox( menu );
+        fghDisplayMenuBox11( menu );
 
-    glPopAttrib( );
+        glPopAttrib( );
 
-    glMatrixMode( GL_PROJECTION );
-    glPopMatrix( );
-    glMatrixMode( GL_MODELVIEW );
-    glPopMatrix( );
+        glMatrixMode( GL_PROJECTION );
+        glPopMatrix( );
+        glMatrixMode( GL_MODELVIEW );
+        glPopMatrix( );
+    }
 
     glutSwapBuffers( );
 
@@ -730,6 +949,33 @@ void fgDeactivateMenu( SFG_Window *window )
     }
 }
 
+/*
+ * Rebuilds the table of a menu's entries by row, and has its cached
+ * contents redrawn
+ */
+static void fghUpdateMenuEntryTable( SFG_Menu* menu )
+{
+    SFG_MenuEntry* menuEntry;
+    int n = fgListLength( &menu->Entries ), i;
+
+    free( menu->EntryTable );
+    menu->EntryTable = NULL;
+    menu->NumEntries = 0;
+    menu->CacheValid = GL_FALSE;
+
+    if( n )
+    {
+        menu->EntryTable = malloc( n * sizeof( SFG_MenuEntry* ) );
+        if( !menu->EntryTable )
+            fgError( "Failed to allocate memory in fghUpdateMenuEntryTable" );
+        for( menuEntry = ( SFG_MenuEntry * )menu->Entries.First, i = 0;
+             menuEntry;
+             menuEntry = ( SFG_MenuEntry * )menuEntry->Node.Next, i++ )
+            menu->EntryTable[ i ] = menuEntry;
+        menu->NumEntries = n;
+    }
+}
+
 /*
  * Recalculates current menu's box size
  */
@@ -741,6 +987,8 @@ void fghCalculateMenuBoxSize( void )
     /* Make sure there is a current menu set */
     freeglut_return_if_fail( fgStructure.CurrentMenu );
 
+    fghUpdateMenuEntryTable( fgStructure.CurrentMenu );
+
     /* The menu's box size depends on the menu entries: */
     for( menuEntry = ( SFG_MenuEntry * )fgStructure.CurrentMenu->Entries.First;
          menuEntry;
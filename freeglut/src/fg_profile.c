@@ -0,0 +1,502 @@
+/*
+ * fg_profile.c
+ *
+ * Timing the phases of the main loop and the callbacks it makes, frame
+ * by frame.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+
+#if !TARGET_HOST_MS_WINDOWS
+#   include <time.h>
+#endif
+
+/*
+ * With GLUT_PROFILE_FRAMES set, or the GLUT_PROFILE environment variable,
+ * every glutMainLoopEvent starts a frame, which lasts until the next one
+ * and so also covers the idle callback or the wait for events. Within a
+ * frame, the phases of glutMainLoopEvent, every window callback and
+ * timer, and the scopes of glutProfileBegin and glutProfileEnd are timed
+ * with the monotonic clock, however deeply nested.
+ *
+ * The last GLUT_PROFILE_FRAMES frames are kept in a ring, each with room
+ * for FGH_PROFILE_SCOPES scopes; those beyond are counted but lost.
+ * glutProfileWriteTrace writes them as a Chrome trace, to be opened with
+ * chrome://tracing or Perfetto, and glutProfileWriteSummary writes the
+ * median, 99th percentile and worst time of each scope. With GLUT_PROFILE
+ * set to a file name, the trace is written there and the summary to
+ * stderr when freeglut is deinitialized.
+ *
+ * Scopes still open at the end of a frame are closed there. Scope names
+ * are kept, not copied, so they are to be string literals or to live as
+ * long as the profile does.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_PROFILE_SCOPES  256     /* Kept per frame */
+#define FGH_PROFILE_DEPTH   64      /* Open at once   */
+
+typedef struct tagSFG_ProfileScope SFG_ProfileScope;
+struct tagSFG_ProfileScope
+{
+    const char*     Name;
+    int             Kind;           /* FG_PROFILE_PHASE and so on         */
+    int             Window;         /* Its ID, or 0                       */
+    fg_time_t       Begin, End;     /* In nanoseconds from the start      */
+};
+
+typedef struct tagSFG_ProfileFrame SFG_ProfileFrame;
+struct tagSFG_ProfileFrame
+{
+    int             Number;
+    fg_time_t       Begin, End;
+    int             NumScopes;
+    int             Lost;           /* Scopes there was no room for       */
+    SFG_ProfileScope Scopes[ FGH_PROFILE_SCOPES ];
+};
+
+struct tagSFG_Profiler
+{
+    int             NumFrames;      /* Frames kept, besides the current   */
+    SFG_ProfileFrame* Frames;       /* The ring, of NumFrames + 1         */
+    int             Current;        /* The frame being timed              */
+    int             Complete;       /* Frames timed, at most NumFrames    */
+    int             Number;         /* Of the current frame               */
+    fg_time_t       Start;
+
+    int             Depth;          /* Of open scopes                     */
+    int             Open[ FGH_PROFILE_DEPTH ];  /* Their indices, or -1   */
+};
+
+/* Durations of one scope, for the summary */
+typedef struct tagSFG_ProfileSample SFG_ProfileSample;
+struct tagSFG_ProfileSample
+{
+    int             Key;
+    fg_time_t       Duration;
+};
+
+typedef struct tagSFG_ProfileKey SFG_ProfileKey;
+struct tagSFG_ProfileKey
+{
+    const char*     Name;
+    int             Kind;
+    int             Window;
+};
+
+static const char* fghProfileKinds[ ] = { "frame", "phase", "callback", "user" };
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * Nanoseconds of a monotonic clock, finer than fgSystemTime's milliseconds
+ */
+static fg_time_t fghProfileTime( void )
+{
+#if TARGET_HOST_MS_WINDOWS
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+
+    if( !frequency.QuadPart )
+        QueryPerformanceFrequency( &frequency );
+    QueryPerformanceCounter( &now );
+    return (fg_time_t)( now.QuadPart / frequency.QuadPart ) * 1000000000 +
+           (fg_time_t)( now.QuadPart % frequency.QuadPart ) * 1000000000 / frequency.QuadPart;
+#elif defined( CLOCK_MONOTONIC )
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (fg_time_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#else
+    return fgSystemTime( ) * 1000000;
+#endif
+}
+
+static SFG_ProfileFrame* fghCurrentProfileFrame( SFG_Profiler* profiler )
+{
+    return &profiler->Frames[ profiler->Current ];
+}
+
+/*
+ * The i-th complete frame kept, oldest first
+ */
+static SFG_ProfileFrame* fghProfileFrame( SFG_Profiler* profiler, int i )
+{
+    const int slots = profiler->NumFrames + 1;
+
+    return &profiler->Frames[ ( profiler->Current - profiler->Complete + i + slots ) % slots ];
+}
+
+static void fghBeginProfileFrame( SFG_Profiler* profiler, fg_time_t now )
+{
+    SFG_ProfileFrame* frame = fghCurrentProfileFrame( profiler );
+
+    frame->Number = profiler->Number;
+    frame->Begin = now;
+    frame->End = now;
+    frame->NumScopes = 0;
+    frame->Lost = 0;
+    profiler->Depth = 0;
+}
+
+static void fghFreeProfiler( void )
+{
+    free( fgState.Profiler->Frames );
+    free( fgState.Profiler );
+    fgState.Profiler = NULL;
+}
+
+/*
+ * Writes a string as a JSON one, quotes included
+ */
+static void fghWriteJSONString( FILE* file, const char* string )
+{
+    fputc( '"', file );
+    for( ; *string; string++ )
+    {
+        const unsigned char c = (unsigned char)*string;
+        if( c == '"' || c == '\\' )
+            fprintf( file, "\\%c", c );
+        else if( c < 0x20 )
+            fprintf( file, "\\u%04x", c );
+        else
+            fputc( c, file );
+    }
+    fputc( '"', file );
+}
+
+static void fghWriteTraceEvent( FILE* file, GLboolean first, const char* name, int kind,
+                                fg_time_t begin, fg_time_t end )
+{
+    fprintf( file, "%s\n{\"name\":", first ? "" : "," );
+    fghWriteJSONString( file, name );
+    fprintf( file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f",
+             fghProfileKinds[ kind ], begin / 1000.0, ( end - begin ) / 1000.0 );
+}
+
+static int fghFindProfileKey( SFG_ProfileKey** keys, int* numKeys, const char* name,
+                              int kind, int window )
+{
+    int i;
+
+    for( i = 0; i < *numKeys; i++ )
+        if( ( *keys )[ i ].Kind == kind && ( *keys )[ i ].Window == window &&
+            ( ( *keys )[ i ].Name == name || !strcmp( ( *keys )[ i ].Name, name ) ) )
+            return i;
+
+    if( !( *numKeys & ( *numKeys - 1 ) ) )
+    {
+        /* At powers of two, grow */
+        SFG_ProfileKey* grown = realloc( *keys, sizeof( SFG_ProfileKey ) * ( *numKeys ? *numKeys * 2 : 16 ) );
+        if( !grown )
+            fgError( "Failed to allocate memory in glutProfileWriteSummary" );
+        *keys = grown;
+    }
+    ( *keys )[ *numKeys ].Name = name;
+    ( *keys )[ *numKeys ].Kind = kind;
+    ( *keys )[ *numKeys ].Window = window;
+    return ( *numKeys )++;
+}
+
+static int fghCompareProfileSamples( const void* a, const void* b )
+{
+    const SFG_ProfileSample* sa = a;
+    const SFG_ProfileSample* sb = b;
+
+    if( sa->Key != sb->Key )
+        return sa->Key < sb->Key ? -1 : 1;
+    if( sa->Duration != sb->Duration )
+        return sa->Duration < sb->Duration ? -1 : 1;
+    return 0;
+}
+
+/*
+ * The nearest-rank percentile of n sorted samples
+ */
+static double fghProfilePercentile( const SFG_ProfileSample* samples, int n, int percent )
+{
+    int rank = ( n * percent + 99 ) / 100;
+
+    if( rank < 1 )
+        rank = 1;
+    return samples[ rank - 1 ].Duration / 1000000.0;
+}
+
+static FILE* fghOpenProfileFile( const char* path )
+{
+    return path ? fopen( path, "w" ) : stderr;
+}
+
+static GLboolean fghCloseProfileFile( FILE* file )
+{
+    GLboolean failed = ferror( file ) != 0;
+
+    if( file != stderr )
+        failed = fclose( file ) != 0 || failed;
+    return !failed;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Ends the frame being timed and begins the next, for every
+ * glutMainLoopEvent. Also makes GLUT_PROFILE_FRAMES take effect.
+ */
+void fgProfileFrame( void )
+{
+    SFG_Profiler* profiler = fgState.Profiler;
+    const fg_time_t now = fghProfileTime( );
+
+    if( profiler && profiler->NumFrames != fgState.ProfileFrames )
+    {
+        fghFreeProfiler( );
+        profiler = NULL;
+    }
+    if( fgState.ProfileFrames <= 0 )
+        return;
+
+    if( !profiler )
+    {
+        profiler = calloc( 1, sizeof( SFG_Profiler ) );
+        if( profiler )
+            profiler->Frames = malloc( sizeof( SFG_ProfileFrame ) * ( fgState.ProfileFrames + 1 ) );
+        if( !profiler || !profiler->Frames )
+            fgError( "Failed to allocate memory in fgProfileFrame" );
+        profiler->NumFrames = fgState.ProfileFrames;
+        profiler->Start = now;
+        fgState.Profiler = profiler;
+    }
+    else
+    {
+        SFG_ProfileFrame* frame = fghCurrentProfileFrame( profiler );
+        int depth;
+
+        /* Close what is left open */
+        for( depth = profiler->Depth < FGH_PROFILE_DEPTH ? profiler->Depth : FGH_PROFILE_DEPTH;
+             depth > 0; depth-- )
+            if( profiler->Open[ depth - 1 ] >= 0 )
+                frame->Scopes[ profiler->Open[ depth - 1 ] ].End = now - profiler->Start;
+        frame->End = now - profiler->Start;
+
+        if( profiler->Complete < profiler->NumFrames )
+            profiler->Complete++;
+        profiler->Current = ( profiler->Current + 1 ) % ( profiler->NumFrames + 1 );
+        profiler->Number++;
+    }
+
+    fghBeginProfileFrame( profiler, now - profiler->Start );
+}
+
+/*
+ * Opens a scope in the current frame. Called only while profiling, see
+ * FREEGLUT_PROFILE_BEGIN.
+ */
+void fgProfileBegin( const char* name, int kind, int window )
+{
+    SFG_Profiler* profiler = fgState.Profiler;
+    SFG_ProfileFrame* frame = fghCurrentProfileFrame( profiler );
+    int index = -1;
+
+    if( frame->NumScopes < FGH_PROFILE_SCOPES )
+    {
+        SFG_ProfileScope* scope = &frame->Scopes[ frame->NumScopes ];
+        index = frame->NumScopes++;
+        scope->Name = name;
+        scope->Kind = kind;
+        scope->Window = window;
+        scope->Begin = scope->End = fghProfileTime( ) - profiler->Start;
+    }
+    else
+        frame->Lost++;
+
+    if( profiler->Depth < FGH_PROFILE_DEPTH )
+        profiler->Open[ profiler->Depth ] = index;
+    profiler->Depth++;
+}
+
+/*
+ * Closes the innermost scope open, if any
+ */
+void fgProfileEnd( void )
+{
+    SFG_Profiler* profiler = fgState.Profiler;
+
+    if( !profiler->Depth )
+        return;
+
+    profiler->Depth--;
+    if( profiler->Depth < FGH_PROFILE_DEPTH && profiler->Open[ profiler->Depth ] >= 0 )
+        fghCurrentProfileFrame( profiler )->Scopes[ profiler->Open[ profiler->Depth ] ].End =
+            fghProfileTime( ) - profiler->Start;
+}
+
+/*
+ * Writes the profile of GLUT_PROFILE and frees it, on deinitialization
+ */
+void fgProfileExit( void )
+{
+    if( fgState.Profiler && fgState.ProfilePath )
+    {
+        if( !glutProfileWriteTrace( fgState.ProfilePath ) )
+            fgWarning( "Failed to write the profile to \"%s\"", fgState.ProfilePath );
+        glutProfileWriteSummary( NULL );
+    }
+    if( fgState.Profiler )
+        fghFreeProfiler( );
+
+    free( fgState.ProfilePath );
+    fgState.ProfilePath = NULL;
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Times a scope of the application's own, while profiling, until the
+ * matching glutProfileEnd. The name is kept, not copied.
+ */
+void FGAPIENTRY glutProfileBegin( const char* name )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutProfileBegin" );
+
+    if( fgState.Profiler )
+        fgProfileBegin( name ? name : "", FG_PROFILE_USER,
+                        fgStructure.CurrentWindow ? fgStructure.CurrentWindow->ID : 0 );
+}
+
+void FGAPIENTRY glutProfileEnd( void )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutProfileEnd" );
+
+    if( fgState.Profiler )
+        fgProfileEnd( );
+}
+
+/*
+ * Writes the frames kept as a Chrome trace, in JSON. Returns the number
+ * of frames written, 0 if there are none or the file cannot be written.
+ */
+int FGAPIENTRY glutProfileWriteTrace( const char* path )
+{
+    SFG_Profiler* profiler = fgState.Profiler;
+    FILE* file;
+    int i, j;
+
+    if( !profiler || !profiler->Complete || !path )
+        return 0;
+    file = fopen( path, "w" );
+    if( !file )
+        return 0;
+
+    fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+    for( i = 0; i < profiler->Complete; i++ )
+    {
+        const SFG_ProfileFrame* frame = fghProfileFrame( profiler, i );
+
+        fghWriteTraceEvent( file, i == 0, "Frame", 0, frame->Begin, frame->End );
+        fprintf( file, ",\"args\":{\"frame\":%d,\"lost\":%d}}", frame->Number, frame->Lost );
+
+        for( j = 0; j < frame->NumScopes; j++ )
+        {
+            const SFG_ProfileScope* scope = &frame->Scopes[ j ];
+
+            fghWriteTraceEvent( file, GL_FALSE, scope->Name, scope->Kind, scope->Begin, scope->End );
+            if( scope->Window )
+                fprintf( file, ",\"args\":{\"window\":%d}", scope->Window );
+            fputc( '}', file );
+        }
+    }
+    fprintf( file, "\n]}\n" );
+
+    return fghCloseProfileFile( file ) ? profiler->Complete : 0;
+}
+
+/*
+ * Writes the median, 99th percentile and worst time of each scope, over
+ * the frames kept, as text, to stderr if the path is NULL. Returns the
+ * number of frames summed up, 0 if there are none or the file cannot be
+ * written.
+ */
+int FGAPIENTRY glutProfileWriteSummary( const char* path )
+{
+    SFG_Profiler* profiler = fgState.Profiler;
+    SFG_ProfileSample* samples;
+    SFG_ProfileKey* keys = NULL;
+    int numSamples = 0, numKeys = 0;
+    FILE* file;
+    int i, j, first;
+
+    if( !profiler || !profiler->Complete )
+        return 0;
+
+    for( i = 0; i < profiler->Complete; i++ )
+        numSamples += 1 + fghProfileFrame( profiler, i )->NumScopes;
+    samples = malloc( sizeof( SFG_ProfileSample ) * numSamples );
+    if( !samples )
+        fgError( "Failed to allocate memory in glutProfileWriteSummary" );
+
+    /* Sorting by scope, then duration, leaves the samples of each in order */
+    numSamples = 0;
+    for( i = 0; i < profiler->Complete; i++ )
+    {
+        const SFG_ProfileFrame* frame = fghProfileFrame( profiler, i );
+
+        samples[ numSamples ].Key = fghFindProfileKey( &keys, &numKeys, "Frame", 0, 0 );
+        samples[ numSamples++ ].Duration = frame->End - frame->Begin;
+        for( j = 0; j < frame->NumScopes; j++ )
+        {
+            const SFG_ProfileScope* scope = &frame->Scopes[ j ];
+            samples[ numSamples ].Key = fghFindProfileKey( &keys, &numKeys, scope->Name,
+                                                           scope->Kind, scope->Window );
+            samples[ numSamples++ ].Duration = scope->End - scope->Begin;
+        }
+    }
+    qsort( samples, numSamples, sizeof( SFG_ProfileSample ), fghCompareProfileSamples );
+
+    file = fghOpenProfileFile( path );
+    if( file )
+    {
+        fprintf( file, "freeglut profile of %d frames, in milliseconds\n", profiler->Complete );
+        fprintf( file, "%-32s %-8s %6s %8s %10s %10s %10s\n",
+                 "scope", "kind", "window", "calls", "p50", "p99", "max" );
+        for( first = 0; first < numSamples; first = j )
+        {
+            const SFG_ProfileKey* key = &keys[ samples[ first ].Key ];
+
+            for( j = first; j < numSamples && samples[ j ].Key == samples[ first ].Key; j++ )
+                ;
+            fprintf( file, "%-32s %-8s %6d %8d %10.3f %10.3f %10.3f\n",
+                     key->Name, fghProfileKinds[ key->Kind ], key->Window, j - first,
+                     fghProfilePercentile( samples + first, j - first, 50 ),
+                     fghProfilePercentile( samples + first, j - first, 99 ),
+                     samples[ j - 1 ].Duration / 1000000.0 );
+        }
+    }
+
+    free( samples );
+    free( keys );
+    return file && fghCloseProfileFile( file ) ? profiler->Complete : 0;
+}
+
+/*** END OF FILE ***/
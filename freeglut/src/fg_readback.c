@@ -0,0 +1,428 @@
+/*
+ * fg_readback.c
+ *
+ * Reading frames back asynchronously, through a ring of pixel buffers.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * glutReadFrameAsync reads a rectangle of the framebuffer bound for
+ * reading, the window's own or one of the application's, into one of a
+ * ring of pixel buffers rather than into memory. glReadPixels then
+ * returns without waiting for the frame to be drawn, and the copy goes
+ * on while the next frames are.
+ *
+ * A fence is put after each read. Reads are handed to their callbacks
+ * oldest first, once their fences have signalled: when the buffers are
+ * swapped, on the next read, and by glutReadFrameFlush. A read whose
+ * buffer is needed again before then is waited for. The callback is
+ * given the buffer mapped, so the pixels are not copied on the way.
+ *
+ * The ring has GLUT_READBACK_DEPTH buffers. Without fences (OpenGL
+ * before 3.2) reads are handed over only when their buffer is needed
+ * again, that many reads later. Without glMapBufferRange (OpenGL (ES)
+ * before 3.0) the pixels are read into memory and handed over at once.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_READBACK_DEPTH      3   /* Reads in flight, by default */
+#define FGH_READBACK_MAX_DEPTH  16
+
+/* Nanoseconds to wait for a fence between checks that it did not fail */
+#define FGH_READBACK_FENCE_TIMEOUT  1000000000ull
+
+/* Pixel buffers, and pack row lengths and skips, are not in OpenGL ES 2.0 */
+#ifdef GL_ES_VERSION_2_0
+#   define FGH_HAS_PACK_BUFFER  ( fgState.GLVersion >= 30 )
+#   define FGH_HAS_PACK_LAYOUT  ( fgState.GLVersion >= 30 )
+#else
+#   define FGH_HAS_PACK_BUFFER  ( fgState.GLVersion >= 21 )
+#   define FGH_HAS_PACK_LAYOUT  GL_TRUE
+#endif
+
+typedef void (* FGCBReadFrame)( const void* pixels, int width, int height, int frame, void* userData );
+
+typedef struct tagSFG_ReadbackSlot SFG_ReadbackSlot;
+struct tagSFG_ReadbackSlot
+{
+    GLuint          Buffer;
+    size_t          BufferSize;
+    fghGLsync       Fence;          /* After the read into the buffer     */
+    int             Width, Height;
+    int             Frame;
+    FGCBReadFrame   Callback;
+    void*           UserData;
+};
+
+struct tagSFG_Readback
+{
+    int             Depth;          /* Slots of the ring in use           */
+    int             Head;           /* The slot to read into next         */
+    int             Pending;        /* Reads not handed over, before Head */
+    int             Frames;         /* Reads so far, which number them    */
+    GLboolean       Delivering;     /* In a callback                      */
+    SFG_ReadbackSlot Slots[ FGH_READBACK_MAX_DEPTH ];
+
+    GLubyte*        Staging;        /* Without pixel buffers              */
+    size_t          StagingSize;
+};
+
+/* The state glReadPixels packs by, saved to be restored afterwards */
+typedef struct tagSFG_PackState SFG_PackState;
+struct tagSFG_PackState
+{
+    GLint Buffer, Alignment, RowLength, SkipPixels, SkipRows;
+};
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static int fghReadbackDepth( void )
+{
+    if( fgState.ReadbackDepth <= 0 )
+        return FGH_READBACK_DEPTH;
+    return fgState.ReadbackDepth < FGH_READBACK_MAX_DEPTH ? fgState.ReadbackDepth
+                                                          : FGH_READBACK_MAX_DEPTH;
+}
+
+/*
+ * Saves the state we are about to change, then packs tightly packed rows
+ * into client memory, whatever the application had set
+ */
+static void fghBeginPack( SFG_PackState* saved )
+{
+    glGetIntegerv( GL_PACK_ALIGNMENT, &saved->Alignment );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );  /* RGBA rows are always 4-byte aligned */
+
+    if( FGH_HAS_PACK_LAYOUT )
+    {
+        glGetIntegerv( FGH_PACK_ROW_LENGTH, &saved->RowLength );
+        glGetIntegerv( FGH_PACK_SKIP_PIXELS, &saved->SkipPixels );
+        glGetIntegerv( FGH_PACK_SKIP_ROWS, &saved->SkipRows );
+        glPixelStorei( FGH_PACK_ROW_LENGTH, 0 );
+        glPixelStorei( FGH_PACK_SKIP_PIXELS, 0 );
+        glPixelStorei( FGH_PACK_SKIP_ROWS, 0 );
+    }
+
+    saved->Buffer = 0;
+    if( FGH_HAS_PACK_BUFFER )
+    {
+        glGetIntegerv( FGH_PIXEL_PACK_BUFFER_BINDING, &saved->Buffer );
+        fghBindBuffer( FGH_PIXEL_PACK_BUFFER, 0 );
+    }
+}
+
+static void fghEndPack( const SFG_PackState* saved )
+{
+    glPixelStorei( GL_PACK_ALIGNMENT, saved->Alignment );
+    if( FGH_HAS_PACK_LAYOUT )
+    {
+        glPixelStorei( FGH_PACK_ROW_LENGTH, saved->RowLength );
+        glPixelStorei( FGH_PACK_SKIP_PIXELS, saved->SkipPixels );
+        glPixelStorei( FGH_PACK_SKIP_ROWS, saved->SkipRows );
+    }
+    if( FGH_HAS_PACK_BUFFER )
+        fghBindBuffer( FGH_PIXEL_PACK_BUFFER, saved->Buffer );
+}
+
+/*
+ * Returns the readback ring of the current window, creating it if needed
+ */
+static SFG_Readback* fghReadback( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+    SFG_Readback* readback = window->Window.Readback;
+
+    if( !readback )
+    {
+        readback = calloc( 1, sizeof( SFG_Readback ) );
+        if( !readback )
+            fgError( "Failed to allocate memory in fghReadback" );
+        readback->Depth = fghReadbackDepth( );
+        window->Window.Readback = readback;
+    }
+    return readback;
+}
+
+/*
+ * Deletes the buffer and fence of a slot
+ */
+static void fghReleaseReadbackSlot( SFG_ReadbackSlot* slot )
+{
+    if( slot->Fence )
+    {
+        fghDeleteSync( slot->Fence );
+        slot->Fence = NULL;
+    }
+    if( slot->Buffer )
+    {
+        fghDeleteBuffers( 1, &slot->Buffer );
+        slot->Buffer = 0;
+        slot->BufferSize = 0;
+    }
+}
+
+static SFG_ReadbackSlot* fghOldestReadback( SFG_Readback* readback )
+{
+    return &readback->Slots[ ( readback->Head - readback->Pending + readback->Depth ) %
+                             readback->Depth ];
+}
+
+/*
+ * Tells whether the oldest read is done, without waiting for it
+ */
+static GLboolean fghReadbackDone( SFG_Readback* readback )
+{
+    SFG_ReadbackSlot* slot = fghOldestReadback( readback );
+
+    if( !slot->Fence )
+        return GL_FALSE;
+    return fghClientWaitSync( slot->Fence, FGH_SYNC_FLUSH_COMMANDS_BIT, 0 ) != FGH_TIMEOUT_EXPIRED;
+}
+
+/*
+ * Hands the oldest read to its callback, waiting for it if need be.
+ * This leaves its buffer bound to GL_PIXEL_PACK_BUFFER.
+ */
+static void fghDeliverOldestReadback( SFG_Readback* readback )
+{
+    SFG_ReadbackSlot* slot = fghOldestReadback( readback );
+    const size_t size = (size_t)slot->Width * slot->Height * 4;
+    GLvoid* pixels;
+
+    if( slot->Fence )
+    {
+        GLenum status;
+        do
+            status = fghClientWaitSync( slot->Fence, FGH_SYNC_FLUSH_COMMANDS_BIT,
+                                        FGH_READBACK_FENCE_TIMEOUT );
+        while( status == FGH_TIMEOUT_EXPIRED );
+
+        fghDeleteSync( slot->Fence );
+        slot->Fence = NULL;
+    }
+    readback->Pending--;
+
+    fghBindBuffer( FGH_PIXEL_PACK_BUFFER, slot->Buffer );
+    pixels = fghMapBufferRange( FGH_PIXEL_PACK_BUFFER, 0, size, FGH_MAP_READ_BIT );
+    if( !pixels )
+    {
+        fgWarning( "glutReadFrameAsync: failed to map frame %d", slot->Frame );
+        return;
+    }
+
+    readback->Delivering = GL_TRUE;
+    slot->Callback( pixels, slot->Width, slot->Height, slot->Frame, slot->UserData );
+    readback->Delivering = GL_FALSE;
+
+    /* The callback may have bound a buffer of its own */
+    fghBindBuffer( FGH_PIXEL_PACK_BUFFER, slot->Buffer );
+    fghUnmapBuffer( FGH_PIXEL_PACK_BUFFER );
+}
+
+/*
+ * Hands over the reads that are done, or all of them when waiting
+ */
+static void fghDeliverReadback( SFG_Readback* readback, GLboolean wait )
+{
+    while( readback->Pending && ( wait || fghReadbackDone( readback ) ) )
+        fghDeliverOldestReadback( readback );
+}
+
+/*
+ * Reads into memory and calls back at once, without pixel buffers
+ */
+static int fghReadFrameSync( SFG_Readback* readback, int x, int y, int width, int height,
+                             FGCBReadFrame callback, void* userData )
+{
+    const size_t size = (size_t)width * height * 4;
+
+    if( readback->StagingSize < size )
+    {
+        free( readback->Staging );
+        readback->Staging = malloc( size );
+        if( !readback->Staging )
+            fgError( "Failed to allocate memory in glutReadFrameAsync" );
+        readback->StagingSize = size;
+    }
+    glReadPixels( x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, readback->Staging );
+
+    readback->Delivering = GL_TRUE;
+    callback( readback->Staging, width, height, readback->Frames, userData );
+    readback->Delivering = GL_FALSE;
+
+    return readback->Frames++;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Hands over the reads of the current window that are done, for every
+ * glutSwapBuffers
+ */
+void fgPollReadback( SFG_Window* window )
+{
+    SFG_Readback* readback = window->Window.Readback;
+    GLint packBuffer;
+
+    freeglut_return_if_fail( readback && readback->Pending && !readback->Delivering );
+    freeglut_return_if_fail( fghReadbackDone( readback ) );
+
+    glGetIntegerv( FGH_PIXEL_PACK_BUFFER_BINDING, &packBuffer );
+    fghDeliverReadback( readback, GL_FALSE );
+    fghBindBuffer( FGH_PIXEL_PACK_BUFFER, packBuffer );
+}
+
+/*
+ * Hands over the reads left and releases the ring of a window, which is
+ * current
+ */
+void fgDestroyReadback( SFG_Window* window )
+{
+    SFG_Readback* readback = window->Window.Readback;
+    GLint packBuffer;
+    int i;
+
+    freeglut_return_if_fail( readback );
+
+    if( fgStructure.CurrentWindow == window )
+    {
+        if( readback->Pending && !readback->Delivering )
+        {
+            glGetIntegerv( FGH_PIXEL_PACK_BUFFER_BINDING, &packBuffer );
+            fghDeliverReadback( readback, GL_TRUE );
+            fghBindBuffer( FGH_PIXEL_PACK_BUFFER, packBuffer );
+        }
+        for( i = 0; i < FGH_READBACK_MAX_DEPTH; i++ )
+            fghReleaseReadbackSlot( &readback->Slots[ i ] );
+    }
+
+    free( readback->Staging );
+    free( readback );
+    window->Window.Readback = NULL;
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Queues a read of the given rectangle of the framebuffer bound for
+ * reading, as RGBA bytes with the bottom row first. The callback is
+ * given them some frames later, with the window current; they are valid
+ * until it returns. Returns the number of the frame, which the callback
+ * is also given, or -1 if nothing is read.
+ *
+ * The back buffer of a window is undefined after glutSwapBuffers, so
+ * this is to be called before it.
+ */
+int FGAPIENTRY glutReadFrameAsync( int x, int y, int width, int height,
+                                   FGCBReadFrame callback, void* userData )
+{
+    SFG_Readback* readback;
+    SFG_ReadbackSlot* slot;
+    const size_t size = (size_t)width * height * 4;
+    SFG_PackState saved;
+    int depth, i;
+
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutReadFrameAsync" );
+    FREEGLUT_EXIT_IF_NO_WINDOW ( "glutReadFrameAsync" );
+    freeglut_return_val_if_fail( callback && width > 0 && height > 0, -1 );
+
+    readback = fghReadback( );
+    if( readback->Delivering )
+    {
+        fgWarning( "glutReadFrameAsync: called from a readback callback" );
+        return -1;
+    }
+
+    fghBeginPack( &saved );
+
+    if( !fghMapBufferRange )
+    {
+        int frame = fghReadFrameSync( readback, x, y, width, height, callback, userData );
+        fghEndPack( &saved );
+        return frame;
+    }
+
+    /* Hand over what is done, and make room for this read */
+    fghDeliverReadback( readback, GL_FALSE );
+    depth = fghReadbackDepth( );
+    if( depth != readback->Depth )
+    {
+        fghDeliverReadback( readback, GL_TRUE );
+        for( i = depth; i < FGH_READBACK_MAX_DEPTH; i++ )
+            fghReleaseReadbackSlot( &readback->Slots[ i ] );
+        readback->Depth = depth;
+        readback->Head = 0;
+    }
+    else if( readback->Pending == readback->Depth )
+        fghDeliverOldestReadback( readback );
+
+    slot = &readback->Slots[ readback->Head ];
+    if( !slot->Buffer )
+        fghGenBuffers( 1, &slot->Buffer );
+    fghBindBuffer( FGH_PIXEL_PACK_BUFFER, slot->Buffer );
+    if( slot->BufferSize < size )
+    {
+        fghBufferData( FGH_PIXEL_PACK_BUFFER, size, NULL, FGH_STREAM_READ );
+        slot->BufferSize = size;
+    }
+
+    glReadPixels( x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    if( fghFenceSync )
+        slot->Fence = fghFenceSync( FGH_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+    slot->Width = width;
+    slot->Height = height;
+    slot->Frame = readback->Frames;
+    slot->Callback = callback;
+    slot->UserData = userData;
+    readback->Head = ( readback->Head + 1 ) % readback->Depth;
+    readback->Pending++;
+
+    fghEndPack( &saved );
+    return readback->Frames++;
+}
+
+/*
+ * Waits for the reads of the current window and hands them over
+ */
+void FGAPIENTRY glutReadFrameFlush( void )
+{
+    SFG_Readback* readback;
+    GLint packBuffer;
+
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutReadFrameFlush" );
+    FREEGLUT_EXIT_IF_NO_WINDOW ( "glutReadFrameFlush" );
+
+    readback = fgStructure.CurrentWindow->Window.Readback;
+    freeglut_return_if_fail( readback && readback->Pending && !readback->Delivering );
+
+    glGetIntegerv( FGH_PIXEL_PACK_BUFFER_BINDING, &packBuffer );
+    fghDeliverReadback( readback, GL_TRUE );
+    fghBindBuffer( FGH_PIXEL_PACK_BUFFER, packBuffer );
+}
+
+/*** END OF FILE ***/
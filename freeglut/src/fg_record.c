@@ -0,0 +1,807 @@
+/*
+ * fg_record.c
+ *
+ * Recording a window's frames to disk, on a thread of their own.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* For O_DIRECT */
+#define _GNU_SOURCE
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+
+#if TARGET_HOST_MS_WINDOWS
+#   define FGH_RECORD_THREAD  1
+#   include <limits.h>     /* LONG_MAX */
+#   if defined( _MSC_VER ) && _MSC_VER < 1900
+#       define snprintf _snprintf
+#   endif
+#elif ( TARGET_HOST_POSIX_X11 || TARGET_HOST_HEADLESS ) && defined( __GNUC__ )
+#   define FGH_RECORD_THREAD  1
+#   define FGH_RECORD_POSIX   1
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <pthread.h>
+#   include <semaphore.h>
+#   include <unistd.h>
+#endif
+
+/*
+ * glutRecordStart records every frame the current window swaps, until
+ * glutRecordStop, as raw RGBA bytes, a Y4M video or a sequence of PNG
+ * files, all with the top row first.
+ *
+ * Frames are read back with glutReadFrameAsync, so the render loop does
+ * not wait for them, and copied into a pool of GLUT_RECORD_POOL_FRAMES
+ * frames. A writer thread encodes and writes them. The pool is a ring
+ * with the render loop at one end and the writer at the other, each
+ * moving its own counter, so neither locks; a semaphore only wakes the
+ * writer. When the disk cannot keep up and the pool is full, frames are
+ * dropped rather than waited for, and counted in
+ * GLUT_RECORD_FRAMES_DROPPED.
+ *
+ * Files are written in chunks of FGH_RECORD_CHUNK_SIZE bytes from an
+ * aligned buffer. On Linux they are opened with O_DIRECT, so that long
+ * recordings do not fill the page cache; the last, partial chunk is
+ * written through the cache. Where there are no threads, frames are
+ * written as they are read back.
+ *
+ * PNG files are not compressed, which costs disk space but keeps the
+ * writer well ahead of the render loop.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_RECORD_POOL_FRAMES  8
+#define FGH_RECORD_CHUNK_SIZE   ( 4 * 1024 * 1024 )
+#define FGH_RECORD_ALIGNMENT    4096    /* Of direct I/O */
+
+/* Counters of the ring, each moved by one thread and read by the other */
+#if TARGET_HOST_MS_WINDOWS
+#   define FGH_LOAD( x )        ( (unsigned int)InterlockedCompareExchange( (LONG volatile*)&(x), 0, 0 ) )
+#   define FGH_STORE( x, v )    InterlockedExchange( (LONG volatile*)&(x), (LONG)(v) )
+#elif defined( __GNUC__ )
+#   define FGH_LOAD( x )        __atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+#   define FGH_STORE( x, v )    __atomic_store_n( &(x), (v), __ATOMIC_RELEASE )
+#else
+#   define FGH_LOAD( x )        ( x )
+#   define FGH_STORE( x, v )    ( (x) = (v) )
+#endif
+
+/* A file written in aligned chunks */
+typedef struct tagSFG_RecordSink SFG_RecordSink;
+struct tagSFG_RecordSink
+{
+#if FGH_RECORD_POSIX
+    int             File;
+    GLboolean       Direct;         /* Opened with O_DIRECT               */
+#else
+    FILE*           File;
+#endif
+    GLubyte*        Chunk;
+    size_t          Used;
+    GLboolean       Failed;
+};
+
+typedef struct tagSFG_RecordFrame SFG_RecordFrame;
+struct tagSFG_RecordFrame
+{
+    GLubyte*        Pixels;         /* RGBA, top row first                */
+    int             Number;         /* Of glutReadFrameAsync              */
+};
+
+typedef struct tagSFG_Recorder SFG_Recorder;
+struct tagSFG_Recorder
+{
+    SFG_Window*     Window;
+    int             Format;
+    char*           Path;           /* Or pattern of PNG file names       */
+    int             Width, Height;
+
+    SFG_RecordFrame* Frames;        /* The pool, filled in turn           */
+    int             PoolSize;
+    int             Head;           /* The frame to fill next             */
+    int             Tail;           /* The frame to write next            */
+    unsigned int    Queued;         /* Frames filled, by the render loop  */
+    unsigned int    Written;        /* Frames done with, by the writer    */
+    unsigned int    Failed;         /* Of those, the ones not written     */
+    unsigned int    Stopping;
+    int             Dropped;        /* For want of a free frame           */
+
+    SFG_RecordSink  Sink;           /* Of raw and Y4M recordings          */
+    GLubyte*        Scratch;        /* Y4M planes or a PNG row            */
+
+    GLboolean       Threaded;
+#if TARGET_HOST_MS_WINDOWS
+    HANDLE          Thread;
+    HANDLE          Ready;
+#elif FGH_RECORD_POSIX
+    pthread_t       Thread;
+    sem_t           Ready;
+#endif
+};
+
+/* The PNG being written */
+typedef struct tagSFG_PngStream SFG_PngStream;
+struct tagSFG_PngStream
+{
+    SFG_RecordSink* Sink;
+    unsigned long   Crc;            /* Of the chunk being written         */
+    unsigned long   Adler1, Adler2; /* Of the uncompressed data           */
+    size_t          BlockLeft;      /* In the stored deflate block        */
+    size_t          DataLeft;       /* Uncompressed bytes still to come   */
+};
+
+static SFG_Recorder* fghRecorder = NULL;
+
+/* The counts of the last recording, once stopped */
+static int fghRecordWritten = 0;
+static int fghRecordDropped = 0;
+
+static unsigned long fghCrcTable[ 256 ];
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static GLboolean fghSinkOpen( SFG_RecordSink* sink, const char* path )
+{
+    sink->Used = 0;
+    sink->Failed = GL_FALSE;
+
+#if FGH_RECORD_POSIX
+    sink->File = -1;
+    sink->Direct = GL_FALSE;
+#   ifdef O_DIRECT
+    /* Not every file system takes it */
+    sink->File = open( path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0666 );
+    sink->Direct = sink->File >= 0;
+#   endif
+    if( sink->File < 0 )
+        sink->File = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+    return sink->File >= 0;
+#else
+    sink->File = fopen( path, "wb" );
+    return sink->File != NULL;
+#endif
+}
+
+#if FGH_RECORD_POSIX
+/*
+ * Goes through the page cache from now on, for writes direct I/O does not
+ * take, such as the last, partial chunk
+ */
+static void fghSinkBuffered( SFG_RecordSink* sink )
+{
+#   ifdef O_DIRECT
+    if( sink->Direct )
+        fcntl( sink->File, F_SETFL, fcntl( sink->File, F_GETFL ) & ~O_DIRECT );
+#   endif
+    sink->Direct = GL_FALSE;
+}
+#endif
+
+static void fghSinkFlush( SFG_RecordSink* sink )
+{
+    if( sink->Used && !sink->Failed )
+    {
+#if FGH_RECORD_POSIX
+        size_t done = 0;
+
+        if( sink->Used % FGH_RECORD_ALIGNMENT )
+            fghSinkBuffered( sink );
+        while( done < sink->Used )
+        {
+            ssize_t written = write( sink->File, sink->Chunk + done, sink->Used - done );
+            if( written < 0 && errno == EINTR )
+                continue;
+            if( written < 0 && errno == EINVAL && sink->Direct )
+            {
+                fghSinkBuffered( sink );
+                continue;
+            }
+            if( written <= 0 )
+            {
+                sink->Failed = GL_TRUE;
+                break;
+            }
+            done += (size_t)written;
+        }
+#else
+        if( fwrite( sink->Chunk, sink->Used, 1, sink->File ) != 1 )
+            sink->Failed = GL_TRUE;
+#endif
+    }
+    sink->Used = 0;
+}
+
+static void fghSinkWrite( SFG_RecordSink* sink, const void* data, size_t size )
+{
+    const GLubyte* bytes = data;
+
+    while( size )
+    {
+        size_t part = FGH_RECORD_CHUNK_SIZE - sink->Used;
+        if( part > size )
+            part = size;
+        memcpy( sink->Chunk + sink->Used, bytes, part );
+        sink->Used += part;
+        bytes += part;
+        size -= part;
+        if( sink->Used == FGH_RECORD_CHUNK_SIZE )
+            fghSinkFlush( sink );
+    }
+}
+
+/*
+ * Writes what is left and closes the file, telling whether all of it
+ * was written
+ */
+static GLboolean fghSinkClose( SFG_RecordSink* sink )
+{
+    fghSinkFlush( sink );
+#if FGH_RECORD_POSIX
+    if( close( sink->File ) != 0 )
+        sink->Failed = GL_TRUE;
+#else
+    if( fclose( sink->File ) != 0 )
+        sink->Failed = GL_TRUE;
+#endif
+    return !sink->Failed;
+}
+
+
+static void fghInitCrcTable( void )
+{
+    unsigned long c;
+    int n, k;
+
+    for( n = 0; n < 256; n++ )
+    {
+        c = (unsigned long)n;
+        for( k = 0; k < 8; k++ )
+            c = ( c & 1 ) ? 0xedb88320ul ^ ( c >> 1 ) : c >> 1;
+        fghCrcTable[ n ] = c;
+    }
+}
+
+static void fghPngOut( SFG_PngStream* png, const GLubyte* data, size_t size )
+{
+    unsigned long crc = png->Crc;
+    size_t i;
+
+    for( i = 0; i < size; i++ )
+        crc = fghCrcTable[ ( crc ^ data[ i ] ) & 0xff ] ^ ( crc >> 8 );
+    png->Crc = crc;
+    fghSinkWrite( png->Sink, data, size );
+}
+
+static void fghPutBigEndian( GLubyte* bytes, unsigned long value )
+{
+    bytes[ 0 ] = (GLubyte)( value >> 24 );
+    bytes[ 1 ] = (GLubyte)( value >> 16 );
+    bytes[ 2 ] = (GLubyte)( value >> 8 );
+    bytes[ 3 ] = (GLubyte)value;
+}
+
+static void fghPngChunkStart( SFG_PngStream* png, const char* type, unsigned long size )
+{
+    GLubyte length[ 4 ];
+
+    fghPutBigEndian( length, size );
+    fghSinkWrite( png->Sink, length, 4 );
+    png->Crc = 0xfffffffful;
+    fghPngOut( png, (const GLubyte*)type, 4 );
+}
+
+static void fghPngChunkEnd( SFG_PngStream* png )
+{
+    GLubyte crc[ 4 ];
+
+    fghPutBigEndian( crc, png->Crc ^ 0xfffffffful );
+    fghSinkWrite( png->Sink, crc, 4 );
+}
+
+/*
+ * Writes uncompressed data as stored deflate blocks
+ */
+static void fghPngDeflate( SFG_PngStream* png, const GLubyte* data, size_t size )
+{
+    while( size )
+    {
+        size_t part, i;
+
+        if( !png->BlockLeft )
+        {
+            GLubyte header[ 5 ];
+
+            png->BlockLeft = png->DataLeft < 0xffff ? png->DataLeft : 0xffff;
+            header[ 0 ] = png->BlockLeft == png->DataLeft;    /* The final block */
+            header[ 1 ] = (GLubyte)png->BlockLeft;
+            header[ 2 ] = (GLubyte)( png->BlockLeft >> 8 );
+            header[ 3 ] = (GLubyte)~header[ 1 ];
+            header[ 4 ] = (GLubyte)~header[ 2 ];
+            fghPngOut( png, header, 5 );
+        }
+
+        part = size < png->BlockLeft ? size : png->BlockLeft;
+        for( i = 0; i < part; i++ )
+        {
+            png->Adler1 = ( png->Adler1 + data[ i ] ) % 65521;
+            png->Adler2 = ( png->Adler2 + png->Adler1 ) % 65521;
+        }
+        fghPngOut( png, data, part );
+        data += part;
+        size -= part;
+        png->BlockLeft -= part;
+        png->DataLeft -= part;
+    }
+}
+
+static GLboolean fghWritePng( SFG_Recorder* recorder, const SFG_RecordFrame* frame )
+{
+    static const GLubyte signature[ 8 ] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    static const GLubyte zlibHeader[ 2 ] = { 0x78, 0x01 };
+    const size_t rowSize = 1 + (size_t)recorder->Width * 3;
+    const size_t dataSize = rowSize * recorder->Height;
+    const size_t blocks = ( dataSize + 0xfffe ) / 0xffff;
+    SFG_RecordSink* sink = &recorder->Sink;
+    SFG_PngStream png;
+    GLubyte header[ 13 ];
+    char path[ 4096 ];
+    int x, y;
+
+    snprintf( path, sizeof( path ), recorder->Path, frame->Number );
+    if( !fghSinkOpen( sink, path ) )
+        return GL_FALSE;
+
+    png.Sink = sink;
+    png.Adler1 = 1;
+    png.Adler2 = 0;
+    png.BlockLeft = 0;
+    png.DataLeft = dataSize;
+
+    fghSinkWrite( sink, signature, sizeof( signature ) );
+
+    /* 8 bit RGB: what was drawn, whatever is in the alpha channel */
+    fghPutBigEndian( header, recorder->Width );
+    fghPutBigEndian( header + 4, recorder->Height );
+    header[ 8 ] = 8;
+    header[ 9 ] = 2;
+    header[ 10 ] = header[ 11 ] = header[ 12 ] = 0;
+    fghPngChunkStart( &png, "IHDR", sizeof( header ) );
+    fghPngOut( &png, header, sizeof( header ) );
+    fghPngChunkEnd( &png );
+
+    fghPngChunkStart( &png, "IDAT", (unsigned long)( 2 + blocks * 5 + dataSize + 4 ) );
+    fghPngOut( &png, zlibHeader, sizeof( zlibHeader ) );
+    for( y = 0; y < recorder->Height; y++ )
+    {
+        const GLubyte* pixel = frame->Pixels + (size_t)y * recorder->Width * 4;
+        GLubyte* row = recorder->Scratch;
+
+        *row++ = 0;     /* No filter */
+        for( x = 0; x < recorder->Width; x++, pixel += 4 )
+        {
+            *row++ = pixel[ 0 ];
+            *row++ = pixel[ 1 ];
+            *row++ = pixel[ 2 ];
+        }
+        fghPngDeflate( &png, recorder->Scratch, rowSize );
+    }
+    fghPutBigEndian( header, ( png.Adler2 << 16 ) | png.Adler1 );
+    fghPngOut( &png, header, 4 );
+    fghPngChunkEnd( &png );
+
+    fghPngChunkStart( &png, "IEND", 0 );
+    fghPngChunkEnd( &png );
+
+    return fghSinkClose( sink );
+}
+
+/*
+ * Writes a Y4M frame, in 4:4:4 BT.601 studio range
+ */
+static GLboolean fghWriteY4M( SFG_Recorder* recorder, const SFG_RecordFrame* frame )
+{
+    static const char header[] = "FRAME\n";
+    const size_t pixels = (size_t)recorder->Width * recorder->Height;
+    GLubyte* y = recorder->Scratch;
+    GLubyte* u = y + pixels;
+    GLubyte* v = u + pixels;
+    const GLubyte* rgba = frame->Pixels;
+    size_t i;
+
+    for( i = 0; i < pixels; i++, rgba += 4 )
+    {
+        const int r = rgba[ 0 ], g = rgba[ 1 ], b = rgba[ 2 ];
+        y[ i ] = (GLubyte)( ( (  66 * r + 129 * g +  25 * b + 128 ) >> 8 ) + 16 );
+        u[ i ] = (GLubyte)( ( ( -38 * r -  74 * g + 112 * b + 128 ) >> 8 ) + 128 );
+        v[ i ] = (GLubyte)( ( ( 112 * r -  94 * g -  18 * b + 128 ) >> 8 ) + 128 );
+    }
+
+    fghSinkWrite( &recorder->Sink, header, sizeof( header ) - 1 );
+    fghSinkWrite( &recorder->Sink, recorder->Scratch, pixels * 3 );
+    return !recorder->Sink.Failed;
+}
+
+/*
+ * Writes the oldest frame of the pool and gives it back
+ */
+static void fghWriteRecordFrame( SFG_Recorder* recorder )
+{
+    const SFG_RecordFrame* frame = &recorder->Frames[ recorder->Tail ];
+    GLboolean written;
+
+    switch( recorder->Format )
+    {
+    case GLUT_RECORD_PNG:
+        written = fghWritePng( recorder, frame );
+        break;
+    case GLUT_RECORD_Y4M:
+        written = fghWriteY4M( recorder, frame );
+        break;
+    default:
+        fghSinkWrite( &recorder->Sink, frame->Pixels,
+                      (size_t)recorder->Width * recorder->Height * 4 );
+        written = !recorder->Sink.Failed;
+        break;
+    }
+
+    if( !written )
+        FGH_STORE( recorder->Failed, recorder->Failed + 1 );
+    recorder->Tail = ( recorder->Tail + 1 ) % recorder->PoolSize;
+    FGH_STORE( recorder->Written, recorder->Written + 1 );
+}
+
+#if FGH_RECORD_THREAD
+/*
+ * The writer thread, woken for every frame and to stop
+ */
+static void fghRecordWriter( SFG_Recorder* recorder )
+{
+    for( ;; )
+    {
+#   if TARGET_HOST_MS_WINDOWS
+        WaitForSingleObject( recorder->Ready, INFINITE );
+#   else
+        while( sem_wait( &recorder->Ready ) != 0 && errno == EINTR )
+            ;
+#   endif
+        if( recorder->Written != FGH_LOAD( recorder->Queued ) )
+            fghWriteRecordFrame( recorder );
+        else if( FGH_LOAD( recorder->Stopping ) )
+            break;
+    }
+}
+
+#   if TARGET_HOST_MS_WINDOWS
+static DWORD WINAPI fghRecordThread( LPVOID recorder )
+{
+    fghRecordWriter( recorder );
+    return 0;
+}
+#   else
+static void* fghRecordThread( void* recorder )
+{
+    fghRecordWriter( recorder );
+    return NULL;
+}
+#   endif
+#endif
+
+/*
+ * Starts the writer thread, telling whether there is one
+ */
+static GLboolean fghStartRecordWriter( SFG_Recorder* recorder )
+{
+#if TARGET_HOST_MS_WINDOWS
+    recorder->Ready = CreateSemaphore( NULL, 0, LONG_MAX, NULL );
+    if( !recorder->Ready )
+        return GL_FALSE;
+    recorder->Thread = CreateThread( NULL, 0, fghRecordThread, recorder, 0, NULL );
+    if( !recorder->Thread )
+    {
+        CloseHandle( recorder->Ready );
+        return GL_FALSE;
+    }
+    return GL_TRUE;
+#elif FGH_RECORD_POSIX
+    if( sem_init( &recorder->Ready, 0, 0 ) != 0 )
+        return GL_FALSE;
+    if( pthread_create( &recorder->Thread, NULL, fghRecordThread, recorder ) != 0 )
+    {
+        sem_destroy( &recorder->Ready );
+        return GL_FALSE;
+    }
+    return GL_TRUE;
+#else
+    return GL_FALSE;
+#endif
+}
+
+static void fghWakeRecordWriter( SFG_Recorder* recorder )
+{
+#if TARGET_HOST_MS_WINDOWS
+    ReleaseSemaphore( recorder->Ready, 1, NULL );
+#elif FGH_RECORD_POSIX
+    sem_post( &recorder->Ready );
+#endif
+}
+
+/*
+ * Lets the writer thread write what is queued, and waits for it to end
+ */
+static void fghStopRecordWriter( SFG_Recorder* recorder )
+{
+    FGH_STORE( recorder->Stopping, 1 );
+    fghWakeRecordWriter( recorder );
+#if TARGET_HOST_MS_WINDOWS
+    WaitForSingleObject( recorder->Thread, INFINITE );
+    CloseHandle( recorder->Thread );
+    CloseHandle( recorder->Ready );
+#elif FGH_RECORD_POSIX
+    pthread_join( recorder->Thread, NULL );
+    sem_destroy( &recorder->Ready );
+#endif
+}
+
+/*
+ * Copies a frame read back into the pool, top row first, and hands it to
+ * the writer, or drops it if the pool is full
+ */
+static void fghRecordReadback( const void* pixels, int width, int height, int frame, void* userData )
+{
+    SFG_Recorder* recorder = userData;
+    SFG_RecordFrame* slot;
+    const size_t rowSize = (size_t)width * 4;
+    int y;
+
+    if( recorder->Queued - FGH_LOAD( recorder->Written ) == (unsigned int)recorder->PoolSize )
+    {
+        recorder->Dropped++;
+        return;
+    }
+
+    slot = &recorder->Frames[ recorder->Head ];
+    for( y = 0; y < height; y++ )
+        memcpy( slot->Pixels + ( height - 1 - y ) * rowSize,
+                (const GLubyte*)pixels + y * rowSize, rowSize );
+    slot->Number = frame;
+    recorder->Head = ( recorder->Head + 1 ) % recorder->PoolSize;
+    FGH_STORE( recorder->Queued, recorder->Queued + 1 );
+
+    if( recorder->Threaded )
+        fghWakeRecordWriter( recorder );
+    else
+        fghWriteRecordFrame( recorder );
+}
+
+static void fghFreeRecorder( SFG_Recorder* recorder )
+{
+    int i;
+
+    if( recorder->Frames )
+        for( i = 0; i < recorder->PoolSize; i++ )
+            free( recorder->Frames[ i ].Pixels );
+    free( recorder->Frames );
+    free( recorder->Sink.Chunk );
+    free( recorder->Scratch );
+    free( recorder->Path );
+    free( recorder );
+}
+
+/*
+ * Whether a PNG path, which is a printf format, has exactly one place for
+ * the frame number, %d or %0Nd, and no other conversion but %%
+ */
+static GLboolean fghIsFramePattern( const char* path )
+{
+    int conversions = 0;
+
+    while( ( path = strchr( path, '%' ) ) != NULL )
+    {
+        path++;
+        if( *path == '%' )
+        {
+            path++;
+            continue;
+        }
+        if( *path == '0' )
+            while( *path >= '0' && *path <= '9' )
+                path++;
+        if( *path != 'd' )
+            return GL_FALSE;
+        path++;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+/*
+ * Stops the recording, once the window's reads are handed over
+ */
+static void fghStopRecording( void )
+{
+    SFG_Recorder* recorder = fghRecorder;
+
+    if( recorder->Threaded )
+        fghStopRecordWriter( recorder );
+    if( recorder->Format != GLUT_RECORD_PNG && !fghSinkClose( &recorder->Sink ) )
+        recorder->Failed = recorder->Written;   /* The file is cut short */
+
+    fghRecordWritten = (int)( recorder->Written - recorder->Failed );
+    fghRecordDropped = recorder->Dropped + (int)recorder->Failed;
+    if( fghRecordDropped )
+        fgWarning( "glutRecordStop: %d of %d frames dropped", fghRecordDropped,
+                   fghRecordWritten + fghRecordDropped );
+
+    fghFreeRecorder( recorder );
+    fghRecorder = NULL;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Reads back the frame of a window being recorded, before its buffers
+ * are swapped
+ */
+void fgRecordFrame( SFG_Window* window )
+{
+    freeglut_return_if_fail( fghRecorder && fghRecorder->Window == window );
+
+    glutReadFrameAsync( 0, 0, fghRecorder->Width, fghRecorder->Height,
+                        fghRecordReadback, fghRecorder );
+}
+
+/*
+ * Stops recording a window that is closing, or any window if NULL, once
+ * the frames read back are written
+ */
+void fgStopRecording( SFG_Window* window )
+{
+    SFG_Window* activeWindow = fgStructure.CurrentWindow;
+
+    freeglut_return_if_fail( fghRecorder && ( !window || fghRecorder->Window == window ) );
+
+    fgSetWindow( fghRecorder->Window );
+    glutReadFrameFlush( );
+    fghStopRecording( );
+    fgSetWindow( activeWindow );
+}
+
+/*
+ * The counts of glutGet, of the recording or else of the last one
+ */
+int fgRecordGet( GLenum eWhat )
+{
+    SFG_Recorder* recorder = fghRecorder;
+
+    if( !recorder )
+        return eWhat == GLUT_RECORD_FRAMES_WRITTEN ? fghRecordWritten : fghRecordDropped;
+
+    if( eWhat == GLUT_RECORD_FRAMES_WRITTEN )
+        return (int)( FGH_LOAD( recorder->Written ) - FGH_LOAD( recorder->Failed ) );
+    return recorder->Dropped + (int)FGH_LOAD( recorder->Failed );
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Starts recording the frames of the current window, at its present
+ * size, as GLUT_RECORD_RAW, GLUT_RECORD_Y4M or GLUT_RECORD_PNG. For PNG
+ * the path is a pattern with the frame number in it, such as
+ * "frame%05d.png". The frame rate is that of the Y4M header, 0 for the
+ * headless virtual clock's or else 30. Returns 0 if the recording
+ * cannot be started, or one already is.
+ */
+int FGAPIENTRY glutRecordStart( const char* path, int format, int framesPerSecond )
+{
+    SFG_Recorder* recorder;
+    int poolSize, i;
+    size_t frameSize;
+
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutRecordStart" );
+    FREEGLUT_EXIT_IF_NO_WINDOW ( "glutRecordStart" );
+
+    if( !path || fghRecorder )
+        return 0;
+    if( format != GLUT_RECORD_RAW && format != GLUT_RECORD_Y4M && format != GLUT_RECORD_PNG )
+    {
+        fgWarning( "glutRecordStart: unknown format %d", format );
+        return 0;
+    }
+    if( format == GLUT_RECORD_PNG && !fghIsFramePattern( path ) )
+    {
+        fgWarning( "glutRecordStart: \"%s\" needs one %%d or %%0Nd for the frame number, and no other conversion", path );
+        return 0;
+    }
+
+    recorder = calloc( 1, sizeof( SFG_Recorder ) );
+    if( !recorder )
+        fgError( "Failed to allocate memory in glutRecordStart" );
+    recorder->Window = fgStructure.CurrentWindow;
+    recorder->Format = format;
+    recorder->Width = glutGet( GLUT_WINDOW_WIDTH );
+    recorder->Height = glutGet( GLUT_WINDOW_HEIGHT );
+    recorder->Path = malloc( strlen( path ) + 1 );
+    if( !recorder->Path )
+        fgError( "Failed to allocate memory in glutRecordStart" );
+    strcpy( recorder->Path, path );
+
+    /* The pool, bounded, and the writer's buffers */
+    poolSize = fgState.RecordPoolFrames > 0 ? fgState.RecordPoolFrames : FGH_RECORD_POOL_FRAMES;
+    frameSize = (size_t)recorder->Width * recorder->Height * 4;
+    recorder->Frames = calloc( poolSize, sizeof( SFG_RecordFrame ) );
+    recorder->PoolSize = poolSize;
+    if( !recorder->Frames )
+        fgError( "Failed to allocate memory in glutRecordStart" );
+    for( i = 0; i < poolSize; i++ )
+        if( !( recorder->Frames[ i ].Pixels = malloc( frameSize ) ) )
+            fgError( "Failed to allocate memory in glutRecordStart" );
+    recorder->Scratch = malloc( (size_t)recorder->Width * recorder->Height * 3 + 1 );
+#if FGH_RECORD_POSIX
+    if( posix_memalign( (void**)&recorder->Sink.Chunk, FGH_RECORD_ALIGNMENT,
+                        FGH_RECORD_CHUNK_SIZE ) != 0 )
+        recorder->Sink.Chunk = NULL;
+#else
+    recorder->Sink.Chunk = malloc( FGH_RECORD_CHUNK_SIZE );
+#endif
+    if( !recorder->Scratch || !recorder->Sink.Chunk )
+        fgError( "Failed to allocate memory in glutRecordStart" );
+
+    if( format != GLUT_RECORD_PNG )
+    {
+        if( !fghSinkOpen( &recorder->Sink, path ) )
+        {
+            fgWarning( "glutRecordStart: cannot open \"%s\"", path );
+            fghFreeRecorder( recorder );
+            return 0;
+        }
+        if( format == GLUT_RECORD_Y4M )
+        {
+            char header[ 128 ];
+            if( framesPerSecond <= 0 )
+                framesPerSecond = fgState.FrameRate > 0 ? fgState.FrameRate : 30;
+            snprintf( header, sizeof( header ), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+                      recorder->Width, recorder->Height, framesPerSecond );
+            fghSinkWrite( &recorder->Sink, header, strlen( header ) );
+        }
+    }
+    else
+        fghInitCrcTable( );
+
+    recorder->Threaded = fghStartRecordWriter( recorder );
+    fghRecorder = recorder;
+    return 1;
+}
+
+/*
+ * Stops the recording, once the frames read back are written
+ */
+void FGAPIENTRY glutRecordStop( void )
+{
+    FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutRecordStop" );
+
+    fgStopRecording( NULL );
+}
+
+/*** END OF FILE ***/
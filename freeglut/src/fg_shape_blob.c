@@ -0,0 +1,631 @@
+/*
+ * fg_shape_blob.c
+ *
+ * Built-in shapes baked ahead of time into a file, and mapped at run time.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_shape_blob.h"
+
+#if TARGET_HOST_POSIX_X11 || TARGET_HOST_HEADLESS
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+/*
+ * glutBakeShapes draws a list of shapes with the usual generators of
+ * fg_geometry.c and fg_teapot.c, but keeps what they pass to
+ * fghDrawGeometryWire and fghDrawGeometrySolid instead of drawing it, and
+ * writes all of it to a file. It needs no window or context, so it is
+ * run at build time by the freeglut_bake_shapes tool.
+ *
+ * glutMapShapes maps such a file. When a shape is not in the buffers of
+ * the window already, fgDrawCachedShape looks its key up in the mapping,
+ * and passes the arrays found there straight to fghDrawGeometryWire or
+ * fghDrawGeometrySolid, without generating it or copying anything first.
+ * Shapes that are not in the file are generated as before. The layout of
+ * the file is in fg_shape_blob.h.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+/* What glutBakeShapes has kept so far, with offsets into Data */
+typedef struct tagSFG_BlobWriter SFG_BlobWriter;
+struct tagSFG_BlobWriter
+{
+    SFG_BlobShape*  Shapes;
+    GLuint          NumShapes;
+    GLuint          MaxShapes;
+    GLubyte*        Data;
+    size_t          DataSize;
+    size_t          MaxDataSize;
+};
+
+static SFG_BlobWriter* fghBlobWriter = NULL;
+
+/* The mapped file */
+static const GLubyte* fghBlob = NULL;
+static size_t fghBlobSize = 0;
+#if TARGET_HOST_MS_WINDOWS
+static HANDLE fghBlobMapping = NULL;
+#endif
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static GLboolean fghBlobKeyIs( const SFG_BlobShape* shape, const SFG_ShapeKey* key )
+{
+    return shape->Shape == key->Shape && ( shape->Wire != 0 ) == ( key->Wire != GL_FALSE ) &&
+           !memcmp( shape->Params, key->Params, sizeof( shape->Params ) ) &&
+           !memcmp( shape->Divisions, key->Divisions, sizeof( shape->Divisions ) );
+}
+
+/*
+ * Copies an array to the data of the writer, returning its offset in the
+ * data plus one, so that 0 still means there is none
+ */
+static GLuint fghBlobAppend( SFG_BlobWriter* writer, const GLvoid* data, size_t size )
+{
+    size_t offset = ( writer->DataSize + FGH_BLOB_ALIGNMENT - 1 ) & ~(size_t)( FGH_BLOB_ALIGNMENT - 1 );
+
+    if( !data || !size )
+        return 0;
+
+    if( offset + size > writer->MaxDataSize )
+    {
+        size_t maxSize = writer->MaxDataSize ? writer->MaxDataSize : 64 * 1024;
+        GLubyte* grown;
+
+        while( offset + size > maxSize )
+            maxSize *= 2;
+        grown = realloc( writer->Data, maxSize );
+        if( !grown )
+            fgError( "Failed to allocate memory in fghBlobAppend" );
+        writer->Data = grown;
+        writer->MaxDataSize = maxSize;
+    }
+
+    memset( writer->Data + writer->DataSize, 0, offset - writer->DataSize );
+    memcpy( writer->Data + offset, data, size );
+    writer->DataSize = offset + size;
+    return (GLuint)offset + 1;
+}
+
+static void fghBlobRelocate( GLuint* offset, size_t base )
+{
+    if( *offset )
+        *offset += (GLuint)base - 1;
+}
+
+/*
+ * Writes what the writer has kept to a file, returning GL_FALSE on failure
+ */
+static GLboolean fghWriteBlob( const SFG_BlobWriter* writer, const char* path )
+{
+    SFG_BlobHeader header;
+    size_t tableSize = writer->NumShapes * sizeof( SFG_BlobShape );
+    size_t base = ( sizeof( header ) + tableSize + FGH_BLOB_ALIGNMENT - 1 ) &
+                  ~(size_t)( FGH_BLOB_ALIGNMENT - 1 );
+    static const GLubyte padding[ FGH_BLOB_ALIGNMENT ] = { 0 };
+    GLboolean written;
+    GLuint i;
+    FILE* file;
+
+    if( base + writer->DataSize > 0xFFFFFFFFu )
+    {
+        fgWarning( "glutBakeShapes: too many shapes for one file" );
+        return GL_FALSE;
+    }
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.Magic, FGH_BLOB_MAGIC, sizeof( header.Magic ) );
+    header.Version = FGH_BLOB_VERSION;
+    header.ByteOrder = FGH_BLOB_BYTE_ORDER;
+    header.EntrySize = sizeof( SFG_BlobShape );
+    header.NumShapes = writer->NumShapes;
+    header.Size = (GLuint)( base + writer->DataSize );
+
+    file = fopen( path, "wb" );
+    if( !file )
+    {
+        fgWarning( "glutBakeShapes: cannot open %s for writing", path );
+        return GL_FALSE;
+    }
+
+    written = fwrite( &header, sizeof( header ), 1, file ) == 1;
+    for( i = 0; i < writer->NumShapes && written; i++ )
+    {
+        SFG_BlobShape shape = writer->Shapes[ i ];
+
+        fghBlobRelocate( &shape.Vertices, base );
+        fghBlobRelocate( &shape.Normals, base );
+        fghBlobRelocate( &shape.Textcs, base );
+        fghBlobRelocate( &shape.VertIdxs, base );
+        fghBlobRelocate( &shape.VertIdxs2, base );
+        written = fwrite( &shape, sizeof( shape ), 1, file ) == 1;
+    }
+    if( written && base > sizeof( header ) + tableSize )
+        written = fwrite( padding, base - sizeof( header ) - tableSize, 1, file ) == 1;
+    if( written && writer->DataSize )
+        written = fwrite( writer->Data, writer->DataSize, 1, file ) == 1;
+
+    if( fclose( file ) != 0 )
+        written = GL_FALSE;
+    if( !written )
+        fgWarning( "glutBakeShapes: failed to write %s", path );
+    return written;
+}
+
+/*
+ * Checks that an array of vertex indices of a mapped file, if there is
+ * one, is in the file and only indexes the vertices of its shape
+ */
+static GLboolean fghBlobIndicesAreValid( const GLubyte* blob, GLuint size, GLuint offset,
+                                         GLsizei numParts, GLsizei numVertPerPart,
+                                         GLsizei numVertices )
+{
+    const size_t count = (size_t)numParts * numVertPerPart;
+    const GLuint* indices;
+    size_t i;
+
+    if( !offset )
+        return GL_TRUE;
+    if( offset % sizeof( GLuint ) || offset + count * sizeof( GLuint ) > size )
+        return GL_FALSE;
+
+    indices = (const GLuint*)( blob + offset );
+    for( i = 0; i < count; i++ )
+        if( indices[ i ] >= (GLuint)numVertices )
+            return GL_FALSE;
+    return GL_TRUE;
+}
+
+/*
+ * Checks a mapped file before any of it is used, so that no array of it
+ * is read out of its bounds when its shapes are drawn
+ */
+static GLboolean fghBlobIsValid( const GLubyte* blob, size_t size )
+{
+    const SFG_BlobHeader* header = (const SFG_BlobHeader*)blob;
+    const SFG_BlobShape* shapes = (const SFG_BlobShape*)( header + 1 );
+    GLuint i;
+
+    if( size < sizeof( SFG_BlobHeader ) ||
+        memcmp( header->Magic, FGH_BLOB_MAGIC, sizeof( header->Magic ) ) ||
+        header->Version != FGH_BLOB_VERSION || header->ByteOrder != FGH_BLOB_BYTE_ORDER ||
+        header->EntrySize != sizeof( SFG_BlobShape ) || header->Size > size ||
+        header->NumShapes > ( size - sizeof( SFG_BlobHeader ) ) / sizeof( SFG_BlobShape ) )
+        return GL_FALSE;
+
+    for( i = 0; i < header->NumShapes; i++ )
+    {
+        const SFG_BlobShape* shape = &shapes[ i ];
+        const size_t vertexSize = (size_t)shape->NumVertices * 3 * sizeof( GLfloat );
+
+        if( shape->NumVertices < 0 || shape->NumParts < 0 || shape->NumVertPerPart < 0 ||
+            shape->NumParts2 < 0 || shape->NumVertPerPart2 < 0 ||
+            !shape->Vertices || shape->Vertices + vertexSize > header->Size ||
+            !shape->Normals || shape->Normals + vertexSize > header->Size ||
+            ( shape->Textcs && shape->Textcs + vertexSize / 3 * 2 > header->Size ) )
+            return GL_FALSE;
+
+        /* Wire parts without indices are drawn from consecutive vertices */
+        if( !shape->VertIdxs && shape->Wire &&
+            (size_t)shape->NumParts * shape->NumVertPerPart > (size_t)shape->NumVertices )
+            return GL_FALSE;
+
+        if( !fghBlobIndicesAreValid( blob, header->Size, shape->VertIdxs, shape->NumParts,
+                                     shape->NumVertPerPart, shape->NumVertices ) ||
+            !fghBlobIndicesAreValid( blob, header->Size, shape->VertIdxs2, shape->NumParts2,
+                                     shape->NumVertPerPart2, shape->NumVertices ) )
+            return GL_FALSE;
+    }
+    return GL_TRUE;
+}
+
+/*
+ * Draws the shape of a spec such as "solidsphere 1 32 16", returning
+ * GL_FALSE if the spec is not understood. The teaset takes a number of
+ * subdivisions after its size, 0 for the default. The Sierpinski sponge
+ * takes its number of levels, then optionally its offset and scale, such
+ * as "wiresierpinskisponge 3 0 0 0 1".
+ */
+static GLboolean fghBakeSpec( const char* spec )
+{
+    char name[ 32 ];
+    double p[ 3 ] = { 0.0, 0.0, 0.0 };
+    int d[ 2 ] = { 0, 0 };
+    const char* shape;
+    GLboolean wire;
+
+    if( sscanf( spec, "%31s", name ) != 1 )
+        return GL_FALSE;
+
+    if( !strncmp( name, "solid", 5 ) )
+        wire = GL_FALSE;
+    else if( !strncmp( name, "wire", 4 ) )
+        wire = GL_TRUE;
+    else
+        return GL_FALSE;
+    shape = name + ( wire ? 4 : 5 );
+
+#define FGH_BAKE_POLYHEDRON(lower,Name)                                        \
+    if( !strcmp( shape, lower ) )                                              \
+    {                                                                          \
+        if( wire ) glutWire##Name( ); else glutSolid##Name( );                 \
+        return GL_TRUE;                                                        \
+    }
+    FGH_BAKE_POLYHEDRON( "dodecahedron", Dodecahedron )
+    FGH_BAKE_POLYHEDRON( "icosahedron", Icosahedron )
+    FGH_BAKE_POLYHEDRON( "octahedron", Octahedron )
+    FGH_BAKE_POLYHEDRON( "rhombicdodecahedron", RhombicDodecahedron )
+    FGH_BAKE_POLYHEDRON( "tetrahedron", Tetrahedron )
+#undef FGH_BAKE_POLYHEDRON
+
+    if( !strcmp( shape, "cube" ) )
+    {
+        if( sscanf( spec, "%*s %lf", &p[ 0 ] ) != 1 )
+            return GL_FALSE;
+        if( wire ) glutWireCube( p[ 0 ] ); else glutSolidCube( p[ 0 ] );
+    }
+    else if( !strcmp( shape, "sphere" ) )
+    {
+        if( sscanf( spec, "%*s %lf %d %d", &p[ 0 ], &d[ 0 ], &d[ 1 ] ) != 3 )
+            return GL_FALSE;
+        if( wire ) glutWireSphere( p[ 0 ], d[ 0 ], d[ 1 ] ); else glutSolidSphere( p[ 0 ], d[ 0 ], d[ 1 ] );
+    }
+    else if( !strcmp( shape, "cone" ) )
+    {
+        if( sscanf( spec, "%*s %lf %lf %d %d", &p[ 0 ], &p[ 1 ], &d[ 0 ], &d[ 1 ] ) != 4 )
+            return GL_FALSE;
+        if( wire ) glutWireCone( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] ); else glutSolidCone( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] );
+    }
+    else if( !strcmp( shape, "cylinder" ) )
+    {
+        if( sscanf( spec, "%*s %lf %lf %d %d", &p[ 0 ], &p[ 1 ], &d[ 0 ], &d[ 1 ] ) != 4 )
+            return GL_FALSE;
+        if( wire ) glutWireCylinder( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] ); else glutSolidCylinder( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] );
+    }
+    else if( !strcmp( shape, "torus" ) )
+    {
+        if( sscanf( spec, "%*s %lf %lf %d %d", &p[ 0 ], &p[ 1 ], &d[ 0 ], &d[ 1 ] ) != 4 )
+            return GL_FALSE;
+        if( wire ) glutWireTorus( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] ); else glutSolidTorus( p[ 0 ], p[ 1 ], d[ 0 ], d[ 1 ] );
+    }
+    else if( !strcmp( shape, "sierpinskisponge" ) )
+    {
+        double scale = 1.0;
+        int n = sscanf( spec, "%*s %d %lf %lf %lf %lf", &d[ 0 ], &p[ 0 ], &p[ 1 ], &p[ 2 ], &scale );
+
+        if( n != 1 && n != 5 )
+            return GL_FALSE;
+        if( wire ) glutWireSierpinskiSponge( d[ 0 ], p, scale ); else glutSolidSierpinskiSponge( d[ 0 ], p, scale );
+    }
+    else if( !strcmp( shape, "teapot" ) || !strcmp( shape, "teacup" ) || !strcmp( shape, "teaspoon" ) )
+    {
+        int subdivisions = fgState.TeapotSubdivisions;
+
+        if( sscanf( spec, "%*s %lf %d", &p[ 0 ], &d[ 0 ] ) < 1 )
+            return GL_FALSE;
+        fgState.TeapotSubdivisions = d[ 0 ];
+        if( !strcmp( shape, "teapot" ) )
+        {
+            if( wire ) glutWireTeapot( p[ 0 ] ); else glutSolidTeapot( p[ 0 ] );
+        }
+        else if( !strcmp( shape, "teacup" ) )
+        {
+            if( wire ) glutWireTeacup( p[ 0 ] ); else glutSolidTeacup( p[ 0 ] );
+        }
+        else if( wire ) glutWireTeaspoon( p[ 0 ] ); else glutSolidTeaspoon( p[ 0 ] );
+        fgState.TeapotSubdivisions = subdivisions;
+    }
+    else
+        return GL_FALSE;
+    return GL_TRUE;
+}
+
+/*
+ * What glutBakeShapes bakes by default: the polyhedra, the unit cube and
+ * teaset, and the unit spheres the *LOD functions choose from
+ */
+static const char* const fghDefaultBakeSpecs[] =
+{
+    "soliddodecahedron", "wiredodecahedron",
+    "solidicosahedron", "wireicosahedron",
+    "solidoctahedron", "wireoctahedron",
+    "solidrhombicdodecahedron", "wirerhombicdodecahedron",
+    "solidtetrahedron", "wiretetrahedron",
+    "solidcube 1", "wirecube 1",
+    "solidteapot 1", "wireteapot 1",
+    "solidteacup 1", "wireteacup 1",
+    "solidteaspoon 1", "wireteaspoon 1",
+    "solidsphere 1 6 3", "wiresphere 1 6 3",
+    "solidsphere 1 8 4", "wiresphere 1 8 4",
+    "solidsphere 1 12 6", "wiresphere 1 12 6",
+    "solidsphere 1 16 8", "wiresphere 1 16 8",
+    "solidsphere 1 24 12", "wiresphere 1 24 12",
+    "solidsphere 1 32 16", "wiresphere 1 32 16",
+    "solidsphere 1 48 24", "wiresphere 1 48 24",
+    "solidsphere 1 64 32", "wiresphere 1 64 32",
+    "solidsphere 1 96 48", "wiresphere 1 96 48",
+    "solidsphere 1 128 64", "wiresphere 1 128 64",
+    NULL
+};
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Whether glutBakeShapes is running, and shapes are to be kept rather
+ * than drawn
+ */
+GLboolean fgBakingShapes( void )
+{
+    return fghBlobWriter != NULL;
+}
+
+/*
+ * Keeps a shape for glutBakeShapes, with the arguments of fgCreateShape
+ * (a wire shape's vertexMode, or GL_TRIANGLES for a solid one). Returns
+ * GL_FALSE, for the caller to draw it, if no baking is going on.
+ */
+GLboolean fgBakeShape( const SFG_ShapeKey* key,
+                       const GLfloat* vertices, const GLfloat* normals, const GLfloat* textcs,
+                       GLsizei numVertices, GLenum mode,
+                       const GLuint* vertIdxs, GLsizei numParts, GLsizei numVertPerPart,
+                       const GLuint* vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 )
+{
+    SFG_BlobWriter* writer = fghBlobWriter;
+    SFG_BlobShape* shape;
+    GLuint i;
+
+    if( !writer )
+        return GL_FALSE;
+
+    /* Shapes drawn without a key cannot be looked up again */
+    if( !key )
+        return GL_TRUE;
+    for( i = 0; i < writer->NumShapes; i++ )
+        if( fghBlobKeyIs( &writer->Shapes[ i ], key ) )
+            return GL_TRUE;
+
+    if( writer->NumShapes == writer->MaxShapes )
+    {
+        GLuint maxShapes = writer->MaxShapes ? writer->MaxShapes * 2 : 32;
+        SFG_BlobShape* grown = realloc( writer->Shapes, maxShapes * sizeof( SFG_BlobShape ) );
+
+        if( !grown )
+            fgError( "Failed to allocate memory in fgBakeShape" );
+        writer->Shapes = grown;
+        writer->MaxShapes = maxShapes;
+    }
+
+    shape = &writer->Shapes[ writer->NumShapes++ ];
+    memset( shape, 0, sizeof( SFG_BlobShape ) );
+    shape->Shape = key->Shape;
+    shape->Wire = key->Wire ? 1 : 0;
+    memcpy( shape->Params, key->Params, sizeof( shape->Params ) );
+    memcpy( shape->Divisions, key->Divisions, sizeof( shape->Divisions ) );
+
+    shape->Mode = mode;
+    shape->NumVertices = numVertices;
+    shape->Vertices = fghBlobAppend( writer, vertices, numVertices * 3 * sizeof( GLfloat ) );
+    shape->Normals = fghBlobAppend( writer, normals, numVertices * 3 * sizeof( GLfloat ) );
+    shape->Textcs = fghBlobAppend( writer, textcs, numVertices * 2 * sizeof( GLfloat ) );
+    shape->NumParts = numParts;
+    shape->NumVertPerPart = numVertPerPart;
+    shape->VertIdxs = fghBlobAppend( writer, vertIdxs, numParts * numVertPerPart * sizeof( GLuint ) );
+    shape->NumParts2 = numParts2;
+    shape->NumVertPerPart2 = numVertPerPart2;
+    shape->VertIdxs2 = fghBlobAppend( writer, vertIdxs2, numParts2 * numVertPerPart2 * sizeof( GLuint ) );
+    return GL_TRUE;
+}
+
+/*
+ * Draws a shape from the mapped file, if it is there
+ */
+GLboolean fgDrawBakedShape( const SFG_ShapeKey* key )
+{
+    const SFG_BlobHeader* header = (const SFG_BlobHeader*)fghBlob;
+    const SFG_BlobShape* shape;
+    GLuint i;
+
+    if( !fghBlob )
+        return GL_FALSE;
+
+    shape = (const SFG_BlobShape*)( header + 1 );
+    for( i = 0; i < header->NumShapes; i++, shape++ )
+        if( fghBlobKeyIs( shape, key ) )
+            break;
+    if( i == header->NumShapes )
+        return GL_FALSE;
+
+    /* The arrays are only read, whatever the prototypes say */
+#define FGH_BLOB_ARRAY(type,offset) ( (offset) ? (type*)( fghBlob + (offset) ) : NULL )
+    if( shape->Wire )
+        fghDrawGeometryWire( key, FGH_BLOB_ARRAY( GLfloat, shape->Vertices ),
+                             FGH_BLOB_ARRAY( GLfloat, shape->Normals ), shape->NumVertices,
+                             FGH_BLOB_ARRAY( GLuint, shape->VertIdxs ), shape->NumParts,
+                             shape->NumVertPerPart, shape->Mode,
+                             FGH_BLOB_ARRAY( GLuint, shape->VertIdxs2 ), shape->NumParts2,
+                             shape->NumVertPerPart2 );
+    else
+        fghDrawGeometrySolid( key, FGH_BLOB_ARRAY( GLfloat, shape->Vertices ),
+                              FGH_BLOB_ARRAY( GLfloat, shape->Normals ),
+                              FGH_BLOB_ARRAY( GLfloat, shape->Textcs ), shape->NumVertices,
+                              FGH_BLOB_ARRAY( GLuint, shape->VertIdxs ), shape->NumParts,
+                              shape->NumVertPerPart );
+#undef FGH_BLOB_ARRAY
+    return GL_TRUE;
+}
+
+/*
+ * Unmaps the file of glutMapShapes, on deinitialization or before another
+ * is mapped
+ */
+void fgUnmapShapes( void )
+{
+    if( !fghBlob )
+        return;
+
+#if TARGET_HOST_MS_WINDOWS
+    UnmapViewOfFile( (LPCVOID)fghBlob );
+    CloseHandle( fghBlobMapping );
+    fghBlobMapping = NULL;
+#elif TARGET_HOST_POSIX_X11 || TARGET_HOST_HEADLESS
+    munmap( (void*)fghBlob, fghBlobSize );
+#else
+    free( (void*)fghBlob );
+#endif
+    fghBlob = NULL;
+    fghBlobSize = 0;
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Bakes the shapes of a NULL terminated list of specs, or of the default
+ * one, into a file for glutMapShapes. Works with or without glutInit and
+ * a window, and draws nothing. Returns the number of shapes written, 0 on
+ * failure.
+ */
+int FGAPIENTRY glutBakeShapes( const char* path, const char* const* specs )
+{
+    SFG_BlobWriter writer;
+    GLboolean initialised = fgState.Initialised;
+    GLboolean written;
+    int i;
+
+    if( !path || fghBlobWriter )
+        return 0;
+    if( !specs )
+        specs = fghDefaultBakeSpecs;
+
+    memset( &writer, 0, sizeof( writer ) );
+    fghBlobWriter = &writer;
+
+    /* Nothing reaches a window, so the shape functions may run without one */
+    fgState.Initialised = GL_TRUE;
+    for( i = 0; specs[ i ]; i++ )
+        if( !fghBakeSpec( specs[ i ] ) )
+            fgWarning( "glutBakeShapes: unknown shape \"%s\"", specs[ i ] );
+    fgState.Initialised = initialised;
+
+    fghBlobWriter = NULL;
+    written = writer.NumShapes && fghWriteBlob( &writer, path );
+    free( writer.Shapes );
+    free( writer.Data );
+    return written ? (int)writer.NumShapes : 0;
+}
+
+/*
+ * Maps a file of glutBakeShapes, for the shapes in it to be drawn from
+ * rather than generated. Returns 0 if it cannot be, and then maps none.
+ */
+int FGAPIENTRY glutMapShapes( const char* path )
+{
+    const GLubyte* blob = NULL;
+    size_t size = 0;
+
+    fgUnmapShapes( );
+    if( !path )
+        return 0;
+
+#if TARGET_HOST_MS_WINDOWS
+    {
+        HANDLE file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, NULL );
+        LARGE_INTEGER fileSize;
+
+        if( file == INVALID_HANDLE_VALUE )
+            return 0;
+        if( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart > 0 )
+        {
+            fghBlobMapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+            if( fghBlobMapping )
+            {
+                blob = MapViewOfFile( fghBlobMapping, FILE_MAP_READ, 0, 0, 0 );
+                size = (size_t)fileSize.QuadPart;
+                if( !blob )
+                {
+                    CloseHandle( fghBlobMapping );
+                    fghBlobMapping = NULL;
+                }
+            }
+        }
+        CloseHandle( file );
+    }
+#elif TARGET_HOST_POSIX_X11 || TARGET_HOST_HEADLESS
+    {
+        int file = open( path, O_RDONLY );
+        struct stat status;
+
+        if( file < 0 )
+            return 0;
+        if( fstat( file, &status ) == 0 && status.st_size > 0 )
+        {
+            size = (size_t)status.st_size;
+            blob = mmap( NULL, size, PROT_READ, MAP_PRIVATE, file, 0 );
+            if( blob == MAP_FAILED )
+                blob = NULL;
+        }
+        close( file );
+    }
+#else
+    {
+        /* No mapping here, so read it in whole */
+        FILE* file = fopen( path, "rb" );
+        long fileSize;
+
+        if( !file )
+            return 0;
+        if( fseek( file, 0, SEEK_END ) == 0 && ( fileSize = ftell( file ) ) > 0 &&
+            fseek( file, 0, SEEK_SET ) == 0 )
+        {
+            GLubyte* data = malloc( (size_t)fileSize );
+            size = (size_t)fileSize;
+            if( data && fread( data, size, 1, file ) == 1 )
+                blob = data;
+            else
+                free( data );
+        }
+        fclose( file );
+    }
+#endif
+
+    if( !blob )
+        return 0;
+
+    fghBlob = blob;
+    fghBlobSize = size;
+    if( !fghBlobIsValid( blob, size ) )
+    {
+        fgWarning( "glutMapShapes: %s is not a shape file of this build", path );
+        fgUnmapShapes( );
+        return 0;
+    }
+    return 1;
+}
+
+/*** END OF FILE ***/
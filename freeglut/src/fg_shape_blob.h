@@ -0,0 +1,76 @@
+/*
+ * fg_shape_blob.h
+ *
+ * The layout of the shape files of glutBakeShapes and glutMapShapes,
+ * shared by fg_shape_blob.c and the freeglut_bake_shapes tool.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __FG_SHAPE_BLOB_H__
+#define __FG_SHAPE_BLOB_H__
+
+/*
+ * A file is a header, the table of its shapes, then their arrays, each
+ * 16-byte aligned, at offsets from the start of the file. It is written in
+ * the byte order of the machine and only mapped by one of the same.
+ *
+ * FGH_BLOB_VERSION is to be raised whenever any of this changes, so that
+ * files baked before are refused rather than misread.
+ */
+
+#define FGH_BLOB_MAGIC      "FGSHAPES"
+#define FGH_BLOB_VERSION    1
+#define FGH_BLOB_BYTE_ORDER 0x01020304
+#define FGH_BLOB_ALIGNMENT  16
+
+typedef struct tagSFG_BlobHeader SFG_BlobHeader;
+struct tagSFG_BlobHeader
+{
+    char            Magic[ 8 ];
+    GLuint          Version;
+    GLuint          ByteOrder;      /* FGH_BLOB_BYTE_ORDER, as written    */
+    GLuint          EntrySize;      /* sizeof( SFG_BlobShape )            */
+    GLuint          NumShapes;
+    GLuint          Size;           /* Of the whole file, in bytes        */
+    GLuint          Reserved;
+};
+
+/* A shape, with its key spelled out and its arrays as offsets, 0 if none */
+typedef struct tagSFG_BlobShape SFG_BlobShape;
+struct tagSFG_BlobShape
+{
+    GLint           Shape;
+    GLint           Wire;
+    GLfloat         Params[ 4 ];
+    GLint           Divisions[ 2 ];
+
+    GLenum          Mode;           /* Of a wire shape's first parts      */
+    GLsizei         NumVertices;
+    GLuint          Vertices;
+    GLuint          Normals;
+    GLuint          Textcs;
+    GLuint          VertIdxs;
+    GLsizei         NumParts;
+    GLsizei         NumVertPerPart;
+    GLuint          VertIdxs2;
+    GLsizei         NumParts2;
+    GLsizei         NumVertPerPart2;
+};
+
+#endif
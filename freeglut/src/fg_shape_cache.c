@@ -0,0 +1,586 @@
+/*
+ * fg_shape_cache.c
+ *
+ * Buffer objects for the shapes of fg_geometry.c and fg_teapot.c.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * With OpenGL (ES) 2.0, shapes are drawn through the vertex attributes the
+ * user gave to glutSetVertexAttribCoord3 and friends. A shape's vertices
+ * are stored interleaved in a single buffer:
+ *
+ *   position    3 floats
+ *   normal      4 normalized shorts (the last one is padding), or 3 floats
+ *               if the normals do not fit in [-1, 1]
+ *   texcoord    2 floats, for the solid teapot, teacup and teaspoon only
+ *
+ * with its vertex indices, if any, in a second one. Where vertex array
+ * objects are available, a shape has one that records the attribute
+ * setup for the locations it was last drawn with, so a draw is a bind
+ * and a draw call.
+ *
+ * Every shape is a single draw call. The lines of a wire shape, whether
+ * given as loops or strips, are turned into GL_LINES. The triangle strips
+ * of a solid shape are laid out one after the other, separated by the
+ * largest index of the index type, and drawn with primitive restart
+ * (OpenGL 3.1, OpenGL ES 3.0) or else glMultiDrawElements (OpenGL 1.4).
+ * Only OpenGL ES 2.0 falls back to a call per strip. Indices are GLushort
+ * whenever the shape has few enough vertices for them.
+ *
+ * Shapes are kept per window, as vertex array objects cannot be shared
+ * between contexts, keyed by the kind of shape and its parameters. The
+ * least recently drawn ones go when there are more than
+ * FGH_SHAPE_CACHE_SIZE of them or they take more than
+ * FGH_SHAPE_CACHE_BYTES, so shapes whose size or subdivisions change
+ * every frame do not pile up.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_SHAPE_CACHE_SIZE    64
+#define FGH_SHAPE_CACHE_BYTES   ( 16 * 1024 * 1024 )
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static GLboolean fghShapeKeysEqual( const SFG_ShapeKey* a, const SFG_ShapeKey* b )
+{
+    return a->Shape == b->Shape && a->Wire == b->Wire &&
+           a->Params[ 0 ] == b->Params[ 0 ] && a->Params[ 1 ] == b->Params[ 1 ] &&
+           a->Params[ 2 ] == b->Params[ 2 ] && a->Params[ 3 ] == b->Params[ 3 ] &&
+           a->Divisions[ 0 ] == b->Divisions[ 0 ] && a->Divisions[ 1 ] == b->Divisions[ 1 ];
+}
+
+static void fghDeleteShape( SFG_Shape* shape )
+{
+    free( shape->PartCounts );
+    free( shape->PartOffsets );
+    fghDeleteBuffers( 1, &shape->VertexBuffer );
+    if( shape->IndexBuffer )
+        fghDeleteBuffers( 1, &shape->IndexBuffer );
+    if( shape->VertexArray )
+        fghDeleteVertexArrays( 1, &shape->VertexArray );
+    free( shape );
+}
+
+/*
+ * Packs the vertices of a shape for its vertex buffer, returning the
+ * memory, to be freed by the caller
+ */
+static GLubyte* fghPackShapeVertices( SFG_Shape* shape, const GLfloat* vertices,
+                                      const GLfloat* normals, const GLfloat* textcs )
+{
+    GLubyte* packed;
+    int i, j;
+
+    shape->NormalType = GL_SHORT;
+    for( i = 0; i < shape->NumVertices * 3; i++ )
+        if( normals[ i ] < -1.0f || normals[ i ] > 1.0f )
+        {
+            shape->NormalType = GL_FLOAT;
+            break;
+        }
+
+    shape->Stride = 3 * sizeof( GLfloat ) +
+                    ( shape->NormalType == GL_SHORT ? 4 * sizeof( GLshort ) : 3 * sizeof( GLfloat ) ) +
+                    ( textcs ? 2 * sizeof( GLfloat ) : 0 );
+    shape->HasTexture = textcs != NULL;
+
+    packed = malloc( (size_t)shape->NumVertices * shape->Stride );
+    if( !packed )
+        fgError( "Failed to allocate memory in fghPackShapeVertices" );
+
+    for( i = 0; i < shape->NumVertices; i++ )
+    {
+        GLubyte* v = packed + i * shape->Stride;
+
+        memcpy( v, vertices + 3 * i, 3 * sizeof( GLfloat ) );
+        v += 3 * sizeof( GLfloat );
+
+        if( shape->NormalType == GL_SHORT )
+        {
+            GLshort n[ 4 ];
+            for( j = 0; j < 3; j++ )
+            {
+                const GLfloat c = normals[ 3 * i + j ] * 32767.0f;
+                n[ j ] = (GLshort)( c < 0.0f ? c - 0.5f : c + 0.5f );
+            }
+            n[ 3 ] = 0;
+            memcpy( v, n, sizeof( n ) );
+            v += sizeof( n );
+        }
+        else
+        {
+            memcpy( v, normals + 3 * i, 3 * sizeof( GLfloat ) );
+            v += 3 * sizeof( GLfloat );
+        }
+
+        if( textcs )
+            memcpy( v, textcs + 2 * i, 2 * sizeof( GLfloat ) );
+    }
+
+    return packed;
+}
+
+/*
+ * Points the given attributes at the shape's vertex buffer, which is left
+ * bound. An attribute location of -1 is not used.
+ */
+static void fghSetShapeAttributes( const SFG_Shape* shape, const GLint* attributes )
+{
+    const GLsizei normalSize = shape->NormalType == GL_SHORT ? 4 * sizeof( GLshort ) : 3 * sizeof( GLfloat );
+
+    fghBindBuffer( FGH_ARRAY_BUFFER, shape->VertexBuffer );
+
+    if( attributes[ 0 ] != -1 )
+    {
+        fghEnableVertexAttribArray( attributes[ 0 ] );
+        fghVertexAttribPointer( attributes[ 0 ], 3, GL_FLOAT, GL_FALSE, shape->Stride, 0 );
+    }
+    if( attributes[ 1 ] != -1 )
+    {
+        fghEnableVertexAttribArray( attributes[ 1 ] );
+        fghVertexAttribPointer( attributes[ 1 ], 3, shape->NormalType, shape->NormalType == GL_SHORT,
+                                shape->Stride, (GLvoid*)( 3 * sizeof( GLfloat ) ) );
+    }
+    if( attributes[ 2 ] != -1 && shape->HasTexture )
+    {
+        fghEnableVertexAttribArray( attributes[ 2 ] );
+        fghVertexAttribPointer( attributes[ 2 ], 2, GL_FLOAT, GL_FALSE, shape->Stride,
+                                (GLvoid*)( 3 * sizeof( GLfloat ) + normalSize ) );
+    }
+}
+
+static void fghDisableShapeAttributes( const SFG_Shape* shape, const GLint* attributes )
+{
+    if( attributes[ 0 ] != -1 )
+        fghDisableVertexAttribArray( attributes[ 0 ] );
+    if( attributes[ 1 ] != -1 )
+        fghDisableVertexAttribArray( attributes[ 1 ] );
+    if( attributes[ 2 ] != -1 && shape->HasTexture )
+        fghDisableVertexAttribArray( attributes[ 2 ] );
+}
+
+/*
+ * Appends numParts lines loops or strips, or GL_LINES parts, as GL_LINES
+ * indices, from vertIdxs or, without, from consecutive vertices. Returns
+ * the end of the indices.
+ */
+static GLuint* fghAppendLines( GLuint* out, GLenum mode, const GLuint* vertIdxs,
+                               GLsizei numParts, GLsizei numVertPerPart )
+{
+    GLsizei i, j;
+
+#define FGH_VERTEX( j ) ( vertIdxs ? vertIdxs[ first + ( j ) ] : first + ( j ) )
+    for( i = 0; i < numParts; i++ )
+    {
+        const GLuint first = i * numVertPerPart;
+
+        if( mode == GL_LINES )
+            for( j = 0; j < numVertPerPart; j++ )
+                *out++ = FGH_VERTEX( j );
+        else
+        {
+            for( j = 0; j + 1 < numVertPerPart; j++ )
+            {
+                *out++ = FGH_VERTEX( j );
+                *out++ = FGH_VERTEX( j + 1 );
+            }
+            if( mode == GL_LINE_LOOP && numVertPerPart > 2 )
+            {
+                *out++ = FGH_VERTEX( numVertPerPart - 1 );
+                *out++ = FGH_VERTEX( 0 );
+            }
+        }
+    }
+#undef FGH_VERTEX
+
+    return out;
+}
+
+/*
+ * Draws the triangle strips of a shape, its buffers being bound
+ */
+static void fghDrawShapeStrips( SFG_Shape* shape )
+{
+    const GLsizei size = shape->IndexType == GL_UNSIGNED_INT ? sizeof( GLuint ) : sizeof( GLushort );
+    GLsizei i;
+
+    if( fghHasFixedIndexRestart )
+    {
+        const GLboolean enabled = glIsEnabled( FGH_PRIMITIVE_RESTART_FIXED_INDEX );
+
+        if( !enabled )
+            glEnable( FGH_PRIMITIVE_RESTART_FIXED_INDEX );
+        glDrawElements( shape->Mode, shape->NumIndices, shape->IndexType, 0 );
+        if( !enabled )
+            glDisable( FGH_PRIMITIVE_RESTART_FIXED_INDEX );
+    }
+    else if( fghPrimitiveRestartIndex )
+    {
+        const GLboolean enabled = glIsEnabled( FGH_PRIMITIVE_RESTART );
+        GLint index;
+
+        glGetIntegerv( FGH_PRIMITIVE_RESTART_INDEX, &index );
+        if( !enabled )
+            glEnable( FGH_PRIMITIVE_RESTART );
+        fghPrimitiveRestartIndex( shape->IndexType == GL_UNSIGNED_INT ? 0xFFFFFFFFu : 0xFFFFu );
+        glDrawElements( shape->Mode, shape->NumIndices, shape->IndexType, 0 );
+        fghPrimitiveRestartIndex( (GLuint)index );
+        if( !enabled )
+            glDisable( FGH_PRIMITIVE_RESTART );
+    }
+    else if( fghMultiDrawElements )
+    {
+        if( !shape->PartCounts )
+        {
+            shape->PartCounts = malloc( shape->NumParts * sizeof( GLsizei ) );
+            shape->PartOffsets = malloc( shape->NumParts * sizeof( GLvoid* ) );
+            if( !shape->PartCounts || !shape->PartOffsets )
+                fgError( "Failed to allocate memory in fghDrawShapeStrips" );
+
+            for( i = 0; i < shape->NumParts; i++ )
+            {
+                shape->PartCounts[ i ] = shape->NumVertPerPart;
+                shape->PartOffsets[ i ] = (GLvoid*)( (size_t)size * i * ( shape->NumVertPerPart + 1 ) );
+            }
+        }
+        fghMultiDrawElements( shape->Mode, shape->PartCounts, shape->IndexType,
+                              (const GLvoid* const*)shape->PartOffsets, shape->NumParts );
+    }
+    else
+        for( i = 0; i < shape->NumParts; i++ )
+            glDrawElements( shape->Mode, shape->NumVertPerPart, shape->IndexType,
+                            (GLvoid*)( (size_t)size * i * ( shape->NumVertPerPart + 1 ) ) );
+}
+
+/*
+ * Issues the draw call of a shape, its buffers being bound
+ */
+static void fghDrawShapeParts( SFG_Shape* shape )
+{
+    if( !shape->IndexType )
+        glDrawArrays( shape->Mode, 0, shape->NumVertices );
+    else if( shape->NumParts > 1 )
+        fghDrawShapeStrips( shape );
+    else
+        glDrawElements( shape->Mode, shape->NumIndices, shape->IndexType, 0 );
+}
+
+/*
+ * Adds a shape to the current window's, making room for it
+ */
+static void fghCacheShape( SFG_Shape* shape, const SFG_ShapeKey* key )
+{
+    SFG_Context* context = &fgStructure.CurrentWindow->Window;
+
+    shape->Key = *key;
+    shape->Cached = GL_TRUE;
+    fgListAppend( &context->Shapes, &shape->Node );
+    context->ShapesSize += shape->Size;
+
+    /* Make room, keeping the new shape whatever its size */
+    while( ( fgListLength( &context->Shapes ) > FGH_SHAPE_CACHE_SIZE ||
+             context->ShapesSize > FGH_SHAPE_CACHE_BYTES ) &&
+           context->Shapes.First != &shape->Node )
+    {
+        SFG_Shape* oldest = ( SFG_Shape* )context->Shapes.First;
+        fgListRemove( &context->Shapes, &oldest->Node );
+        context->ShapesSize -= oldest->Size;
+        fghDeleteShape( oldest );
+    }
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Fills in a shape key. Unused parameters are zero.
+ */
+void fgInitShapeKey( SFG_ShapeKey* key, int shape, GLboolean wire,
+                     GLfloat param0, GLfloat param1, GLint divisions0, GLint divisions1 )
+{
+    memset( key, 0, sizeof( SFG_ShapeKey ) );
+    key->Shape = shape;
+    key->Wire = wire;
+    key->Params[ 0 ] = param0;
+    key->Params[ 1 ] = param1;
+    key->Divisions[ 0 ] = divisions0;
+    key->Divisions[ 1 ] = divisions1;
+}
+
+/*
+ * Returns the current window's buffers for a shape, if it has them
+ */
+SFG_Shape* fgFindShape( const SFG_ShapeKey* key )
+{
+    SFG_Context* context = &fgStructure.CurrentWindow->Window;
+    SFG_Shape* shape;
+
+    for( shape = ( SFG_Shape* )context->Shapes.Last; shape;
+         shape = ( SFG_Shape* )shape->Node.Prev )
+        if( fghShapeKeysEqual( &shape->Key, key ) )
+        {
+            /* Keep the list in least recently drawn order */
+            fgListRemove( &context->Shapes, &shape->Node );
+            fgListAppend( &context->Shapes, &shape->Node );
+            return shape;
+        }
+
+    return NULL;
+}
+
+/*
+ * Uploads a shape to buffer objects of the current window. The arguments
+ * are those of fghDrawGeometryWire, mode being how to draw the first set
+ * of indices (or the vertices themselves, without indices) and the second
+ * set being drawn as line loops; for solid shapes, more than one part
+ * means triangle strips. With a key, the shape is kept for fgFindShape,
+ * otherwise fgReleaseShape deletes it.
+ */
+SFG_Shape* fgCreateShape( const SFG_ShapeKey* key,
+                          const GLfloat* vertices, const GLfloat* normals, const GLfloat* textcs,
+                          GLsizei numVertices, GLenum mode,
+                          const GLuint* vertIdxs, GLsizei numParts, GLsizei numVertPerPart,
+                          const GLuint* vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2 )
+{
+    SFG_Shape* shape = calloc( 1, sizeof( SFG_Shape ) );
+    GLuint* indices = NULL;
+    GLubyte* packed;
+
+    if( !shape )
+        fgError( "Failed to allocate memory in fgCreateShape" );
+
+    shape->NumVertices = numVertices;
+    shape->Mode = mode;
+    shape->NumParts = 1;
+
+    fgGLStateBegin( );
+    packed = fghPackShapeVertices( shape, vertices, normals, textcs );
+    fghGenBuffers( 1, &shape->VertexBuffer );
+    fghBindBuffer( FGH_ARRAY_BUFFER, shape->VertexBuffer );
+    fghBufferData( FGH_ARRAY_BUFFER, numVertices * shape->Stride, packed, FGH_STATIC_DRAW );
+    fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+    free( packed );
+    shape->Size = numVertices * shape->Stride;
+
+    if( mode == GL_LINES || mode == GL_LINE_STRIP || mode == GL_LINE_LOOP )
+    {
+        GLuint* end;
+
+        /* At most two indices per vertex of a part */
+        indices = malloc( ( 2 * ( numParts * numVertPerPart +
+                                  ( vertIdxs2 ? numParts2 * numVertPerPart2 : 0 ) ) + 1 ) * sizeof( GLuint ) );
+        if( !indices )
+            fgError( "Failed to allocate memory in fgCreateShape" );
+
+        end = fghAppendLines( indices, mode, vertIdxs, numParts, numVertPerPart );
+        if( vertIdxs2 )
+            end = fghAppendLines( end, GL_LINE_LOOP, vertIdxs2, numParts2, numVertPerPart2 );
+        shape->Mode = GL_LINES;
+        shape->NumIndices = (GLsizei)( end - indices );
+    }
+    else if( vertIdxs && numParts > 1 )
+    {
+        /* Triangle strips, each followed by a restart index but the last */
+        GLsizei i;
+
+        shape->NumParts = numParts;
+        shape->NumVertPerPart = numVertPerPart;
+        shape->NumIndices = numParts * ( numVertPerPart + 1 ) - 1;
+        indices = malloc( ( shape->NumIndices + 1 ) * sizeof( GLuint ) );
+        if( !indices )
+            fgError( "Failed to allocate memory in fgCreateShape" );
+
+        for( i = 0; i < numParts; i++ )
+        {
+            memcpy( indices + i * ( numVertPerPart + 1 ), vertIdxs + i * numVertPerPart,
+                    numVertPerPart * sizeof( GLuint ) );
+            indices[ i * ( numVertPerPart + 1 ) + numVertPerPart ] = 0xFFFFFFFFu;
+        }
+    }
+    else if( vertIdxs )
+    {
+        shape->NumIndices = numParts * numVertPerPart;
+        indices = malloc( ( shape->NumIndices + 1 ) * sizeof( GLuint ) );
+        if( !indices )
+            fgError( "Failed to allocate memory in fgCreateShape" );
+        memcpy( indices, vertIdxs, shape->NumIndices * sizeof( GLuint ) );
+    }
+
+    if( indices )
+    {
+        GLsizei size = sizeof( GLuint );
+
+        /* Up to 0xFFFF vertices, which leaves index 0xFFFF for restarting strips */
+        if( numVertices <= 0xFFFF || !fghHasIndexUint )
+        {
+            GLushort* shortIndices = ( GLushort* )indices;
+            GLsizei i;
+
+            if( numVertices > 0xFFFF )
+                fgWarning( "fgCreateShape: too many slices or stacks requested, indices will wrap" );
+
+            /* In place, front to back */
+            for( i = 0; i < shape->NumIndices; i++ )
+                shortIndices[ i ] = (GLushort)indices[ i ];
+            shape->IndexType = GL_UNSIGNED_SHORT;
+            size = sizeof( GLushort );
+        }
+        else
+            shape->IndexType = GL_UNSIGNED_INT;
+
+        /*
+         * Through the array buffer binding, as the element array buffer
+         * binding belongs to whatever vertex array object is bound
+         */
+        fghGenBuffers( 1, &shape->IndexBuffer );
+        fghBindBuffer( FGH_ARRAY_BUFFER, shape->IndexBuffer );
+        fghBufferData( FGH_ARRAY_BUFFER, shape->NumIndices * size, indices, FGH_STATIC_DRAW );
+        fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+        free( indices );
+        shape->Size += shape->NumIndices * size;
+    }
+    fgGLStateEnd( );
+
+    if( key )
+        fghCacheShape( shape, key );
+
+    return shape;
+}
+
+/*
+ * Takes over a vertex buffer filled on the GPU, of numVertices positions
+ * and normals, followed by texture coordinates if hasTexture, to be drawn
+ * without indices. The normals are laid out as fghPackShapeVertices does
+ * for normalType, GL_SHORT or GL_FLOAT. The key is as for fgCreateShape.
+ */
+SFG_Shape* fgCreateShapeFromBuffer( const SFG_ShapeKey* key, GLuint vertexBuffer,
+                                    GLsizei numVertices, GLenum mode, GLenum normalType,
+                                    GLboolean hasTexture )
+{
+    SFG_Shape* shape = calloc( 1, sizeof( SFG_Shape ) );
+
+    if( !shape )
+        fgError( "Failed to allocate memory in fgCreateShapeFromBuffer" );
+
+    shape->VertexBuffer = vertexBuffer;
+    shape->NormalType = normalType;
+    shape->HasTexture = hasTexture;
+    shape->Stride = 3 * sizeof( GLfloat ) +
+                    ( normalType == GL_SHORT ? 4 * sizeof( GLshort ) : 3 * sizeof( GLfloat ) ) +
+                    ( hasTexture ? 2 * sizeof( GLfloat ) : 0 );
+    shape->Size = (size_t)numVertices * shape->Stride;
+    shape->NumVertices = numVertices;
+    shape->Mode = mode;
+    shape->NumParts = 1;
+
+    if( key )
+        fghCacheShape( shape, key );
+
+    return shape;
+}
+
+/*
+ * Draws a shape with the current window's vertex attributes
+ */
+void fgDrawShape( SFG_Shape* shape )
+{
+    SFG_Context* context = &fgStructure.CurrentWindow->Window;
+    GLint attributes[ 3 ];
+
+    attributes[ 0 ] = context->attribute_v_coord;
+    attributes[ 1 ] = context->attribute_v_normal;
+    attributes[ 2 ] = context->attribute_v_texture;
+
+    fgGLStateBegin( );
+    if( fghGenVertexArrays )
+    {
+        GLint vertexArray;
+        fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &vertexArray );
+
+        /* Set the vertex array up again if the attribute locations changed */
+        if( shape->VertexArray && memcmp( shape->Attributes, attributes, sizeof( attributes ) ) )
+        {
+            fghDeleteVertexArrays( 1, &shape->VertexArray );
+            shape->VertexArray = 0;
+        }
+        if( !shape->VertexArray )
+        {
+            fghGenVertexArrays( 1, &shape->VertexArray );
+            fghBindVertexArray( shape->VertexArray );
+            fghSetShapeAttributes( shape, attributes );
+            if( shape->IndexBuffer )
+                fghBindBuffer( FGH_ELEMENT_ARRAY_BUFFER, shape->IndexBuffer );
+            fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+            memcpy( shape->Attributes, attributes, sizeof( attributes ) );
+        }
+        else
+            fghBindVertexArray( shape->VertexArray );
+
+        fghDrawShapeParts( shape );
+        fghBindVertexArray( vertexArray );
+    }
+    else
+    {
+        fghSetShapeAttributes( shape, attributes );
+        if( shape->IndexBuffer )
+            fghBindBuffer( FGH_ELEMENT_ARRAY_BUFFER, shape->IndexBuffer );
+
+        fghDrawShapeParts( shape );
+
+        /* Clean existing bindings before clean-up */
+        /* Android showed instability otherwise */
+        fghBindBuffer( FGH_ELEMENT_ARRAY_BUFFER, 0 );
+        fghBindBuffer( FGH_ARRAY_BUFFER, 0 );
+        fghDisableShapeAttributes( shape, attributes );
+    }
+    fgGLStateEnd( );
+}
+
+/*
+ * Deletes a shape created without a key, once drawn
+ */
+void fgReleaseShape( SFG_Shape* shape )
+{
+    if( !shape->Cached )
+        fghDeleteShape( shape );
+}
+
+/*
+ * Deletes the shapes of a window, its context being current
+ */
+void fgDestroyShapes( SFG_Window* window )
+{
+    SFG_Shape* shape;
+
+    while( ( shape = ( SFG_Shape* )window->Window.Shapes.First ) )
+    {
+        fgListRemove( &window->Window.Shapes, &shape->Node );
+        fghDeleteShape( shape );
+    }
+    window->Window.ShapesSize = 0;
+}
+
+/*** END OF FILE ***/
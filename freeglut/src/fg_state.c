@@ -122,6 +122,48 @@ void FGAPIENTRY glutSetOption( GLenum eWhat, int value )
       fgState.StrokeFontDrawJoinDots = !!value;
       break;
 
+    case GLUT_BITMAP_FONT_ATLAS:
+      fgState.BitmapFontAtlas = !!value;
+      break;
+
+    case GLUT_GEOMETRY_TEAPOT_SUBDIVISIONS:
+      fgState.TeapotSubdivisions = value > 0 ? value : 0;
+      break;
+
+    case GLUT_GEOMETRY_INSTANCES:
+      fgState.ShapeInstances = value > 0 ? value : 1;
+      break;
+
+    case GLUT_GL_STATE_FILTER:
+      fgState.GLStateFilter = !!value;
+      if( fgStructure.CurrentWindow != NULL )
+        fgGLStateInvalidate( &fgStructure.CurrentWindow->Window );
+      break;
+
+    case GLUT_GL_CALLS_ISSUED:
+      fgState.GLCallsIssued = value;
+      break;
+
+    case GLUT_GL_CALLS_ELIDED:
+      fgState.GLCallsElided = value;
+      break;
+
+    case GLUT_HEADLESS_FRAME_RATE:
+      fgState.FrameRate = value > 0 ? value : 0;
+      break;
+
+    case GLUT_READBACK_DEPTH:
+      fgState.ReadbackDepth = value > 0 ? value : 0;
+      break;
+
+    case GLUT_RECORD_POOL_FRAMES:
+      fgState.RecordPoolFrames = value > 0 ? value : 0;
+      break;
+
+    case GLUT_PROFILE_FRAMES:
+      fgState.ProfileFrames = value > 0 ? value : 0;
+      break;
+
     default:
         fgWarning( "glutSetOption(): missing enum handle %d", eWhat );
         break;
@@ -225,6 +267,40 @@ int FGAPIENTRY glutGet( GLenum eWhat )
     case GLUT_STROKE_FONT_DRAW_JOIN_DOTS:
         return fgState.StrokeFontDrawJoinDots;
 
+    case GLUT_BITMAP_FONT_ATLAS:
+        return fgFontAtlasEnabled();
+
+    case GLUT_GEOMETRY_TEAPOT_SUBDIVISIONS:
+        return fgState.TeapotSubdivisions;
+
+    case GLUT_GEOMETRY_INSTANCES:
+        return fgState.ShapeInstances;
+
+    case GLUT_GL_STATE_FILTER:
+        return fgState.GLStateFilter;
+
+    case GLUT_GL_CALLS_ISSUED:
+        return (int)fgState.GLCallsIssued;
+
+    case GLUT_GL_CALLS_ELIDED:
+        return (int)fgState.GLCallsElided;
+
+    case GLUT_HEADLESS_FRAME_RATE:
+        return fgState.FrameRate;
+
+    case GLUT_READBACK_DEPTH:
+        return fgState.ReadbackDepth;
+
+    case GLUT_RECORD_POOL_FRAMES:
+        return fgState.RecordPoolFrames;
+
+    case GLUT_RECORD_FRAMES_WRITTEN:
+    case GLUT_RECORD_FRAMES_DROPPED:
+        return fgRecordGet( eWhat );
+
+    case GLUT_PROFILE_FRAMES:
+        return fgState.ProfileFrames;
+
     default:
         return fgPlatformGlutGet ( eWhat );
         break;
@@ -0,0 +1,311 @@
+/*
+ * fg_stream.c
+ *
+ * A ring buffer for the vertices and commands freeglut streams to OpenGL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * Data that is drawn once and thrown away, such as the quads of a text
+ * string, a menu batch or indirect draw commands, is suballocated from a
+ * single buffer per context rather than given buffers of its own or
+ * respecified with glBufferData on every draw.
+ *
+ * The buffer is split into FGH_STREAM_REGIONS regions used in turn. When
+ * a range does not fit in the rest of the current region, a fence is put
+ * after the commands that read the region, and the next one is waited
+ * for before being written again; with three regions, that wait is for
+ * commands two regions old and normally returns at once.
+ *
+ * With OpenGL 4.4 the buffer is mapped once, persistently and coherently,
+ * so writing a range is a plain store. Otherwise each range is mapped
+ * unsynchronized with glMapBufferRange, or written with glBufferSubData
+ * from a copy in memory on OpenGL (ES) 2.0. Without fences, the buffer is
+ * orphaned instead each time the ring wraps around.
+ *
+ * A range is written between fgStreamMap and fgStreamUnmap, which must be
+ * called before anything is drawn from it. Both leave the stream buffer
+ * bound to GL_ARRAY_BUFFER. The buffer may be replaced by a larger one,
+ * so its name is returned with every range, and vertex attribute pointers
+ * are to be set again for each.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+#define FGH_STREAM_REGIONS      3
+#define FGH_STREAM_REGION_SIZE  ( 256 * 1024 )  /* Grown for larger ranges */
+#define FGH_STREAM_ALIGNMENT    16
+
+/* Nanoseconds to wait for a fence between checks that it did not fail */
+#define FGH_STREAM_FENCE_TIMEOUT  1000000000ull
+
+struct tagSFG_StreamBuffer
+{
+    GLuint          Buffer;
+    size_t          RegionSize;
+    int             Region;         /* The region being written           */
+    size_t          Head;           /* Its first free byte, in the buffer */
+    fghGLsync       Fences[ FGH_STREAM_REGIONS ];  /* Of regions left     */
+    GLubyte*        Mapped;         /* The whole buffer, if persistent    */
+
+    /* The range between fgStreamMap and fgStreamUnmap */
+    size_t          Offset;
+    size_t          Size;
+    GLboolean       RangeMapped;    /* By glMapBufferRange                */
+    GLubyte*        Staging;        /* For glBufferSubData otherwise      */
+    size_t          StagingSize;
+};
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * Creates the buffer of the ring, with regions of the given size,
+ * leaving it bound to GL_ARRAY_BUFFER
+ */
+static void fghCreateStreamBuffer( SFG_StreamBuffer* stream, size_t regionSize )
+{
+    const size_t size = regionSize * FGH_STREAM_REGIONS;
+
+    fghGenBuffers( 1, &stream->Buffer );
+    fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+    stream->Mapped = NULL;
+
+    if( fghBufferStorage && fghMapBufferRange && fghFenceSync )
+    {
+        const GLbitfield flags = FGH_MAP_WRITE_BIT | FGH_MAP_PERSISTENT_BIT | FGH_MAP_COHERENT_BIT;
+
+        fghBufferStorage( FGH_ARRAY_BUFFER, size, NULL, flags );
+        stream->Mapped = fghMapBufferRange( FGH_ARRAY_BUFFER, 0, size, flags );
+        if( !stream->Mapped )
+        {
+            /* Storage is immutable, so start again with a buffer of the usual kind */
+            fghDeleteBuffers( 1, &stream->Buffer );
+            fghGenBuffers( 1, &stream->Buffer );
+            fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+        }
+    }
+    if( !stream->Mapped )
+        fghBufferData( FGH_ARRAY_BUFFER, size, NULL, FGH_STREAM_DRAW );
+
+    stream->RegionSize = regionSize;
+    stream->Region = 0;
+    stream->Head = 0;
+}
+
+/*
+ * Deletes the buffer of the ring and its fences
+ */
+static void fghReleaseStreamBuffer( SFG_StreamBuffer* stream )
+{
+    int i;
+
+    for( i = 0; i < FGH_STREAM_REGIONS; i++ )
+        if( stream->Fences[ i ] )
+        {
+            fghDeleteSync( stream->Fences[ i ] );
+            stream->Fences[ i ] = NULL;
+        }
+
+    if( stream->Mapped )
+    {
+        fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+        fghUnmapBuffer( FGH_ARRAY_BUFFER );
+        stream->Mapped = NULL;
+    }
+    fghDeleteBuffers( 1, &stream->Buffer );
+    stream->Buffer = 0;
+}
+
+/*
+ * Fences the region being left and moves on to the next one, once the
+ * commands reading that are done with it
+ */
+static void fghNextStreamRegion( SFG_StreamBuffer* stream )
+{
+    fghGLsync fence;
+
+    if( fghFenceSync )
+        stream->Fences[ stream->Region ] = fghFenceSync( FGH_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+    stream->Region = ( stream->Region + 1 ) % FGH_STREAM_REGIONS;
+    stream->Head = stream->Region * stream->RegionSize;
+
+    fence = stream->Fences[ stream->Region ];
+    if( fence )
+    {
+        GLenum status;
+        do
+            status = fghClientWaitSync( fence, FGH_SYNC_FLUSH_COMMANDS_BIT, FGH_STREAM_FENCE_TIMEOUT );
+        while( status == FGH_TIMEOUT_EXPIRED );
+
+        fghDeleteSync( fence );
+        stream->Fences[ stream->Region ] = NULL;
+    }
+    else if( !fghFenceSync && stream->Region == 0 )
+    {
+        /* Let the driver keep the old contents for as long as they are read */
+        fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+        fghBufferData( FGH_ARRAY_BUFFER, stream->RegionSize * FGH_STREAM_REGIONS, NULL,
+                       FGH_STREAM_DRAW );
+    }
+}
+
+/*
+ * Returns the stream of the current window, creating it if needed
+ */
+static SFG_StreamBuffer* fghStream( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+    SFG_StreamBuffer* stream;
+
+    freeglut_return_val_if_fail( window && fgState.HasOpenGL20, NULL );
+
+    stream = window->Window.Stream;
+    if( !stream )
+    {
+        stream = calloc( 1, sizeof( SFG_StreamBuffer ) );
+        if( !stream )
+            fgError( "Failed to allocate memory in fghStream" );
+        fghCreateStreamBuffer( stream, FGH_STREAM_REGION_SIZE );
+        window->Window.Stream = stream;
+    }
+    return stream;
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Reserves size bytes of the stream of the current context, returning
+ * where to write them, or NULL without OpenGL (ES) 2.0. The range is in
+ * *buffer, at *offset bytes from its start.
+ */
+GLvoid* fgStreamMap( size_t size, GLuint* buffer, size_t* offset )
+{
+    SFG_StreamBuffer* stream = fghStream( );
+
+    freeglut_return_val_if_fail( stream, NULL );
+
+    size = ( size + FGH_STREAM_ALIGNMENT - 1 ) & ~(size_t)( FGH_STREAM_ALIGNMENT - 1 );
+    if( size > stream->RegionSize )
+    {
+        size_t regionSize = stream->RegionSize;
+        while( regionSize < size )
+            regionSize *= 2;
+        fghReleaseStreamBuffer( stream );
+        fghCreateStreamBuffer( stream, regionSize );
+    }
+    else if( stream->Head + size > ( stream->Region + 1 ) * stream->RegionSize )
+        fghNextStreamRegion( stream );
+
+    stream->Offset = stream->Head;
+    stream->Size = size;
+    stream->Head += size;
+    stream->RangeMapped = GL_FALSE;
+    *buffer = stream->Buffer;
+    *offset = stream->Offset;
+
+    fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+    if( stream->Mapped )
+        return stream->Mapped + stream->Offset;
+
+    if( fghMapBufferRange )
+    {
+        /* Fences, or orphaning on wrapping around, keep this from racing the GPU */
+        GLvoid* range = fghMapBufferRange( FGH_ARRAY_BUFFER, stream->Offset, size,
+                                           FGH_MAP_WRITE_BIT | FGH_MAP_INVALIDATE_RANGE_BIT |
+                                           FGH_MAP_UNSYNCHRONIZED_BIT );
+        if( range )
+        {
+            stream->RangeMapped = GL_TRUE;
+            return range;
+        }
+    }
+
+    if( stream->StagingSize < size )
+    {
+        free( stream->Staging );
+        stream->Staging = malloc( size );
+        if( !stream->Staging )
+            fgError( "Failed to allocate memory in fgStreamMap" );
+        stream->StagingSize = size;
+    }
+    return stream->Staging;
+}
+
+/*
+ * Makes the range of the last fgStreamMap available for drawing
+ */
+void fgStreamUnmap( void )
+{
+    SFG_StreamBuffer* stream = fghStream( );
+
+    freeglut_return_if_fail( stream );
+
+    fghBindBuffer( FGH_ARRAY_BUFFER, stream->Buffer );
+    if( stream->Mapped )
+        return;
+
+    if( stream->RangeMapped )
+        fghUnmapBuffer( FGH_ARRAY_BUFFER );
+    else
+        fghBufferSubData( FGH_ARRAY_BUFFER, stream->Offset, stream->Size, stream->Staging );
+    stream->RangeMapped = GL_FALSE;
+}
+
+/*
+ * Copies size bytes to the stream of the current context, returning the
+ * buffer they are in, with their offset in *offset, or 0 without OpenGL
+ * (ES) 2.0
+ */
+GLuint fgStreamUpload( const GLvoid* data, size_t size, size_t* offset )
+{
+    GLuint buffer;
+    GLvoid* range = fgStreamMap( size, &buffer, offset );
+
+    freeglut_return_val_if_fail( range, 0 );
+
+    memcpy( range, data, size );
+    fgStreamUnmap( );
+    return buffer;
+}
+
+/*
+ * Releases the stream of a window, which is current
+ */
+void fgDestroyStream( SFG_Window* window )
+{
+    SFG_StreamBuffer* stream = window->Window.Stream;
+
+    freeglut_return_if_fail( stream );
+
+    if( fgState.HasOpenGL20 && fgStructure.CurrentWindow == window )
+        fghReleaseStreamBuffer( stream );
+
+    free( stream->Staging );
+    free( stream );
+    window->Window.Stream = NULL;
+}
+
+/*** END OF FILE ***/
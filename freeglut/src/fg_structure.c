@@ -262,7 +262,10 @@ static void fghRemoveMenuFromMenu( SFG_Menu* from, SFG_Menu* menu )
          entry;
          entry = ( SFG_MenuEntry * )entry->Node.Next )
         if( entry->SubMenu == menu )
+        {
             entry->SubMenu = NULL;
+            from->CacheValid = GL_FALSE;    /* The arrow has to go */
+        }
 }
 
 /*
@@ -318,6 +321,17 @@ void fgDestroyMenu( SFG_Menu* menu )
         free( entry );
     }
 
+    free( menu->EntryTable );
+
+    /* The cached contents belong to the menu window's context */
+    if( menu->CacheTexture )
+    {
+        SFG_Window *activeWindow = fgStructure.CurrentWindow;
+        fgSetWindow( menu->Window );
+        glDeleteTextures( 1, &menu->CacheTexture );
+        fgSetWindow( activeWindow );
+    }
+
     if( fgStructure.CurrentWindow == menu->Window )
         fgSetWindow( NULL );
     fgDestroyWindow( menu->Window );
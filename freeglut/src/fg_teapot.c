@@ -33,110 +33,76 @@
 #include <GL/freeglut.h>
 #include "fg_internal.h"
 #include "fg_teapot_data.h"
+#if !TARGET_HOST_MS_WINDOWS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 /* -- STATIC VARS: CACHES ---------------------------------------------------- */
 
 /* General defs */
 #define GLUT_SOLID_N_SUBDIV  8
 #define GLUT_WIRE_N_SUBDIV   10
+#define GLUT_MAX_N_SUBDIV    256        /* For GLUT_GEOMETRY_TEAPOT_SUBDIVISIONS */
 
-/* Bernstein coefficients only have to be precomputed once (number of patch subdivisions is fixed)
- * Can thus define arrays for them here, they will be filled upon first use.
- * 3rd order Bezier surfaces have 4 Bernstein coeffs.
- * Have separate caches for solid and wire as they use a different number of subdivisions
- * _0 is for Bernstein polynomials, _1 for their first derivative (which we need for normals)
- */
-static GLfloat bernWire_0 [GLUT_WIRE_N_SUBDIV] [4];
-static GLfloat bernWire_1 [GLUT_WIRE_N_SUBDIV] [4];
-static GLfloat bernSolid_0[GLUT_SOLID_N_SUBDIV][4];
-static GLfloat bernSolid_1[GLUT_SOLID_N_SUBDIV][4];
+/* Patches are evaluated on several threads once there are this many
+ * vertices to evaluate (before rotating or flipping them) */
+#define GLUT_TEASET_PARALLEL_N_VERT  16384
+#define GLUT_TEASET_MAX_THREADS      16
 
 /* Teapot defs */
 #define GLUT_TEAPOT_N_PATCHES       (6*4 + 4*2)                                                                     /* 6 patches are reproduced (rotated) 4 times, 4 patches (flipped) 2 times */
-#define GLUT_SOLID_TEAPOT_N_VERT    GLUT_SOLID_N_SUBDIV*GLUT_SOLID_N_SUBDIV * GLUT_TEAPOT_N_PATCHES                 /* N_SUBDIV^2 vertices per patch */
-#define GLUT_SOLID_TEAPOT_N_TRI     (GLUT_SOLID_N_SUBDIV-1)*(GLUT_SOLID_N_SUBDIV-1) * GLUT_TEAPOT_N_PATCHES * 2     /* if e.g. 7x7 vertices for each patch, there are 6*6 squares for each patch. Each square is decomposed into 2 triangles */
-
-#define GLUT_WIRE_TEAPOT_N_VERT     GLUT_WIRE_N_SUBDIV*GLUT_WIRE_N_SUBDIV * GLUT_TEAPOT_N_PATCHES                   /* N_SUBDIV^2 vertices per patch */
-
-/* Bit of caching:
- * vertex indices and normals only need to be generated once for
- * a given number of subdivisions as they don't change with scale.
- * Vertices can be cached and reused if scale didn't change.
- */
-static GLushort vertIdxsTeapotS[GLUT_SOLID_TEAPOT_N_TRI*3];
-static GLfloat  normsTeapotS   [GLUT_SOLID_TEAPOT_N_VERT*3];
-static GLfloat  vertsTeapotS   [GLUT_SOLID_TEAPOT_N_VERT*3];
-static GLfloat  texcsTeapotS   [GLUT_SOLID_TEAPOT_N_VERT*2];
-static GLfloat  lastScaleTeapotS = 0.f;
-static GLboolean initedTeapotS   = GL_FALSE;
-
-static GLushort vertIdxsTeapotW[GLUT_WIRE_TEAPOT_N_VERT*2];
-static GLfloat  normsTeapotW   [GLUT_WIRE_TEAPOT_N_VERT*3];
-static GLfloat  vertsTeapotW   [GLUT_WIRE_TEAPOT_N_VERT*3];
-static GLfloat  lastScaleTeapotW = 0.f;
-static GLboolean initedTeapotW   = GL_FALSE;
-
 
 /* Teacup defs */
 #define GLUT_TEACUP_N_PATCHES       (6*4 + 1*2)                                                                     /* 6 patches are reproduced (rotated) 4 times, 1 patch (flipped) 2 times */
-#define GLUT_SOLID_TEACUP_N_VERT    GLUT_SOLID_N_SUBDIV*GLUT_SOLID_N_SUBDIV * GLUT_TEACUP_N_PATCHES                 /* N_SUBDIV^2 vertices per patch */
-#define GLUT_SOLID_TEACUP_N_TRI     (GLUT_SOLID_N_SUBDIV-1)*(GLUT_SOLID_N_SUBDIV-1) * GLUT_TEACUP_N_PATCHES * 2     /* if e.g. 7x7 vertices for each patch, there are 6*6 squares for each patch. Each square is decomposed into 2 triangles */
-
-#define GLUT_WIRE_TEACUP_N_VERT     GLUT_WIRE_N_SUBDIV*GLUT_WIRE_N_SUBDIV * GLUT_TEACUP_N_PATCHES                   /* N_SUBDIV^2 vertices per patch */
-
-/* Bit of caching:
- * vertex indices and normals only need to be generated once for
- * a given number of subdivisions as they don't change with scale.
- * Vertices can be cached and reused if scale didn't change.
- */
-static GLushort vertIdxsTeacupS[GLUT_SOLID_TEACUP_N_TRI*3];
-static GLfloat  normsTeacupS   [GLUT_SOLID_TEACUP_N_VERT*3];
-static GLfloat  vertsTeacupS   [GLUT_SOLID_TEACUP_N_VERT*3];
-static GLfloat  texcsTeacupS   [GLUT_SOLID_TEACUP_N_VERT*2];
-static GLfloat  lastScaleTeacupS = 0.f;
-static GLboolean initedTeacupS   = GL_FALSE;
-
-static GLushort vertIdxsTeacupW[GLUT_WIRE_TEACUP_N_VERT*2];
-static GLfloat  normsTeacupW   [GLUT_WIRE_TEACUP_N_VERT*3];
-static GLfloat  vertsTeacupW   [GLUT_WIRE_TEACUP_N_VERT*3];
-static GLfloat  lastScaleTeacupW = 0.f;
-static GLboolean initedTeacupW   = GL_FALSE;
-
 
 /* Teaspoon defs */
 #define GLUT_TEASPOON_N_PATCHES     GLUT_TEASPOON_N_INPUT_PATCHES
-#define GLUT_SOLID_TEASPOON_N_VERT  GLUT_SOLID_N_SUBDIV*GLUT_SOLID_N_SUBDIV * GLUT_TEASPOON_N_PATCHES               /* N_SUBDIV^2 vertices per patch */
-#define GLUT_SOLID_TEASPOON_N_TRI   (GLUT_SOLID_N_SUBDIV-1)*(GLUT_SOLID_N_SUBDIV-1) * GLUT_TEASPOON_N_PATCHES * 2   /* if e.g. 7x7 vertices for each patch, there are 6*6 squares for each patch. Each square is decomposed into 2 triangles */
-
-#define GLUT_WIRE_TEASPOON_N_VERT   GLUT_WIRE_N_SUBDIV*GLUT_WIRE_N_SUBDIV * GLUT_TEASPOON_N_PATCHES                 /* N_SUBDIV^2 vertices per patch */
 
 /* Bit of caching:
- * vertex indices and normals only need to be generated once for
- * a given number of subdivisions as they don't change with scale.
- * Vertices can be cached and reused if scale didn't change.
+ * vertex indices, normals, texture coordinates and the vertices at unit
+ * scale only need to be generated once for a given number of
+ * subdivisions. Bezier patches are linear in their control points, so the
+ * vertices at any other scale are the unit ones scaled; those at the
+ * scale last drawn are kept.
  */
-static GLushort vertIdxsTeaspoonS[GLUT_SOLID_TEASPOON_N_TRI*3];
-static GLfloat  normsTeaspoonS   [GLUT_SOLID_TEASPOON_N_VERT*3];
-static GLfloat  vertsTeaspoonS   [GLUT_SOLID_TEASPOON_N_VERT*3];
-static GLfloat  texcsTeaspoonS   [GLUT_SOLID_TEASPOON_N_VERT*2];
-static GLfloat  lastScaleTeaspoonS = 0.f;
-static GLboolean initedTeaspoonS   = GL_FALSE;
-
-static GLushort vertIdxsTeaspoonW[GLUT_WIRE_TEASPOON_N_VERT*2];
-static GLfloat  normsTeaspoonW   [GLUT_WIRE_TEASPOON_N_VERT*3];
-static GLfloat  vertsTeaspoonW   [GLUT_WIRE_TEASPOON_N_VERT*3];
-static GLfloat  lastScaleTeaspoonW = 0.f;
-static GLboolean initedTeaspoonW   = GL_FALSE;
-
+typedef struct tagSFG_Teaset SFG_Teaset;
+struct tagSFG_Teaset
+{
+    int       NumSubDivs;           /* 0 if not tessellated yet */
+    GLuint   *VertIdxs;
+    GLfloat  *UnitVerts;
+    GLfloat  *Verts;
+    GLfloat  *Norms;
+    GLfloat  *Texcs;                /* Solid only */
+    GLfloat   LastScale;
+};
+
+static SFG_Teaset teasetTeapotS,   teasetTeapotW;
+static SFG_Teaset teasetTeacupS,   teasetTeacupW;
+static SFG_Teaset teasetTeaspoonS, teasetTeaspoonW;
+
+/* The control points of every patch of the teapot, teacup and teaspoon,
+ * for tessellation on the GPU (see fg_teapot_gpu.c) */
+#define FREEGLUT_NUM_TEASETS 3     /* Teapot, teacup and teaspoon */
+static GLfloat *teasetPatches[FREEGLUT_NUM_TEASETS];
+
+/* The patches one thread evaluates */
+typedef struct tagSFG_TeasetJob SFG_TeasetJob;
+struct tagSFG_TeasetJob
+{
+    GLfloat   (*cpdata)[3];
+    int       (*patchdata)[16];
+    GLboolean needNormalFix, rotFlip;
+    GLfloat   zOffset;
+    int       nSubDivs;
+    GLfloat  *bern_0, *bern_1;      /* [4][nSubDivs] */
+    GLfloat  *verts, *norms;
+    int       firstPatch, lastPatch;
+};
 
 
 /* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
-extern void fghDrawGeometrySolid(GLfloat *vertices, GLfloat *normals, GLfloat *textcs, GLsizei numVertices,
-                                 GLushort *vertIdxs, GLsizei numParts, GLsizei numVertIdxsPerPart);
-extern void fghDrawGeometryWire(GLfloat *vertices, GLfloat *normals, GLsizei numVertices,
-                                GLushort *vertIdxs, GLsizei numParts, GLsizei numVertPerPart, GLenum vertexMode,
-                                GLushort *vertIdxs2, GLsizei numParts2, GLsizei numVertPerPart2);
-
 /* evaluate 3rd order Bernstein polynomial and its 1st deriv */
 static void bernstein3(int i, GLfloat x, GLfloat *r0, GLfloat *r1)
 {
@@ -171,14 +137,15 @@ static void bernstein3(int i, GLfloat x, GLfloat *r0, GLfloat *r1)
     }
 }
 
-static void pregenBernstein(int nSubDivs, GLfloat (*bern_0)[4], GLfloat (*bern_1)[4])
+/* bern_0 and bern_1 are [4][nSubDivs], so that a coefficient is contiguous for all points */
+static void pregenBernstein(int nSubDivs, GLfloat *bern_0, GLfloat *bern_1)
 {
     int s,i;
     for (s=0; s<nSubDivs; s++)
     {
         GLfloat x = s/(nSubDivs-1.f);
         for (i=0; i<4; i++) /* 3rd order polynomial */
-            bernstein3(i,x,bern_0[s]+i,bern_1[s]+i);
+            bernstein3(i,x,bern_0+i*nSubDivs+s,bern_1+i*nSubDivs+s);
     }
 }
 
@@ -223,53 +190,73 @@ static void rotOrReflect(int flag, int nVals, int nSubDivs, GLfloat *vals)
     }
 }
 
-/* verts array should be initialized to 0! */
-static int evalBezierWithNorm(GLfloat cp[4][4][3], int nSubDivs, float (*bern_0)[4], float (*bern_1)[4], int flag, int normalFix, GLfloat *verts, GLfloat *norms)
+/* The surface is evaluated separably: the four rows of control points
+ * are first evaluated as curves at every v, then those curves at every u.
+ * Each vertex thus takes 4 rather than 16 control points, and the inner
+ * loops run over the vertices of a row in arrays of their own, which
+ * compilers vectorise. work holds 33*nSubDivs floats.
+ */
+static int evalBezierWithNorm(GLfloat cp[4][4][3], int nSubDivs, GLfloat *bern_0, GLfloat *bern_1, int flag, int normalFix, GLfloat *verts, GLfloat *norms, GLfloat *work)
 {
     int nVerts    = nSubDivs*nSubDivs;
     int nVertVals = nVerts*3;               /* number of values output for one patch, flag (2 or 4) indicates how many times we will write this to output */
-    int u,v,i,j,o;
-
-    /* generate vertices and coordinates for the patch */
-    for (u=0,o=0; u<nSubDivs; u++)
-    {
-        for (v=0; v<nSubDivs; v++, o+=3)
+    GLfloat *curve_0 = work;                /* [4 rows][3 coords][nSubDivs], the rows at each v */
+    GLfloat *curve_1 = curve_0 + 12*nSubDivs;   /* and their derivatives along v */
+    GLfloat *pos  = curve_1 + 12*nSubDivs;  /* [3 coords][nSubDivs], the vertices of a row */
+    GLfloat *tan1 = pos  + 3*nSubDivs;      /* tangents along v */
+    GLfloat *tan2 = tan1 + 3*nSubDivs;      /* tangents along u */
+    int u,v,i,c,o;
+
+    /* evaluate the rows of control points along v */
+    for (i=0; i<4; i++)
+        for (c=0; c<3; c++)
         {
-            /* for normals, get two tangents at the vertex using partial derivatives of 2D Bezier grid */
-            float tan1[3]={0}, tan2[3]={0}, len;
-            for (i=0; i<=3; i++)
+            const GLfloat p0 = cp[i][0][c], p1 = cp[i][1][c], p2 = cp[i][2][c], p3 = cp[i][3][c];
+            GLfloat *r0 = curve_0 + (i*3+c)*nSubDivs;
+            GLfloat *r1 = curve_1 + (i*3+c)*nSubDivs;
+
+            for (v=0; v<nSubDivs; v++)
             {
-                float vert_0[3]={0}, vert_1[3]={0};
-                for (j=0; j<=3; j++)
-                {
-                    vert_0[0] += bern_0[v][j] * cp[i][j][0];
-                    vert_0[1] += bern_0[v][j] * cp[i][j][1];
-                    vert_0[2] += bern_0[v][j] * cp[i][j][2];
+                r0[v] = bern_0[v]*p0 + bern_0[nSubDivs+v]*p1 + bern_0[2*nSubDivs+v]*p2 + bern_0[3*nSubDivs+v]*p3;
+                r1[v] = bern_1[v]*p0 + bern_1[nSubDivs+v]*p1 + bern_1[2*nSubDivs+v]*p2 + bern_1[3*nSubDivs+v]*p3;
+            }
+        }
 
-                    vert_1[0] += bern_1[v][j] * cp[i][j][0];
-                    vert_1[1] += bern_1[v][j] * cp[i][j][1];
-                    vert_1[2] += bern_1[v][j] * cp[i][j][2];
-                }
+    /* then those curves along u, a row of vertices at a time */
+    for (u=0,o=0; u<nSubDivs; u++)
+    {
+        const GLfloat b0[4] = { bern_0[u], bern_0[nSubDivs+u], bern_0[2*nSubDivs+u], bern_0[3*nSubDivs+u] };
+        const GLfloat b1[4] = { bern_1[u], bern_1[nSubDivs+u], bern_1[2*nSubDivs+u], bern_1[3*nSubDivs+u] };
 
-                verts[o+0] += bern_0[u][i]*vert_0[0];
-                verts[o+1] += bern_0[u][i]*vert_0[1];
-                verts[o+2] += bern_0[u][i]*vert_0[2];
+        for (c=0; c<3; c++)
+        {
+            const GLfloat *r00 = curve_0 + c*nSubDivs, *r01 = r00 + 3*nSubDivs, *r02 = r01 + 3*nSubDivs, *r03 = r02 + 3*nSubDivs;
+            const GLfloat *r10 = curve_1 + c*nSubDivs, *r11 = r10 + 3*nSubDivs, *r12 = r11 + 3*nSubDivs, *r13 = r12 + 3*nSubDivs;
+            GLfloat *pc = pos + c*nSubDivs, *t1 = tan1 + c*nSubDivs, *t2 = tan2 + c*nSubDivs;
 
-                tan1[0] += bern_0[u][i]*vert_1[0];
-                tan1[1] += bern_0[u][i]*vert_1[1];
-                tan1[2] += bern_0[u][i]*vert_1[2];
-                tan2[0] += bern_1[u][i]*vert_0[0];
-                tan2[1] += bern_1[u][i]*vert_0[1];
-                tan2[2] += bern_1[u][i]*vert_0[2];
+            for (v=0; v<nSubDivs; v++)
+            {
+                pc[v] = b0[0]*r00[v] + b0[1]*r01[v] + b0[2]*r02[v] + b0[3]*r03[v];
+                t1[v] = b0[0]*r10[v] + b0[1]*r11[v] + b0[2]*r12[v] + b0[3]*r13[v];
+                t2[v] = b1[0]*r00[v] + b1[1]*r01[v] + b1[2]*r02[v] + b1[3]*r03[v];
             }
-            /* get normal through cross product of the two tangents of the vertex */
-            norms[o+0] = tan1[1] * tan2[2] - tan1[2] * tan2[1];
-            norms[o+1] = tan1[2] * tan2[0] - tan1[0] * tan2[2];
-            norms[o+2] = tan1[0] * tan2[1] - tan1[1] * tan2[0];
-            len = (GLfloat)sqrt(norms[o+0] * norms[o+0] + norms[o+1] * norms[o+1] + norms[o+2] * norms[o+2]);
-            norms[o+0] /= len;
-            norms[o+1] /= len;
-            norms[o+2] /= len;
+        }
+
+        /* get normal through cross product of the two tangents of the vertex */
+        for (v=0; v<nSubDivs; v++, o+=3)
+        {
+            const GLfloat *t1 = tan1 + v, *t2 = tan2 + v;
+            GLfloat n0 = t1[nSubDivs] * t2[2*nSubDivs] - t1[2*nSubDivs] * t2[nSubDivs];
+            GLfloat n1 = t1[2*nSubDivs] * t2[0] - t1[0] * t2[2*nSubDivs];
+            GLfloat n2 = t1[0] * t2[nSubDivs] - t1[nSubDivs] * t2[0];
+            GLfloat len = (GLfloat)sqrt(n0*n0 + n1*n1 + n2*n2);
+
+            verts[o+0] = pos[v];
+            verts[o+1] = pos[nSubDivs+v];
+            verts[o+2] = pos[2*nSubDivs+v];
+            norms[o+0] = n0/len;
+            norms[o+1] = n1/len;
+            norms[o+2] = n2/len;
         }
     }
 
@@ -291,185 +278,384 @@ static int evalBezierWithNorm(GLfloat cp[4][4][3], int nSubDivs, float (*bern_0)
     return nVertVals*flag;
 }
 
-/* verts array should be initialized to 0! */
-static int evalBezier(GLfloat cp[4][4][3], int nSubDivs, float (*bern_0)[4], int flag, GLfloat *verts)
+/* For teapot and teacup, first six patches get 3 copies (rotations), others get 2 copies (flips). No rotating or flipping at all for teaspoon */
+static int teasetPatchFlag(GLboolean rotFlip, int p)
 {
-    int nVerts    = nSubDivs*nSubDivs;
-    int nVertVals = nVerts*3;               /* number of values output for one patch, flag (2 or 4) indicates how many times we will write this to output */
-    int u,v,i,j,o;
+    return rotFlip?p<6?4:2:1;
+}
 
-    /* generate vertices and coordinates for the patch */
-    for (u=0,o=0; u<nSubDivs; u++)
+/* Evaluates the patches of a job, at unit scale */
+static void evalTeasetPatches(SFG_TeasetJob *job)
+{
+    const int nSubDivs = job->nSubDivs;
+    GLfloat cp[4][4][3];
+    GLfloat *work;
+    int p,o;
+
+    work = malloc(33*nSubDivs*sizeof(GLfloat));
+    if (!work)
+        fgError("Failed to allocate memory in evalTeasetPatches");
+
+    /* output of the patches before the first of this job */
+    for (p=0, o=0; p<job->firstPatch; p++)
+        o += nSubDivs*nSubDivs*3*teasetPatchFlag(job->rotFlip, p);
+
+    for (; p<job->lastPatch; p++)
     {
-        for (v=0; v<nSubDivs; v++, o+=3)
-        {
-            for (i=0; i<=3; i++)
-            {
-                float vert_0[3]={0};
-                for (j=0; j<=3; j++)
-                {
-                    vert_0[0] += bern_0[v][j] * cp[i][j][0];
-                    vert_0[1] += bern_0[v][j] * cp[i][j][1];
-                    vert_0[2] += bern_0[v][j] * cp[i][j][2];
-                }
+        /* set flags for evalBezier function */
+        int flag      = teasetPatchFlag(job->rotFlip, p);
+        int normalFix = job->needNormalFix?p==3?1:p==5?2:0:0;   /* For teapot, fix normal vectors for vertices on top of lid (patch 4) and on middle of bottom (patch 6). Different flag value as different normal needed */
 
-                verts[o+0] += bern_0[u][i]*vert_0[0];
-                verts[o+1] += bern_0[u][i]*vert_0[1];
-                verts[o+2] += bern_0[u][i]*vert_0[2];
-            }
+        /* collect control points */
+        int i;
+        for (i=0; i<16; i++)
+        {
+            /* Original code draws with a 270?rot around X axis, a scaling and a translation along the Z-axis.
+             * Incorporating these in the control points is much cheaper than transforming all the vertices.
+             * Original:
+             * glRotated( 270.0, 1.0, 0.0, 0.0 );
+             * glScaled( 0.5 * scale, 0.5 * scale, 0.5 * scale );
+             * glTranslated( 0.0, 0.0, -zOffset );  -> was 1.5 for teapot, but should be 1.575 to center it on the Z axis. Teacup and teaspoon have different offsets
+             * The scale is applied to the vertices afterwards, see fghTeaset.
+             */
+            cp[i/4][i%4][0] =  job->cpdata[job->patchdata[p][i]][0]              /2.f;
+            cp[i/4][i%4][1] = (job->cpdata[job->patchdata[p][i]][2]-job->zOffset)/2.f;
+            cp[i/4][i%4][2] = -job->cpdata[job->patchdata[p][i]][1]              /2.f;
         }
-    }
 
-    /* now based on flag either rotate patches around y axis to other 3 quadrants (flag=4) or reflect patch across x-y plane (flag=2) */
-    rotOrReflect(flag, nVertVals, nSubDivs, verts);
+        /* eval bezier patch */
+        o += evalBezierWithNorm(cp,nSubDivs,job->bern_0,job->bern_1, flag, normalFix, job->verts+o,job->norms+o, work);
+    }
 
-    return nVertVals*flag;
+    free(work);
 }
 
-static void fghTeaset( GLfloat scale, GLboolean useWireMode,
-                       GLfloat (*cpdata)[3], int (*patchdata)[16],
-                       GLushort *vertIdxs,
-                       GLfloat *verts, GLfloat *norms, GLfloat *texcs,
-                       GLfloat *lastScale, GLboolean *inited,
-                       GLboolean needNormalFix, GLboolean rotFlip, GLfloat zOffset,
-                       int nVerts, int nInputPatches, int nPatches, int nTriangles )
+#if TARGET_HOST_MS_WINDOWS
+static DWORD WINAPI teasetThread(LPVOID job)
 {
-    /* for internal use */
-    int p,o;
-    GLfloat cp[4][4][3];
-    /* to hold pointers to static vars/arrays */
-    GLfloat (*bern_0)[4], (*bern_1)[4];
-    int nSubDivs;
+    evalTeasetPatches(job);
+    return 0;
+}
+#else
+static void *teasetThread(void *job)
+{
+    evalTeasetPatches(job);
+    return NULL;
+}
+#endif
 
-    /* Get relevant static arrays and variables */
-    bern_0      = useWireMode ? bernWire_0                : bernSolid_0;
-    bern_1      = useWireMode ? bernWire_1                : bernSolid_1;
-    nSubDivs    = useWireMode ? GLUT_WIRE_N_SUBDIV        : GLUT_SOLID_N_SUBDIV;
+static int teasetNumThreads(void)
+{
+#if TARGET_HOST_MS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
 
-    /* check if need to generate vertices */
-    if (!*inited || scale != *lastScale)
+/* Evaluates all patches, splitting them over threads when there are enough
+ * vertices. Patches write to separate parts of the output, so the threads
+ * do not share anything but their input. The calling thread takes the
+ * first share, and any other share a thread could not be started for.
+ */
+static void evalTeasetPatchesParallel(SFG_TeasetJob *job, int nInputPatches)
+{
+    SFG_TeasetJob jobs[GLUT_TEASET_MAX_THREADS];
+#if TARGET_HOST_MS_WINDOWS
+    HANDLE threads[GLUT_TEASET_MAX_THREADS];
+#else
+    pthread_t threads[GLUT_TEASET_MAX_THREADS];
+#endif
+    GLboolean started[GLUT_TEASET_MAX_THREADS];
+    int nThreads = 1, t;
+
+    if (job->nSubDivs*job->nSubDivs*nInputPatches >= GLUT_TEASET_PARALLEL_N_VERT)
+        nThreads = teasetNumThreads();
+    if (nThreads > GLUT_TEASET_MAX_THREADS)
+        nThreads = GLUT_TEASET_MAX_THREADS;
+    if (nThreads > nInputPatches)
+        nThreads = nInputPatches;
+
+    for (t=0; t<nThreads; t++)
     {
-        /* set vertex array to all 0 (not necessary for normals and vertex indices) */
-        memset(verts,0,nVerts*3*sizeof(GLfloat));
+        jobs[t] = *job;
+        jobs[t].firstPatch = nInputPatches* t   /nThreads;
+        jobs[t].lastPatch  = nInputPatches*(t+1)/nThreads;
+        started[t] = GL_FALSE;
+    }
+
+    for (t=1; t<nThreads; t++)
+#if TARGET_HOST_MS_WINDOWS
+        started[t] = (threads[t] = CreateThread(NULL, 0, teasetThread, &jobs[t], 0, NULL)) != NULL;
+#else
+        started[t] = pthread_create(&threads[t], NULL, teasetThread, &jobs[t]) == 0;
+#endif
 
-        /* pregen Berstein polynomials and their first derivatives (for normals) */
-        if (!*inited)
-            pregenBernstein(nSubDivs,bern_0,bern_1);
+    for (t=0; t<nThreads; t++)
+        if (!started[t])
+            evalTeasetPatches(&jobs[t]);
 
-        /* generate vertices and normals */
-        for (p=0, o=0; p<nInputPatches; p++)
+    for (t=1; t<nThreads; t++)
+        if (started[t])
         {
-            /* set flags for evalBezier function */
-            int flag      = rotFlip?p<6?4:2:1;                  /* For teapot and teacup, first six patches get 3 copies (rotations), others get 2 copies (flips). No rotating or flipping at all for teaspoon */
-            int normalFix = needNormalFix?p==3?1:p==5?2:0:0;    /* For teapot, fix normal vectors for vertices on top of lid (patch 4) and on middle of bottom (patch 6). Different flag value as different normal needed */
+#if TARGET_HOST_MS_WINDOWS
+            WaitForSingleObject(threads[t], INFINITE);
+            CloseHandle(threads[t]);
+#else
+            pthread_join(threads[t], NULL);
+#endif
+        }
+}
 
-            /* collect control points */
-            int i;
-            for (i=0; i<16; i++)
+/* Gives the control points of all the patches of a teaset, one set per
+ * rotated or flipped copy, as 16 (x,y,z,w) per patch. They are those
+ * evalTeasetPatches uses, of the patch the copy is made from: the GPU
+ * evaluates it and then copies the vertices as rotOrReflect does, for
+ * them to come out the same. The w of the first point is the normal fix,
+ * that of the second the copy, 1 to 3 for the rotations and 4 for the flip.
+ */
+static GLfloat *expandTeasetPatches(GLfloat (*cpdata)[3], int (*patchdata)[16],
+                                    GLboolean needNormalFix, GLboolean rotFlip, GLfloat zOffset,
+                                    int nInputPatches, int nPatches)
+{
+    GLfloat *patches = malloc(nPatches*16*4*sizeof(GLfloat));
+    GLfloat *o = patches;
+    int p,c,i;
+
+    if (!patches)
+        fgError("Failed to allocate memory in expandTeasetPatches");
+
+    for (p=0; p<nInputPatches; p++)
+    {
+        int flag      = teasetPatchFlag(rotFlip, p);
+        int normalFix = needNormalFix?p==3?1:p==5?2:0:0;
+
+        for (c=0; c<flag; c++)
+            for (i=0; i<16; i++, o+=4)
             {
-                /* Original code draws with a 270?rot around X axis, a scaling and a translation along the Z-axis.
-                 * Incorporating these in the control points is much cheaper than transforming all the vertices.
-                 * Original:
-                 * glRotated( 270.0, 1.0, 0.0, 0.0 );
-                 * glScaled( 0.5 * scale, 0.5 * scale, 0.5 * scale );
-                 * glTranslated( 0.0, 0.0, -zOffset );  -> was 1.5 for teapot, but should be 1.575 to center it on the Z axis. Teacup and teaspoon have different offsets
-                 */
-                cp[i/4][i%4][0] =  cpdata[patchdata[p][i]][0]         *scale/2.f;
-                cp[i/4][i%4][1] = (cpdata[patchdata[p][i]][2]-zOffset)*scale/2.f;
-                cp[i/4][i%4][2] = -cpdata[patchdata[p][i]][1]         *scale/2.f;
+                const GLfloat *pt = cpdata[patchdata[p][i]];
+
+                o[0] =  pt[0]         /2.f;
+                o[1] = (pt[2]-zOffset)/2.f;
+                o[2] = -pt[1]         /2.f;
+                o[3] = i==0 ? (GLfloat)normalFix : i==1 ? (GLfloat)(flag==2 ? c*4 : c) : 0.f;
             }
+    }
 
-            /* eval bezier patch */
-            if (!*inited)   /* first time, generate normals as well */
-                o += evalBezierWithNorm(cp,nSubDivs,bern_0,bern_1, flag, normalFix, verts+o,norms+o);
-            else            /* only need to regen vertices */
-                o += evalBezier(cp,nSubDivs,bern_0, flag, verts+o);
-        }
-        *lastScale = scale;
+    return patches;
+}
 
-        if (!*inited)
+static void freeTeaset(SFG_Teaset *teaset)
+{
+    free(teaset->VertIdxs);
+    free(teaset->UnitVerts);
+    free(teaset->Verts);
+    free(teaset->Norms);
+    free(teaset->Texcs);
+    memset(teaset, 0, sizeof(SFG_Teaset));
+}
+
+/* Generates the vertices at unit scale, normals, texture coordinates and vertex indices of a teaset */
+static void tessellateTeaset(SFG_Teaset *teaset, int nSubDivs, GLboolean useWireMode,
+                             GLfloat (*cpdata)[3], int (*patchdata)[16],
+                             GLboolean needNormalFix, GLboolean rotFlip, GLfloat zOffset,
+                             int nInputPatches, int nPatches)
+{
+    const int nVerts = nSubDivs*nSubDivs*nPatches;
+    const int nVertIdxs = useWireMode ? nVerts*2 : (nSubDivs-1)*(nSubDivs-1)*nPatches*6;
+    SFG_TeasetJob job;
+    GLuint *vertIdxs;
+    GLfloat *texcs;
+    int p,r,c,o;
+
+    freeTeaset(teaset);
+    teaset->UnitVerts = malloc(nVerts*3*sizeof(GLfloat));
+    teaset->Verts     = malloc(nVerts*3*sizeof(GLfloat));
+    teaset->Norms     = malloc(nVerts*3*sizeof(GLfloat));
+    teaset->VertIdxs  = malloc(nVertIdxs*sizeof(GLuint));
+    if (!useWireMode)
+        teaset->Texcs = malloc(nVerts*2*sizeof(GLfloat));
+    job.bern_0 = malloc(4*nSubDivs*sizeof(GLfloat));
+    job.bern_1 = malloc(4*nSubDivs*sizeof(GLfloat));
+    if (!teaset->UnitVerts || !teaset->Verts || !teaset->Norms || !teaset->VertIdxs ||
+        (!useWireMode && !teaset->Texcs) || !job.bern_0 || !job.bern_1)
+        fgError("Failed to allocate memory in tessellateTeaset");
+    vertIdxs = teaset->VertIdxs;
+    texcs    = teaset->Texcs;
+
+    /* pregen Berstein polynomials and their first derivatives (for normals) */
+    pregenBernstein(nSubDivs,job.bern_0,job.bern_1);
+
+    /* generate vertices and normals */
+    job.cpdata        = cpdata;
+    job.patchdata     = patchdata;
+    job.needNormalFix = needNormalFix;
+    job.rotFlip       = rotFlip;
+    job.zOffset       = zOffset;
+    job.nSubDivs      = nSubDivs;
+    job.verts         = teaset->UnitVerts;
+    job.norms         = teaset->Norms;
+    evalTeasetPatchesParallel(&job, nInputPatches);
+    free(job.bern_0);
+    free(job.bern_1);
+
+    /* generate texture coordinates if solid teapot/teacup/teaspoon */
+    if (!useWireMode)
+    {
+        /* generate for first patch */
+        for (r=0,o=0; r<nSubDivs; r++)
         {
-            int r,c;
-            /* generate texture coordinates if solid teapot/teacup/teaspoon */
-            if (!useWireMode)
+            GLfloat u = r/(nSubDivs-1.f);
+            for (c=0; c<nSubDivs; c++, o+=2)
             {
-                /* generate for first patch */
-                for (r=0,o=0; r<nSubDivs; r++)
-                {
-                    GLfloat u = r/(nSubDivs-1.f);
-                    for (c=0; c<nSubDivs; c++, o+=2)
-                    {
-                        GLfloat v = c/(nSubDivs-1.f);
-                        texcs[o+0] = u;
-                        texcs[o+1] = v;
-                    }
-                }
-                /* copy it over for all the other patches */
-                for (p=1; p<nPatches; p++)
-                    memcpy(texcs+p*nSubDivs*nSubDivs*2,texcs,nSubDivs*nSubDivs*2*sizeof(GLfloat));
+                GLfloat v = c/(nSubDivs-1.f);
+                texcs[o+0] = u;
+                texcs[o+1] = v;
             }
+        }
+        /* copy it over for all the other patches */
+        for (p=1; p<nPatches; p++)
+            memcpy(texcs+p*nSubDivs*nSubDivs*2,texcs,nSubDivs*nSubDivs*2*sizeof(GLfloat));
+    }
 
-            /* build vertex index array */
-            if (useWireMode)
-            {
-                /* build vertex indices to draw teapot/teacup/teaspoon as line strips */
-                /* first strips along increasing u, constant v */
-                for (p=0, o=0; p<nPatches; p++)
-                {
-                    int idx = nSubDivs*nSubDivs*p;
-                    for (c=0; c<nSubDivs; c++)
-                        for (r=0; r<nSubDivs; r++, o++)
-                            vertIdxs[o] = idx+r*nSubDivs+c;
-                }
+    /* build vertex index array */
+    if (useWireMode)
+    {
+        /* build vertex indices to draw teapot/teacup/teaspoon as line strips */
+        /* first strips along increasing u, constant v */
+        for (p=0, o=0; p<nPatches; p++)
+        {
+            int idx = nSubDivs*nSubDivs*p;
+            for (c=0; c<nSubDivs; c++)
+                for (r=0; r<nSubDivs; r++, o++)
+                    vertIdxs[o] = idx+r*nSubDivs+c;
+        }
 
-                /* then strips along increasing v, constant u */
-                for (p=0; p<nPatches; p++) /* don't reset o, we continue appending! */
-                {
-                    int idx = nSubDivs*nSubDivs*p;
-                    for (r=0; r<nSubDivs; r++)
-                    {
-                        int loc = r*nSubDivs;
-                        for (c=0; c<nSubDivs; c++, o++)
-                            vertIdxs[o] = idx+loc+c;
-                    }
-                }
+        /* then strips along increasing v, constant u */
+        for (p=0; p<nPatches; p++) /* don't reset o, we continue appending! */
+        {
+            int idx = nSubDivs*nSubDivs*p;
+            for (r=0; r<nSubDivs; r++)
+            {
+                int loc = r*nSubDivs;
+                for (c=0; c<nSubDivs; c++, o++)
+                    vertIdxs[o] = idx+loc+c;
             }
-            else
+        }
+    }
+    else
+    {
+        /* build vertex indices to draw teapot/teacup/teaspoon as triangles */
+        for (p=0,o=0; p<nPatches; p++)
+        {
+            int idx = nSubDivs*nSubDivs*p;
+            for (r=0; r<nSubDivs-1; r++)
             {
-                /* build vertex indices to draw teapot/teacup/teaspoon as triangles */
-                for (p=0,o=0; p<nPatches; p++)
+                int loc = r*nSubDivs;
+                for (c=0; c<nSubDivs-1; c++, o+=6)
                 {
-                    int idx = nSubDivs*nSubDivs*p;
-                    for (r=0; r<nSubDivs-1; r++)
-                    {
-                        int loc = r*nSubDivs;
-                        for (c=0; c<nSubDivs-1; c++, o+=6)
-                        {
-                            /* ABC ACD, where B and C are one row lower */
-                            int row1 = idx+loc+c;
-                            int row2 = row1+nSubDivs;
-
-                            vertIdxs[o+0] = row1+0;
-                            vertIdxs[o+1] = row2+0;
-                            vertIdxs[o+2] = row2+1;
-
-                            vertIdxs[o+3] = row1+0;
-                            vertIdxs[o+4] = row2+1;
-                            vertIdxs[o+5] = row1+1;
-                        }
-                    }
+                    /* ABC ACD, where B and C are one row lower */
+                    int row1 = idx+loc+c;
+                    int row2 = row1+nSubDivs;
+
+                    vertIdxs[o+0] = row1+0;
+                    vertIdxs[o+1] = row2+0;
+                    vertIdxs[o+2] = row2+1;
+
+                    vertIdxs[o+3] = row1+0;
+                    vertIdxs[o+4] = row2+1;
+                    vertIdxs[o+5] = row1+1;
                 }
             }
-
-            *inited = GL_TRUE;
         }
     }
 
+    teaset->NumSubDivs = nSubDivs;
+}
+
+static void fghTeaset( int shape, GLfloat scale, GLboolean useWireMode,
+                       GLfloat (*cpdata)[3], int (*patchdata)[16],
+                       SFG_Teaset *teaset,
+                       GLboolean needNormalFix, GLboolean rotFlip, GLfloat zOffset,
+                       int nInputPatches, int nPatches )
+{
+    int nSubDivs, nVerts, i;
+    SFG_ShapeKey key;
+    SFG_Shape *gpuShape;
+
+    /* Number of vertices along each side of a patch */
+    nSubDivs = fgState.TeapotSubdivisions;
+    if (nSubDivs <= 0)
+        nSubDivs = useWireMode ? GLUT_WIRE_N_SUBDIV : GLUT_SOLID_N_SUBDIV;
+    else if (nSubDivs < 2)
+        nSubDivs = 2;
+    else if (nSubDivs > GLUT_MAX_N_SUBDIV)
+        nSubDivs = GLUT_MAX_N_SUBDIV;
+    nVerts = nSubDivs*nSubDivs*nPatches;
+
+    /* Nothing to do if the window has the shape's buffers already */
+    fgInitShapeKey(&key, shape, useWireMode, scale, 0.f, nSubDivs, 0);
+    if (fgDrawCachedShape(&key))
+        return;
+
+    /* Tessellate on the GPU if it can */
+    if (!teasetPatches[shape-FG_SHAPE_TEAPOT])
+        teasetPatches[shape-FG_SHAPE_TEAPOT] = expandTeasetPatches(cpdata, patchdata, needNormalFix, rotFlip, zOffset,
+                                                                   nInputPatches, nPatches);
+    gpuShape = fgTessellateTeaset(&key, teasetPatches[shape-FG_SHAPE_TEAPOT], nPatches, nSubDivs, scale);
+    if (gpuShape)
+    {
+        fgDrawShape(gpuShape);
+        return;
+    }
+
+    /* check if need to generate the shape, or only to scale it */
+    if (teaset->NumSubDivs != nSubDivs)
+    {
+        tessellateTeaset(teaset, nSubDivs, useWireMode, cpdata, patchdata,
+                         needNormalFix, rotFlip, zOffset, nInputPatches, nPatches);
+        teaset->LastScale = 0.f;
+    }
+    if (scale != teaset->LastScale)
+    {
+        for (i=0; i<nVerts*3; i++)
+            teaset->Verts[i] = teaset->UnitVerts[i]*scale;
+        teaset->LastScale = scale;
+    }
+
     /* draw */
     if (useWireMode)
-        fghDrawGeometryWire (verts, norms,        nVerts, vertIdxs, nPatches*nSubDivs*2, nSubDivs, GL_LINE_STRIP, NULL,0,0);
+        fghDrawGeometryWire (&key, teaset->Verts, teaset->Norms,                nVerts, teaset->VertIdxs, nPatches*nSubDivs*2, nSubDivs, GL_LINE_STRIP, NULL,0,0);
     else
-        fghDrawGeometrySolid(verts, norms, texcs, nVerts, vertIdxs,1,nTriangles*3);
+        fghDrawGeometrySolid(&key, teaset->Verts, teaset->Norms, teaset->Texcs, nVerts, teaset->VertIdxs,1,(nSubDivs-1)*(nSubDivs-1)*nPatches*6);
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Frees the tessellations, on deinitialization
+ */
+void fgDestroyTeasets( void )
+{
+    int i;
+
+    freeTeaset(&teasetTeapotS);
+    freeTeaset(&teasetTeapotW);
+    freeTeaset(&teasetTeacupS);
+    freeTeaset(&teasetTeacupW);
+    freeTeaset(&teasetTeaspoonS);
+    freeTeaset(&teasetTeaspoonW);
+    for (i=0; i<FREEGLUT_NUM_TEASETS; i++)
+    {
+        free(teasetPatches[i]);
+        teasetPatches[i] = NULL;
+    }
 }
 
 
@@ -481,13 +667,11 @@ static void fghTeaset( GLfloat scale, GLboolean useWireMode,
 void FGAPIENTRY glutWireTeapot( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireTeapot" );
-    fghTeaset( (GLfloat)size, GL_TRUE,
+    fghTeaset( FG_SHAPE_TEAPOT, (GLfloat)size, GL_TRUE,
                cpdata_teapot, patchdata_teapot,
-               vertIdxsTeapotW,
-               vertsTeapotW, normsTeapotW, NULL,
-               &lastScaleTeapotW, &initedTeapotW,
+               &teasetTeapotW,
                GL_TRUE, GL_TRUE, 1.575f,
-               GLUT_WIRE_TEAPOT_N_VERT, GLUT_TEAPOT_N_INPUT_PATCHES, GLUT_TEAPOT_N_PATCHES, 0);
+               GLUT_TEAPOT_N_INPUT_PATCHES, GLUT_TEAPOT_N_PATCHES);
 }
 
 /*
@@ -496,13 +680,11 @@ void FGAPIENTRY glutWireTeapot( double size )
 void FGAPIENTRY glutSolidTeapot( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidTeapot" );
-    fghTeaset( (GLfloat)size, GL_FALSE,
+    fghTeaset( FG_SHAPE_TEAPOT, (GLfloat)size, GL_FALSE,
                cpdata_teapot, patchdata_teapot,
-               vertIdxsTeapotS,
-               vertsTeapotS, normsTeapotS, texcsTeapotS,
-               &lastScaleTeapotS, &initedTeapotS,
+               &teasetTeapotS,
                GL_TRUE, GL_TRUE, 1.575f,
-               GLUT_SOLID_TEAPOT_N_VERT, GLUT_TEAPOT_N_INPUT_PATCHES, GLUT_TEAPOT_N_PATCHES, GLUT_SOLID_TEAPOT_N_TRI);
+               GLUT_TEAPOT_N_INPUT_PATCHES, GLUT_TEAPOT_N_PATCHES);
 }
 
 
@@ -512,13 +694,11 @@ void FGAPIENTRY glutSolidTeapot( double size )
 void FGAPIENTRY glutWireTeacup( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireTeacup" );
-    fghTeaset( (GLfloat)size/2.5f, GL_TRUE,
+    fghTeaset( FG_SHAPE_TEACUP, (GLfloat)size/2.5f, GL_TRUE,
                cpdata_teacup, patchdata_teacup,
-               vertIdxsTeacupW,
-               vertsTeacupW, normsTeacupW, NULL,
-               &lastScaleTeacupW, &initedTeacupW,
+               &teasetTeacupW,
                GL_FALSE, GL_TRUE, 1.5121f,
-               GLUT_WIRE_TEACUP_N_VERT, GLUT_TEACUP_N_INPUT_PATCHES, GLUT_TEACUP_N_PATCHES, 0);
+               GLUT_TEACUP_N_INPUT_PATCHES, GLUT_TEACUP_N_PATCHES);
 }
 
 /*
@@ -527,13 +707,11 @@ void FGAPIENTRY glutWireTeacup( double size )
 void FGAPIENTRY glutSolidTeacup( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidTeacup" );
-    fghTeaset( (GLfloat)size/2.5f, GL_FALSE,
+    fghTeaset( FG_SHAPE_TEACUP, (GLfloat)size/2.5f, GL_FALSE,
                cpdata_teacup, patchdata_teacup,
-               vertIdxsTeacupS,
-               vertsTeacupS, normsTeacupS, texcsTeacupS,
-               &lastScaleTeacupS, &initedTeacupS,
+               &teasetTeacupS,
                GL_FALSE, GL_TRUE, 1.5121f,
-               GLUT_SOLID_TEACUP_N_VERT, GLUT_TEACUP_N_INPUT_PATCHES, GLUT_TEACUP_N_PATCHES, GLUT_SOLID_TEACUP_N_TRI);
+               GLUT_TEACUP_N_INPUT_PATCHES, GLUT_TEACUP_N_PATCHES);
 }
 
 
@@ -543,13 +721,11 @@ void FGAPIENTRY glutSolidTeacup( double size )
 void FGAPIENTRY glutWireTeaspoon( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutWireTeaspoon" );
-    fghTeaset( (GLfloat)size/2.5f, GL_TRUE,
+    fghTeaset( FG_SHAPE_TEASPOON, (GLfloat)size/2.5f, GL_TRUE,
                cpdata_teaspoon, patchdata_teaspoon,
-               vertIdxsTeaspoonW,
-               vertsTeaspoonW, normsTeaspoonW, NULL,
-               &lastScaleTeaspoonW, &initedTeaspoonW,
+               &teasetTeaspoonW,
                GL_FALSE, GL_FALSE, -0.0315f,
-               GLUT_WIRE_TEASPOON_N_VERT, GLUT_TEASPOON_N_INPUT_PATCHES, GLUT_TEASPOON_N_PATCHES, 0);
+               GLUT_TEASPOON_N_INPUT_PATCHES, GLUT_TEASPOON_N_PATCHES);
 }
 
 /*
@@ -558,13 +734,11 @@ void FGAPIENTRY glutWireTeaspoon( double size )
 void FGAPIENTRY glutSolidTeaspoon( double size )
 {
     FREEGLUT_EXIT_IF_NOT_INITIALISED ( "glutSolidTeaspoon" );
-    fghTeaset( (GLfloat)size/2.5f, GL_FALSE,
+    fghTeaset( FG_SHAPE_TEASPOON, (GLfloat)size/2.5f, GL_FALSE,
                cpdata_teaspoon, patchdata_teaspoon,
-               vertIdxsTeaspoonS,
-               vertsTeaspoonS, normsTeaspoonS, texcsTeaspoonS,
-               &lastScaleTeaspoonS, &initedTeaspoonS,
+               &teasetTeaspoonS,
                GL_FALSE, GL_FALSE, -0.0315f,
-               GLUT_SOLID_TEASPOON_N_VERT, GLUT_TEASPOON_N_INPUT_PATCHES, GLUT_TEASPOON_N_PATCHES, GLUT_SOLID_TEASPOON_N_TRI);
+               GLUT_TEASPOON_N_INPUT_PATCHES, GLUT_TEASPOON_N_PATCHES);
 }
 
 /*** END OF FILE ***/
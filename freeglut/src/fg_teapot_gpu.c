@@ -0,0 +1,324 @@
+/*
+ * fg_teapot_gpu.c
+ *
+ * Tessellation of the teapot, teacup and teaspoon on the GPU.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+
+/*
+ * With OpenGL 4.0, the Bezier patches of the teapot family are evaluated
+ * on the GPU rather than on the CPU (see fg_teapot.c).
+ *
+ * The shapes are drawn with the application's program, which cannot be
+ * given stages of ours. The patches are instead evaluated once, by a
+ * vertex shader of freeglut's own with the rasterizer discarding its
+ * output, and the vertices captured by transform feedback into a buffer
+ * that becomes a cached shape (see fg_shape_cache.c). Only the control
+ * points go to the GPU, however fine the tessellation.
+ *
+ * The vertices are those the CPU would draw, in the same order and to
+ * the bit: solid shapes are triangles of positions, normals and texture
+ * coordinates, wire ones lines of positions and normals along both
+ * directions of each patch. The fixed-function tessellator cannot give
+ * that, as it chooses its own triangulation and order. Each vertex is
+ * rather made from gl_VertexID, with the arithmetic of the CPU path
+ * step by step, which the precise qualifier of GLSL 4.00 keeps compilers
+ * from fusing or reordering. fgTessellateTeaset returns NULL, for the CPU
+ * to do it, whenever the GPU cannot.
+ */
+
+/* -- PRIVATE DEFINITIONS -------------------------------------------------- */
+
+static const char* fghTessSolidVaryings[ ] = { "fg_position", "fg_normal", "fg_texcoord", NULL };
+static const char* fghTessWireVaryings[ ] = { "fg_position", "fg_normal", NULL };
+
+/*
+ * As evalBezierWithNorm and rotOrReflect in fg_teapot.c, for the vertex
+ * at row r and column c of the patch: the rows of control points along
+ * v, then those along u. fg_patch holds the control points of the patch
+ * the copy is made from, the w of the first being its normal fix and
+ * that of the second the copy: 1 to 3 rotated, 4 flipped. The normal is
+ * packed into normalized shorts as fghPackShapeVertices of
+ * fg_shape_cache.c does, two to an uint, in the byte order of the host.
+ */
+#define FGH_TESS_EVALUATE_PATCH \
+    "uniform vec4 fg_patch[16];\n" \
+    "uniform vec4 fg_params;\n"         /* Subdivisions, scale, the pass of wire shapes, big endian */ \
+    "precise out vec3 fg_position;\n" \
+    "flat out uvec2 fg_normal;\n" \
+    "void fgEvaluatePatch(int r, int c)\n" \
+    "{\n" \
+    "    int copy = int(fg_patch[1].w);\n" \
+    "    int ru = copy == 4 ? int(fg_params.x) - 1 - r : r;\n" \
+    "    precise float u = float(ru) / (fg_params.x - 1.0), v = float(c) / (fg_params.x - 1.0);\n" \
+    "    precise float su = 1.0 - u, su2 = su*su, u2 = u*u;\n" \
+    "    precise float sv = 1.0 - v, sv2 = sv*sv, v2 = v*v;\n" \
+    "    precise vec4 bu = vec4(su*su2, 3.0*u*su2, 3.0*u2*su, u*u2);\n" \
+    "    precise vec4 du = vec4(-3.0*su2, 3.0*su2 - 6.0*u*su, 6.0*u*su - 3.0*u2, 3.0*u2);\n" \
+    "    precise vec4 bv = vec4(sv*sv2, 3.0*v*sv2, 3.0*v2*sv, v*v2);\n" \
+    "    precise vec4 dv = vec4(-3.0*sv2, 3.0*sv2 - 6.0*v*sv, 6.0*v*sv - 3.0*v2, 3.0*v2);\n" \
+    "    precise vec3 r0[4], r1[4];\n" \
+    "    for (int i = 0; i < 4; i++)\n" \
+    "    {\n" \
+    "        r0[i] = bv.x*fg_patch[i*4].xyz + bv.y*fg_patch[i*4+1].xyz + bv.z*fg_patch[i*4+2].xyz + bv.w*fg_patch[i*4+3].xyz;\n" \
+    "        r1[i] = dv.x*fg_patch[i*4].xyz + dv.y*fg_patch[i*4+1].xyz + dv.z*fg_patch[i*4+2].xyz + dv.w*fg_patch[i*4+3].xyz;\n" \
+    "    }\n" \
+    "    precise vec3 pos  = bu.x*r0[0] + bu.y*r0[1] + bu.z*r0[2] + bu.w*r0[3];\n" \
+    "    precise vec3 tan1 = bu.x*r1[0] + bu.y*r1[1] + bu.z*r1[2] + bu.w*r1[3];\n" \
+    "    precise vec3 tan2 = du.x*r0[0] + du.y*r0[1] + du.z*r0[2] + du.w*r0[3];\n" \
+    "    precise vec3 nrm = vec3(tan1.y*tan2.z - tan1.z*tan2.y,\n" \
+    "                            tan1.z*tan2.x - tan1.x*tan2.z,\n" \
+    "                            tan1.x*tan2.y - tan1.y*tan2.x);\n" \
+    "    nrm = nrm / sqrt(nrm.x*nrm.x + nrm.y*nrm.y + nrm.z*nrm.z);\n" \
+    "    if (ru == 0 && fg_patch[0].w != 0.0)\n" \
+    "        nrm = vec3(0.0, fg_patch[0].w == 1.0 ? 1.0 : -1.0, 0.0);\n" \
+    "    if (copy == 1)\n" \
+    "    {\n" \
+    "        pos = vec3(pos.z, pos.y, -pos.x);\n" \
+    "        nrm = vec3(nrm.z, nrm.y, -nrm.x);\n" \
+    "    }\n" \
+    "    else if (copy == 2)\n" \
+    "    {\n" \
+    "        pos = vec3(-pos.x, pos.y, -pos.z);\n" \
+    "        nrm = vec3(-nrm.x, nrm.y, -nrm.z);\n" \
+    "    }\n" \
+    "    else if (copy == 3)\n" \
+    "    {\n" \
+    "        pos = vec3(-pos.z, pos.y, pos.x);\n" \
+    "        nrm = vec3(-nrm.z, nrm.y, nrm.x);\n" \
+    "    }\n" \
+    "    else if (copy == 4)\n" \
+    "    {\n" \
+    "        pos.z = -pos.z;\n" \
+    "        nrm.z = -nrm.z;\n" \
+    "    }\n" \
+    "    fg_position = pos * fg_params.y;\n" \
+    "    precise vec3 n = nrm * 32767.0;\n" \
+    "    uvec3 s = uvec3(ivec3(n.x < 0.0 ? n.x - 0.5 : n.x + 0.5,\n" \
+    "                          n.y < 0.0 ? n.y - 0.5 : n.y + 0.5,\n" \
+    "                          n.z < 0.0 ? n.z - 0.5 : n.z + 0.5)) & 0xFFFFu;\n" \
+    "    uint first = fg_params.w == 0.0 ? 0u : 16u;\n" \
+    "    fg_normal = uvec2(s.x << first | s.y << (16u - first), s.z << first);\n" \
+    "}\n"
+
+/* Six vertices per grid cell, as the indices of tessellateTeaset: ABC
+   ACD, where B and C are one row lower */
+static const char* fghTessSolidShader[ ] =
+{
+    FGH_TESS_EVALUATE_PATCH,
+    "precise out vec2 fg_texcoord;\n"
+    "void main()\n"
+    "{\n"
+    "    int cells = int(fg_params.x) - 1, cell = gl_VertexID / 6, corner = gl_VertexID % 6;\n"
+    "    int r = cell / cells + (corner == 1 || corner == 2 || corner == 4 ? 1 : 0);\n"
+    "    int c = cell % cells + (corner == 2 || corner == 4 || corner == 5 ? 1 : 0);\n"
+    "    fgEvaluatePatch(r, c);\n"
+    "    fg_texcoord = vec2(float(r), float(c)) / (fg_params.x - 1.0);\n"
+    "}\n",
+    NULL
+};
+
+/* The line strips of tessellateTeaset as lines: the first pass along u,
+   a strip per column, the second along v, a strip per row */
+static const char* fghTessWireShader[ ] =
+{
+    FGH_TESS_EVALUATE_PATCH,
+    "void main()\n"
+    "{\n"
+    "    int ends = (int(fg_params.x) - 1) * 2, strip = gl_VertexID / ends, end = gl_VertexID % ends;\n"
+    "    int along = end / 2 + end % 2;\n"
+    "    if (fg_params.z == 0.0)\n"
+    "        fgEvaluatePatch(along, strip);\n"
+    "    else\n"
+    "        fgEvaluatePatch(strip, along);\n"
+    "}\n",
+    NULL
+};
+
+/* The state changed while tessellating */
+typedef struct tagSFG_TessState SFG_TessState;
+struct tagSFG_TessState
+{
+    GLint           Program;
+    GLint           VertexArray;
+    GLint           FeedbackBuffer;
+    GLint           FeedbackBuffer0;
+    GLboolean       RasterizerDiscard;
+};
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * Returns the tessellator of the current window, creating its programs
+ * the first time. NULL if they cannot be built.
+ */
+static SFG_Tessellator* fghTessellator( void )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+    SFG_Tessellator* tess = window->Window.Tessellator;
+    int i;
+
+    if( !tess )
+    {
+        tess = calloc( 1, sizeof( SFG_Tessellator ) );
+        if( !tess )
+            fgError( "Failed to allocate memory in fghTessellator" );
+        window->Window.Tessellator = tess;
+
+        /* Built once, whether that works or not, so as to warn only once */
+        tess->Programs[ 0 ] = fgCreateFeedbackProgram( fghTessSolidShader, fghTessSolidVaryings );
+        tess->Programs[ 1 ] = fgCreateFeedbackProgram( fghTessWireShader, fghTessWireVaryings );
+        for( i = 0; i < 2; i++ )
+            if( tess->Programs[ i ] )
+            {
+                tess->PatchUniforms[ i ] = fghGetUniformLocation( tess->Programs[ i ], "fg_patch" );
+                tess->ParamsUniforms[ i ] = fghGetUniformLocation( tess->Programs[ i ], "fg_params" );
+            }
+
+        /* The shaders only read gl_VertexID, but core profiles draw nothing without one */
+        fghGenVertexArrays( 1, &tess->VertexArray );
+    }
+
+    return tess->Programs[ 0 ] && tess->Programs[ 1 ] ? tess : NULL;
+}
+
+static void fghBeginTessellation( SFG_TessState* saved )
+{
+    fgGLStateBegin( );
+    fghGetIntegerv( FGH_CURRENT_PROGRAM, &saved->Program );
+    fghGetIntegerv( FGH_VERTEX_ARRAY_BINDING, &saved->VertexArray );
+    glGetIntegerv( FGH_TRANSFORM_FEEDBACK_BUFFER_BINDING, &saved->FeedbackBuffer );
+    fghGetIntegeri_v( FGH_TRANSFORM_FEEDBACK_BUFFER_BINDING, 0, &saved->FeedbackBuffer0 );
+    saved->RasterizerDiscard = glIsEnabled( FGH_RASTERIZER_DISCARD );
+
+    glEnable( FGH_RASTERIZER_DISCARD );
+}
+
+static void fghEndTessellation( const SFG_TessState* saved )
+{
+    if( !saved->RasterizerDiscard )
+        glDisable( FGH_RASTERIZER_DISCARD );
+    fghBindBufferBase( FGH_TRANSFORM_FEEDBACK_BUFFER, 0, saved->FeedbackBuffer0 );
+    fghBindBuffer( FGH_TRANSFORM_FEEDBACK_BUFFER, saved->FeedbackBuffer );
+    fghBindVertexArray( saved->VertexArray );
+    fghUseProgram( saved->Program );
+    fgGLStateEnd( );
+}
+
+
+/* -- INTERNAL FUNCTIONS --------------------------------------------------- */
+
+/*
+ * Tessellates a teaset into a new shape of the current window, cached
+ * under the key. patches holds the 16 control points of each of its
+ * numPatches patches, at unit scale, as expandTeasetPatches of
+ * fg_teapot.c gives them. Returns NULL if the GPU cannot do it.
+ */
+SFG_Shape* fgTessellateTeaset( const SFG_ShapeKey* key, const GLfloat* patches, GLsizei numPatches,
+                               int nSubDivs, GLfloat scale )
+{
+    SFG_Window* window = fgStructure.CurrentWindow;
+    const int wire = key->Wire ? 1 : 0;
+    SFG_Tessellator* tess;
+    SFG_TessState saved;
+    GLsizei numVertices, patchVertices;
+    GLuint buffer;
+    GLint active;
+    int pass, p;
+    const GLushort one = 1;
+    const GLfloat bigEndian = *(const GLubyte*)&one ? 0.0f : 1.0f;
+
+    /* Leave what the CPU path draws differently to it */
+    if( fgBakingShapes( ) || !fgState.HasOpenGL20 || !fghTransformFeedbackVaryings || window->State.VisualizeNormals ||
+        ( window->Window.attribute_v_coord == -1 && window->Window.attribute_v_normal == -1 ) )
+        return NULL;
+
+    tess = fghTessellator( );
+    if( !tess )
+        return NULL;
+
+    /* The application may be capturing its own output */
+    glGetIntegerv( FGH_TRANSFORM_FEEDBACK_ACTIVE, &active );
+    if( active )
+        return NULL;
+
+    /* 2 triangles per grid cell, or a pass of lines along each direction */
+    if( wire )
+        patchVertices = nSubDivs * ( nSubDivs - 1 ) * 2;
+    else
+        patchVertices = ( nSubDivs - 1 ) * ( nSubDivs - 1 ) * 6;
+    numVertices = numPatches * patchVertices * ( wire ? 2 : 1 );
+
+    fghBeginTessellation( &saved );
+    fghUseProgram( tess->Programs[ wire ] );
+    fghBindVertexArray( tess->VertexArray );
+
+    fghGenBuffers( 1, &buffer );
+    fghBindBuffer( FGH_TRANSFORM_FEEDBACK_BUFFER, buffer );
+    fghBufferData( FGH_TRANSFORM_FEEDBACK_BUFFER,
+                   numVertices * ( 3 * sizeof( GLfloat ) + 4 * sizeof( GLshort ) + ( wire ? 0 : 2 * sizeof( GLfloat ) ) ),
+                   NULL, FGH_STATIC_DRAW );
+    fghBindBufferBase( FGH_TRANSFORM_FEEDBACK_BUFFER, 0, buffer );
+
+    fghBeginTransformFeedback( GL_POINTS );
+    for( pass = 0; pass < ( wire ? 2 : 1 ); pass++ )
+    {
+        fghUniform4f( tess->ParamsUniforms[ wire ], (GLfloat)nSubDivs, scale, (GLfloat)pass, bigEndian );
+        for( p = 0; p < numPatches; p++ )
+        {
+            fghUniform4fv( tess->PatchUniforms[ wire ], 16, patches + p * 16 * 4 );
+            glDrawArrays( GL_POINTS, 0, patchVertices );
+        }
+    }
+    fghEndTransformFeedback( );
+
+    fghEndTessellation( &saved );
+
+    return fgCreateShapeFromBuffer( key, buffer, numVertices, wire ? GL_LINES : GL_TRIANGLES, GL_SHORT, !wire );
+}
+
+/*
+ * Releases a window's tessellator. Its GL objects are deleted when the
+ * window's context is current, otherwise they go with the context.
+ */
+void fgDestroyTessellator( SFG_Window* window )
+{
+    SFG_Tessellator* tess = window->Window.Tessellator;
+
+    freeglut_return_if_fail( tess );
+
+    if( fgState.HasOpenGL20 && fgStructure.CurrentWindow == window )
+    {
+        /* Unused names are silently ignored */
+        fghDeleteProgram( tess->Programs[ 0 ] );
+        fghDeleteProgram( tess->Programs[ 1 ] );
+        if( tess->VertexArray )
+            fghDeleteVertexArrays( 1, &tess->VertexArray );
+    }
+
+    free( tess );
+    window->Window.Tessellator = NULL;
+}
+
+/*** END OF FILE ***/
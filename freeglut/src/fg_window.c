@@ -97,6 +97,37 @@ void fghContextCreationError( void )
              fgState.ContextProfile );
 }
 
+/*
+ * A static helper function to look for another window with the OpenGL
+ * context of the one given, as with GLUT_USE_CURRENT_CONTEXT
+ */
+static void fghcbWindowSharingContext( SFG_Window *window,
+                                       SFG_Enumerator *enumerator )
+{
+    SFG_Window *other = (SFG_Window *) enumerator->data;
+
+    if ( enumerator->found )
+        return;
+
+    if( window != other && window->Window.Context == other->Window.Context )
+    {
+        enumerator->found = GL_TRUE;
+        return;
+    }
+
+    fgEnumSubWindows( window, fghcbWindowSharingContext, enumerator );
+}
+
+static GLboolean fghContextIsShared( SFG_Window *window )
+{
+    SFG_Enumerator enumerator;
+
+    enumerator.found = GL_FALSE;
+    enumerator.data = window;
+    fgEnumWindows( fghcbWindowSharingContext, &enumerator );
+    return enumerator.found;
+}
+
 
 /* -- SYSTEM-DEPENDENT PRIVATE FUNCTIONS ------------------------------------ */
 
@@ -108,6 +139,12 @@ void fgSetWindow ( SFG_Window *window )
 {
     fgPlatformSetWindow ( window );
 
+    /* Another window with the same context may have changed the state
+       shadowed for this one, which is only kept with GLUT_GL_STATE_FILTER */
+    if( window && window != fgStructure.CurrentWindow && fgState.GLStateFilter &&
+        fghContextIsShared( window ) )
+        fgGLStateInvalidate( &window->Window );
+
     fgStructure.CurrentWindow = window;
 }
 
@@ -144,6 +181,9 @@ void fgOpenWindow( SFG_Window* window, const char* title,
     window->Window.attribute_v_coord = -1;
     window->Window.attribute_v_normal = -1;
     window->Window.attribute_v_texture = -1;
+    window->Window.attribute_v_glyph_offset = -1;
+    window->Window.uniform_shape = -1;
+    fgGLStateInvalidate( &window->Window );
 
     fgInitGL2();
 
@@ -162,6 +202,24 @@ void fgCloseWindow( SFG_Window* window )
     if (fgStructure.GameModeWindow != NULL && fgStructure.GameModeWindow->ID==window->ID)
         glutLeaveGameMode();
 
+    /* A recording stops with its window, even one with no frame read yet */
+    fgStopRecording( window );
+
+    /* Release the GL objects freeglut itself created in the window's context */
+    if( window->Window.TextRenderer || window->Window.Shapes.First || window->Window.Tessellator ||
+        window->Window.ShapeVertexArray || window->Window.Stream || window->Window.Readback )
+    {
+        SFG_Window *activeWindow = fgStructure.CurrentWindow;
+        fgSetWindow( window );
+        fgDestroyReadback( window );
+        fgDestroyTextRenderer( window );
+        fgDestroyShapes( window );
+        fgDestroyTessellator( window );
+        fgDestroyProceduralShapes( window );
+        fgDestroyStream( window );
+        fgSetWindow( activeWindow );
+    }
+
     fgPlatformCloseWindow ( window );
 }
 
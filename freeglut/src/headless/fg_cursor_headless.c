@@ -0,0 +1,57 @@
+/*
+ * fg_cursor_headless.c
+ *
+ * The headless backend's mouse cursor: there is none, but the pointer
+ * position is kept, e.g. for menus.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "../fg_internal.h"
+
+void fgPlatformSetCursor ( SFG_Window *window, int cursorID )
+{
+    /* No-op: nothing is shown */
+}
+
+void fgPlatformWarpPointer ( int x, int y )
+{
+    /* There is no pointer to move, only the last position to keep */
+    SFG_Window* window = fgStructure.CurrentWindow;
+    window->State.MouseX = x;
+    window->State.MouseY = y;
+}
+
+void fghPlatformGetCursorPos(const SFG_Window *window, GLboolean client, SFG_XYUse *mouse_pos)
+{
+    /* Where the pointer was last put, relative to the window or the screen */
+    const SFG_Window *w = window ? window : fgStructure.CurrentWindow;
+
+    mouse_pos->X = w ? w->State.MouseX : 0;
+    mouse_pos->Y = w ? w->State.MouseY : 0;
+    if( w && !client )
+    {
+        mouse_pos->X += w->State.Xpos;
+        mouse_pos->Y += w->State.Ypos;
+    }
+
+    mouse_pos->Use = GL_TRUE;
+}
+
+/*** END OF FILE ***/
@@ -0,0 +1,68 @@
+/*
+ * fg_gamemode_headless.c
+ *
+ * Game mode for the headless backend: the virtual screen takes any mode.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "../fg_internal.h"
+
+static int fghOldScreenWidth, fghOldScreenHeight;
+
+/*
+ * Remember the current virtual screen size, to restore it afterwards
+ */
+void fgPlatformRememberState( void )
+{
+    fghOldScreenWidth = fgDisplay.ScreenWidth;
+    fghOldScreenHeight = fgDisplay.ScreenHeight;
+}
+
+/*
+ * Restores the previously remembered virtual screen size
+ */
+void fgPlatformRestoreState( void )
+{
+    fgDisplay.ScreenWidth = fghOldScreenWidth;
+    fgDisplay.ScreenHeight = fghOldScreenHeight;
+}
+
+/*
+ * Changes the current display mode to match user's settings
+ */
+GLboolean fgPlatformChangeDisplayMode( GLboolean haveToTest )
+{
+    if( !haveToTest )
+    {
+        fgDisplay.ScreenWidth = fgState.GameModeSize.X;
+        fgDisplay.ScreenHeight = fgState.GameModeSize.Y;
+    }
+    return GL_TRUE;
+}
+
+void fgPlatformEnterGameMode( void )
+{
+}
+
+void fgPlatformLeaveGameMode( void )
+{
+}
+
+/*** END OF FILE ***/
@@ -0,0 +1,177 @@
+/*
+ * fg_init_headless.c
+ *
+ * Various freeglut initialization functions, for the headless backend.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#define FREEGLUT_BUILDING_LIB
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_init.h"
+#include "egl/fg_init_egl.h"
+
+/* The virtual screen: a common desktop monitor, at 96 dots per inch */
+#define FGH_SCREEN_WIDTH      1920
+#define FGH_SCREEN_HEIGHT     1080
+#define FGH_SCREEN_WIDTH_MM   508
+#define FGH_SCREEN_HEIGHT_MM  286
+
+/*
+ * Is the extension in the space separated list?
+ */
+static int fghHasExtension( const char* extensions, const char* name )
+{
+    size_t length = strlen( name );
+
+    while( extensions && *extensions )
+    {
+        const char* end = strchr( extensions, ' ' );
+        size_t wordLength = end ? (size_t)( end - extensions ) : strlen( extensions );
+
+        if( wordLength == length && !strncmp( extensions, name, length ) )
+            return 1;
+        extensions = end ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+/*
+ * Gets the display of the index-th platform to try: Mesa's surfaceless
+ * one, then the first device (e.g. a GPU without a display server), and
+ * last whatever the default one is. Returns EGL_NO_DISPLAY for platforms
+ * that are not there.
+ */
+static EGLDisplay fghGetDisplay( int index )
+{
+    const char* extensions = eglQueryString( EGL_NO_DISPLAY, EGL_EXTENSIONS );
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = NULL;
+
+    if( fghHasExtension( extensions, "EGL_EXT_platform_base" ) )
+        getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress( "eglGetPlatformDisplayEXT" );
+
+    switch( index )
+    {
+    case 0:
+        if( getPlatformDisplay && fghHasExtension( extensions, "EGL_MESA_platform_surfaceless" ) )
+            return getPlatformDisplay( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL );
+        break;
+
+    case 1:
+        if( getPlatformDisplay && fghHasExtension( extensions, "EGL_EXT_platform_device" ) )
+        {
+            PFNEGLQUERYDEVICESEXTPROC queryDevices =
+                (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress( "eglQueryDevicesEXT" );
+            EGLDeviceEXT device;
+            EGLint numDevices = 0;
+
+            if( queryDevices && queryDevices( 1, &device, &numDevices ) && numDevices > 0 )
+                return getPlatformDisplay( EGL_PLATFORM_DEVICE_EXT, device, NULL );
+        }
+        break;
+
+    case 2:
+        return eglGetDisplay( EGL_DEFAULT_DISPLAY );
+    }
+
+    return EGL_NO_DISPLAY;
+}
+
+/*
+ * Can the display draw desktop OpenGL to pbuffers?
+ */
+static GLboolean fghHasPbuffers( void )
+{
+    EGLint attributes[ 5 ];
+    EGLint numConfigs = 0;
+    EGLConfig config;
+    int where = 0;
+
+    ATTRIB_VAL( EGL_SURFACE_TYPE, EGL_PBUFFER_BIT );
+    ATTRIB_VAL( EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT );
+    ATTRIB( EGL_NONE );
+
+    return eglChooseConfig( fgDisplay.pDisplay.egl.Display, attributes, &config, 1, &numConfigs ) &&
+           numConfigs > 0;
+}
+
+/*
+ * A call to this function should initialize all the display stuff...
+ * There is no display to name, so displayName is ignored.
+ */
+void fgPlatformInitialize( const char* displayName )
+{
+    int i;
+
+    fgDisplay.pDisplay.egl.Display = EGL_NO_DISPLAY;
+    for( i = 0; i < 3 && fgDisplay.pDisplay.egl.Display == EGL_NO_DISPLAY; i++ )
+    {
+        fgDisplay.pDisplay.egl.Display = fghGetDisplay( i );
+        if( fgDisplay.pDisplay.egl.Display != EGL_NO_DISPLAY &&
+            eglInitialize( fgDisplay.pDisplay.egl.Display,
+                           &fgDisplay.pDisplay.egl.MajorVersion,
+                           &fgDisplay.pDisplay.egl.MinorVersion ) != EGL_TRUE )
+            fgDisplay.pDisplay.egl.Display = EGL_NO_DISPLAY;
+    }
+
+    FREEGLUT_INTERNAL_ERROR_EXIT( fgDisplay.pDisplay.egl.Display != EGL_NO_DISPLAY,
+                                  "No EGL display available", "fgPlatformInitialize" );
+
+    if( eglBindAPI( EGL_OPENGL_API ) != EGL_TRUE )
+        fgError( "eglBindAPI: desktop OpenGL not supported, error %x", eglGetError( ) );
+
+    fgDisplay.pDisplay.Pbuffers = fghHasPbuffers( );
+    if( !fgDisplay.pDisplay.Pbuffers &&
+        !fghHasExtension( eglQueryString( fgDisplay.pDisplay.egl.Display, EGL_EXTENSIONS ),
+                          "EGL_KHR_surfaceless_context" ) )
+        fgError( "EGL display has neither pbuffers nor surfaceless contexts" );
+    fgDisplay.pDisplay.NextHandle = 0;
+
+    fgDisplay.ScreenWidth    = FGH_SCREEN_WIDTH;
+    fgDisplay.ScreenHeight   = FGH_SCREEN_HEIGHT;
+    fgDisplay.ScreenWidthMM  = FGH_SCREEN_WIDTH_MM;
+    fgDisplay.ScreenHeightMM = FGH_SCREEN_HEIGHT_MM;
+
+    /* Get start time */
+    fgState.Time = fgSystemTime();
+
+    fgState.Initialised = GL_TRUE;
+
+    atexit(fgDeinitialize);
+
+    /* InputDevice uses GlutTimerFunc(), so fgState.Initialised must be TRUE */
+    fgInitialiseInputDevices();
+}
+
+
+void fgPlatformDeinitialiseInputDevices ( void )
+{
+    fghCloseInputDevices ();
+
+    fgState.JoysticksInitialised = GL_FALSE;
+    fgState.InputDevsInitialised = GL_FALSE;
+}
+
+
+void fgPlatformCloseDisplay ( void )
+{
+    fghPlatformCloseDisplayEGL();
+}
+
+/*** END OF FILE ***/
@@ -0,0 +1,89 @@
+/*
+ * fg_internal_headless.h
+ *
+ * The freeglut library private include file.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef  FREEGLUT_INTERNAL_HEADLESS_H
+#define  FREEGLUT_INTERNAL_HEADLESS_H
+
+/*
+ * The headless backend renders without any display server, for batch jobs
+ * on machines without one, or without a GPU (e.g. with Mesa's llvmpipe).
+ * Windows are EGL pbuffers, or framebuffer objects of a surfaceless
+ * context where there are no pbuffers. Nothing is ever shown, and there is
+ * no input.
+ */
+
+/* -- PLATFORM-SPECIFIC INCLUDES ------------------------------------------- */
+/* No X11 types in the native EGL ones */
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "egl/fg_internal_egl.h"
+
+
+/* -- GLOBAL TYPE DEFINITIONS ---------------------------------------------- */
+/* The structure used by display initialization in fg_init.c */
+typedef struct tagSFG_PlatformDisplay SFG_PlatformDisplay;
+struct tagSFG_PlatformDisplay
+{
+    struct tagSFG_PlatformDisplayEGL egl;
+    GLboolean       Pbuffers;           /* Or surfaceless contexts only      */
+    int             NextHandle;         /* Windows have numbers for handles  */
+};
+
+typedef struct tagSFG_PlatformContext SFG_PlatformContext;
+struct tagSFG_PlatformContext
+{
+    struct tagSFG_PlatformContextEGL egl;
+    GLuint          Framebuffer;        /* Drawn to without a pbuffer        */
+    GLuint          Renderbuffers[ 2 ]; /* Its colour and depth/stencil      */
+    int             Width, Height;      /* Of the pbuffer or framebuffer     */
+};
+
+/* Window's state description. This structure should be kept portable. */
+typedef struct tagSFG_PlatformWindowState SFG_PlatformWindowState;
+struct tagSFG_PlatformWindowState
+{
+    int             OldX, OldY;         /* Before going full screen          */
+    int             OldWidth, OldHeight;
+};
+
+
+/* Joystick-Specific Definitions: there are none to be found */
+#define _JS_MAX_AXES  1
+typedef struct tagSFG_PlatformJoystick SFG_PlatformJoystick;
+struct tagSFG_PlatformJoystick
+{
+    int             Unused;
+};
+
+
+/* Menu font and color definitions */
+#define  FREEGLUT_MENU_FONT    GLUT_BITMAP_HELVETICA_18
+
+#define  FREEGLUT_MENU_PEN_FORE_COLORS   {0.0f,  0.0f,  0.0f,  1.0f}
+#define  FREEGLUT_MENU_PEN_BACK_COLORS   {0.70f, 0.70f, 0.70f, 1.0f}
+#define  FREEGLUT_MENU_PEN_HFORE_COLORS  {0.0f,  0.0f,  0.0f,  1.0f}
+#define  FREEGLUT_MENU_PEN_HBACK_COLORS  {1.0f,  1.0f,  1.0f,  1.0f}
+
+#endif  /* FREEGLUT_INTERNAL_HEADLESS_H */
@@ -0,0 +1,160 @@
+/*
+ * fg_main_headless.c
+ *
+ * The headless backend's main loop: there are no events, only work items
+ * and timers, and the clock may be a virtual one advanced per frame.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "../fg_internal.h"
+#include "headless/fg_window_headless.h"
+#include <errno.h>
+#include <time.h>
+
+extern void fghOnReshapeNotify(SFG_Window *window, int width, int height, GLboolean forceNotify);
+extern void fghOnPositionNotify(SFG_Window *window, int x, int y, GLboolean forceNotify);
+extern void fgPlatformFullScreenToggle( SFG_Window *win );
+extern void fgPlatformPositionWindow( SFG_Window *window, int x, int y );
+extern void fgPlatformReshapeWindow ( SFG_Window *window, int width, int height );
+extern void fgPlatformHideWindow( SFG_Window *window );
+extern void fgPlatformIconifyWindow( SFG_Window *window );
+extern void fgPlatformShowWindow( SFG_Window *window );
+
+/*
+ * The virtual clock, in microseconds so that rates which do not divide a
+ * second keep their average. It starts at the real time when first read.
+ */
+static unsigned long long fghVirtualTime = 0;
+
+static fg_time_t fghRealTime( void )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_nsec/1000000 + now.tv_sec*1000;
+}
+
+static void fghAdvanceVirtualTime( unsigned long long usec )
+{
+    if( !fghVirtualTime )
+        fghVirtualTime = (unsigned long long)fghRealTime( ) * 1000;
+    fghVirtualTime += usec;
+}
+
+/*
+ * Steps the virtual clock by one frame, when there is one. Called for
+ * every glutSwapBuffers().
+ */
+void fghPlatformAdvanceFrameHeadless( void )
+{
+    if( fgState.FrameRate > 0 )
+        fghAdvanceVirtualTime( 1000000 / fgState.FrameRate );
+}
+
+fg_time_t fgPlatformSystemTime ( void )
+{
+    if( fgState.FrameRate > 0 )
+    {
+        fghAdvanceVirtualTime( 0 );
+        return (fg_time_t)( fghVirtualTime / 1000 );
+    }
+    return fghRealTime( );
+}
+
+/*
+ * With nothing to wait for but timers, waiting means the time passes:
+ * on the virtual clock at once, on the real one by sleeping.
+ */
+void fgPlatformSleepForEvents( fg_time_t msec )
+{
+    struct timespec wait;
+
+    /* Left from a callback: nothing is coming that the loop would wait for */
+    if( fgState.ExecState != GLUT_EXEC_STATE_RUNNING )
+        return;
+
+    if( fgState.FrameRate > 0 )
+    {
+        fghAdvanceVirtualTime( (unsigned long long)msec * 1000 );
+        return;
+    }
+
+    wait.tv_sec = msec / 1000;
+    wait.tv_nsec = (msec % 1000) * 1000000;
+    while( nanosleep( &wait, &wait ) == -1 && errno == EINTR )
+        ;
+}
+
+
+/*
+ * There are no events to process
+ */
+void fgPlatformProcessSingleEvent ( void )
+{
+}
+
+void fgPlatformMainLoopPreliminaryWork ( void )
+{
+}
+
+
+/* deal with work list items */
+void fgPlatformInitWork(SFG_Window* window)
+{
+    /* No window system tells about the new window, so do it here, as on
+     * Windows. Menus stay hidden until they pop up.
+     */
+    fghPlatformOnWindowStatusNotifyHeadless( window, !window->IsMenu, GL_TRUE );
+    fghOnPositionNotify( window, window->State.Xpos, window->State.Ypos, GL_TRUE );
+    fghOnReshapeNotify( window, window->Window.pContext.Width,
+                        window->Window.pContext.Height, GL_TRUE );
+}
+
+void fgPlatformPosResZordWork(SFG_Window* window, unsigned int workMask)
+{
+    if (workMask & GLUT_FULL_SCREEN_WORK)
+        fgPlatformFullScreenToggle( window );
+    if (workMask & GLUT_POSITION_WORK)
+        fgPlatformPositionWindow( window, window->State.DesiredXpos, window->State.DesiredYpos );
+    if (workMask & GLUT_SIZE_WORK)
+        fgPlatformReshapeWindow ( window, window->State.DesiredWidth, window->State.DesiredHeight );
+    /* Nothing overlaps, so there is no Z order */
+}
+
+void fgPlatformVisibilityWork(SFG_Window* window)
+{
+    SFG_Window *win = window;
+    switch (window->State.DesiredVisibility)
+    {
+    case DesireHiddenState:
+        fgPlatformHideWindow( window );
+        break;
+    case DesireIconicState:
+        /* Call on top-level window */
+        while (win->Parent)
+            win = win->Parent;
+        fgPlatformIconifyWindow( win );
+        break;
+    case DesireNormalState:
+        fgPlatformShowWindow( window );
+        break;
+    }
+}
+
+/*** END OF FILE ***/
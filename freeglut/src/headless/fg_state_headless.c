@@ -0,0 +1,78 @@
+/*
+ * fg_state_headless.c
+ *
+ * Freeglut state query methods, for the headless backend.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "egl/fg_state_egl.h"
+
+int fgPlatformGlutDeviceGet ( GLenum eWhat )
+{
+    switch( eWhat )
+    {
+    /* Nothing to type or point with */
+    case GLUT_HAS_KEYBOARD:
+    case GLUT_HAS_MOUSE:
+    case GLUT_NUM_MOUSE_BUTTONS:
+        return 0;
+
+    default:
+        fgWarning( "glutDeviceGet(): missing enum handle %d", eWhat );
+        break;
+    }
+
+    /* And now -- the failure. */
+    return -1;
+}
+
+int fgPlatformGlutGet ( GLenum eWhat )
+{
+    switch( eWhat )
+    {
+    case GLUT_WINDOW_X:
+        return fgStructure.CurrentWindow ? fgStructure.CurrentWindow->State.Xpos : 0;
+    case GLUT_WINDOW_Y:
+        return fgStructure.CurrentWindow ? fgStructure.CurrentWindow->State.Ypos : 0;
+
+    /* The drawable may be ahead of the window state until the reshape */
+    case GLUT_WINDOW_WIDTH:
+        return fgStructure.CurrentWindow ? fgStructure.CurrentWindow->Window.pContext.Width : 0;
+    case GLUT_WINDOW_HEIGHT:
+        return fgStructure.CurrentWindow ? fgStructure.CurrentWindow->Window.pContext.Height : 0;
+
+    /* No decorations */
+    case GLUT_WINDOW_BORDER_WIDTH:
+    case GLUT_WINDOW_HEADER_HEIGHT:
+        return 0;
+
+    case GLUT_WINDOW_COLORMAP_SIZE:
+        /* 0 for RGBA/non-indexed mode, which is the only one */
+        return 0;
+
+    default:
+        return fghPlatformGlutGetEGL( eWhat );
+    }
+
+    return -1;
+}
+
+/*** END OF FILE ***/
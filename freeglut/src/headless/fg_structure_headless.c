@@ -0,0 +1,42 @@
+/*
+ * fg_structure_headless.c
+ *
+ * Windows and menus need a tree structure, headless as anywhere else.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <GL/freeglut.h>
+#include "../fg_internal.h"
+#include "egl/fg_structure_egl.h"
+
+/*
+ * Initialize default platform-specific fields in SFG_Window
+ */
+void fgPlatformCreateWindow ( SFG_Window *window )
+{
+    fghPlatformCreateWindowEGL( window );
+
+    window->Window.pContext.Framebuffer = 0;
+    window->Window.pContext.Renderbuffers[ 0 ] = 0;
+    window->Window.pContext.Renderbuffers[ 1 ] = 0;
+    window->Window.pContext.Width = 0;
+    window->Window.pContext.Height = 0;
+}
+
+/*** END OF FILE ***/
@@ -0,0 +1,546 @@
+/*
+ * fg_window_headless.c
+ *
+ * Window management methods for the headless backend: windows are EGL
+ * pbuffers, or framebuffer objects of surfaceless contexts.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#define FREEGLUT_BUILDING_LIB
+#include <GL/freeglut.h>
+#include "fg_internal.h"
+#include "fg_gl2.h"
+#include "egl/fg_window_egl.h"
+#include "headless/fg_window_headless.h"
+
+extern void fghOnReshapeNotify(SFG_Window *window, int width, int height, GLboolean forceNotify);
+extern void fghOnPositionNotify(SFG_Window *window, int x, int y, GLboolean forceNotify);
+
+/*
+ * The framebuffer objects of surfaceless contexts exist before fgInitGL2()
+ * has run, so their entry points are looked up here.
+ */
+#define FGH_RENDERBUFFER              0x8D41
+#define FGH_DEPTH24_STENCIL8          0x88F0
+#define FGH_DEPTH_STENCIL_ATTACHMENT  0x821A
+
+typedef void (APIENTRY *FGH_PFNGLGENRENDERBUFFERSPROC) (GLsizei n, GLuint *renderbuffers);
+typedef void (APIENTRY *FGH_PFNGLDELETERENDERBUFFERSPROC) (GLsizei n, const GLuint *renderbuffers);
+typedef void (APIENTRY *FGH_PFNGLBINDRENDERBUFFERPROC) (GLenum target, GLuint renderbuffer);
+typedef void (APIENTRY *FGH_PFNGLRENDERBUFFERSTORAGEPROC) (GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRY *FGH_PFNGLFRAMEBUFFERRENDERBUFFERPROC) (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+
+static struct
+{
+    FGH_PFNGLGENFRAMEBUFFERSPROC         GenFramebuffers;
+    FGH_PFNGLBINDFRAMEBUFFERPROC         BindFramebuffer;
+    FGH_PFNGLDELETEFRAMEBUFFERSPROC      DeleteFramebuffers;
+    FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC  CheckFramebufferStatus;
+    FGH_PFNGLGENRENDERBUFFERSPROC        GenRenderbuffers;
+    FGH_PFNGLDELETERENDERBUFFERSPROC     DeleteRenderbuffers;
+    FGH_PFNGLBINDRENDERBUFFERPROC        BindRenderbuffer;
+    FGH_PFNGLRENDERBUFFERSTORAGEPROC     RenderbufferStorage;
+    FGH_PFNGLFRAMEBUFFERRENDERBUFFERPROC FramebufferRenderbuffer;
+} fghFBO;
+
+static void fghLoadFramebufferFunctions( void )
+{
+    if( fghFBO.GenFramebuffers )
+        return;
+
+#define LOAD(name, type) fghFBO.name = (type)fgPlatformGetProcAddress( "gl" #name )
+    LOAD( GenFramebuffers,         FGH_PFNGLGENFRAMEBUFFERSPROC );
+    LOAD( BindFramebuffer,         FGH_PFNGLBINDFRAMEBUFFERPROC );
+    LOAD( DeleteFramebuffers,      FGH_PFNGLDELETEFRAMEBUFFERSPROC );
+    LOAD( CheckFramebufferStatus,  FGH_PFNGLCHECKFRAMEBUFFERSTATUSPROC );
+    LOAD( GenRenderbuffers,        FGH_PFNGLGENRENDERBUFFERSPROC );
+    LOAD( DeleteRenderbuffers,     FGH_PFNGLDELETERENDERBUFFERSPROC );
+    LOAD( BindRenderbuffer,        FGH_PFNGLBINDRENDERBUFFERPROC );
+    LOAD( RenderbufferStorage,     FGH_PFNGLRENDERBUFFERSTORAGEPROC );
+    LOAD( FramebufferRenderbuffer, FGH_PFNGLFRAMEBUFFERRENDERBUFFERPROC );
+#undef LOAD
+
+    if( !fghFBO.GenFramebuffers || !fghFBO.BindFramebuffer || !fghFBO.DeleteFramebuffers ||
+        !fghFBO.CheckFramebufferStatus || !fghFBO.GenRenderbuffers || !fghFBO.DeleteRenderbuffers ||
+        !fghFBO.BindRenderbuffer || !fghFBO.RenderbufferStorage || !fghFBO.FramebufferRenderbuffer )
+        fgError( "Framebuffer objects are needed to draw without pbuffers" );
+}
+
+
+/* -- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+/*
+ * Chooses a config for the current display mode. Without pbuffers, the
+ * config only describes the context: the framebuffer object drawn to is
+ * always RGBA8, with a depth and stencil buffer if either was asked for.
+ */
+int fghChooseConfig( EGLConfig* config )
+{
+    EGLint attributes[ 32 ];
+    EGLint numConfigs = 0;
+    int where = 0;
+
+    ATTRIB_VAL( EGL_SURFACE_TYPE, fgDisplay.pDisplay.Pbuffers ? EGL_PBUFFER_BIT : 0 );
+    ATTRIB_VAL( EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT );
+    ATTRIB_VAL( EGL_RED_SIZE, 1 );
+    ATTRIB_VAL( EGL_GREEN_SIZE, 1 );
+    ATTRIB_VAL( EGL_BLUE_SIZE, 1 );
+    ATTRIB_VAL( EGL_ALPHA_SIZE, ( fgState.DisplayMode & GLUT_ALPHA ) ? 1 : 0 );
+    ATTRIB_VAL( EGL_DEPTH_SIZE, ( fgState.DisplayMode & GLUT_DEPTH ) ? 1 : 0 );
+    ATTRIB_VAL( EGL_STENCIL_SIZE, ( fgState.DisplayMode & GLUT_STENCIL ) ? 1 : 0 );
+    if( fgDisplay.pDisplay.Pbuffers )
+    {
+        ATTRIB_VAL( EGL_SAMPLE_BUFFERS, ( fgState.DisplayMode & GLUT_MULTISAMPLE ) ? 1 : 0 );
+        ATTRIB_VAL( EGL_SAMPLES, ( fgState.DisplayMode & GLUT_MULTISAMPLE ) ? fgState.SampleNumber : 0 );
+    }
+    ATTRIB( EGL_NONE );
+
+    *config = NULL;
+    if( !eglChooseConfig( fgDisplay.pDisplay.egl.Display,
+                          attributes, config, 1, &numConfigs ) )
+    {
+        fgWarning( "eglChooseConfig: error %x", eglGetError( ) );
+        return 0;
+    }
+
+    return numConfigs > 0;
+}
+
+/*
+ * Creates a desktop OpenGL context, with EGL_KHR_create_context for
+ * anything past the legacy versions
+ */
+static EGLContext fghCreateNewContext( SFG_Window* window )
+{
+    EGLint attributes[ 9 ];
+    int where = 0, contextFlags, contextProfile;
+    EGLContext context;
+
+    if( !fghIsLegacyContextRequested( ) )
+    {
+        ATTRIB_VAL( EGL_CONTEXT_MAJOR_VERSION_KHR, fgState.MajorVersion );
+        ATTRIB_VAL( EGL_CONTEXT_MINOR_VERSION_KHR, fgState.MinorVersion );
+
+        contextFlags =
+            fghMapBit( fgState.ContextFlags, GLUT_DEBUG, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR ) |
+            fghMapBit( fgState.ContextFlags, GLUT_FORWARD_COMPATIBLE, EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR );
+        if( contextFlags != 0 )
+            ATTRIB_VAL( EGL_CONTEXT_FLAGS_KHR, contextFlags );
+
+        contextProfile =
+            fghMapBit( fgState.ContextProfile, GLUT_CORE_PROFILE, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR ) |
+            fghMapBit( fgState.ContextProfile, GLUT_COMPATIBILITY_PROFILE, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR );
+        if( contextProfile != 0 )
+            ATTRIB_VAL( EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, contextProfile );
+    }
+    ATTRIB( EGL_NONE );
+
+    if( fgState.DisplayMode & GLUT_INDEX )
+        fgWarning( "color index mode is not available headless, using RGBA mode" );
+
+    context = eglCreateContext( fgDisplay.pDisplay.egl.Display,
+                                window->Window.pContext.egl.Config,
+                                EGL_NO_CONTEXT, attributes );
+    if( context == EGL_NO_CONTEXT )
+    {
+        fgWarning( "eglCreateContext: error %x", eglGetError( ) );
+        fghContextCreationError( );
+    }
+    return context;
+}
+
+static EGLSurface fghCreatePbuffer( EGLConfig config, int width, int height )
+{
+    EGLint attributes[ 5 ];
+    int where = 0;
+    EGLSurface surface;
+
+    ATTRIB_VAL( EGL_WIDTH, width );
+    ATTRIB_VAL( EGL_HEIGHT, height );
+    ATTRIB( EGL_NONE );
+
+    surface = eglCreatePbufferSurface( fgDisplay.pDisplay.egl.Display, config, attributes );
+    if( surface == EGL_NO_SURFACE )
+        fgError( "Cannot create a %dx%d pbuffer, error %x", width, height, eglGetError( ) );
+    return surface;
+}
+
+/*
+ * (Re)allocates the renderbuffers of the window's framebuffer object.
+ * The window's context must be current.
+ */
+static void fghStoreRenderbuffers( SFG_Window* window, int width, int height )
+{
+    SFG_PlatformContext* pContext = &window->Window.pContext;
+
+    fghFBO.BindRenderbuffer( FGH_RENDERBUFFER, pContext->Renderbuffers[ 0 ] );
+    fghFBO.RenderbufferStorage( FGH_RENDERBUFFER, GL_RGBA8, width, height );
+    if( pContext->Renderbuffers[ 1 ] )
+    {
+        fghFBO.BindRenderbuffer( FGH_RENDERBUFFER, pContext->Renderbuffers[ 1 ] );
+        fghFBO.RenderbufferStorage( FGH_RENDERBUFFER, FGH_DEPTH24_STENCIL8, width, height );
+    }
+    fghFBO.BindRenderbuffer( FGH_RENDERBUFFER, 0 );
+}
+
+/*
+ * Creates the framebuffer object standing in for the window's default
+ * framebuffer, and leaves it bound
+ */
+static void fghCreateFramebuffer( SFG_Window* window, int width, int height )
+{
+    SFG_PlatformContext* pContext = &window->Window.pContext;
+    GLboolean depthStencil = ( fgState.DisplayMode & ( GLUT_DEPTH | GLUT_STENCIL ) ) ? GL_TRUE : GL_FALSE;
+    GLenum status;
+
+    fghLoadFramebufferFunctions( );
+
+    if( eglMakeCurrent( fgDisplay.pDisplay.egl.Display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                        window->Window.Context ) == EGL_FALSE )
+        fgError( "eglMakeCurrent: error %x", eglGetError( ) );
+
+    fghFBO.GenRenderbuffers( depthStencil ? 2 : 1, pContext->Renderbuffers );
+    fghStoreRenderbuffers( window, width, height );
+
+    fghFBO.GenFramebuffers( 1, &pContext->Framebuffer );
+    fghFBO.BindFramebuffer( FGH_FRAMEBUFFER, pContext->Framebuffer );
+    fghFBO.FramebufferRenderbuffer( FGH_FRAMEBUFFER, FGH_COLOR_ATTACHMENT0,
+                                    FGH_RENDERBUFFER, pContext->Renderbuffers[ 0 ] );
+    if( depthStencil )
+        fghFBO.FramebufferRenderbuffer( FGH_FRAMEBUFFER, FGH_DEPTH_STENCIL_ATTACHMENT,
+                                        FGH_RENDERBUFFER, pContext->Renderbuffers[ 1 ] );
+
+    status = fghFBO.CheckFramebufferStatus( FGH_FRAMEBUFFER );
+    if( status != FGH_FRAMEBUFFER_COMPLETE )
+        fgError( "Window framebuffer is incomplete, status %x", status );
+}
+
+
+/* -- INTERFACE FUNCTIONS -------------------------------------------------- */
+
+/*
+ * Resizes the window's drawable. Its contents are lost, as they are when
+ * a real window grows.
+ */
+void fghPlatformResizeWindowHeadless( SFG_Window* window, int width, int height )
+{
+    SFG_PlatformContext* pContext = &window->Window.pContext;
+
+    if( width < 1 )
+        width = 1;
+    if( height < 1 )
+        height = 1;
+    if( width == pContext->Width && height == pContext->Height )
+        return;
+
+    if( pContext->Framebuffer )
+    {
+        fgPlatformSetWindow( window );
+        fghStoreRenderbuffers( window, width, height );
+    }
+    else
+    {
+        EGLSurface surface = pContext->egl.Surface;
+
+        pContext->egl.Surface = fghCreatePbuffer( pContext->egl.Config, width, height );
+        fgPlatformSetWindow( window );
+        eglDestroySurface( fgDisplay.pDisplay.egl.Display, surface );
+    }
+    pContext->Width = width;
+    pContext->Height = height;
+
+    if( fgStructure.CurrentWindow )
+        fgPlatformSetWindow( fgStructure.CurrentWindow );
+}
+
+/*
+ * Tells the window and its children about them being shown or hidden,
+ * which is all there is to window status without a display
+ */
+void fghPlatformOnWindowStatusNotifyHeadless( SFG_Window* window, GLboolean visState, GLboolean forceNotify )
+{
+    SFG_Window* child;
+
+    if( window->State.Visible != visState || forceNotify )
+    {
+        SFG_Window *saved_window = fgStructure.CurrentWindow;
+
+        window->State.Visible = visState;
+        INVOKE_WCB( *window, WindowStatus, ( visState ? GLUT_FULLY_RETAINED : GLUT_HIDDEN ) );
+        fgSetWindow( saved_window );
+    }
+
+    for( child = ( SFG_Window * )window->Children.First;
+         child;
+         child = ( SFG_Window * )child->Node.Next )
+        fghPlatformOnWindowStatusNotifyHeadless( child, visState, GL_FALSE );
+}
+
+void fgPlatformSetWindow ( SFG_Window *window )
+{
+    if( window )
+    {
+        if( eglMakeCurrent( fgDisplay.pDisplay.egl.Display,
+                            window->Window.pContext.egl.Surface,
+                            window->Window.pContext.egl.Surface,
+                            window->Window.Context ) == EGL_FALSE )
+            fgError( "eglMakeCurrent: error %x", eglGetError( ) );
+
+        if( window->Window.pContext.Framebuffer )
+            fghFBO.BindFramebuffer( FGH_FRAMEBUFFER, window->Window.pContext.Framebuffer );
+    }
+}
+
+/*
+ * Opens a window. Requires a SFG_Window object created and attached
+ * to the freeglut structure. OpenGL context is created here.
+ */
+void fgPlatformOpenWindow( SFG_Window* window, const char* title,
+                           GLboolean positionUse, int x, int y,
+                           GLboolean sizeUse, int w, int h,
+                           GLboolean gameMode, GLboolean isSubWindow )
+{
+    unsigned int current_DisplayMode = fgState.DisplayMode ;
+
+    /* Save the display mode if we are creating a menu window */
+    if( window->IsMenu && ( ! fgStructure.MenuContext ) )
+        fgState.DisplayMode = GLUT_DOUBLE | GLUT_RGB ;
+
+    fghChooseConfig( &window->Window.pContext.egl.Config );
+
+    if( window->IsMenu && ( ! fgStructure.MenuContext ) )
+        fgState.DisplayMode = current_DisplayMode ;
+
+    if( ! window->Window.pContext.egl.Config &&
+        ( fgState.DisplayMode & GLUT_MULTISAMPLE ) )
+    {
+        fgState.DisplayMode &= ~GLUT_MULTISAMPLE ;
+        fghChooseConfig( &window->Window.pContext.egl.Config );
+        fgState.DisplayMode |= GLUT_MULTISAMPLE;
+    }
+
+    FREEGLUT_INTERNAL_ERROR_EXIT( window->Window.pContext.egl.Config != NULL,
+                                  "EGLConfig with necessary capabilities not found", "fgOpenWindow" );
+
+    if( ( fgState.DisplayMode & GLUT_MULTISAMPLE ) && ! fgDisplay.pDisplay.Pbuffers )
+        fgWarning( "multisampling needs pbuffers, which this display does not have" );
+
+    if( ! positionUse )
+        x = y = 0;
+    if( ! sizeUse )
+        w = h = 300; /* default window size */
+    if( w < 1 )
+        w = 1;
+    if( h < 1 )
+        h = 1;
+
+    /* Handles are only there to tell windows apart */
+    window->Window.Handle = ++fgDisplay.pDisplay.NextHandle;
+
+    if( window->IsMenu )
+    {
+        /*
+         * If there isn't already an OpenGL rendering context for menu
+         * windows, make one
+         */
+        if( !fgStructure.MenuContext )
+        {
+            fgStructure.MenuContext =
+                (SFG_MenuContext *)malloc( sizeof(SFG_MenuContext) );
+            fgStructure.MenuContext->MContext = fghCreateNewContext( window );
+        }
+
+        window->Window.Context = fghCreateNewContext( window );
+    }
+    else if( fgState.UseCurrentContext )
+    {
+        window->Window.Context = eglGetCurrentContext( );
+
+        if( window->Window.Context == EGL_NO_CONTEXT )
+            window->Window.Context = fghCreateNewContext( window );
+    }
+    else
+        window->Window.Context = fghCreateNewContext( window );
+
+    if( fgDisplay.pDisplay.Pbuffers )
+        window->Window.pContext.egl.Surface =
+            fghCreatePbuffer( window->Window.pContext.egl.Config, w, h );
+    else
+        fghCreateFramebuffer( window, w, h );
+    window->Window.pContext.Width = w;
+    window->Window.pContext.Height = h;
+
+    /* Position and size get reported by the initial work, see fg_main_headless.c */
+    window->State.Xpos = x;
+    window->State.Ypos = y;
+    window->State.pWState.OldX = x;
+    window->State.pWState.OldY = y;
+    window->State.pWState.OldWidth = w;
+    window->State.pWState.OldHeight = h;
+
+    /* Menus are shown when they pop up, everything else right away */
+    window->State.Visible = GL_FALSE;
+}
+
+
+/*
+ * Request a window resize
+ */
+void fgPlatformReshapeWindow ( SFG_Window *window, int width, int height )
+{
+    fghPlatformResizeWindowHeadless( window, width, height );
+    fghOnReshapeNotify( window, window->Window.pContext.Width,
+                        window->Window.pContext.Height, GL_FALSE );
+}
+
+
+/*
+ * Closes a window, destroying the frame and OpenGL context
+ */
+void fgPlatformCloseWindow( SFG_Window* window )
+{
+    SFG_PlatformContext* pContext = &window->Window.pContext;
+
+    if( pContext->Framebuffer && window->Window.Context != EGL_NO_CONTEXT )
+    {
+        fgPlatformSetWindow( window );
+        fghFBO.BindFramebuffer( FGH_FRAMEBUFFER, 0 );
+        fghFBO.DeleteFramebuffers( 1, &pContext->Framebuffer );
+        fghFBO.DeleteRenderbuffers( pContext->Renderbuffers[ 1 ] ? 2 : 1, pContext->Renderbuffers );
+        pContext->Framebuffer = 0;
+        pContext->Renderbuffers[ 0 ] = pContext->Renderbuffers[ 1 ] = 0;
+    }
+
+    /* Nothing may stay current that is about to go */
+    eglMakeCurrent( fgDisplay.pDisplay.egl.Display,
+                    EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+
+    if( window->Window.Context != EGL_NO_CONTEXT )
+    {
+        /* Step through the list of windows. If the rendering context is not being used by another window, then delete it */
+        GLboolean used = GL_FALSE;
+        SFG_Window *iter;
+
+        for( iter = (SFG_Window*)fgStructure.Windows.First;
+             iter && used == GL_FALSE;
+             iter = (SFG_Window*)iter->Node.Next )
+        {
+            if( ( iter->Window.Context == window->Window.Context ) &&
+                ( iter != window ) )
+                used = GL_TRUE;
+        }
+
+        if( !used )
+            eglDestroyContext( fgDisplay.pDisplay.egl.Display, window->Window.Context );
+        window->Window.Context = EGL_NO_CONTEXT;
+    }
+
+    if( pContext->egl.Surface != EGL_NO_SURFACE )
+    {
+        eglDestroySurface( fgDisplay.pDisplay.egl.Display, pContext->egl.Surface );
+        pContext->egl.Surface = EGL_NO_SURFACE;
+    }
+
+    if( fgStructure.CurrentWindow && fgStructure.CurrentWindow != window )
+        fgPlatformSetWindow( fgStructure.CurrentWindow );
+}
+
+
+/*
+ * This function makes the specified window visible
+ */
+void fgPlatformShowWindow( SFG_Window *window )
+{
+    fghPlatformOnWindowStatusNotifyHeadless( window, GL_TRUE, GL_FALSE );
+}
+
+/*
+ * This function hides the specified window
+ */
+void fgPlatformHideWindow( SFG_Window *window )
+{
+    fghPlatformOnWindowStatusNotifyHeadless( window, GL_FALSE, GL_FALSE );
+}
+
+/*
+ * Iconify the specified window (top-level windows only)
+ */
+void fgPlatformIconifyWindow( SFG_Window *window )
+{
+    fghPlatformOnWindowStatusNotifyHeadless( window, GL_FALSE, GL_FALSE );
+}
+
+/*
+ * Nobody reads the titles
+ */
+void fgPlatformGlutSetWindowTitle( const char* title )
+{
+}
+
+void fgPlatformGlutSetIconTitle( const char* title )
+{
+}
+
+/*
+ * Change the specified window's position
+ */
+void fgPlatformPositionWindow( SFG_Window *window, int x, int y )
+{
+    fghOnPositionNotify( window, x, y, GL_FALSE );
+}
+
+/*
+ * Windows do not overlap anything, so Z order is moot
+ */
+void fgPlatformPushWindow( SFG_Window *window )
+{
+}
+
+void fgPlatformPopWindow( SFG_Window *window )
+{
+}
+
+/*
+ * Toggle the window's full screen state: it takes the whole virtual
+ * screen, and gets its previous place back afterwards.
+ */
+void fgPlatformFullScreenToggle( SFG_Window *win )
+{
+    SFG_PlatformWindowState* pWState = &win->State.pWState;
+
+    if( !win->State.IsFullscreen )
+    {
+        pWState->OldX = win->State.Xpos;
+        pWState->OldY = win->State.Ypos;
+        pWState->OldWidth = win->Window.pContext.Width;
+        pWState->OldHeight = win->Window.pContext.Height;
+
+        fgPlatformPositionWindow( win, 0, 0 );
+        fgPlatformReshapeWindow( win, fgDisplay.ScreenWidth, fgDisplay.ScreenHeight );
+    }
+    else
+    {
+        fgPlatformPositionWindow( win, pWState->OldX, pWState->OldY );
+        fgPlatformReshapeWindow( win, pWState->OldWidth, pWState->OldHeight );
+    }
+
+    win->State.IsFullscreen = !win->State.IsFullscreen;
+}
+
+/*** END OF FILE ***/
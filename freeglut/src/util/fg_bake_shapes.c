@@ -0,0 +1,52 @@
+/*
+ * fg_bake_shapes.c
+ *
+ * Bakes freeglut's built-in shapes into a file for glutMapShapes.
+ *
+ * Usage: freeglut_bake_shapes <output> [<shape spec>...]
+ * where a spec is a shape function and its arguments, such as
+ * "solidsphere 1 32 16"; without any, the default list is baked.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * PAWEL W. OLSZTA BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <GL/freeglut.h>
+#include "../fg_shape_blob.h"
+
+int main( int argc, char** argv )
+{
+    int count;
+
+    if( argc < 2 )
+    {
+        fprintf( stderr, "usage: %s <output> [<shape spec>...]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    /* argv is NULL terminated, as glutBakeShapes wants its specs */
+    count = glutBakeShapes( argv[ 1 ], argc > 2 ? (const char* const*)( argv + 2 ) : NULL );
+    if( !count )
+        return 1;
+
+    /* The version glutMapShapes of the same build will map */
+    printf( "%d shapes baked into %s, format version %d\n", count, argv[ 1 ], FGH_BLOB_VERSION );
+    return 0;
+}
+
+/*** END OF FILE ***/
@@ -0,0 +1,170 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _ORK_DUALQUAT_H_
+#define _ORK_DUALQUAT_H_
+
+#include "pmath.h"
+
+#include "vec3.h"
+#include "mat4.h"
+#include "quat.h"
+
+namespace sim
+{
+
+/**
+ * A unit dual quaternion representing a rigid transformation (a rotation
+ * followed by a translation). Unlike matrices, dual quaternions can be
+ * blended without introducing scale or shear, which makes them well suited
+ * for skinning.
+ * @ingroup math
+ */
+template <typename type>
+class dualquat {
+public:
+    /**
+     * The rotation part.
+     */
+    quat<type> real;
+
+    /**
+     * The translation part (half the translation multiplied by the rotation).
+     */
+    quat<type> dual;
+
+    /**
+     * Creates a new, uninitialized dual quaternion.
+     */
+    dualquat();
+
+    /**
+     * Creates a new dual quaternion with the given parts.
+     */
+    dualquat(const quat<type>& real, const quat<type>& dual);
+
+    /**
+     * Creates a new dual quaternion from a rotation and a translation.
+     *
+     * @param rotation a normalized quaternion.
+     * @param translation the translation applied after the rotation.
+     */
+    dualquat(const quat<type>& rotation, const vec3<type>& translation);
+
+    /**
+     * Returns the translation part of this dual quaternion.
+     */
+    vec3<type> translation() const;
+
+    /**
+     * Returns this dual quaternion normalized so that its real part has
+     * unit length.
+     */
+    dualquat normalize() const;
+
+    /**
+     * Transforms a point (rotation then translation).
+     */
+    vec3<type> transform(const vec3<type>& p) const;
+
+    /**
+     * Returns the corresponding 4x4 transformation matrix.
+     */
+    mat4<type> toMat4() const;
+
+    static const dualquat IDENTITY;
+};
+
+/**
+ * Dual quaternion using float.
+ * @ingroup math
+ */
+typedef dualquat<float> dualquatf;
+
+/**
+ * Dual quaternion using double.
+ * @ingroup math
+ */
+typedef dualquat<double> dualquatd;
+
+template <typename type>
+inline dualquat<type>::dualquat()
+{
+}
+
+template <typename type>
+inline dualquat<type>::dualquat(const quat<type>& real, const quat<type>& dual) :
+    real(real), dual(dual)
+{
+}
+
+template <typename type>
+inline dualquat<type>::dualquat(const quat<type>& rotation, const vec3<type>& t) :
+    real(rotation)
+{
+    // dual = 0.5 * (t, 0) * rotation
+    const quat<type>& r = rotation;
+    dual.x = (type) 0.5 * (r.w * t.x + t.y * r.z - t.z * r.y);
+    dual.y = (type) 0.5 * (r.w * t.y + t.z * r.x - t.x * r.z);
+    dual.z = (type) 0.5 * (r.w * t.z + t.x * r.y - t.y * r.x);
+    dual.w = (type) -0.5 * (t.x * r.x + t.y * r.y + t.z * r.z);
+}
+
+template <typename type>
+inline vec3<type> dualquat<type>::translation() const
+{
+    // t = 2 * (dual * conjugate(real)).xyz
+    const quat<type>& r = real;
+    const quat<type>& d = dual;
+    return vec3<type>(2 * (r.w * d.x - d.w * r.x + r.y * d.z - r.z * d.y),
+                      2 * (r.w * d.y - d.w * r.y + r.z * d.x - r.x * d.z),
+                      2 * (r.w * d.z - d.w * r.z + r.x * d.y - r.y * d.x));
+}
+
+template <typename type>
+inline dualquat<type> dualquat<type>::normalize() const
+{
+    type invLength = 1 / real.length();
+    return dualquat(quat<type>(real.x * invLength, real.y * invLength, real.z * invLength, real.w * invLength),
+                    quat<type>(dual.x * invLength, dual.y * invLength, dual.z * invLength, dual.w * invLength));
+}
+
+template <typename type>
+inline vec3<type> dualquat<type>::transform(const vec3<type>& p) const
+{
+    return real * p + translation();
+}
+
+template <typename type>
+mat4<type> dualquat<type>::toMat4() const
+{
+    mat3<type> r = real.toMat3();
+    vec3<type> t = translation();
+    return mat4<type>(r[0][0], r[0][1], r[0][2], t.x,
+                      r[1][0], r[1][1], r[1][2], t.y,
+                      r[2][0], r[2][1], r[2][2], t.z,
+                      0,       0,       0,       1);
+}
+
+template <typename type>
+const dualquat<type> dualquat<type>::IDENTITY(quat<type>(0, 0, 0, 1), quat<type>(0, 0, 0, 0));
+
+}
+
+#endif
@@ -391,16 +391,22 @@ vec2<type> mat3<type>::operator*(const vec2<type>& v) const
 template <typename type>
 box3<type> mat3<type>::operator*(const box3<type>& v) const
 {
-    box3<type> b;
-    b = b.enlarge(operator*(vec3<type>(v.xmin, v.ymin, v.zmin)));
-    b = b.enlarge(operator*(vec3<type>(v.xmax, v.ymin, v.zmin)));
-    b = b.enlarge(operator*(vec3<type>(v.xmin, v.ymax, v.zmin)));
-    b = b.enlarge(operator*(vec3<type>(v.xmax, v.ymax, v.zmin)));
-    b = b.enlarge(operator*(vec3<type>(v.xmin, v.ymin, v.zmax)));
-    b = b.enlarge(operator*(vec3<type>(v.xmax, v.ymin, v.zmax)));
-    b = b.enlarge(operator*(vec3<type>(v.xmin, v.ymax, v.zmax)));
-    b = b.enlarge(operator*(vec3<type>(v.xmax, v.ymax, v.zmax)));
-    return b;
+    // Arvo's method: each coefficient contributes its smallest product to
+    // the minimum and its largest one to the maximum, which gives the exact
+    // bounds of the 8 transformed corners
+    type bmin[3] = { v.xmin, v.ymin, v.zmin };
+    type bmax[3] = { v.xmax, v.ymax, v.zmax };
+    type rmin[3] = { 0, 0, 0 };
+    type rmax[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            type a = m[i][j] * bmin[j];
+            type b = m[i][j] * bmax[j];
+            rmin[i] += min(a, b);
+            rmax[i] += max(a, b);
+        }
+    }
+    return box3<type>(rmin[0], rmax[0], rmin[1], rmax[1], rmin[2], rmax[2]);
 }
 
 template <typename type>
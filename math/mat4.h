@@ -144,9 +144,22 @@ public:
     /**
      * Returns the bounding box of the given bounding box, transormed
      * by the linear transformation represented by this matrix.
+     * Uses transformAffine if this matrix is affine.
      */
     box3<type> operator*(const box3<type>& b) const;
 
+    /**
+     * Returns true if the last row of this matrix is 0,0,0,1.
+     */
+    bool isAffine() const;
+
+    /**
+     * Returns the bounding box of the given bounding box, transformed by
+     * this matrix, assuming it is affine (see isAffine). Exact, and much
+     * cheaper than transforming the 8 corners.
+     */
+    box3<type> transformAffine(const box3<type>& b) const;
+
     /**
      * Returns the product of this matrix and of the given scalar.
      */
@@ -167,6 +180,13 @@ public:
      */
     mat4 inverse() const;
 
+    /**
+     * Returns the inverse of this matrix, assuming it is an affine
+     * transformation (i.e. its last row is 0,0,0,1). Much cheaper than
+     * inverse().
+     */
+    mat4 inverseAffine() const;
+
     /**
      * Returns the linear part of this matrix (i.e. without translations).
      */
@@ -481,6 +501,9 @@ inline vec3<type> mat4<type>::operator*(const vec3<type>& v) const
 template <typename type>
 box3<type> mat4<type>::operator*(const box3<type>& v) const
 {
+    if (isAffine()) {
+        return transformAffine(v);
+    }
     box3<type> b;
     b = b.enlarge(operator*(vec3<type>(v.xmin, v.ymin, v.zmin)));
     b = b.enlarge(operator*(vec3<type>(v.xmax, v.ymin, v.zmin)));
@@ -493,6 +516,31 @@ box3<type> mat4<type>::operator*(const box3<type>& v) const
     return b;
 }
 
+template <typename type>
+inline bool mat4<type>::isAffine() const
+{
+    return m[3][0] == 0 && m[3][1] == 0 && m[3][2] == 0 && m[3][3] == 1;
+}
+
+template <typename type>
+box3<type> mat4<type>::transformAffine(const box3<type>& v) const
+{
+    // Arvo's method, see mat3::operator*(const box3&)
+    type bmin[3] = { v.xmin, v.ymin, v.zmin };
+    type bmax[3] = { v.xmax, v.ymax, v.zmax };
+    type rmin[3] = { m[0][3], m[1][3], m[2][3] };
+    type rmax[3] = { m[0][3], m[1][3], m[2][3] };
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            type a = m[i][j] * bmin[j];
+            type b = m[i][j] * bmax[j];
+            rmin[i] += min(a, b);
+            rmax[i] += max(a, b);
+        }
+    }
+    return box3<type>(rmin[0], rmax[0], rmin[1], rmax[1], rmin[2], rmax[2]);
+}
+
 template <typename type>
 inline mat4<type> mat4<type>::operator*(type f) const
 {
@@ -569,6 +617,30 @@ mat4<type> mat4<type>::inverse() const
     return adjoint() * (1.0f / determinant());
 }
 
+template <typename type>
+mat4<type> mat4<type>::inverseAffine() const
+{
+    // inverse of the linear part, by cofactors
+    type c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    type c01 = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+    type c02 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+    type c10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    type c11 = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+    type c12 = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+    type c20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    type c21 = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+    type c22 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    type invDet = 1 / (m[0][0] * c00 + m[0][1] * c10 + m[0][2] * c20);
+    c00 *= invDet; c01 *= invDet; c02 *= invDet;
+    c10 *= invDet; c11 *= invDet; c12 *= invDet;
+    c20 *= invDet; c21 *= invDet; c22 *= invDet;
+    // the translation is -inverse(linear part) * translation
+    return mat4(c00, c01, c02, -(c00 * m[0][3] + c01 * m[1][3] + c02 * m[2][3]),
+                c10, c11, c12, -(c10 * m[0][3] + c11 * m[1][3] + c12 * m[2][3]),
+                c20, c21, c22, -(c20 * m[0][3] + c21 * m[1][3] + c22 * m[2][3]),
+                0,   0,   0,   1);
+}
+
 template <typename type>
 mat3<type> mat4<type>::mat3x3() const
 {
@@ -598,8 +670,8 @@ inline mat4<type> mat4<type>::translate(const vec3<type> &v)
 template <typename type>
 inline mat4<type> mat4<type>::rotatex(type angle)
 {
-    type ca = (type) cos(angle * M_PI / 180.0);
-    type sa = (type) sin(angle * M_PI / 180.0);
+    type ca, sa;
+    sincosDegrees(angle, sa, ca);
     return mat4<type>(1, 0, 0, 0,
                       0, ca, -sa, 0,
                       0, sa, ca, 0,
@@ -609,8 +681,8 @@ inline mat4<type> mat4<type>::rotatex(type angle)
 template <typename type>
 inline mat4<type> mat4<type>::rotatey(type angle)
 {
-    type ca = (type) cos(angle * M_PI / 180.0);
-    type sa = (type) sin(angle * M_PI / 180.0);
+    type ca, sa;
+    sincosDegrees(angle, sa, ca);
     return mat4<type>(ca, 0, sa, 0,
                       0, 1, 0, 0,
                       -sa, 0, ca, 0,
@@ -620,8 +692,8 @@ inline mat4<type> mat4<type>::rotatey(type angle)
 template <typename type>
 inline mat4<type> mat4<type>::rotatez(type angle)
 {
-    type ca = (type) cos(angle * M_PI / 180.0);
-    type sa = (type) sin(angle * M_PI / 180.0);
+    type ca, sa;
+    sincosDegrees(angle, sa, ca);
     return mat4<type>(ca, -sa, 0, 0,
                       sa, ca, 0, 0,
                       0, 0, 1, 0,
@@ -665,6 +737,39 @@ const mat4<type> mat4<type>::IDENTITY(
     0, 0, 1, 0,
     0, 0, 0, 1);
 
+/**
+ * Transforms n bounding boxes by n affine matrices (e.g. local bounds by
+ * world matrices): out[i] = m[i].transformAffine(b[i]). Uses the center and
+ * extent form of the boxes, without branches, so that the loop can be
+ * vectorized. The boxes must not be empty. out may be equal to b.
+ * @ingroup math
+ */
+template <typename type>
+void transformAffine(const mat4<type>* m, const box3<type>* b, box3<type>* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const type* c = m[i].coefficients();
+        type cx = (b[i].xmin + b[i].xmax) / 2;
+        type cy = (b[i].ymin + b[i].ymax) / 2;
+        type cz = (b[i].zmin + b[i].zmax) / 2;
+        type ex = (b[i].xmax - b[i].xmin) / 2;
+        type ey = (b[i].ymax - b[i].ymin) / 2;
+        type ez = (b[i].zmax - b[i].zmin) / 2;
+        type rx = c[0] * cx + c[1] * cy + c[2] * cz + c[3];
+        type ry = c[4] * cx + c[5] * cy + c[6] * cz + c[7];
+        type rz = c[8] * cx + c[9] * cy + c[10] * cz + c[11];
+        type sx = fabs(c[0]) * ex + fabs(c[1]) * ey + fabs(c[2]) * ez;
+        type sy = fabs(c[4]) * ex + fabs(c[5]) * ey + fabs(c[6]) * ez;
+        type sz = fabs(c[8]) * ex + fabs(c[9]) * ey + fabs(c[10]) * ez;
+        out[i].xmin = rx - sx;
+        out[i].xmax = rx + sx;
+        out[i].ymin = ry - sy;
+        out[i].ymax = ry + sy;
+        out[i].zmin = rz - sz;
+        out[i].zmax = rz + sz;
+    }
+}
+
 }
 
 #endif
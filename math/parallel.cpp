@@ -0,0 +1,164 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "parallel.h"
+
+namespace sim
+{
+
+namespace
+{
+
+// true on the threads executing a task, to run nested loops serially
+thread_local bool insideTask = false;
+
+}
+
+TaskPool::TaskPool(unsigned int threadCount) :
+    task(NULL), count(0), grainSize(1), nextRange(0), pendingRanges(0),
+    activeWorkers(0), generation(0), stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        workers.push_back(std::thread(&TaskPool::workerLoop, this));
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+unsigned int TaskPool::getThreadCount() const
+{
+    return (unsigned int) workers.size() + 1;
+}
+
+void TaskPool::parallelFor(size_t count, size_t grainSize, const RangeTask& task)
+{
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+    if (workers.empty() || count <= grainSize || insideTask) {
+        task(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock(jobMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->count = count;
+        this->grainSize = grainSize;
+        nextRange.store(0);
+        pendingRanges = (count + grainSize - 1) / grainSize;
+        ++generation;
+    }
+    wakeWorkers.notify_all();
+
+    runRanges(task, count, grainSize);
+
+    // workers may still be inside runRanges after the last range completed
+    std::unique_lock<std::mutex> lock(mutex);
+    while (pendingRanges > 0 || activeWorkers > 0) {
+        jobDone.wait(lock);
+    }
+    this->task = NULL;
+}
+
+TaskPool& TaskPool::getDefault()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+void TaskPool::workerLoop()
+{
+    unsigned int seen = 0;
+    for (;;) {
+        const RangeTask* t;
+        size_t n;
+        size_t grain;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && generation == seen) {
+                wakeWorkers.wait(lock);
+            }
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (task == NULL) {
+                // woke up after the job was already completed
+                continue;
+            }
+            t = task;
+            n = count;
+            grain = grainSize;
+            ++activeWorkers;
+        }
+        runRanges(*t, n, grain);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+            if (activeWorkers == 0 && pendingRanges == 0) {
+                jobDone.notify_one();
+            }
+        }
+    }
+}
+
+void TaskPool::runRanges(const RangeTask& task, size_t count, size_t grainSize)
+{
+    size_t ranges = (count + grainSize - 1) / grainSize;
+    size_t done = 0;
+    insideTask = true;
+    for (;;) {
+        size_t r = nextRange.fetch_add(1);
+        if (r >= ranges) {
+            break;
+        }
+        size_t begin = r * grainSize;
+        size_t end = begin + grainSize < count ? begin + grainSize : count;
+        task(begin, end);
+        ++done;
+    }
+    insideTask = false;
+    if (done > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingRanges -= done;
+        if (pendingRanges == 0) {
+            jobDone.notify_one();
+        }
+    }
+}
+
+}
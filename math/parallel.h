@@ -0,0 +1,165 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _ORK_PARALLEL_H_
+#define _ORK_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace sim
+{
+
+/**
+ * A fixed set of worker threads used to split loops over large arrays
+ * (skinning, transform hierarchies, ...) into ranges processed in parallel.
+ * The calling thread takes part in the work, so a pool with a single thread
+ * simply runs everything inline.
+ * @ingroup math
+ */
+class TaskPool
+{
+public:
+    /**
+     * A task processing the elements [begin, end) of a loop.
+     */
+    typedef std::function<void(size_t begin, size_t end)> RangeTask;
+
+    /**
+     * Creates a new pool.
+     *
+     * @param threadCount the total number of threads used by parallelFor,
+     *      including the calling thread. 0 means one per hardware thread.
+     */
+    explicit TaskPool(unsigned int threadCount = 0);
+
+    /**
+     * Stops and joins the worker threads.
+     */
+    ~TaskPool();
+
+    /**
+     * Returns the total number of threads used by parallelFor, including
+     * the calling thread.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Calls task on consecutive ranges covering [0, count), and returns when
+     * all of them have been processed. Ranges contain grainSize elements
+     * (except the last one) and are distributed dynamically between the
+     * threads. Calls made from inside a task run serially on the caller.
+     *
+     * @param count the number of elements to process.
+     * @param grainSize the number of elements per range (at least 1).
+     * @param task the function to call for each range.
+     */
+    void parallelFor(size_t count, size_t grainSize, const RangeTask& task);
+
+    /**
+     * Returns a process wide pool with one thread per hardware thread.
+     */
+    static TaskPool& getDefault();
+
+private:
+    /**
+     * The worker threads (the calling thread is not included).
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * Serializes concurrent calls to parallelFor.
+     */
+    std::mutex jobMutex;
+
+    /**
+     * Protects the job description and counters below.
+     */
+    std::mutex mutex;
+
+    /**
+     * Signaled when a new job is available or when the pool is stopped.
+     */
+    std::condition_variable wakeWorkers;
+
+    /**
+     * Signaled when the last range of a job has been processed.
+     */
+    std::condition_variable jobDone;
+
+    /**
+     * The task of the current job, or NULL if there is none.
+     */
+    const RangeTask* task;
+
+    /**
+     * The number of elements of the current job.
+     */
+    size_t count;
+
+    /**
+     * The number of elements per range of the current job.
+     */
+    size_t grainSize;
+
+    /**
+     * The index of the next range to process.
+     */
+    std::atomic<size_t> nextRange;
+
+    /**
+     * The number of ranges of the current job not yet processed.
+     */
+    size_t pendingRanges;
+
+    /**
+     * The number of workers currently processing ranges.
+     */
+    unsigned int activeWorkers;
+
+    /**
+     * Incremented for each new job.
+     */
+    unsigned int generation;
+
+    /**
+     * True when the pool is being destroyed.
+     */
+    bool stopping;
+
+    TaskPool(const TaskPool&);
+
+    TaskPool& operator=(const TaskPool&);
+
+    void workerLoop();
+
+    /**
+     * Processes ranges of the current job until none is left.
+     */
+    void runRanges(const RangeTask& task, size_t count, size_t grainSize);
+};
+
+}
+
+#endif
@@ -7,7 +7,9 @@
  * Also provides helper functions:
  *     isNaN, isFinite, sincos, mix, step, smoothStep,
  *     square, signedSquare, clamp,
- *     degrees, radians, safe_asin, safe_acos, round, ipow
+ *     degrees, radians, sincosDegrees, safe_asin, safe_acos, round, ipow
+ * and fast array kernels, with a selectable precision:
+ *     sincos, rsqrt, exp, log
  */
 
 #include <math.h>
@@ -658,6 +660,26 @@ inline void sincos(T angleRad, T& sinResult, T& cosResult)
     cosResult = cos(angleRad);
 }
 
+#if defined(__GNUC__)
+
+/**
+ * Returns the sinus and cosinus of an angle, with a single range reduction.
+ */
+inline void sincos(float angleRad, float& sinResult, float& cosResult)
+{
+    __builtin_sincosf(angleRad, &sinResult, &cosResult);
+}
+
+/**
+ * Returns the sinus and cosinus of an angle, with a single range reduction.
+ */
+inline void sincos(double angleRad, double& sinResult, double& cosResult)
+{
+    __builtin_sincos(angleRad, &sinResult, &cosResult);
+}
+
+#endif
+
 /**
  * Returns v^2.
  */
@@ -779,6 +801,35 @@ inline long double radians(long double x)
     return x * (M_PI_L / 180.0L);
 }
 
+/**
+ * Returns the sinus and cosinus of an angle in degrees. The angle is
+ * converted to radians and reduced in double precision, and only the
+ * results are rounded to float.
+ */
+inline void sincosDegrees(float angleDeg, float& sinResult, float& cosResult)
+{
+    double s, c;
+    sincos(radians((double) angleDeg), s, c);
+    sinResult = (float) s;
+    cosResult = (float) c;
+}
+
+/**
+ * Returns the sinus and cosinus of an angle in degrees.
+ */
+inline void sincosDegrees(double angleDeg, double& sinResult, double& cosResult)
+{
+    sincos(radians(angleDeg), sinResult, cosResult);
+}
+
+/**
+ * Returns the sinus and cosinus of an angle in degrees.
+ */
+inline void sincosDegrees(long double angleDeg, long double& sinResult, long double& cosResult)
+{
+    sincos(radians(angleDeg), sinResult, cosResult);
+}
+
 /**
  * Returns the arccosinus of x clamped to [-1,1].
  */
@@ -831,4 +882,213 @@ inline T remap(T value, T a, T b, T c, T d)
     return c + (d - c) * (value - a) / (b - a);
 }
 
+// Precision policies of the array kernels below. Errors were measured
+// against double precision libm results on the documented input ranges.
+
+/**
+ * Uses the C library functions (at most 1 ulp of error).
+ */
+struct PrecisionExact
+{
+    static const int LEVEL = 2;
+};
+
+/**
+ * Uses polynomial approximations with at most 2 ulp of error for sin and
+ * cos (|x| <= 8192), 3 ulp for rsqrt, 1 ulp for exp and log.
+ */
+struct PrecisionHigh
+{
+    static const int LEVEL = 1;
+};
+
+/**
+ * Uses short polynomial approximations, with a relative error below 1e-5
+ * for rsqrt and 1e-4 for exp, and an absolute error below 1e-4 for sin and
+ * cos (|x| <= 8192) and log. Good enough for geometry generation and
+ * animation.
+ */
+struct PrecisionLow
+{
+    static const int LEVEL = 0;
+};
+
+// The kernels are written without branches in their loop bodies, so that
+// they are vectorized by the compiler. The output arrays may be equal to the
+// input ones.
+
+/**
+ * Computes the sinus and cosinus of n angles, in radians.
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ */
+template<typename Precision>
+void sincos(const float* angleRad, float* sinResult, float* cosResult, size_t n)
+{
+    if (Precision::LEVEL == PrecisionExact::LEVEL) {
+        for (size_t i = 0; i < n; ++i) {
+            sincos(angleRad[i], sinResult[i], cosResult[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        // x = j * pi / 2 + r, with |r| <= pi / 4 (Cody-Waite reduction). It
+        // is done in double precision: near the zeros of sin and cos, r is
+        // tiny and float constants lose most of its bits. pi / 2 is split
+        // into a 33 bit part, whose products by j are exact, and the rest.
+        double x = angleRad[i];
+        int j = (int) (x * M_2_PI + (x >= 0 ? 0.5 : -0.5));
+        double dj = (double) j;
+        float r = (float) ((x - dj * 1.57079632673412561417e+00) - dj * 6.07710050650619224932e-11);
+        float r2 = r * r;
+        float s, c;
+        if (Precision::LEVEL == PrecisionHigh::LEVEL) {
+            s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+            c = 1 - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+        } else {
+            s = r + r * r2 * (-1.6659486e-1f + r2 * 8.1403e-3f);
+            c = 1 + r2 * (-4.9967e-1f + r2 * 4.0102e-2f);
+        }
+        // quadrant j & 3: (s, c), (c, -s), (-s, -c), (-c, s), with bit
+        // operations rather than branches
+        UIF32 us, uc;
+        us.f = s;
+        uc.f = c;
+        unsigned int swap = 0U - (unsigned int) (j & 1);
+        unsigned int sr = (us.i & ~swap) | (uc.i & swap);
+        unsigned int cr = (uc.i & ~swap) | (us.i & swap);
+        us.i = sr ^ ((unsigned int) (j & 2) << 30);
+        uc.i = cr ^ ((unsigned int) ((j + 1) & 2) << 30);
+        sinResult[i] = us.f;
+        cosResult[i] = uc.f;
+    }
+}
+
+/**
+ * Returns the inverse square root of a positive number.
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ */
+template<typename Precision>
+inline float rsqrt(float x)
+{
+    if (Precision::LEVEL == PrecisionExact::LEVEL) {
+        return 1.0f / sqrt(x);
+    }
+    // initial estimate from the exponent bits, then Newton iterations
+    UIF32 u;
+    u.f = x;
+    u.i = 0x5F375A86UL - (u.i >> 1);
+    float hx = 0.5f * x;
+    float y = u.f;
+    y = y * (1.5f - hx * y * y);
+    y = y * (1.5f - hx * y * y);
+    if (Precision::LEVEL == PrecisionHigh::LEVEL) {
+        y = y * (1.5f - hx * y * y);
+    }
+    return y;
+}
+
+/**
+ * Computes the inverse square root of n positive numbers.
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ */
+template<typename Precision>
+void rsqrt(const float* x, float* result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = rsqrt<Precision>(x[i]);
+    }
+}
+
+/**
+ * Computes the exponential of n numbers, which must be in [-87, 88].
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ */
+template<typename Precision>
+void exp(const float* x, float* result, size_t n)
+{
+    if (Precision::LEVEL == PrecisionExact::LEVEL) {
+        for (size_t i = 0; i < n; ++i) {
+            result[i] = exp(x[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        // x = j * ln(2) + r, with |r| <= ln(2) / 2, and exp(x) = 2^j exp(r)
+        float v = x[i];
+        int j = (int) (v * M_LOG2E_F + (v >= 0 ? 0.5f : -0.5f));
+        float fj = (float) j;
+        float r = (v - fj * 0.693359375f) + fj * 2.12194440e-4f;
+        float p;
+        if (Precision::LEVEL == PrecisionHigh::LEVEL) {
+            p = 1.9875691500e-4f;
+            p = p * r + 1.3981999507e-3f;
+            p = p * r + 8.3334519073e-3f;
+            p = p * r + 4.1665795894e-2f;
+            p = p * r + 1.6666665459e-1f;
+            p = p * r + 5.0000001201e-1f;
+            p = p * r * r + r + 1;
+        } else {
+            p = 4.3682e-2f;
+            p = p * r + 1.6674e-1f;
+            p = p * r + 4.9993e-1f;
+            p = p * r * r + r + 1;
+        }
+        UIF32 u;
+        u.i = (unsigned int) (j + 127) << 23;
+        result[i] = p * u.f;
+    }
+}
+
+/**
+ * Computes the natural logarithm of n positive normal numbers.
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ */
+template<typename Precision>
+void log(const float* x, float* result, size_t n)
+{
+    if (Precision::LEVEL == PrecisionExact::LEVEL) {
+        for (size_t i = 0; i < n; ++i) {
+            result[i] = log(x[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        // x = 2^e m, with m in [sqrt(1/2), sqrt(2)), and log(x) = e ln(2) + log(m)
+        UIF32 u;
+        u.f = x[i];
+        int e = (int) ((u.i >> 23) & 0xFF) - 127;
+        u.i = (u.i & 0x007FFFFFUL) | 0x3F800000UL;
+        // halves m if it is above sqrt(2), by decrementing its exponent
+        unsigned int high = u.i > 0x3FB504F3UL ? 1U : 0U;
+        u.i -= high << 23;
+        float fe = (float) (e + (int) high);
+        float r = u.f - 1;
+        float r2 = r * r;
+        float p;
+        if (Precision::LEVEL == PrecisionHigh::LEVEL) {
+            p = 7.0376836292e-2f;
+            p = p * r - 1.1514610310e-1f;
+            p = p * r + 1.1676998740e-1f;
+            p = p * r - 1.2420140846e-1f;
+            p = p * r + 1.4249322787e-1f;
+            p = p * r - 1.6668057665e-1f;
+            p = p * r + 2.0000714765e-1f;
+            p = p * r - 2.4999993993e-1f;
+            p = p * r + 3.3333331174e-1f;
+            p = p * r * r2 - 0.5f * r2 + r;
+        } else {
+            p = 1.9158e-1f;
+            p = p * r - 2.6338e-1f;
+            p = p * r + 3.3214e-1f;
+            p = p * r * r2 - 0.5f * r2 + r;
+        }
+        result[i] = (p - fe * 2.12194440e-4f) + fe * 0.693359375f;
+    }
+}
+
 #endif
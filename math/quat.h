@@ -25,6 +25,7 @@
 #define _QUAT_H_
 
 #include "pmath.h"
+#include <cstddef>
 
 #include "vec3.h"
 #include "mat3.h"
@@ -81,6 +82,11 @@ public:
      */
     quat(const quat& v);
 
+    /**
+     * Assigns the given quaternion to this quaternion.
+     */
+    quat& operator=(const quat& v);
+
     /**
      * Create a normalized quaternion from an axis and an angle (MOST USEFUL)
      * @param axis an axis (do not need to be normalized)
@@ -173,13 +179,23 @@ inline quat<type>::quat(const quat& v) : x(v.x), y(v.y), z(v.z), w(v.w)
 {
 }
 
+template <typename type>
+inline quat<type>& quat<type>::operator=(const quat& v)
+{
+    x = v.x;
+    y = v.y;
+    z = v.z;
+    w = v.w;
+    return *this;
+}
+
 template <typename type>
 inline quat<type>::quat(const vec3<type>& axis, type angle)
 {
     vec3<type> axisN = axis.normalize();
     type a = angle * 0.5f;
-    type sina = sin(a);
-    type cosa = cos(a);
+    type sina, cosa;
+    sincos(a, sina, cosa);
     x = axisN.x * sina;
     y = axisN.y * sina;
     z = axisN.z * sina;
@@ -236,15 +252,27 @@ quat<type> quat<type>::operator*( const quat &a ) const
 template <typename type>
 quat<type>& quat<type>::operator*=( const quat &a )
 {
-    *this = *this * a;
+    type nx = a.w * x  + a.x * w  + a.y * z  - a.z * y;
+    type ny = a.w * y  - a.x * z  + a.y * w  + a.z * x;
+    type nz = a.w * z  + a.x * y  - a.y * x  + a.z * w;
+    w       = a.w * w  - a.x * x  - a.y * y  - a.z * z;
+    x = nx;
+    y = ny;
+    z = nz;
     return *this;
 }
 
 template <typename type>
-vec3<type> quat<type>::operator*(const vec3<type>& a) const
+inline vec3<type> quat<type>::operator*(const vec3<type>& a) const
 {
-    // TODO implement faster, direct multiplication
-    return toMat3() * a;
+    // v' = v + w * t + q.xyz ^ t, with t = 2 * (q.xyz ^ v)
+    // same result as toMat3() * a, without building the matrix
+    type tx = 2 * (y * a.z - z * a.y);
+    type ty = 2 * (z * a.x - x * a.z);
+    type tz = 2 * (x * a.y - y * a.x);
+    return vec3<type>(a.x + w * tx + (y * tz - z * ty),
+                      a.y + w * ty + (z * tx - x * tz),
+                      a.z + w * tz + (x * ty - y * tx));
 }
 
 template <typename type>
@@ -296,6 +324,11 @@ mat4<type> quat<type>::toMat4() const
 template <typename type>
 const quat<type> quat<type>::ONE(0, 0, 0, 1);
 
+/**
+ * Spherical linear interpolation between two normalized quaternions.
+ * Interpolates along the shortest arc.
+ * @ingroup math
+ */
 template <typename type>
 quat<type> slerp(const quat<type>& from, const quat<type>& to, type t)
 {
@@ -319,6 +352,9 @@ quat<type> slerp(const quat<type>& from, const quat<type>& to, type t)
             scale0 = 1 - t;
             scale1 = t;
         }
+        if (cosom < 0) {
+            scale1 = -scale1;
+        }
         quat<type> res = quat<type>(scale0 * from.x + scale1 * to.x,
                                     scale0 * from.y + scale1 * to.y,
                                     scale0 * from.z + scale1 * to.z,
@@ -327,6 +363,141 @@ quat<type> slerp(const quat<type>& from, const quat<type>& to, type t)
     }
 }
 
+/**
+ * Normalized linear interpolation between two normalized quaternions.
+ * Cheaper than slerp but the angular velocity is not constant, which is
+ * usually acceptable for blending animation poses.
+ * Interpolates along the shortest arc.
+ * @ingroup math
+ */
+template <typename type>
+inline quat<type> nlerp(const quat<type>& from, const quat<type>& to, type t)
+{
+    type cosom = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+    type scale0 = 1 - t;
+    type scale1 = cosom < 0 ? -t : t;
+    quat<type> res = quat<type>(scale0 * from.x + scale1 * to.x,
+                                scale0 * from.y + scale1 * to.y,
+                                scale0 * from.z + scale1 * to.z,
+                                scale0 * from.w + scale1 * to.w);
+    return res.normalize();
+}
+
+// batch kernels
+//
+// These process whole arrays of quaternions (e.g. all the bones of all the
+// characters of a frame). Loop bodies are kept branch-free so that the
+// compiler can vectorize them; the output arrays must not alias the inputs
+// unless stated otherwise.
+
+/**
+ * Rotates n vectors: out[i] = q[i] * v[i]. out may be equal to v.
+ * @ingroup math
+ */
+template <typename type>
+void rotate(const quat<type>* q, const vec3<type>* v, vec3<type>* out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        type qx = q[i].x, qy = q[i].y, qz = q[i].z, qw = q[i].w;
+        type vx = v[i].x, vy = v[i].y, vz = v[i].z;
+        type tx = 2 * (qy * vz - qz * vy);
+        type ty = 2 * (qz * vx - qx * vz);
+        type tz = 2 * (qx * vy - qy * vx);
+        out[i].x = vx + qw * tx + (qy * tz - qz * ty);
+        out[i].y = vy + qw * ty + (qz * tx - qx * tz);
+        out[i].z = vz + qw * tz + (qx * ty - qy * tx);
+    }
+}
+
+/**
+ * Rotates n vectors by the same quaternion: out[i] = q * v[i]. out may be
+ * equal to v.
+ * @ingroup math
+ */
+template <typename type>
+void rotate(const quat<type>& q, const vec3<type>* v, vec3<type>* out, size_t n)
+{
+    const type qx = q.x, qy = q.y, qz = q.z, qw = q.w;
+    for (size_t i = 0; i < n; ++i) {
+        type vx = v[i].x, vy = v[i].y, vz = v[i].z;
+        type tx = 2 * (qy * vz - qz * vy);
+        type ty = 2 * (qz * vx - qx * vz);
+        type tz = 2 * (qx * vy - qy * vx);
+        out[i].x = vx + qw * tx + (qy * tz - qz * ty);
+        out[i].y = vy + qw * ty + (qz * tx - qx * tz);
+        out[i].z = vz + qw * tz + (qx * ty - qy * tx);
+    }
+}
+
+/**
+ * Normalized linear interpolation of n pairs of quaternions with a common
+ * factor t: out[i] = nlerp(from[i], to[i], t). out may be equal to from or to.
+ * @ingroup math
+ */
+template <typename type>
+void nlerp(const quat<type>* from, const quat<type>* to, type t, quat<type>* out, size_t n)
+{
+    const type scale0 = 1 - t;
+    for (size_t i = 0; i < n; ++i) {
+        const quat<type>& a = from[i];
+        const quat<type>& b = to[i];
+        type cosom = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+        type scale1 = cosom < 0 ? -t : t;
+        type rx = scale0 * a.x + scale1 * b.x;
+        type ry = scale0 * a.y + scale1 * b.y;
+        type rz = scale0 * a.z + scale1 * b.z;
+        type rw = scale0 * a.w + scale1 * b.w;
+        type invLength = 1 / static_cast<type>(sqrt(rx * rx + ry * ry + rz * rz + rw * rw));
+        out[i].x = rx * invLength;
+        out[i].y = ry * invLength;
+        out[i].z = rz * invLength;
+        out[i].w = rw * invLength;
+    }
+}
+
+/**
+ * Spherical linear interpolation of n pairs of quaternions with a common
+ * factor t: out[i] = slerp(from[i], to[i], t). out may be equal to from or to.
+ * @ingroup math
+ */
+template <typename type>
+void slerp(const quat<type>* from, const quat<type>* to, type t, quat<type>* out, size_t n)
+{
+    if (t <= 0 || t >= 1) {
+        const quat<type>* src = t <= 0 ? from : to;
+        if (src != out) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = src[i];
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const quat<type>& a = from[i];
+        const quat<type>& b = to[i];
+        type cosom = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+        type absCosom = fabs(cosom);
+        // nearly parallel quaternions fall back to a linear blend; omega
+        // is clamped so that the division below is always defined
+        bool linear = (1 - absCosom) <= (type) 1e-6;
+        type omega = safe_acos(absCosom);
+        type sinom = sin(omega);
+        type invSinom = 1 / (linear ? (type) 1 : sinom);
+        type scale0 = linear ? 1 - t : sin((1 - t) * omega) * invSinom;
+        type scale1 = linear ? t : sin(t * omega) * invSinom;
+        scale1 = cosom < 0 ? -scale1 : scale1;
+        type rx = scale0 * a.x + scale1 * b.x;
+        type ry = scale0 * a.y + scale1 * b.y;
+        type rz = scale0 * a.z + scale1 * b.z;
+        type rw = scale0 * a.w + scale1 * b.w;
+        type invLength = 1 / static_cast<type>(sqrt(rx * rx + ry * ry + rz * rz + rw * rw));
+        out[i].x = rx * invLength;
+        out[i].y = ry * invLength;
+        out[i].z = rz * invLength;
+        out[i].w = rw * invLength;
+    }
+}
+
 }
 
 #endif // _QUAT_H_
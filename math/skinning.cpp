@@ -0,0 +1,213 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "skinning.h"
+
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SKINNING_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace sim
+{
+
+namespace
+{
+
+inline void store3(void* dst, float x, float y, float z)
+{
+    float* f = static_cast<float*>(dst);
+    f[0] = x;
+    f[1] = y;
+    f[2] = z;
+}
+
+inline void* advance(void* p, size_t bytes)
+{
+    return static_cast<char*>(p) + bytes;
+}
+
+}
+
+SkinningEngine::SkinningEngine(TaskPool& pool, size_t grainSize) :
+    pool(pool), grainSize(grainSize)
+{
+}
+
+void SkinningEngine::skin(const SkinningSource& source, const mat4f* palette, const SkinningTarget& target)
+{
+    pool.parallelFor(source.vertexCount, grainSize, [&](size_t begin, size_t end) {
+        skinRange(source, palette, target, begin, end);
+    });
+}
+
+void SkinningEngine::skin(const SkinningSource& source, const dualquatf* palette, const SkinningTarget& target)
+{
+    pool.parallelFor(source.vertexCount, grainSize, [&](size_t begin, size_t end) {
+        skinRange(source, palette, target, begin, end);
+    });
+}
+
+void SkinningEngine::skinRange(const SkinningSource& source, const mat4f* palette,
+    const SkinningTarget& target, size_t begin, size_t end)
+{
+    const bool withNormals = source.normals != NULL && target.normals != NULL;
+    void* pos = advance(target.positions, begin * target.positionStride);
+    void* nor = withNormals ? advance(target.normals, begin * target.normalStride) : NULL;
+
+    for (size_t i = begin; i < end; ++i) {
+        const unsigned short* bones = source.boneIndices + i * SKINNING_BONES_PER_VERTEX;
+        const float* weights = source.boneWeights + i * SKINNING_BONES_PER_VERTEX;
+        const vec3f& p = source.positions[i];
+
+#ifdef SKINNING_SSE
+        // blends the first three rows of the bone matrices
+        __m128 r0 = _mm_setzero_ps();
+        __m128 r1 = _mm_setzero_ps();
+        __m128 r2 = _mm_setzero_ps();
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            const float* m = palette[bones[k]].coefficients();
+            __m128 w = _mm_set1_ps(weights[k]);
+            r0 = _mm_add_ps(r0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+            r1 = _mm_add_ps(r1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+            r2 = _mm_add_ps(r2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+        }
+        // rows to columns, so that m * p is a sum of scaled columns
+        __m128 r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        float out[4];
+        __m128 q = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, _mm_set1_ps(p.x)), _mm_mul_ps(r1, _mm_set1_ps(p.y))),
+                              _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(p.z)), r3));
+        _mm_storeu_ps(out, q);
+        store3(pos, out[0], out[1], out[2]);
+
+        if (withNormals) {
+            const vec3f& n = source.normals[i];
+            __m128 m = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, _mm_set1_ps(n.x)), _mm_mul_ps(r1, _mm_set1_ps(n.y))),
+                                  _mm_mul_ps(r2, _mm_set1_ps(n.z)));
+            _mm_storeu_ps(out, m);
+            float invLength = 1.0f / sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+            store3(nor, out[0] * invLength, out[1] * invLength, out[2] * invLength);
+            nor = advance(nor, target.normalStride);
+        }
+#else
+        float r[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            const float* m = palette[bones[k]].coefficients();
+            float w = weights[k];
+            for (int j = 0; j < 12; ++j) {
+                r[j] += w * m[j];
+            }
+        }
+        store3(pos, r[0] * p.x + r[1] * p.y + r[2] * p.z + r[3],
+                    r[4] * p.x + r[5] * p.y + r[6] * p.z + r[7],
+                    r[8] * p.x + r[9] * p.y + r[10] * p.z + r[11]);
+
+        if (withNormals) {
+            const vec3f& n = source.normals[i];
+            float nx = r[0] * n.x + r[1] * n.y + r[2] * n.z;
+            float ny = r[4] * n.x + r[5] * n.y + r[6] * n.z;
+            float nz = r[8] * n.x + r[9] * n.y + r[10] * n.z;
+            float invLength = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz);
+            store3(nor, nx * invLength, ny * invLength, nz * invLength);
+            nor = advance(nor, target.normalStride);
+        }
+#endif
+        pos = advance(pos, target.positionStride);
+    }
+}
+
+void SkinningEngine::skinRange(const SkinningSource& source, const dualquatf* palette,
+    const SkinningTarget& target, size_t begin, size_t end)
+{
+    const bool withNormals = source.normals != NULL && target.normals != NULL;
+    void* pos = advance(target.positions, begin * target.positionStride);
+    void* nor = withNormals ? advance(target.normals, begin * target.normalStride) : NULL;
+
+    for (size_t i = begin; i < end; ++i) {
+        const unsigned short* bones = source.boneIndices + i * SKINNING_BONES_PER_VERTEX;
+        const float* weights = source.boneWeights + i * SKINNING_BONES_PER_VERTEX;
+        const quatf& pivot = palette[bones[0]].real;
+
+        // blends the dual quaternions, all in the hemisphere of the first one
+        float b[8];
+#ifdef SKINNING_SSE
+        __m128 real = _mm_setzero_ps();
+        __m128 dual = _mm_setzero_ps();
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            const dualquatf& dq = palette[bones[k]];
+            float cosom = pivot.x * dq.real.x + pivot.y * dq.real.y + pivot.z * dq.real.z + pivot.w * dq.real.w;
+            __m128 w = _mm_set1_ps(cosom < 0 ? -weights[k] : weights[k]);
+            real = _mm_add_ps(real, _mm_mul_ps(w, _mm_loadu_ps(&dq.real.x)));
+            dual = _mm_add_ps(dual, _mm_mul_ps(w, _mm_loadu_ps(&dq.dual.x)));
+        }
+        _mm_storeu_ps(b, real);
+        _mm_storeu_ps(b + 4, dual);
+#else
+        memset(b, 0, sizeof(b));
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            const dualquatf& dq = palette[bones[k]];
+            float cosom = pivot.x * dq.real.x + pivot.y * dq.real.y + pivot.z * dq.real.z + pivot.w * dq.real.w;
+            float w = cosom < 0 ? -weights[k] : weights[k];
+            b[0] += w * dq.real.x;
+            b[1] += w * dq.real.y;
+            b[2] += w * dq.real.z;
+            b[3] += w * dq.real.w;
+            b[4] += w * dq.dual.x;
+            b[5] += w * dq.dual.y;
+            b[6] += w * dq.dual.z;
+            b[7] += w * dq.dual.w;
+        }
+#endif
+        float invLength = 1.0f / sqrtf(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+        float rx = b[0] * invLength, ry = b[1] * invLength, rz = b[2] * invLength, rw = b[3] * invLength;
+        float dx = b[4] * invLength, dy = b[5] * invLength, dz = b[6] * invLength, dw = b[7] * invLength;
+
+        // translation = 2 * (dual * conjugate(real)).xyz
+        float tx = 2 * (rw * dx - dw * rx + ry * dz - rz * dy);
+        float ty = 2 * (rw * dy - dw * ry + rz * dx - rx * dz);
+        float tz = 2 * (rw * dz - dw * rz + rx * dy - ry * dx);
+
+        // rotation, see quat::operator*(const vec3&)
+        const vec3f& p = source.positions[i];
+        float ux = 2 * (ry * p.z - rz * p.y);
+        float uy = 2 * (rz * p.x - rx * p.z);
+        float uz = 2 * (rx * p.y - ry * p.x);
+        store3(pos, p.x + rw * ux + (ry * uz - rz * uy) + tx,
+                    p.y + rw * uy + (rz * ux - rx * uz) + ty,
+                    p.z + rw * uz + (rx * uy - ry * ux) + tz);
+        pos = advance(pos, target.positionStride);
+
+        if (withNormals) {
+            const vec3f& n = source.normals[i];
+            ux = 2 * (ry * n.z - rz * n.y);
+            uy = 2 * (rz * n.x - rx * n.z);
+            uz = 2 * (rx * n.y - ry * n.x);
+            store3(nor, n.x + rw * ux + (ry * uz - rz * uy),
+                        n.y + rw * uy + (rz * ux - rx * uz),
+                        n.z + rw * uz + (rx * uy - ry * ux));
+            nor = advance(nor, target.normalStride);
+        }
+    }
+}
+
+}
@@ -0,0 +1,170 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _ORK_SKINNING_H_
+#define _ORK_SKINNING_H_
+
+#include <cstddef>
+
+#include "vec3.h"
+#include "mat4.h"
+#include "dualquat.h"
+#include "parallel.h"
+
+namespace sim
+{
+
+/**
+ * The number of bones influencing each skinned vertex.
+ * @ingroup math
+ */
+const int SKINNING_BONES_PER_VERTEX = 4;
+
+/**
+ * The bind-pose data of a skinned mesh. Each vertex is influenced by
+ * SKINNING_BONES_PER_VERTEX bones; unused influences must have a 0 weight
+ * and a valid bone index (e.g. 0). Weights are expected to sum to 1.
+ * @ingroup math
+ */
+struct SkinningSource
+{
+    /**
+     * The bind-pose vertex positions.
+     */
+    const vec3f* positions;
+
+    /**
+     * The bind-pose vertex normals, or NULL to skin positions only.
+     */
+    const vec3f* normals;
+
+    /**
+     * The bone indices, SKINNING_BONES_PER_VERTEX per vertex.
+     */
+    const unsigned short* boneIndices;
+
+    /**
+     * The bone weights, SKINNING_BONES_PER_VERTEX per vertex.
+     */
+    const float* boneWeights;
+
+    /**
+     * The number of vertices.
+     */
+    size_t vertexCount;
+};
+
+/**
+ * Where skinned vertices are written. Positions and normals are written as
+ * 3 consecutive floats, every stride bytes, so that they can be written
+ * directly into an interleaved vertex buffer mapped with glMapBufferRange.
+ * The destination is never read, which keeps write-combined memory fast.
+ * @ingroup math
+ */
+struct SkinningTarget
+{
+    /**
+     * The destination of the first skinned position.
+     */
+    void* positions;
+
+    /**
+     * The number of bytes between two consecutive positions.
+     */
+    size_t positionStride;
+
+    /**
+     * The destination of the first skinned normal, or NULL.
+     */
+    void* normals;
+
+    /**
+     * The number of bytes between two consecutive normals.
+     */
+    size_t normalStride;
+};
+
+/**
+ * A CPU linear blend or dual quaternion skinning engine. Vertices are split
+ * in ranges skinned in parallel by a TaskPool, each range using SIMD kernels
+ * when available.
+ * @ingroup math
+ */
+class SkinningEngine
+{
+public:
+    /**
+     * Creates a new skinning engine.
+     *
+     * @param pool the threads used to skin vertices.
+     * @param grainSize the number of vertices skinned per task.
+     */
+    SkinningEngine(TaskPool& pool = TaskPool::getDefault(), size_t grainSize = 4096);
+
+    /**
+     * Skins vertices with linear blend skinning. Only the first three rows
+     * of the matrices are used: bone transforms are assumed affine, so no
+     * projective divide is performed. Normals are transformed by the blended
+     * linear part and renormalized.
+     *
+     * @param source the bind-pose mesh.
+     * @param palette the bone matrices, indexed by source.boneIndices.
+     * @param target where to write the skinned vertices.
+     */
+    void skin(const SkinningSource& source, const mat4f* palette, const SkinningTarget& target);
+
+    /**
+     * Skins vertices with dual quaternion skinning, which preserves volume
+     * around joints. Normals are rotated by the blended rotation.
+     *
+     * @param source the bind-pose mesh.
+     * @param palette the bone transforms, indexed by source.boneIndices.
+     * @param target where to write the skinned vertices.
+     */
+    void skin(const SkinningSource& source, const dualquatf* palette, const SkinningTarget& target);
+
+    /**
+     * Skins the vertices [begin, end) with linear blend skinning on the
+     * calling thread.
+     */
+    static void skinRange(const SkinningSource& source, const mat4f* palette,
+        const SkinningTarget& target, size_t begin, size_t end);
+
+    /**
+     * Skins the vertices [begin, end) with dual quaternion skinning on the
+     * calling thread.
+     */
+    static void skinRange(const SkinningSource& source, const dualquatf* palette,
+        const SkinningTarget& target, size_t begin, size_t end);
+
+private:
+    /**
+     * The threads used to skin vertices.
+     */
+    TaskPool& pool;
+
+    /**
+     * The number of vertices skinned per task.
+     */
+    size_t grainSize;
+};
+
+}
+
+#endif
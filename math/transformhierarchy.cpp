@@ -0,0 +1,298 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "transformhierarchy.h"
+
+#include <cassert>
+
+namespace sim
+{
+
+namespace
+{
+
+/**
+ * Returns parent * child, assuming both are affine transformations.
+ */
+inline void affineProduct(const float* a, const float* b, float* r)
+{
+    for (int i = 0; i < 12; i += 4) {
+        r[i + 0] = a[i] * b[0] + a[i + 1] * b[4] + a[i + 2] * b[8];
+        r[i + 1] = a[i] * b[1] + a[i + 1] * b[5] + a[i + 2] * b[9];
+        r[i + 2] = a[i] * b[2] + a[i + 1] * b[6] + a[i + 2] * b[10];
+        r[i + 3] = a[i] * b[3] + a[i + 1] * b[7] + a[i + 2] * b[11] + a[i + 3];
+    }
+    r[12] = 0;
+    r[13] = 0;
+    r[14] = 0;
+    r[15] = 1;
+}
+
+/**
+ * Returns translation * rotation * scale.
+ */
+inline void localMatrix(const vec3f& t, const quatf& q, const vec3f& s, float* r)
+{
+    float xx = q.x * q.x, xy = q.x * q.y, xz = q.x * q.z, xw = q.x * q.w;
+    float yy = q.y * q.y, yz = q.y * q.z, yw = q.y * q.w;
+    float zz = q.z * q.z, zw = q.z * q.w;
+    r[0] = (1 - 2 * (yy + zz)) * s.x;
+    r[1] = 2 * (xy - zw) * s.y;
+    r[2] = 2 * (xz + yw) * s.z;
+    r[3] = t.x;
+    r[4] = 2 * (xy + zw) * s.x;
+    r[5] = (1 - 2 * (xx + zz)) * s.y;
+    r[6] = 2 * (yz - xw) * s.z;
+    r[7] = t.y;
+    r[8] = 2 * (xz - yw) * s.x;
+    r[9] = 2 * (yz + xw) * s.y;
+    r[10] = (1 - 2 * (xx + yy)) * s.z;
+    r[11] = t.z;
+    r[12] = 0;
+    r[13] = 0;
+    r[14] = 0;
+    r[15] = 1;
+}
+
+}
+
+TransformHierarchy::TransformHierarchy(TaskPool& pool) :
+    pool(pool), serialCount(0), orderDirty(false)
+{
+}
+
+size_t TransformHierarchy::getNodeCount() const
+{
+    return parents.size();
+}
+
+int TransformHierarchy::addNode(int parent)
+{
+    assert(parent == NO_PARENT || (parent >= 0 && parent < (int) parents.size()));
+    int node = (int) parents.size();
+    parents.push_back(parent);
+    translations.push_back(vec3f::ZERO);
+    rotations.push_back(quatf::ONE);
+    scales.push_back(vec3f(1, 1, 1));
+    worlds.push_back(mat4f::IDENTITY);
+    localDirty.push_back(1);
+    worldChanged.push_back(0);
+    orderDirty = true;
+    return node;
+}
+
+int TransformHierarchy::getParent(int node) const
+{
+    return parents[node];
+}
+
+void TransformHierarchy::setParent(int node, int parent)
+{
+    assert(parent == NO_PARENT || (parent >= 0 && parent < (int) parents.size()));
+    if (parents[node] != parent) {
+        parents[node] = parent;
+        localDirty[node] = 1;
+        orderDirty = true;
+    }
+}
+
+const vec3f& TransformHierarchy::getTranslation(int node) const
+{
+    return translations[node];
+}
+
+const quatf& TransformHierarchy::getRotation(int node) const
+{
+    return rotations[node];
+}
+
+const vec3f& TransformHierarchy::getScale(int node) const
+{
+    return scales[node];
+}
+
+void TransformHierarchy::setTranslation(int node, const vec3f& t)
+{
+    translations[node] = t;
+    localDirty[node] = 1;
+}
+
+void TransformHierarchy::setRotation(int node, const quatf& r)
+{
+    rotations[node] = r;
+    localDirty[node] = 1;
+}
+
+void TransformHierarchy::setScale(int node, const vec3f& s)
+{
+    scales[node] = s;
+    localDirty[node] = 1;
+}
+
+void TransformHierarchy::setLocal(int node, const vec3f& t, const quatf& r, const vec3f& s)
+{
+    translations[node] = t;
+    rotations[node] = r;
+    scales[node] = s;
+    localDirty[node] = 1;
+}
+
+size_t TransformHierarchy::update()
+{
+    if (orderDirty) {
+        sortNodes();
+        orderDirty = false;
+    }
+
+    size_t updated = 0;
+    for (size_t i = 0; i < serialCount; ++i) {
+        updated += updateNode(order[i]) ? 1 : 0;
+    }
+
+    size_t segmentCount = segments.size() - 1;
+    if (segmentCount > 0) {
+        std::vector<size_t> counts(segmentCount, 0);
+        size_t grain = segmentCount / (pool.getThreadCount() * 4) + 1;
+        pool.parallelFor(segmentCount, grain, [&](size_t begin, size_t end) {
+            for (size_t s = begin; s < end; ++s) {
+                size_t n = 0;
+                for (size_t i = segments[s]; i < segments[s + 1]; ++i) {
+                    n += updateNode(order[i]) ? 1 : 0;
+                }
+                counts[s] = n;
+            }
+        });
+        for (size_t s = 0; s < segmentCount; ++s) {
+            updated += counts[s];
+        }
+    }
+    return updated;
+}
+
+const mat4f& TransformHierarchy::getWorld(int node) const
+{
+    return worlds[node];
+}
+
+mat4f TransformHierarchy::getWorldInverse(int node) const
+{
+    return worlds[node].inverseAffine();
+}
+
+const mat4f* TransformHierarchy::getWorldMatrices() const
+{
+    return worlds.empty() ? NULL : &worlds[0];
+}
+
+void TransformHierarchy::sortNodes()
+{
+    int n = (int) parents.size();
+
+    // children lists, in a single array
+    std::vector<int> childStart(n + 1, 0);
+    std::vector<int> children(n);
+    std::vector<int> roots;
+    for (int i = 0; i < n; ++i) {
+        if (parents[i] == NO_PARENT) {
+            roots.push_back(i);
+        } else {
+            ++childStart[parents[i] + 1];
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        childStart[i + 1] += childStart[i];
+    }
+    std::vector<int> next(childStart.begin(), childStart.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        if (parents[i] != NO_PARENT) {
+            children[next[parents[i]]++] = i;
+        }
+    }
+
+    // breadth first traversal, and number of nodes at each depth
+    std::vector<int> bfs(roots);
+    std::vector<size_t> levelStart(1, 0);
+    levelStart.push_back(bfs.size());
+    for (size_t i = 0; i < bfs.size(); ++i) {
+        int node = bfs[i];
+        for (int c = childStart[node]; c < childStart[node + 1]; ++c) {
+            bfs.push_back(children[c]);
+        }
+        if (i + 1 == levelStart.back() && bfs.size() > levelStart.back()) {
+            levelStart.push_back(bfs.size());
+        }
+    }
+    assert((int) bfs.size() == n); // fails if there is a cycle
+
+    // the subtrees at the first depth with enough nodes to keep all threads
+    // busy are updated in parallel, the levels above them serially
+    size_t levels = levelStart.size() - 1;
+    size_t wanted = pool.getThreadCount() * 4;
+    size_t split = 0;
+    for (size_t d = 0; d < levels; ++d) {
+        size_t count = levelStart[d + 1] - levelStart[d];
+        if (count >= wanted) {
+            split = d;
+            break;
+        }
+        if (count > levelStart[split + 1] - levelStart[split]) {
+            split = d;
+        }
+    }
+
+    order.assign(bfs.begin(), bfs.begin() + levelStart[split]);
+    serialCount = order.size();
+    segments.clear();
+    std::vector<int> stack;
+    for (size_t i = serialCount; i < levelStart[split + 1]; ++i) {
+        segments.push_back(order.size());
+        stack.push_back(bfs[i]);
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            order.push_back(node);
+            for (int c = childStart[node + 1] - 1; c >= childStart[node]; --c) {
+                stack.push_back(children[c]);
+            }
+        }
+    }
+    segments.push_back(order.size());
+}
+
+bool TransformHierarchy::updateNode(int node)
+{
+    int parent = parents[node];
+    bool dirty = localDirty[node] || (parent != NO_PARENT && worldChanged[parent]);
+    worldChanged[node] = dirty ? 1 : 0;
+    if (dirty) {
+        float local[16];
+        localMatrix(translations[node], rotations[node], scales[node], local);
+        if (parent == NO_PARENT) {
+            worlds[node] = mat4f(local);
+        } else {
+            float world[16];
+            affineProduct(worlds[parent].coefficients(), local, world);
+            worlds[node] = mat4f(world);
+        }
+        localDirty[node] = 0;
+    }
+    return dirty;
+}
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Copyright (c) 2008-2010 INRIA
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _ORK_TRANSFORM_HIERARCHY_H_
+#define _ORK_TRANSFORM_HIERARCHY_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "vec3.h"
+#include "mat4.h"
+#include "quat.h"
+#include "parallel.h"
+
+namespace sim
+{
+
+/**
+ * A hierarchy of transformations (a scene graph without content). Each
+ * node has a local translation, rotation and scale relative to its parent,
+ * stored in separate arrays. update() recomputes the world matrices of the
+ * nodes whose local transformation, or the one of an ancestor, changed since
+ * the last update, in a single pass over the nodes sorted so that parents
+ * come before their children. Independent subtrees are updated in parallel.
+ *
+ * Nodes are identified by the index returned by addNode. The world matrices
+ * are stored contiguously in this order, so that they can be uploaded
+ * directly in a uniform or texture buffer (they are row major).
+ * @ingroup math
+ */
+class TransformHierarchy
+{
+public:
+    /**
+     * The parent index of root nodes.
+     */
+    static const int NO_PARENT = -1;
+
+    /**
+     * Creates a new, empty hierarchy.
+     *
+     * @param pool the threads used to update independent subtrees.
+     */
+    TransformHierarchy(TaskPool& pool = TaskPool::getDefault());
+
+    /**
+     * Returns the number of nodes of this hierarchy.
+     */
+    size_t getNodeCount() const;
+
+    /**
+     * Adds a node with an identity local transformation.
+     *
+     * @param parent the parent node, or NO_PARENT to add a root node.
+     * @return the index of the new node.
+     */
+    int addNode(int parent = NO_PARENT);
+
+    /**
+     * Returns the parent of the given node, or NO_PARENT.
+     */
+    int getParent(int node) const;
+
+    /**
+     * Moves a node, with its subtree, under a new parent.
+     *
+     * @param parent the new parent node (must not be in the subtree of
+     *      node), or NO_PARENT.
+     */
+    void setParent(int node, int parent);
+
+    /**
+     * Returns the local translation of the given node.
+     */
+    const vec3f& getTranslation(int node) const;
+
+    /**
+     * Returns the local rotation of the given node.
+     */
+    const quatf& getRotation(int node) const;
+
+    /**
+     * Returns the local scale of the given node.
+     */
+    const vec3f& getScale(int node) const;
+
+    /**
+     * Sets the local translation of the given node.
+     */
+    void setTranslation(int node, const vec3f& t);
+
+    /**
+     * Sets the local rotation of the given node.
+     *
+     * @param r a normalized quaternion.
+     */
+    void setRotation(int node, const quatf& r);
+
+    /**
+     * Sets the local scale of the given node.
+     */
+    void setScale(int node, const vec3f& s);
+
+    /**
+     * Sets the local translation, rotation and scale of the given node.
+     * The local matrix is translation * rotation * scale.
+     */
+    void setLocal(int node, const vec3f& t, const quatf& r, const vec3f& s);
+
+    /**
+     * Recomputes the world matrices of the nodes whose local
+     * transformation, or the one of an ancestor, changed.
+     *
+     * @return the number of recomputed world matrices.
+     */
+    size_t update();
+
+    /**
+     * Returns the world matrix of the given node, as computed by the last
+     * call to update().
+     */
+    const mat4f& getWorld(int node) const;
+
+    /**
+     * Returns the inverse of the world matrix of the given node.
+     */
+    mat4f getWorldInverse(int node) const;
+
+    /**
+     * Returns the world matrices of all the nodes, indexed by node.
+     */
+    const mat4f* getWorldMatrices() const;
+
+private:
+    /**
+     * The threads used to update independent subtrees.
+     */
+    TaskPool& pool;
+
+    /**
+     * The parent of each node.
+     */
+    std::vector<int> parents;
+
+    /**
+     * The local translation of each node.
+     */
+    std::vector<vec3f> translations;
+
+    /**
+     * The local rotation of each node.
+     */
+    std::vector<quatf> rotations;
+
+    /**
+     * The local scale of each node.
+     */
+    std::vector<vec3f> scales;
+
+    /**
+     * The world matrix of each node.
+     */
+    std::vector<mat4f> worlds;
+
+    /**
+     * Whether the local transformation of each node changed since the last
+     * update.
+     */
+    std::vector<unsigned char> localDirty;
+
+    /**
+     * Whether the world matrix of each node was recomputed during the
+     * current update.
+     */
+    std::vector<unsigned char> worldChanged;
+
+    /**
+     * The nodes, sorted so that parents come before their children. The
+     * first serialCount nodes are updated serially, then each range
+     * [segments[i], segments[i + 1]) is a set of whole subtrees that can be
+     * updated independently of the others.
+     */
+    std::vector<int> order;
+
+    /**
+     * The start of each independent range of order, followed by the size
+     * of order.
+     */
+    std::vector<size_t> segments;
+
+    /**
+     * The number of nodes at the start of order to update serially.
+     */
+    size_t serialCount;
+
+    /**
+     * True if order must be recomputed.
+     */
+    bool orderDirty;
+
+    /**
+     * Recomputes order and segments.
+     */
+    void sortNodes();
+
+    /**
+     * Recomputes the world matrix of a node if needed.
+     *
+     * @return true if the world matrix was recomputed.
+     */
+    bool updateNode(int node);
+};
+
+}
+
+#endif
@@ -489,6 +489,23 @@ const vec3<type> vec3<type>::UNIT_Y(0, 1, 0);
 template <typename type>
 const vec3<type> vec3<type>::UNIT_Z(0, 0, 1);
 
+/**
+ * Normalizes n vectors to unit length, in place, using rsqrt.
+ *
+ * @tparam Precision PrecisionExact, PrecisionHigh or PrecisionLow.
+ * @ingroup math
+ */
+template <typename Precision>
+void normalize(vec3<float>* v, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        float invLength = rsqrt<Precision>(v[i].x * v[i].x + v[i].y * v[i].y + v[i].z * v[i].z);
+        v[i].x *= invLength;
+        v[i].y *= invLength;
+        v[i].z *= invLength;
+    }
+}
+
 }
 
 #endif
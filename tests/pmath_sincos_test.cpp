@@ -0,0 +1,83 @@
+/*
+ * Checks the error bound documented on PrecisionHigh for the sincos array
+ * kernel of pmath.h, against double precision libm results: every float
+ * with 1 <= |x| <= 8192, where the argument reduction matters, and every
+ * 16th one below.
+ */
+
+#include "pmath.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+const float MAX_ANGLE = 8192.0f;
+
+const double MAX_ULP = 2.0;
+
+// Error of result in units in the last place of the float nearest to
+// reference
+double ulpError(float result, double reference)
+{
+    int e;
+    frexp(reference, &e);
+    double ulp = ldexp(1.0, e < -125 ? -149 : e - 24);
+    return fabs(result - reference) / ulp;
+}
+
+unsigned int floatBits(float x)
+{
+    unsigned int bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(unsigned int bits)
+{
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+}
+
+int main()
+{
+    const size_t CHUNK = 1 << 20;
+    std::vector<float> angles(CHUNK), sines(CHUNK), cosines(CHUNK);
+    const unsigned int one = floatBits(1.0f);
+    const unsigned int last = floatBits(MAX_ANGLE);
+    double maxSin = 0, maxCos = 0;
+    float maxSinAngle = 0, maxCosAngle = 0;
+
+    for (int sign = -1; sign <= 1; sign += 2) {
+        unsigned int bits = 0;
+        while (bits <= last) {
+            size_t n = 0;
+            while (n < CHUNK && bits <= last) {
+                angles[n++] = sign * bitsFloat(bits);
+                bits += bits < one ? 16 : 1;
+            }
+            sincos<PrecisionHigh>(angles.data(), sines.data(), cosines.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                double s = ulpError(sines[i], sin((double) angles[i]));
+                double c = ulpError(cosines[i], cos((double) angles[i]));
+                if (s > maxSin) {
+                    maxSin = s;
+                    maxSinAngle = angles[i];
+                }
+                if (c > maxCos) {
+                    maxCos = c;
+                    maxCosAngle = angles[i];
+                }
+            }
+        }
+    }
+
+    printf("sin: %.2f ulp at %.9g\n", maxSin, maxSinAngle);
+    printf("cos: %.2f ulp at %.9g\n", maxCos, maxCosAngle);
+    return maxSin <= MAX_ULP && maxCos <= MAX_ULP ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/*
+ * Times SkinningEngine on a mesh of 1M vertices with 4 bone influences
+ * each, with a mat4f and a dual quaternion palette of 64 bones, writing
+ * positions and normals interleaved as into a mapped vertex buffer. The
+ * output must match that of skinRange on the calling thread, also when
+ * split between 4 threads whatever the machine has. An optional argument
+ * sets the number of vertices.
+ */
+
+#include "skinning.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace sim;
+
+namespace
+{
+
+const size_t DEFAULT_VERTICES = 1000000;
+
+const int BONES = 64;
+
+const int RUNS = 20;
+
+const unsigned int CHECK_THREADS = 4;
+
+// Deterministic pseudo random numbers in [0, 1)
+unsigned int seed = 1;
+
+float random01()
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+// Sets best and mean to the times of RUNS calls of skin, in milliseconds,
+// after a first call to warm up the pool and the caches
+template <typename Palette>
+void time(SkinningEngine& engine, const SkinningSource& source, const Palette* palette,
+    const SkinningTarget& target, double& best, double& mean)
+{
+    engine.skin(source, palette, target);
+    best = 1e30;
+    mean = 0;
+    for (int i = 0; i < RUNS; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        engine.skin(source, palette, target);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = ms < best ? ms : best;
+        mean += ms / RUNS;
+    }
+}
+
+// Times one palette, and checks the output of engine and checkEngine
+// against that of the calling thread alone
+template <typename Palette>
+bool run(const char* name, SkinningEngine& engine, SkinningEngine& checkEngine,
+    const SkinningSource& source, const Palette* palette,
+    std::vector<float>& threaded, std::vector<float>& serial)
+{
+    SkinningTarget target = { &threaded[0], 6 * sizeof(float), &threaded[3], 6 * sizeof(float) };
+    SkinningTarget serialTarget = { &serial[0], 6 * sizeof(float), &serial[3], 6 * sizeof(float) };
+    double best, mean;
+
+    time(engine, source, palette, target, best, mean);
+    SkinningEngine::skinRange(source, palette, serialTarget, 0, source.vertexCount);
+
+    bool same = memcmp(&threaded[0], &serial[0], threaded.size() * sizeof(float)) == 0;
+    memset(&threaded[0], 0, threaded.size() * sizeof(float));
+    checkEngine.skin(source, palette, target);
+    same = same && memcmp(&threaded[0], &serial[0], threaded.size() * sizeof(float)) == 0;
+    printf("%s: best %.2f ms, mean %.2f ms, %.0f Mvertices/s%s\n", name, best, mean,
+        source.vertexCount / best / 1000.0, same ? "" : ", output differs from skinRange");
+    return same;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const size_t n = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : DEFAULT_VERTICES;
+    std::vector<vec3f> positions(n), normals(n);
+    std::vector<unsigned short> boneIndices(n * SKINNING_BONES_PER_VERTEX);
+    std::vector<float> boneWeights(n * SKINNING_BONES_PER_VERTEX);
+    std::vector<mat4f> matrices(BONES);
+    std::vector<dualquatf> dualquats(BONES);
+    std::vector<float> threaded(n * 6), serial(n * 6);
+
+    if (n == 0) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        float sum = 0;
+        positions[i] = vec3f(random01() * 2 - 1, random01() * 2 - 1, random01() * 2 - 1);
+        normals[i] = vec3f(random01() * 2 - 1, random01() * 2 - 1, random01() * 2 - 1 + 4).normalize();
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            boneIndices[i * SKINNING_BONES_PER_VERTEX + k] = (unsigned short) (random01() * BONES);
+            boneWeights[i * SKINNING_BONES_PER_VERTEX + k] = random01() + 0.1f;
+            sum += boneWeights[i * SKINNING_BONES_PER_VERTEX + k];
+        }
+        for (int k = 0; k < SKINNING_BONES_PER_VERTEX; ++k) {
+            boneWeights[i * SKINNING_BONES_PER_VERTEX + k] /= sum;
+        }
+    }
+
+    for (int b = 0; b < BONES; ++b) {
+        vec3f axis(random01() - 0.5f, random01() - 0.5f, random01() + 0.5f);
+        float angle = random01() * 3.0f;
+        vec3f translation(random01() - 0.5f, random01() - 0.5f, random01() - 0.5f);
+        quatf rotation(axis, angle);
+        matrices[b] = mat4f::translate(translation) * rotation.toMat4();
+        dualquats[b] = dualquatf(rotation, translation);
+    }
+
+    SkinningSource source = { &positions[0], &normals[0], &boneIndices[0], &boneWeights[0], n };
+    SkinningEngine engine;
+    TaskPool checkPool(CHECK_THREADS);
+    SkinningEngine checkEngine(checkPool);
+
+    printf("%lu vertices, %d bones, %d influences, %u threads\n", (unsigned long) n, BONES,
+        SKINNING_BONES_PER_VERTEX, TaskPool::getDefault().getThreadCount());
+    bool same = run("linear blend", engine, checkEngine, source, &matrices[0], threaded, serial);
+    same = run("dual quaternion", engine, checkEngine, source, &dualquats[0], threaded, serial) && same;
+    return same ? 0 : 1;
+}
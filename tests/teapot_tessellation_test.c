@@ -0,0 +1,213 @@
+/*
+ * Checks that the teapot, teacup and teaspoon tessellated on the GPU
+ * (fg_teapot_gpu.c) draw exactly as those of the CPU path: each shape is
+ * drawn in a GL 4.3 context, and in a GL 3.3 one in a child process,
+ * which has Mesa cap its version for the CPU path to be taken, and the
+ * images must not differ in any pixel. Meant for llvmpipe, whose
+ * arithmetic is that of the CPU; skipped elsewhere.
+ */
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include "fg_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SIZE        128
+#define NUM_SHAPES  12
+#define IMAGE_BYTES ( SIZE * SIZE * 4 )
+#define SKIPPED     77
+
+static const char* vertexShader =
+    "#version 330\n"
+    "in vec3 v_coord;\n"
+    "in vec3 v_normal;\n"
+    "out vec3 normal;\n"
+    "void main()\n"
+    "{\n"
+    "    normal = v_normal;\n"
+    "    gl_Position = vec4(v_coord.xy * 1.2, v_coord.z * -0.5, 1.0);\n"
+    "}\n";
+
+static const char* fragmentShader =
+    "#version 330\n"
+    "in vec3 normal;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    color = vec4(normalize(normal) * 0.5 + 0.5, 1.0);\n"
+    "}\n";
+
+static const char* shapeNames[ NUM_SHAPES / 2 ] =
+{
+    "solid teapot", "wire teapot", "solid teacup", "wire teacup", "solid teaspoon", "wire teaspoon"
+};
+
+static void display( void )
+{
+}
+
+static void drawShape( int shape )
+{
+    switch( shape % 6 )
+    {
+    case 0: glutSolidTeapot( 0.5 ); break;
+    case 1: glutWireTeapot( 0.5 ); break;
+    case 2: glutSolidTeacup( 0.8 ); break;
+    case 3: glutWireTeacup( 0.8 ); break;
+    case 4: glutSolidTeaspoon( 3.0 ); break;
+    case 5: glutWireTeaspoon( 3.0 ); break;
+    }
+}
+
+static GLuint buildShader( GLenum type, const char* source )
+{
+    GLuint shader = glCreateShader( type );
+    glShaderSource( shader, 1, &source, NULL );
+    glCompileShader( shader );
+    return shader;
+}
+
+/*
+ * Draws every shape, at the default subdivisions and then at 24, in a
+ * context of the given version. Returns 0, SKIPPED if that context is no
+ * good for the test, or 1 if a shape took the wrong path.
+ */
+static int render( int major, int minor, unsigned char* images )
+{
+    const GLboolean gpu = major >= 4;
+    const char* renderer;
+    GLuint program;
+    int shape;
+
+    glutInitContextVersion( major, minor );
+    glutInitContextProfile( GLUT_CORE_PROFILE );
+    glutCreateWindow( "teapot_tessellation_test" );
+    glutDisplayFunc( display );
+    glutMainLoopEvent( );
+
+    renderer = (const char*)glGetString( GL_RENDERER );
+    if( !renderer || !strstr( renderer, "llvmpipe" ) || fgState.GLVersion / 10 != major )
+    {
+        printf( "GL %d.%d: got %s on %s, skipping\n", major, minor,
+                glGetString( GL_VERSION ), renderer ? renderer : "nothing" );
+        return SKIPPED;
+    }
+
+    program = glCreateProgram( );
+    glAttachShader( program, buildShader( GL_VERTEX_SHADER, vertexShader ) );
+    glAttachShader( program, buildShader( GL_FRAGMENT_SHADER, fragmentShader ) );
+    glLinkProgram( program );
+    glUseProgram( program );
+    glutSetVertexAttribCoord3( glGetAttribLocation( program, "v_coord" ) );
+    glutSetVertexAttribNormal( glGetAttribLocation( program, "v_normal" ) );
+    glEnable( GL_DEPTH_TEST );
+
+    for( shape = 0; shape < NUM_SHAPES; shape++ )
+    {
+        glutSetOption( GLUT_GEOMETRY_TEAPOT_SUBDIVISIONS, shape < NUM_SHAPES / 2 ? 0 : 24 );
+        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+        drawShape( shape );
+        glReadPixels( 0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, images + shape * IMAGE_BYTES );
+    }
+
+    /* The GPU tessellator is only made when a shape needs it */
+    if( ( fgStructure.CurrentWindow->Window.Tessellator != NULL ) != gpu )
+    {
+        printf( "GL %d.%d: the shapes were not tessellated on the %s\n", major, minor, gpu ? "GPU" : "CPU" );
+        return 1;
+    }
+    return 0;
+}
+
+/* Renders the CPU images in a child process, as Mesa reads its version override once */
+static int renderCpu( int argc, char** argv, unsigned char* images )
+{
+    int fds[ 2 ], status, result;
+    size_t got = 0;
+    ssize_t n;
+    pid_t child;
+
+    if( pipe( fds ) || ( child = fork( ) ) < 0 )
+        return 1;
+
+    if( child == 0 )
+    {
+        close( fds[ 0 ] );
+        setenv( "MESA_GL_VERSION_OVERRIDE", "3.3", 1 );
+        glutInit( &argc, argv );
+        glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+        glutInitWindowSize( SIZE, SIZE );
+        result = render( 3, 3, images );
+        if( result == 0 && write( fds[ 1 ], images, NUM_SHAPES * IMAGE_BYTES ) != NUM_SHAPES * IMAGE_BYTES )
+            result = 1;
+        _exit( result );
+    }
+
+    close( fds[ 1 ] );
+    while( got < NUM_SHAPES * IMAGE_BYTES &&
+           ( n = read( fds[ 0 ], images + got, NUM_SHAPES * IMAGE_BYTES - got ) ) > 0 )
+        got += ( size_t )n;
+    close( fds[ 0 ] );
+    if( waitpid( child, &status, 0 ) != child || !WIFEXITED( status ) )
+        return 1;
+    if( WEXITSTATUS( status ) != 0 )
+        return WEXITSTATUS( status );
+    return got == NUM_SHAPES * IMAGE_BYTES ? 0 : 1;
+}
+
+int main( int argc, char** argv )
+{
+    unsigned char* cpu = malloc( NUM_SHAPES * IMAGE_BYTES );
+    unsigned char* gpu = malloc( NUM_SHAPES * IMAGE_BYTES );
+    int shape, i, result, failed = 0;
+
+    if( !cpu || !gpu )
+        return 1;
+
+    /* Before anything of GL is loaded in this process */
+    result = renderCpu( argc, argv, cpu );
+    if( result )
+        return result;
+
+    glutInit( &argc, argv );
+    glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+    glutInitWindowSize( SIZE, SIZE );
+    result = render( 4, 3, gpu );
+    if( result )
+        return result;
+
+    for( shape = 0; shape < NUM_SHAPES; shape++ )
+    {
+        const unsigned char* a = cpu + shape * IMAGE_BYTES;
+        const unsigned char* b = gpu + shape * IMAGE_BYTES;
+        int maxDiff = 0, numDiff = 0, numDrawn = 0;
+
+        for( i = 0; i < IMAGE_BYTES; i += 4 )
+        {
+            int c, diff = 0;
+            for( c = 0; c < 3; c++ )
+                if( abs( a[ i + c ] - b[ i + c ] ) > diff )
+                    diff = abs( a[ i + c ] - b[ i + c ] );
+            if( diff > maxDiff )
+                maxDiff = diff;
+            numDiff += diff != 0;
+            numDrawn += a[ i ] || a[ i + 1 ] || a[ i + 2 ];
+        }
+
+        printf( "%s, %s subdivisions: %d pixels drawn, %d differ, max difference %d\n",
+                shapeNames[ shape % 6 ], shape < NUM_SHAPES / 2 ? "default" : "24",
+                numDrawn, numDiff, maxDiff );
+        if( maxDiff != 0 || numDrawn == 0 )
+            failed = 1;
+    }
+
+    free( cpu );
+    free( gpu );
+    return failed;
+}